@@ -0,0 +1,120 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/testing/CMakeLists.txt"
+  "/root/repo/third_party/CMakeLists.txt"
+  "/root/repo/third_party/googletest-release-1.8.1/CMakeLists.txt"
+  "/root/repo/third_party/googletest-release-1.8.1/googlemock/CMakeLists.txt"
+  "/root/repo/third_party/googletest-release-1.8.1/googlemock/cmake/gmock.pc.in"
+  "/root/repo/third_party/googletest-release-1.8.1/googlemock/cmake/gmock_main.pc.in"
+  "/root/repo/third_party/googletest-release-1.8.1/googletest/CMakeLists.txt"
+  "/root/repo/third_party/googletest-release-1.8.1/googletest/cmake/Config.cmake.in"
+  "/root/repo/third_party/googletest-release-1.8.1/googletest/cmake/gtest.pc.in"
+  "/root/repo/third_party/googletest-release-1.8.1/googletest/cmake/gtest_main.pc.in"
+  "/root/repo/third_party/googletest-release-1.8.1/googletest/cmake/internal_utils.cmake"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-AnyNewerVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeDependentOption.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPythonInterp.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "testing/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/googletest-release-1.8.1/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/gmock.pc"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/gmock_main.pc"
+  "third_party/googletest-release-1.8.1/googlemock/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/GTestConfigVersion.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/GTestConfig.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/gtest.pc"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/generated/gtest_main.pc"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/CMakeFiles/jstdlib.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testUdpClient.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testUdpServerApp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testTcpServerApp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testTcpClient.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testTcpServer.dir/DependInfo.cmake"
+  "testing/CMakeFiles/scrap.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchServerDispatch.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testEventLoopApp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testHttpServerApp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/httpLoad.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testHttpParser.dir/DependInfo.cmake"
+  "testing/CMakeFiles/kvCacheServer.dir/DependInfo.cmake"
+  "testing/CMakeFiles/kvBench.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testRespParser.dir/DependInfo.cmake"
+  "testing/CMakeFiles/testTcpProxyApp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/trafficReplay.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchWal.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchShedding.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchFairQueue.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchCoalescing.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchResponseCache.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchHotRestart.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchRouter.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchCodec.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchTcpInfo.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchUdpBatch.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchUdpOffload.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchReusePort.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchClientIndex.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchReliableUdp.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchFragmentation.dir/DependInfo.cmake"
+  "testing/CMakeFiles/benchMulticast.dir/DependInfo.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/CMakeFiles/gmock.dir/DependInfo.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/CMakeFiles/gmock_main.dir/DependInfo.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  "third_party/googletest-release-1.8.1/googlemock/gtest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,44 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/BackendPool.cpp" "src/CMakeFiles/jstdlib.dir/BackendPool.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/BackendPool.cpp.o.d"
+  "/root/repo/src/BufferPool.cpp" "src/CMakeFiles/jstdlib.dir/BufferPool.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/BufferPool.cpp.o.d"
+  "/root/repo/src/ClientIndex.cpp" "src/CMakeFiles/jstdlib.dir/ClientIndex.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/ClientIndex.cpp.o.d"
+  "/root/repo/src/ConnectionTable.cpp" "src/CMakeFiles/jstdlib.dir/ConnectionTable.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/ConnectionTable.cpp.o.d"
+  "/root/repo/src/DatagramBatch.cpp" "src/CMakeFiles/jstdlib.dir/DatagramBatch.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/DatagramBatch.cpp.o.d"
+  "/root/repo/src/EventLoop.cpp" "src/CMakeFiles/jstdlib.dir/EventLoop.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/EventLoop.cpp.o.d"
+  "/root/repo/src/Fragmentation.cpp" "src/CMakeFiles/jstdlib.dir/Fragmentation.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/Fragmentation.cpp.o.d"
+  "/root/repo/src/HotRestart.cpp" "src/CMakeFiles/jstdlib.dir/HotRestart.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/HotRestart.cpp.o.d"
+  "/root/repo/src/HttpParser.cpp" "src/CMakeFiles/jstdlib.dir/HttpParser.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/HttpParser.cpp.o.d"
+  "/root/repo/src/HttpResponse.cpp" "src/CMakeFiles/jstdlib.dir/HttpResponse.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/HttpResponse.cpp.o.d"
+  "/root/repo/src/IPAddress.cpp" "src/CMakeFiles/jstdlib.dir/IPAddress.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/IPAddress.cpp.o.d"
+  "/root/repo/src/IoUring.cpp" "src/CMakeFiles/jstdlib.dir/IoUring.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/IoUring.cpp.o.d"
+  "/root/repo/src/KvStore.cpp" "src/CMakeFiles/jstdlib.dir/KvStore.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/KvStore.cpp.o.d"
+  "/root/repo/src/Multicast.cpp" "src/CMakeFiles/jstdlib.dir/Multicast.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/Multicast.cpp.o.d"
+  "/root/repo/src/ReliableUdp.cpp" "src/CMakeFiles/jstdlib.dir/ReliableUdp.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/ReliableUdp.cpp.o.d"
+  "/root/repo/src/RequestCoalescer.cpp" "src/CMakeFiles/jstdlib.dir/RequestCoalescer.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/RequestCoalescer.cpp.o.d"
+  "/root/repo/src/RespParser.cpp" "src/CMakeFiles/jstdlib.dir/RespParser.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/RespParser.cpp.o.d"
+  "/root/repo/src/ResponseCache.cpp" "src/CMakeFiles/jstdlib.dir/ResponseCache.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/ResponseCache.cpp.o.d"
+  "/root/repo/src/ReusePort.cpp" "src/CMakeFiles/jstdlib.dir/ReusePort.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/ReusePort.cpp.o.d"
+  "/root/repo/src/TcpInfo.cpp" "src/CMakeFiles/jstdlib.dir/TcpInfo.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/TcpInfo.cpp.o.d"
+  "/root/repo/src/TcpSocket.cpp" "src/CMakeFiles/jstdlib.dir/TcpSocket.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/TcpSocket.cpp.o.d"
+  "/root/repo/src/TrafficCapture.cpp" "src/CMakeFiles/jstdlib.dir/TrafficCapture.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/TrafficCapture.cpp.o.d"
+  "/root/repo/src/WriteAheadLog.cpp" "src/CMakeFiles/jstdlib.dir/WriteAheadLog.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/WriteAheadLog.cpp.o.d"
+  "/root/repo/src/epoll_set.cpp" "src/CMakeFiles/jstdlib.dir/epoll_set.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/epoll_set.cpp.o.d"
+  "/root/repo/src/fd_sets.cpp" "src/CMakeFiles/jstdlib.dir/fd_sets.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/fd_sets.cpp.o.d"
+  "/root/repo/src/jstd_util.cpp" "src/CMakeFiles/jstdlib.dir/jstd_util.cpp.o" "gcc" "src/CMakeFiles/jstdlib.dir/jstd_util.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,61 @@
+file(REMOVE_RECURSE
+  "/root/repo/lib/libjstdlib.pdb"
+  "/root/repo/lib/libjstdlib.so"
+  "CMakeFiles/jstdlib.dir/BackendPool.cpp.o"
+  "CMakeFiles/jstdlib.dir/BackendPool.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/BufferPool.cpp.o"
+  "CMakeFiles/jstdlib.dir/BufferPool.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/ClientIndex.cpp.o"
+  "CMakeFiles/jstdlib.dir/ClientIndex.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/ConnectionTable.cpp.o"
+  "CMakeFiles/jstdlib.dir/ConnectionTable.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/DatagramBatch.cpp.o"
+  "CMakeFiles/jstdlib.dir/DatagramBatch.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/EventLoop.cpp.o"
+  "CMakeFiles/jstdlib.dir/EventLoop.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/Fragmentation.cpp.o"
+  "CMakeFiles/jstdlib.dir/Fragmentation.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/HotRestart.cpp.o"
+  "CMakeFiles/jstdlib.dir/HotRestart.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/HttpParser.cpp.o"
+  "CMakeFiles/jstdlib.dir/HttpParser.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/HttpResponse.cpp.o"
+  "CMakeFiles/jstdlib.dir/HttpResponse.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/IPAddress.cpp.o"
+  "CMakeFiles/jstdlib.dir/IPAddress.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/IoUring.cpp.o"
+  "CMakeFiles/jstdlib.dir/IoUring.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/KvStore.cpp.o"
+  "CMakeFiles/jstdlib.dir/KvStore.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/Multicast.cpp.o"
+  "CMakeFiles/jstdlib.dir/Multicast.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/ReliableUdp.cpp.o"
+  "CMakeFiles/jstdlib.dir/ReliableUdp.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/RequestCoalescer.cpp.o"
+  "CMakeFiles/jstdlib.dir/RequestCoalescer.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/RespParser.cpp.o"
+  "CMakeFiles/jstdlib.dir/RespParser.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/ResponseCache.cpp.o"
+  "CMakeFiles/jstdlib.dir/ResponseCache.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/ReusePort.cpp.o"
+  "CMakeFiles/jstdlib.dir/ReusePort.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/TcpInfo.cpp.o"
+  "CMakeFiles/jstdlib.dir/TcpInfo.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/TcpSocket.cpp.o"
+  "CMakeFiles/jstdlib.dir/TcpSocket.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/TrafficCapture.cpp.o"
+  "CMakeFiles/jstdlib.dir/TrafficCapture.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/WriteAheadLog.cpp.o"
+  "CMakeFiles/jstdlib.dir/WriteAheadLog.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/epoll_set.cpp.o"
+  "CMakeFiles/jstdlib.dir/epoll_set.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/fd_sets.cpp.o"
+  "CMakeFiles/jstdlib.dir/fd_sets.cpp.o.d"
+  "CMakeFiles/jstdlib.dir/jstd_util.cpp.o"
+  "CMakeFiles/jstdlib.dir/jstd_util.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jstdlib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
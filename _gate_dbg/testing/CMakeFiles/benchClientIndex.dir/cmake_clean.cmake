@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchClientIndex"
+  "/root/repo/bin/benchClientIndex.pdb"
+  "CMakeFiles/benchClientIndex.dir/benchClientIndex.cpp.o"
+  "CMakeFiles/benchClientIndex.dir/benchClientIndex.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchClientIndex.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
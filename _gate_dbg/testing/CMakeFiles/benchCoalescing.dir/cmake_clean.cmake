@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchCoalescing"
+  "/root/repo/bin/benchCoalescing.pdb"
+  "CMakeFiles/benchCoalescing.dir/benchCoalescing.cpp.o"
+  "CMakeFiles/benchCoalescing.dir/benchCoalescing.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchCoalescing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
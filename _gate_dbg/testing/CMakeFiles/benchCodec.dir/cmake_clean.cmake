@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchCodec"
+  "/root/repo/bin/benchCodec.pdb"
+  "CMakeFiles/benchCodec.dir/benchCodec.cpp.o"
+  "CMakeFiles/benchCodec.dir/benchCodec.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchCodec.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchFairQueue"
+  "/root/repo/bin/benchFairQueue.pdb"
+  "CMakeFiles/benchFairQueue.dir/benchFairQueue.cpp.o"
+  "CMakeFiles/benchFairQueue.dir/benchFairQueue.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchFairQueue.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchFragmentation"
+  "/root/repo/bin/benchFragmentation.pdb"
+  "CMakeFiles/benchFragmentation.dir/benchFragmentation.cpp.o"
+  "CMakeFiles/benchFragmentation.dir/benchFragmentation.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchFragmentation.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
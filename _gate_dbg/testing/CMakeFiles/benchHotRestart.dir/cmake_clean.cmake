@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchHotRestart"
+  "/root/repo/bin/benchHotRestart.pdb"
+  "CMakeFiles/benchHotRestart.dir/benchHotRestart.cpp.o"
+  "CMakeFiles/benchHotRestart.dir/benchHotRestart.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchHotRestart.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
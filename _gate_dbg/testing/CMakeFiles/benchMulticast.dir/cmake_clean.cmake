@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchMulticast"
+  "/root/repo/bin/benchMulticast.pdb"
+  "CMakeFiles/benchMulticast.dir/benchMulticast.cpp.o"
+  "CMakeFiles/benchMulticast.dir/benchMulticast.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchMulticast.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
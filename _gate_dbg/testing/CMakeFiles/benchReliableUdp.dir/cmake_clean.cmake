@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchReliableUdp"
+  "/root/repo/bin/benchReliableUdp.pdb"
+  "CMakeFiles/benchReliableUdp.dir/benchReliableUdp.cpp.o"
+  "CMakeFiles/benchReliableUdp.dir/benchReliableUdp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchReliableUdp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchResponseCache"
+  "/root/repo/bin/benchResponseCache.pdb"
+  "CMakeFiles/benchResponseCache.dir/benchResponseCache.cpp.o"
+  "CMakeFiles/benchResponseCache.dir/benchResponseCache.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchResponseCache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchReusePort"
+  "/root/repo/bin/benchReusePort.pdb"
+  "CMakeFiles/benchReusePort.dir/benchReusePort.cpp.o"
+  "CMakeFiles/benchReusePort.dir/benchReusePort.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchReusePort.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchRouter"
+  "/root/repo/bin/benchRouter.pdb"
+  "CMakeFiles/benchRouter.dir/benchRouter.cpp.o"
+  "CMakeFiles/benchRouter.dir/benchRouter.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchRouter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchServerDispatch"
+  "/root/repo/bin/benchServerDispatch.pdb"
+  "CMakeFiles/benchServerDispatch.dir/benchServerDispatch.cpp.o"
+  "CMakeFiles/benchServerDispatch.dir/benchServerDispatch.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchServerDispatch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
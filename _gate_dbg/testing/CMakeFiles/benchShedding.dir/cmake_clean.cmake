@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchShedding"
+  "/root/repo/bin/benchShedding.pdb"
+  "CMakeFiles/benchShedding.dir/benchShedding.cpp.o"
+  "CMakeFiles/benchShedding.dir/benchShedding.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchShedding.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchTcpInfo"
+  "/root/repo/bin/benchTcpInfo.pdb"
+  "CMakeFiles/benchTcpInfo.dir/benchTcpInfo.cpp.o"
+  "CMakeFiles/benchTcpInfo.dir/benchTcpInfo.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchTcpInfo.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
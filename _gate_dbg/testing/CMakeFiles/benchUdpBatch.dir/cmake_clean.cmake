@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchUdpBatch"
+  "/root/repo/bin/benchUdpBatch.pdb"
+  "CMakeFiles/benchUdpBatch.dir/benchUdpBatch.cpp.o"
+  "CMakeFiles/benchUdpBatch.dir/benchUdpBatch.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchUdpBatch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
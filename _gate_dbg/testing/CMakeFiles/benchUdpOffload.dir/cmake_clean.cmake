@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchUdpOffload"
+  "/root/repo/bin/benchUdpOffload.pdb"
+  "CMakeFiles/benchUdpOffload.dir/benchUdpOffload.cpp.o"
+  "CMakeFiles/benchUdpOffload.dir/benchUdpOffload.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchUdpOffload.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
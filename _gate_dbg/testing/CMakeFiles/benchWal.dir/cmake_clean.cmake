@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/benchWal"
+  "/root/repo/bin/benchWal.pdb"
+  "CMakeFiles/benchWal.dir/benchWal.cpp.o"
+  "CMakeFiles/benchWal.dir/benchWal.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/benchWal.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/httpLoad"
+  "/root/repo/bin/httpLoad.pdb"
+  "CMakeFiles/httpLoad.dir/httpLoad.cpp.o"
+  "CMakeFiles/httpLoad.dir/httpLoad.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/httpLoad.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
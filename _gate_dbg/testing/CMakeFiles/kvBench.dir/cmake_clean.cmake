@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/kvBench"
+  "/root/repo/bin/kvBench.pdb"
+  "CMakeFiles/kvBench.dir/kvBench.cpp.o"
+  "CMakeFiles/kvBench.dir/kvBench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/kvBench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
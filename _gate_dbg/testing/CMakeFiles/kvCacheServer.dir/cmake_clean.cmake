@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/kvCacheServer"
+  "/root/repo/bin/kvCacheServer.pdb"
+  "CMakeFiles/kvCacheServer.dir/kvCacheServer.cpp.o"
+  "CMakeFiles/kvCacheServer.dir/kvCacheServer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/kvCacheServer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/scrap"
+  "/root/repo/bin/scrap.pdb"
+  "CMakeFiles/scrap.dir/scrap.cpp.o"
+  "CMakeFiles/scrap.dir/scrap.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/scrap.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testEventLoopApp"
+  "/root/repo/bin/testEventLoopApp.pdb"
+  "CMakeFiles/testEventLoopApp.dir/testEventLoopApp.cpp.o"
+  "CMakeFiles/testEventLoopApp.dir/testEventLoopApp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testEventLoopApp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
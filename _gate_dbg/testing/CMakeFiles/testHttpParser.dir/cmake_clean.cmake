@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testHttpParser"
+  "/root/repo/bin/testHttpParser.pdb"
+  "CMakeFiles/testHttpParser.dir/testHttpParser.cpp.o"
+  "CMakeFiles/testHttpParser.dir/testHttpParser.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testHttpParser.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
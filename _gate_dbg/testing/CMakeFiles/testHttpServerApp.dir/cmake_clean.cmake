@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testHttpServerApp"
+  "/root/repo/bin/testHttpServerApp.pdb"
+  "CMakeFiles/testHttpServerApp.dir/testHttpServerApp.cpp.o"
+  "CMakeFiles/testHttpServerApp.dir/testHttpServerApp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testHttpServerApp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
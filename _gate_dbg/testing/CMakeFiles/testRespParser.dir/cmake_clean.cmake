@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testRespParser"
+  "/root/repo/bin/testRespParser.pdb"
+  "CMakeFiles/testRespParser.dir/testRespParser.cpp.o"
+  "CMakeFiles/testRespParser.dir/testRespParser.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testRespParser.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
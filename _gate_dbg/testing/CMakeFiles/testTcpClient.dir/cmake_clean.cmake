@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testTcpClient"
+  "/root/repo/bin/testTcpClient.pdb"
+  "CMakeFiles/testTcpClient.dir/testTcpClient.cpp.o"
+  "CMakeFiles/testTcpClient.dir/testTcpClient.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testTcpClient.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
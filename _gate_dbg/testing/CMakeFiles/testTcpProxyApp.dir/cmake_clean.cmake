@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testTcpProxyApp"
+  "/root/repo/bin/testTcpProxyApp.pdb"
+  "CMakeFiles/testTcpProxyApp.dir/testTcpProxyApp.cpp.o"
+  "CMakeFiles/testTcpProxyApp.dir/testTcpProxyApp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testTcpProxyApp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
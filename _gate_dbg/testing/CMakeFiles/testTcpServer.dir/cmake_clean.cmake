@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testTcpServer"
+  "/root/repo/bin/testTcpServer.pdb"
+  "CMakeFiles/testTcpServer.dir/testTcpServer.cpp.o"
+  "CMakeFiles/testTcpServer.dir/testTcpServer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testTcpServer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
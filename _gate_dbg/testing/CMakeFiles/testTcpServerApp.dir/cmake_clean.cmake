@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testTcpServerApp"
+  "/root/repo/bin/testTcpServerApp.pdb"
+  "CMakeFiles/testTcpServerApp.dir/testTcpServerApp.cpp.o"
+  "CMakeFiles/testTcpServerApp.dir/testTcpServerApp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testTcpServerApp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
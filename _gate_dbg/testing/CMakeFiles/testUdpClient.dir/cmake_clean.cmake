@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testUdpClient"
+  "/root/repo/bin/testUdpClient.pdb"
+  "CMakeFiles/testUdpClient.dir/testUdpClient.cpp.o"
+  "CMakeFiles/testUdpClient.dir/testUdpClient.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testUdpClient.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/testUdpServerApp"
+  "/root/repo/bin/testUdpServerApp.pdb"
+  "CMakeFiles/testUdpServerApp.dir/testUdpServerApp.cpp.o"
+  "CMakeFiles/testUdpServerApp.dir/testUdpServerApp.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testUdpServerApp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
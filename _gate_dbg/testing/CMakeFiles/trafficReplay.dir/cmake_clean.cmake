@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/bin/trafficReplay"
+  "/root/repo/bin/trafficReplay.pdb"
+  "CMakeFiles/trafficReplay.dir/trafficReplay.cpp.o"
+  "CMakeFiles/trafficReplay.dir/trafficReplay.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/trafficReplay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
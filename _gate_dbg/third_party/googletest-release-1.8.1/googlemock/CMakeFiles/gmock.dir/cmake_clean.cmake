@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/lib/libgmockd.a"
+  "/root/repo/lib/libgmockd.pdb"
+  "CMakeFiles/gmock.dir/src/gmock-all.cc.o"
+  "CMakeFiles/gmock.dir/src/gmock-all.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gmock.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
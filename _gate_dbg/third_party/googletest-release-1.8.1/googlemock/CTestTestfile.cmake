@@ -0,0 +1,7 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/third_party/googletest-release-1.8.1/googlemock
+# Build directory: /root/repo/_gate_dbg/third_party/googletest-release-1.8.1/googlemock
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("gtest")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "/root/repo/lib/libgtest_maind.a"
+  "/root/repo/lib/libgtest_maind.pdb"
+  "CMakeFiles/gtest_main.dir/src/gtest_main.cc.o"
+  "CMakeFiles/gtest_main.dir/src/gtest_main.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gtest_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,6 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/third_party/googletest-release-1.8.1/googletest
+# Build directory: /root/repo/_gate_dbg/third_party/googletest-release-1.8.1/googlemock/gtest
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
@@ -0,0 +1,85 @@
+#include "BackendPool.h"
+#include <chrono>
+
+using namespace jstd::net;
+
+namespace {
+    inline uint64_t now_ms() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+BackendPool::BackendPool(LB_POLICY policy, unsigned fail_threshold, unsigned retry_ms):
+    m_policy(policy), m_fail_threshold(fail_threshold ? fail_threshold : 1), m_retry_ms(retry_ms), m_next(0) { }
+
+size_t BackendPool::add(const std::string &ip, uint16_t port) {
+    m_backends.push_back(Backend{IPAddress(ip), port, true, 0, 0, 0, 0});
+    return m_backends.size() - 1;
+}
+
+bool BackendPool::usable(Backend &be, uint64_t now) const {
+    if (be.healthy) return true;
+    if (now < be.retry_at) return false;
+    be.retry_at = now + m_retry_ms;     // one probe per retry interval
+    return true;
+}
+
+int BackendPool::select() {
+    if (m_backends.empty()) return -1;
+    uint64_t now = now_ms();
+    size_t cnt = m_backends.size();
+    int best = -1;
+    for (size_t n = 0; n < cnt; n++) {
+        size_t idx = (m_next + n) % cnt;
+        Backend &be = m_backends[idx];
+        if (m_policy == LB_POLICY::ROUND_ROBIN) {
+            if (!usable(be, now)) continue;
+            best = static_cast<int>(idx);
+            break;
+        }
+        // least connections, a down backend only takes part once its probe is due
+        if ((!be.healthy && now < be.retry_at) || (best >= 0 && be.active >= m_backends[best].active))
+            continue;
+        best = static_cast<int>(idx);
+    }
+    if (best < 0) return -1;
+    if (m_policy == LB_POLICY::LEAST_CONNECTIONS) usable(m_backends[best], now);
+    m_backends[best].active++;
+    m_next = static_cast<size_t>(best) + 1;
+    return best;
+}
+
+void BackendPool::connected(size_t idx) {
+    Backend &be = m_backends[idx];
+    be.total++;
+    be.failures = 0;
+    be.healthy = true;
+}
+
+void BackendPool::released(size_t idx) {
+    Backend &be = m_backends[idx];
+    if (be.active) be.active--;
+}
+
+void BackendPool::failed(size_t idx) {
+    Backend &be = m_backends[idx];
+    if (++be.failures >= m_fail_threshold || !be.healthy) {
+        be.healthy = false;
+        be.retry_at = now_ms() + m_retry_ms;
+    }
+}
+
+void BackendPool::set_healthy(size_t idx, bool healthy) {
+    Backend &be = m_backends[idx];
+    be.healthy = healthy;
+    be.failures = 0;
+    if (!healthy) be.retry_at = now_ms() + m_retry_ms;
+}
+
+size_t BackendPool::healthy_count() const {
+    size_t cnt = 0;
+    for (const auto &be : m_backends)
+        if (be.healthy) cnt++;
+    return cnt;
+}
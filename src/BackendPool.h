@@ -0,0 +1,74 @@
+#ifndef JSTDLIB_BACKENDPOOL_H
+#define JSTDLIB_BACKENDPOOL_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "IPAddress.h"
+
+/*
+ * Upstream set of a TCP proxy, picks the backend for each new client and tracks per backend health.
+ *  - ROUND_ROBIN cycles over healthy backends, LEAST_CONNECTIONS takes the healthy one with the fewest
+ *    active sessions (ties broken round robin)
+ *  - health is passive: fail_threshold consecutive connect failures mark a backend down, after retry_ms it is
+ *    handed out again as a probe (half open), a successful connect marks it up, set_healthy() lets an
+ *    external checker override the state
+ *  - addresses are resolved once in add(), select() does no lookups
+ */
+namespace jstd {
+    namespace net {
+        enum class LB_POLICY { ROUND_ROBIN, LEAST_CONNECTIONS };
+
+        struct Backend {
+            IPAddress addr;
+            uint16_t port;
+            bool healthy;
+            unsigned active;            // sessions currently using the backend
+            unsigned failures;          // consecutive connect failures
+            uint64_t retry_at;          // steady clock ms a down backend is probed again
+            uint64_t total;             // sessions ever connected
+        };
+
+        class BackendPool {
+            std::vector<Backend> m_backends;
+            LB_POLICY m_policy;
+            unsigned m_fail_threshold;
+            unsigned m_retry_ms;
+            size_t m_next;
+
+            bool usable(Backend &be, uint64_t now) const;
+
+        public:
+            explicit BackendPool(LB_POLICY policy = LB_POLICY::ROUND_ROBIN, unsigned fail_threshold = 3,
+                                 unsigned retry_ms = 5000);
+
+            // returns the backend index, throws std::runtime_error on an invalid address like IPAddress
+            size_t add(const std::string &ip, uint16_t port);
+
+            // backend for a new session, -1 if none is usable, counts the session as active until released()
+            int select();
+
+            // the session's connect succeeded, marks the backend healthy
+            void connected(size_t idx);
+
+            // session ended or its connect failed
+            void released(size_t idx);
+
+            // connect attempt failed, counts towards fail_threshold
+            void failed(size_t idx);
+
+            void set_healthy(size_t idx, bool healthy);
+
+            inline void set_policy(LB_POLICY policy) { m_policy = policy; }
+
+            inline LB_POLICY policy() const { return m_policy; }
+
+            inline const Backend &at(size_t idx) const { return m_backends[idx]; }
+
+            inline size_t size() const { return m_backends.size(); }
+
+            size_t healthy_count() const;
+        };
+    }
+}
+
+#endif //JSTDLIB_BACKENDPOOL_H
@@ -0,0 +1,27 @@
+#include "BufferPool.h"
+
+using namespace jstd::net;
+
+BufferPool::BufferPool(size_t buff_sz, unsigned chunk_cnt):
+    m_buff_sz(buff_sz ? buff_sz : 1), m_chunk_cnt(chunk_cnt ? chunk_cnt : 1), m_total(0) {
+    grow();
+}
+
+void BufferPool::grow() {
+    std::unique_ptr<uint8_t[]> chunk(new uint8_t[m_buff_sz * m_chunk_cnt]);
+    for (unsigned i = 0; i < m_chunk_cnt; i++)
+        m_free.push_back(chunk.get() + (i * m_buff_sz));
+    m_chunks.push_back(std::move(chunk));
+    m_total += m_chunk_cnt;
+}
+
+uint8_t *BufferPool::acquire() {
+    if (m_free.empty()) grow();
+    uint8_t *buff = m_free.back();
+    m_free.pop_back();
+    return buff;
+}
+
+void BufferPool::release(uint8_t *buff) {
+    if (buff) m_free.push_back(buff);
+}
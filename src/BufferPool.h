@@ -0,0 +1,64 @@
+#ifndef JSTDLIB_BUFFERPOOL_H
+#define JSTDLIB_BUFFERPOOL_H
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * Free list of equally sized byte buffers, allocated in chunks and reused for the life of the pool.
+ * Not synchronized, a pool belongs to one thread (e.g. the thread running an EventLoop) and is shared by
+ * every handler running there.
+ */
+namespace jstd {
+    namespace net {
+        class BufferPool {
+            size_t m_buff_sz;
+            unsigned m_chunk_cnt;
+            std::vector<std::unique_ptr<uint8_t[]>> m_chunks;
+            std::vector<uint8_t*> m_free;
+            size_t m_total;
+
+            void grow();
+
+        public:
+            // buff_sz bytes per buffer, buffers are allocated chunk_cnt at a time
+            BufferPool(size_t buff_sz, unsigned chunk_cnt);
+
+            BufferPool(const BufferPool&) = delete;
+            BufferPool& operator = (const BufferPool&) = delete;
+
+            // never fails, the pool grows by one chunk when empty
+            uint8_t *acquire();
+
+            // buff must have come from acquire() on this pool
+            void release(uint8_t *buff);
+
+            inline size_t buffer_size() const { return m_buff_sz; }
+
+            inline size_t available() const { return m_free.size(); }
+
+            inline size_t capacity() const { return m_total; }
+        };
+
+        // returns its buffer to the pool when it goes out of scope
+        class PooledBuffer {
+            BufferPool &m_pool;
+            uint8_t *m_buff;
+
+        public:
+            explicit PooledBuffer(BufferPool &pool): m_pool(pool), m_buff(pool.acquire()) {}
+
+            PooledBuffer(const PooledBuffer&) = delete;
+            PooledBuffer& operator = (const PooledBuffer&) = delete;
+
+            ~PooledBuffer() { m_pool.release(m_buff); }
+
+            inline uint8_t *data() const { return m_buff; }
+
+            inline size_t size() const { return m_pool.buffer_size(); }
+        };
+    }
+}
+
+#endif //JSTDLIB_BUFFERPOOL_H
@@ -0,0 +1,94 @@
+#include "ClientIndex.h"
+#include <thread>
+
+using namespace jstd::net;
+
+constexpr unsigned ClientIndex::READER_SLOTS;
+constexpr uint64_t ClientIndex::EMPTY;
+constexpr uint64_t ClientIndex::TOMBSTONE;
+
+namespace {
+    constexpr size_t MIN_CAPACITY = 16;
+}
+
+ClientIndex::table::table(size_t capacity): entries(new entry[capacity]), mask(capacity - 1), shift(64), used(0) {
+    for (size_t c = capacity; c > 1; c >>= 1) shift--;
+    for (size_t i = 0; i < capacity; i++) {
+        entries[i].key.store(0, std::memory_order_relaxed);
+        entries[i].handle.store(EMPTY, std::memory_order_relaxed);
+    }
+}
+
+ClientIndex::ClientIndex(size_t capacity): m_table(nullptr), m_size(0) {
+    for (auto &r : m_readers) r.active.store(0, std::memory_order_relaxed);
+    size_t cap = MIN_CAPACITY;
+    while (cap < capacity) cap <<= 1;
+    m_owned.reset(new table(cap));
+    m_table.store(m_owned.get(), std::memory_order_release);
+}
+
+bool ClientIndex::insert(uint64_t key, ConnHandle handle) {
+    if (!handle.is_valid() || handle.value == TOMBSTONE) return false;
+    // at most half the slots taken so probes stay short, a rebuild leaves it a quarter full at most
+    if ((m_owned->used + 1) * 2 > m_owned->mask + 1) {
+        size_t cap = MIN_CAPACITY;
+        while (cap < (m_size + 1) * 4) cap <<= 1;
+        rebuild(cap);
+    }
+    table &t = *m_owned;
+    for (size_t i = t.home(key);; i = (i + 1) & t.mask) {
+        uint64_t h = t.entries[i].handle.load(std::memory_order_relaxed);
+        if (h == EMPTY) {
+            t.entries[i].key.store(key, std::memory_order_relaxed);
+            t.entries[i].handle.store(handle.value, std::memory_order_release);
+            t.used++;
+            m_size++;
+            return true;
+        }
+        if (h != TOMBSTONE && t.entries[i].key.load(std::memory_order_relaxed) == key) return false;
+    }
+}
+
+bool ClientIndex::erase(uint64_t key) {
+    table &t = *m_owned;
+    for (size_t i = t.home(key);; i = (i + 1) & t.mask) {
+        uint64_t h = t.entries[i].handle.load(std::memory_order_relaxed);
+        if (h == EMPTY) return false;
+        if (h != TOMBSTONE && t.entries[i].key.load(std::memory_order_relaxed) == key) {
+            t.entries[i].handle.store(TOMBSTONE, std::memory_order_release);
+            m_size--;
+            return true;
+        }
+    }
+}
+
+void ClientIndex::clear() {
+    publish(new table(MIN_CAPACITY));
+    m_size = 0;
+}
+
+void ClientIndex::rebuild(size_t capacity) {
+    table *next = new table(capacity);
+    const table &t = *m_owned;
+    for (size_t i = 0; i <= t.mask; i++) {
+        uint64_t h = t.entries[i].handle.load(std::memory_order_relaxed);
+        if (h == EMPTY || h == TOMBSTONE) continue;
+        uint64_t key = t.entries[i].key.load(std::memory_order_relaxed);
+        size_t j = next->home(key);
+        while (next->entries[j].handle.load(std::memory_order_relaxed) != EMPTY) j = (j + 1) & next->mask;
+        next->entries[j].key.store(key, std::memory_order_relaxed);
+        next->entries[j].handle.store(h, std::memory_order_relaxed);
+        next->used++;
+    }
+    publish(next);
+}
+
+void ClientIndex::publish(table *next) {
+    std::unique_ptr<table> old(m_owned.release());
+    m_owned.reset(next);
+    m_table.store(next, std::memory_order_seq_cst);
+    // a reader still in the old table announced itself before this store, once its counter was seen at zero it
+    // has left, whoever comes after loads next. Lookups take nanoseconds, rebuilds are rare
+    for (auto &r : m_readers)
+        while (r.active.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+}
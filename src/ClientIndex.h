@@ -0,0 +1,108 @@
+#ifndef JSTDLIB_CLIENTINDEX_H
+#define JSTDLIB_CLIENTINDEX_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "net_types.h"
+
+/*
+ * Address index of a server's clients, 64 bit key (packed address and port, see UdpServerBase::hash_conn) to
+ * ConnHandle, in an open addressed table
+ *  - find() takes no lock and allocates nothing, readers only announce themselves in a per thread counter
+ *  - insert/erase/clear have to be serialized by the owner, it guards them with its client mutex
+ *  - a slot is written once, erasing leaves a tombstone, tombstones go when the table is rebuilt. A table that
+ *    was replaced is freed once every reader that could still be probing it has left
+ *  - find() racing an erase may return the erased handle, it is stale by then and does not resolve
+ */
+namespace jstd {
+    namespace net {
+        class ClientIndex {
+            struct entry {
+                std::atomic<uint64_t> key;
+                std::atomic<uint64_t> handle;   // EMPTY, TOMBSTONE or a ConnHandle value, published after key
+            };
+
+            struct table {
+                std::unique_ptr<entry[]> entries;
+                size_t mask;
+                unsigned shift;
+                size_t used;                    // live entries and tombstones
+
+                explicit table(size_t capacity);
+
+                inline size_t home(uint64_t key) const {
+                    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift);
+                }
+            };
+
+            // one cache line each so lanes on different cores do not share the counter they bump
+            struct reader_slot {
+                std::atomic<uint32_t> active;
+                char pad[64 - sizeof(std::atomic<uint32_t>)];
+            };
+
+            static constexpr unsigned READER_SLOTS = 16;
+
+            std::atomic<table*> m_table;
+            std::unique_ptr<table> m_owned;
+            size_t m_size;
+            mutable reader_slot m_readers[READER_SLOTS];
+
+            // threads take the reader slots round robin, two threads sharing one only share a counter
+            static inline unsigned reader_index() {
+                static std::atomic<unsigned> next{0};
+                static thread_local const unsigned mine = next.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS;
+                return mine;
+            }
+
+            // swap in next and free the old table when no reader is left in it
+            void publish(table *next);
+
+            void rebuild(size_t capacity);
+
+        public:
+            static constexpr uint64_t EMPTY = UINT64_MAX;
+            static constexpr uint64_t TOMBSTONE = UINT64_MAX - 1;
+
+            explicit ClientIndex(size_t capacity = 64);
+
+            ClientIndex(const ClientIndex &) = delete;
+
+            ClientIndex &operator=(const ClientIndex &) = delete;
+
+            // handle stored for key, invalid handle if none, safe from any thread. Inline, it runs per datagram
+            inline ConnHandle find(uint64_t key) const {
+                std::atomic<uint32_t> &active = m_readers[reader_index()].active;
+                // announced before the table is loaded, publish() sees it or this reader sees the new table
+                active.fetch_add(1, std::memory_order_seq_cst);
+                const table *t = m_table.load(std::memory_order_seq_cst);
+                ConnHandle out;
+                for (size_t i = t->home(key);; i = (i + 1) & t->mask) {
+                    uint64_t h = t->entries[i].handle.load(std::memory_order_acquire);
+                    if (h == EMPTY) break;
+                    if (h != TOMBSTONE && t->entries[i].key.load(std::memory_order_relaxed) == key) {
+                        out.value = h;
+                        break;
+                    }
+                }
+                active.fetch_sub(1, std::memory_order_release);
+                return out;
+            }
+
+            // false and nothing stored if key is already present
+            bool insert(uint64_t key, ConnHandle handle);
+
+            // false if key is not present
+            bool erase(uint64_t key);
+
+            void clear();
+
+            inline size_t size() const { return m_size; }
+
+            inline size_t capacity() const { return m_owned->mask + 1; }
+        };
+    }
+}
+
+#endif //JSTDLIB_CLIENTINDEX_H
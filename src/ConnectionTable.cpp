@@ -0,0 +1,55 @@
+#include "ConnectionTable.h"
+
+using namespace jstd::net;
+
+ConnectionTable::ConnectionTable(): m_size(0) { }
+
+ConnHandle ConnectionTable::insert(const NetConnection &conn) {
+    uint32_t idx;
+    if (!m_free.empty()) {
+        idx = m_free.back();
+        m_free.pop_back();
+    } else {
+        idx = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back(slot{NetConnection(), 0, false});
+    }
+    slot &s = m_slots[idx];
+    s.conn = conn;
+    s.conn.handle = ConnHandle(idx, s.generation);
+    s.active = true;
+    m_size++;
+    return s.conn.handle;
+}
+
+bool ConnectionTable::erase(ConnHandle h) {
+    if (!find(h)) return false;
+    slot &s = m_slots[h.index()];
+    s.active = false;
+    s.generation++;
+    m_free.push_back(h.index());
+    m_size--;
+    return true;
+}
+
+const NetConnection *ConnectionTable::find(ConnHandle h) const {
+    if (!h.is_valid() || h.index() >= m_slots.size()) return nullptr;
+    const slot &s = m_slots[h.index()];
+    return (s.active && s.generation == h.generation()) ? &s.conn : nullptr;
+}
+
+NetConnection *ConnectionTable::find(ConnHandle h) {
+    return const_cast<NetConnection*>(static_cast<const ConnectionTable*>(this)->find(h));
+}
+
+void ConnectionTable::clear() {
+    m_free.clear();
+    for (uint32_t idx = 0; idx < m_slots.size(); idx++) {
+        slot &s = m_slots[idx];
+        if (s.active) {
+            s.active = false;
+            s.generation++;
+        }
+        m_free.push_back(idx);
+    }
+    m_size = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef JSTDLIB_CONNECTIONTABLE_H
+#define JSTDLIB_CONNECTIONTABLE_H
+#include <cstdint>
+#include <vector>
+#include "net_types.h"
+
+/*
+ * Slot table of connection records addressed by ConnHandle
+ *  - insert/erase/lookup are O(1), freed slots are recycled with a bumped generation
+ *  - a handle whose generation does not match its slot is stale and never resolves
+ *  - not synchronized, the owning server guards it with its client mutex
+ */
+namespace jstd {
+    namespace net {
+        class ConnectionTable {
+            struct slot {
+                NetConnection conn;
+                uint32_t generation;
+                bool active;
+            };
+
+            std::vector<slot> m_slots;
+            std::vector<uint32_t> m_free;
+            size_t m_size;
+
+        public:
+            ConnectionTable();
+
+            // store a copy of conn, the returned handle is also written to the stored record
+            ConnHandle insert(const NetConnection &conn);
+
+            // remove the record, returns false for unknown or stale handles
+            bool erase(ConnHandle h);
+
+            // nullptr for unknown or stale handles, pointer is invalidated by the next insert
+            const NetConnection *find(ConnHandle h) const;
+
+            NetConnection *find(ConnHandle h);
+
+            inline bool contains(ConnHandle h) const { return find(h) != nullptr; }
+
+            inline size_t size() const { return m_size; }
+
+            inline bool empty() const { return m_size == 0; }
+
+            // drops every record, outstanding handles all become stale
+            void clear();
+
+            // fn(const NetConnection&) for every live record
+            template<typename Fn>
+            void for_each(Fn &&fn) const {
+                for (const auto &s : m_slots)
+                    if (s.active) fn(s.conn);
+            }
+        };
+    }
+}
+
+#endif //JSTDLIB_CONNECTIONTABLE_H
@@ -0,0 +1,240 @@
+#include "DatagramBatch.h"
+#include <algorithm>
+#include <cerrno>
+#include <netinet/udp.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+using namespace jstd::net;
+
+namespace {
+    // uint64_t words per slot for a control message carrying an int
+    const size_t CTRL_WORDS = (CMSG_SPACE(sizeof(int)) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+#ifdef LINUX_OS
+    // sendmmsg hdrs[0, cnt), a datagram the kernel refuses is counted in failed (index into hdrs) and skipped
+    size_t send_all(int sockfd, mmsghdr *hdrs, size_t cnt, std::vector<size_t> *failed, size_t base) {
+        size_t sent = 0;
+        size_t i = 0;
+        while (i < cnt) {
+            int rc = sendmmsg(sockfd, hdrs + i, static_cast<unsigned>(cnt - i), 0);
+            if (rc < 0) {
+                if (errno == EINTR) continue;
+                // the error belongs to the first datagram of the call, the ones after it were not tried
+                if (failed) failed->push_back(base + i);
+                i++;
+                continue;
+            }
+            sent += static_cast<size_t>(rc);
+            i += static_cast<size_t>(rc);
+        }
+        return sent;
+    }
+#endif
+}
+
+RecvBatch::RecvBatch(unsigned cnt, size_t buff_sz)
+    : m_buff_sz(buff_sz), m_buffs(new uint8_t[cnt * buff_sz]), m_ctrl(new uint64_t[cnt * CTRL_WORDS]()),
+      m_addrs(cnt), m_iovs(cnt) {
+#ifdef LINUX_OS
+    m_hdrs.resize(cnt);
+    for (unsigned i = 0; i < cnt; i++) {
+        m_iovs[i].iov_base = m_buffs.get() + i * buff_sz;
+        m_iovs[i].iov_len = buff_sz;
+        m_hdrs[i].msg_hdr = msghdr{};
+        m_hdrs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_hdrs[i].msg_hdr.msg_iovlen = 1;
+        m_hdrs[i].msg_hdr.msg_name = &m_addrs[i];
+        m_hdrs[i].msg_hdr.msg_control = m_ctrl.get() + i * CTRL_WORDS;
+    }
+#endif
+}
+
+int RecvBatch::recv(int sockfd, int flags) {
+#ifdef LINUX_OS
+    // the kernel overwrites the name lengths with what it stored
+    for (auto &hdr : m_hdrs) {
+        hdr.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        hdr.msg_hdr.msg_controllen = CTRL_WORDS * sizeof(uint64_t);
+        hdr.msg_len = 0;
+    }
+    return recvmmsg(sockfd, m_hdrs.data(), static_cast<unsigned>(m_hdrs.size()), flags, nullptr);
+#else
+    (void)sockfd;
+    (void)flags;
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
+
+bool RecvBatch::truncated(unsigned slot) const {
+#ifdef LINUX_OS
+    return (m_hdrs[slot].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+size_t RecvBatch::length(unsigned slot) const {
+#ifdef LINUX_OS
+    return m_hdrs[slot].msg_len;
+#else
+    (void)slot;
+    return 0;
+#endif
+}
+
+uint16_t RecvBatch::segment_size(unsigned slot) const {
+#ifdef LINUX_OS
+    const msghdr &msg = m_hdrs[slot].msg_hdr;
+    for (const cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(const_cast<msghdr*>(&msg), const_cast<cmsghdr*>(c))) {
+        if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO) {
+            int seg;
+            std::memcpy(&seg, CMSG_DATA(c), sizeof(seg));
+            return static_cast<uint16_t>(seg);
+        }
+    }
+#else
+    (void)slot;
+#endif
+    return 0;
+}
+
+SendBatch::SendBatch(unsigned cap) : m_cap(std::max(1u, cap)) {
+    m_offs.reserve(m_cap + 1);
+    m_offs.push_back(0);
+    m_addrs.reserve(m_cap);
+    m_iovs.resize(m_cap);
+#ifdef LINUX_OS
+    m_hdrs.resize(m_cap);
+#endif
+}
+
+bool SendBatch::add(const sockaddr_in &to, const uint8_t *data, size_t len) {
+    if (full()) return false;
+    m_bytes.insert(m_bytes.end(), data, data + len);
+    m_offs.push_back(m_bytes.size());
+    m_addrs.push_back(to);
+    return true;
+}
+
+unsigned SendBatch::flush(int sockfd) {
+    if (empty()) return 0;
+    size_t cnt = m_addrs.size();
+    size_t sent = 0;
+#ifdef LINUX_OS
+    // m_bytes may have moved while datagrams were added, the iovecs are pointed into it here
+    for (size_t i = 0; i < cnt; i++) {
+        m_iovs[i].iov_base = m_bytes.data() + m_offs[i];
+        m_iovs[i].iov_len = m_offs[i + 1] - m_offs[i];
+        m_hdrs[i].msg_hdr = msghdr{};
+        m_hdrs[i].msg_hdr.msg_name = &m_addrs[i];
+        m_hdrs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        m_hdrs[i].msg_hdr.msg_iov = &m_iovs[i];
+        m_hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+    sent = send_all(sockfd, m_hdrs.data(), cnt, nullptr, 0);
+#else
+    (void)sockfd;
+#endif
+    m_bytes.clear();
+    m_offs.resize(1);
+    m_addrs.clear();
+    return static_cast<unsigned>(cnt - sent);
+}
+
+size_t jstd::net::send_fanout(int sockfd, const uint8_t *data, size_t len, const sockaddr_in *to, size_t cnt,
+                              unsigned batch, std::vector<size_t> &failed) {
+#ifdef LINUX_OS
+    batch = std::max(1u, batch);
+    iovec iov{const_cast<uint8_t*>(data), len};
+    std::vector<mmsghdr> hdrs(std::min<size_t>(batch, cnt));
+    size_t sent = 0;
+    for (size_t at = 0; at < cnt; at += hdrs.size()) {
+        size_t n = std::min(hdrs.size(), cnt - at);
+        for (size_t i = 0; i < n; i++) {
+            hdrs[i].msg_hdr = msghdr{};
+            hdrs[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&to[at + i]);
+            hdrs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            hdrs[i].msg_hdr.msg_iov = &iov;
+            hdrs[i].msg_hdr.msg_iovlen = 1;
+        }
+        sent += send_all(sockfd, hdrs.data(), n, &failed, at);
+    }
+    return sent;
+#else
+    (void)sockfd;
+    (void)data;
+    (void)len;
+    (void)batch;
+    for (size_t i = 0; i < cnt; i++) failed.push_back(i);
+    (void)to;
+    return 0;
+#endif
+}
+
+bool udp_offload::gso_supported(int sockfd) {
+#ifdef LINUX_OS
+    int seg = 0;
+    socklen_t len = sizeof(seg);
+    return getsockopt(sockfd, SOL_UDP, UDP_SEGMENT, &seg, &len) == 0;
+#else
+    (void)sockfd;
+    return false;
+#endif
+}
+
+bool udp_offload::set_gro(int sockfd, bool on) {
+#ifdef LINUX_OS
+    int val = on ? 1 : 0;
+    return setsockopt(sockfd, SOL_UDP, UDP_GRO, &val, sizeof(val)) == 0;
+#else
+    (void)sockfd;
+    errno = on ? EOPNOTSUPP : 0;
+    return !on;
+#endif
+}
+
+size_t udp_offload::max_gso_bytes(uint16_t seg_size) {
+    if (!seg_size) return 0;
+    size_t segs = std::min<size_t>(UDP_MAX_GSO_SEGMENTS, UDP_MAX_PAYLOAD / seg_size);
+    return segs * seg_size;
+}
+
+ssize_t udp_offload::send_gso(int sockfd, const sockaddr_in &to, const uint8_t *data, size_t len, uint16_t seg_size) {
+#ifdef LINUX_OS
+    uint64_t ctrl[CTRL_WORDS] = {};
+    iovec iov{const_cast<uint8_t*>(data), len};
+    msghdr msg{};
+    msg.msg_name = const_cast<sockaddr_in*>(&to);
+    msg.msg_namelen = sizeof(sockaddr_in);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+    cmsghdr *c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_UDP;
+    c->cmsg_type = UDP_SEGMENT;
+    c->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    std::memcpy(CMSG_DATA(c), &seg_size, sizeof(seg_size));
+    ssize_t rc;
+    do {
+        rc = sendmsg(sockfd, &msg, 0);
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+#else
+    (void)sockfd;
+    (void)to;
+    (void)data;
+    (void)len;
+    (void)seg_size;
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
@@ -0,0 +1,114 @@
+#ifndef JSTDLIB_DATAGRAMBATCH_H
+#define JSTDLIB_DATAGRAMBATCH_H
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "net_types.h"
+
+/*
+ * Batched datagram I/O through recvmmsg / sendmmsg, one syscall for up to a batch of datagrams.
+ *  - RecvBatch owns one buffer per slot, allocated once, recv() fills as many slots as the socket has
+ *    datagrams queued and they stay valid until the next recv()
+ *  - SendBatch copies datagrams and their destinations in, flush() hands them to the kernel in one sendmmsg
+ *    (several when a datagram fails, the rest of the batch is still sent)
+ *  - send_fanout() sends one datagram to many destinations a batch at a time, what a broadcast does
+ *  - udp_offload wraps UDP_SEGMENT (GSO, Linux 4.18) and UDP_GRO (Linux 5.0): one send of a large buffer leaves as
+ *    datagrams of a fixed size, and datagrams of one flow arrive coalesced in one buffer with their segment size,
+ *    RecvBatch::segment_size() reports it so the segments can be processed in place
+ * Not synchronized, a batch belongs to the thread using it. Linux only, elsewhere recv() and flush() fail
+ * with EOPNOTSUPP.
+ */
+namespace jstd {
+    namespace net {
+        class RecvBatch {
+            size_t m_buff_sz;
+            std::unique_ptr<uint8_t[]> m_buffs;
+            std::unique_ptr<uint64_t[]> m_ctrl;     // a UDP_GRO control message per slot, 8 byte aligned
+            std::vector<sockaddr_in> m_addrs;
+            std::vector<iovec> m_iovs;
+#ifdef LINUX_OS
+            std::vector<mmsghdr> m_hdrs;
+#endif
+
+        public:
+            // cnt slots of buff_sz bytes
+            RecvBatch(unsigned cnt, size_t buff_sz);
+
+            RecvBatch(const RecvBatch&) = delete;
+            RecvBatch& operator = (const RecvBatch&) = delete;
+
+            // recvmmsg into the slots with flags (MSG_WAITFORONE blocks for the first datagram only,
+            // MSG_DONTWAIT for none), returns the datagrams received or -1 with errno set
+            int recv(int sockfd, int flags);
+
+            inline const uint8_t *data(unsigned slot) const { return m_buffs.get() + slot * m_buff_sz; }
+
+            size_t length(unsigned slot) const;
+
+            // the datagram in slot was larger than its buffer and cut short
+            bool truncated(unsigned slot) const;
+
+            // size of the segments coalesced into slot by GRO, 0 for a plain datagram
+            uint16_t segment_size(unsigned slot) const;
+
+            inline const sockaddr_in &from(unsigned slot) const { return m_addrs[slot]; }
+
+            inline unsigned capacity() const { return static_cast<unsigned>(m_addrs.size()); }
+        };
+
+        class SendBatch {
+            unsigned m_cap;
+            std::vector<uint8_t> m_bytes;       // queued datagrams back to back
+            std::vector<size_t> m_offs;         // start of each in m_bytes, plus the end
+            std::vector<sockaddr_in> m_addrs;
+            std::vector<iovec> m_iovs;
+#ifdef LINUX_OS
+            std::vector<mmsghdr> m_hdrs;
+#endif
+
+        public:
+            // at most cap datagrams queued between flushes
+            explicit SendBatch(unsigned cap);
+
+            SendBatch(const SendBatch&) = delete;
+            SendBatch& operator = (const SendBatch&) = delete;
+
+            // copy a datagram for to into the batch, false when full
+            bool add(const sockaddr_in &to, const uint8_t *data, size_t len);
+
+            // send everything queued on sockfd and empty the batch, returns the datagrams that failed
+            unsigned flush(int sockfd);
+
+            inline size_t size() const { return m_addrs.size(); }
+
+            inline bool empty() const { return m_addrs.empty(); }
+
+            inline bool full() const { return m_addrs.size() >= m_cap; }
+
+            inline unsigned capacity() const { return m_cap; }
+        };
+
+        namespace udp_offload {
+            // true if the kernel knows UDP_SEGMENT
+            bool gso_supported(int sockfd);
+
+            // deliver datagrams coalesced with their segment size on sockfd, false (errno set) if refused
+            bool set_gro(int sockfd, bool on);
+
+            // largest buffer one send_gso() call with seg_size takes
+            size_t max_gso_bytes(uint16_t seg_size);
+
+            // one sendmsg of len bytes (up to max_gso_bytes()) leaving as datagrams of seg_size, the last one
+            // shorter, returns the bytes sent or -1 with errno set
+            ssize_t send_gso(int sockfd, const sockaddr_in &to, const uint8_t *data, size_t len, uint16_t seg_size);
+        }
+
+        // send data to every one of cnt destinations, batch per sendmmsg, indexes of the destinations that
+        // failed are appended to failed, returns the number sent
+        size_t send_fanout(int sockfd, const uint8_t *data, size_t len, const sockaddr_in *to, size_t cnt,
+                           unsigned batch, std::vector<size_t> &failed);
+    }
+}
+
+#endif //JSTDLIB_DATAGRAMBATCH_H
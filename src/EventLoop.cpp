@@ -0,0 +1,152 @@
+#include "EventLoop.h"
+#ifdef LINUX_OS
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+using namespace jstd::net;
+
+EventLoop::EventLoop(size_t buff_sz, unsigned buff_cnt):
+    m_buffers(buff_sz, buff_cnt), m_wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), m_running(false),
+    m_dispatching(false) {
+    if (m_wake_fd >= 0) m_epoll.add_fd(m_wake_fd);
+}
+
+EventLoop::~EventLoop() {
+    for (const auto &src : m_sources)
+        if (src.second.type != SOURCE::IO) close(src.first);   // timer and event fds are owned by the loop
+    if (m_wake_fd >= 0) close(m_wake_fd);
+}
+
+bool EventLoop::add_fd(int fd, uint32_t events, io_handler handler) {
+    if (fd < 0 || !m_epoll.add_fd(fd, events)) return false;
+    source &src = m_sources[fd];
+    src.type = SOURCE::IO;
+    src.repeat = true;
+    src.on_io = std::move(handler);
+    return true;
+}
+
+bool EventLoop::modify_fd(int fd, uint32_t events) {
+    return m_epoll.modify_fd(fd, events);
+}
+
+void EventLoop::remove_fd(int fd) {
+    auto it = m_sources.find(fd);
+    if (it == m_sources.end() || it->second.type != SOURCE::IO) return;
+    forget(it);
+}
+
+int EventLoop::add_timer(unsigned interval_ms, bool repeat, event_handler handler) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+    itimerspec spec{};
+    spec.it_value.tv_sec = interval_ms / 1000;
+    spec.it_value.tv_nsec = (interval_ms % 1000) * 1000000L;
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+        spec.it_value.tv_nsec = 1;   // zero would disarm the timer
+    if (repeat) spec.it_interval = spec.it_value;
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0 || !m_epoll.add_fd(fd)) {
+        close(fd);
+        return -1;
+    }
+    source &src = m_sources[fd];
+    src.type = SOURCE::TIMER;
+    src.repeat = repeat;
+    src.on_event = std::move(handler);
+    return fd;
+}
+
+void EventLoop::cancel_timer(int timer_id) {
+    auto it = m_sources.find(timer_id);
+    if (it == m_sources.end() || it->second.type != SOURCE::TIMER) return;
+    forget(it);
+    close(timer_id);
+}
+
+int EventLoop::add_event(event_handler handler) {
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (!m_epoll.add_fd(fd)) {
+        close(fd);
+        return -1;
+    }
+    source &src = m_sources[fd];
+    src.type = SOURCE::EVENT;
+    src.repeat = true;
+    src.on_event = std::move(handler);
+    return fd;
+}
+
+void EventLoop::remove_event(int event_id) {
+    auto it = m_sources.find(event_id);
+    if (it == m_sources.end() || it->second.type != SOURCE::EVENT) return;
+    forget(it);
+    close(event_id);
+}
+
+bool EventLoop::notify(int event_id) {
+    uint64_t one = 1;
+    return write(event_id, &one, sizeof(one)) == sizeof(one);
+}
+
+void EventLoop::forget(std::unordered_map<int, source>::iterator it) {
+    if (m_dispatching) m_removed.push_back(it->first);
+    m_epoll.clear_fd(it->first);
+    m_sources.erase(it);
+}
+
+void EventLoop::dispatch(int fd, uint32_t events) {
+    // removed earlier in this round, and maybe added again for a descriptor that reused the number
+    if (!m_removed.empty() && std::find(m_removed.begin(), m_removed.end(), fd) != m_removed.end()) return;
+    auto it = m_sources.find(fd);
+    if (it == m_sources.end()) return;
+    // handlers may remove their own source, run a copy
+    if (it->second.type == SOURCE::IO) {
+        io_handler handler = it->second.on_io;
+        handler(fd, events);
+        return;
+    }
+    uint64_t cnt = 0;
+    if (read(fd, &cnt, sizeof(cnt)) != sizeof(cnt)) return;
+    event_handler handler = it->second.on_event;
+    if (it->second.type == SOURCE::TIMER && !it->second.repeat)
+        cancel_timer(fd);
+    handler();
+}
+
+int EventLoop::run_once(int timeout_ms) {
+    int rc = m_epoll.wait(timeout_ms);
+    if (rc <= 0) return (rc < 0 && errno != EINTR) ? -1 : 0;
+    int handled = 0;
+    m_dispatching = true;
+    for (int i = 0; i < m_epoll.ready_count(); i++) {
+        int fd = m_epoll.ready_fd(i);
+        if (fd == m_wake_fd) {
+            uint64_t cnt;
+            while (read(m_wake_fd, &cnt, sizeof(cnt)) == sizeof(cnt)) {}
+            continue;
+        }
+        dispatch(fd, m_epoll.ready_events(i));
+        handled++;
+    }
+    m_dispatching = false;
+    m_removed.clear();
+    return handled;
+}
+
+void EventLoop::run() {
+    m_running = true;
+    while (m_running) {
+        if (run_once(-1) < 0) break;
+    }
+    m_running = false;
+}
+
+void EventLoop::stop() {
+    m_running = false;
+    notify(m_wake_fd);
+}
+#endif
@@ -0,0 +1,101 @@
+#ifndef JSTDLIB_EVENTLOOP_H
+#define JSTDLIB_EVENTLOOP_H
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "epoll_set.h"
+#include "BufferPool.h"
+
+/*
+ * Single threaded reactor, socket, timerfd and eventfd sources are registered with a handler and
+ * dispatched from run() on whatever thread the application calls it on. TcpServerBase::attach() and
+ * UdpServerBase::attach() hook listeners into a loop, so any number of endpoints share one thread,
+ * one set of timers and one BufferPool.
+ *
+ * Apart from stop() and notify(), methods must be called from the loop thread or while it is not running.
+ */
+namespace jstd {
+    namespace net {
+#ifdef LINUX_OS
+        class EventLoop {
+        public:
+            // events is the epoll event mask that fired
+            typedef std::function<void(int fd, uint32_t events)> io_handler;
+            typedef std::function<void()> event_handler;
+
+        private:
+            enum class SOURCE : uint8_t { IO, TIMER, EVENT };
+
+            struct source {
+                SOURCE type;
+                bool repeat;
+                io_handler on_io;
+                event_handler on_event;
+            };
+
+            epoll_set m_epoll;
+            std::unordered_map<int, source> m_sources;
+            BufferPool m_buffers;
+            int m_wake_fd;
+            std::atomic<bool> m_running;
+            // sources removed while a batch of ready events is dispatched. Their fd may be reused by a source added
+            // later in the batch, its remaining events in the batch belong to the old one and are skipped
+            bool m_dispatching;
+            std::vector<int> m_removed;
+
+            void dispatch(int fd, uint32_t events);
+
+            void forget(std::unordered_map<int, source>::iterator it);
+
+        public:
+            // buffers of buff_sz bytes are handed out by buffers(), buff_cnt at a time
+            explicit EventLoop(size_t buff_sz = 2048, unsigned buff_cnt = 64);
+
+            EventLoop(const EventLoop&) = delete;
+            EventLoop& operator = (const EventLoop&) = delete;
+
+            ~EventLoop();
+
+            inline bool is_valid() const { return m_epoll.is_valid() && m_wake_fd >= 0; }
+
+            inline bool is_running() const { return m_running; }
+
+            // watch fd for events (level triggered), replaces the handler if fd is already registered
+            bool add_fd(int fd, uint32_t events, io_handler handler);
+
+            bool modify_fd(int fd, uint32_t events);
+
+            // stop watching fd, the descriptor itself is left open
+            void remove_fd(int fd);
+
+            // timerfd firing every interval_ms (once when repeat is false), returns the timer id or -1
+            int add_timer(unsigned interval_ms, bool repeat, event_handler handler);
+
+            void cancel_timer(int timer_id);
+
+            // eventfd source, handler runs on the loop thread after notify(id) from any thread, returns id or -1
+            int add_event(event_handler handler);
+
+            void remove_event(int event_id);
+
+            static bool notify(int event_id);
+
+            // dispatch ready sources once, waits up to timeout_ms (-1 blocks), returns number of sources handled
+            int run_once(int timeout_ms);
+
+            // dispatch until stop()
+            void run();
+
+            // safe from any thread, run() returns after the current dispatch round
+            void stop();
+
+            // scratch buffers shared by every handler on this loop
+            inline BufferPool &buffers() { return m_buffers; }
+        };
+#endif
+    }
+}
+
+#endif //JSTDLIB_EVENTLOOP_H
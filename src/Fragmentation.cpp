@@ -0,0 +1,163 @@
+#include "Fragmentation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace jstd::net;
+
+namespace {
+    inline void put16(uint8_t *p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 8);
+        p[1] = static_cast<uint8_t>(v);
+    }
+
+    inline uint32_t get16(const uint8_t *p) {
+        return (static_cast<uint32_t>(p[0]) << 8) | p[1];
+    }
+
+    inline void put32(uint8_t *p, uint32_t v) {
+        put16(p, v >> 16);
+        put16(p + 2, v);
+    }
+
+    inline uint32_t get32(const uint8_t *p) {
+        return (get16(p) << 16) | get16(p + 2);
+    }
+
+    inline uint64_t now_ms() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+size_t jstd::net::fragment::split(uint32_t id, const uint8_t *data, size_t len, uint16_t fragment_size,
+                                  std::vector<uint8_t> &out) {
+    if (!fragment_size || len > UINT32_MAX) return 0;
+    size_t count = len ? (len + fragment_size - 1) / fragment_size : 1;
+    if (count > FRAG_MAX_COUNT) return 0;
+    out.resize(count * FRAG_HEADER + len);
+    uint8_t *p = out.data();
+    for (size_t i = 0, off = 0; i < count; i++) {
+        size_t n = std::min<size_t>(fragment_size, len - off);
+        p[0] = FRAG_MAGIC;
+        p[1] = 0;
+        put16(p + 2, static_cast<uint32_t>(i));
+        put16(p + 4, static_cast<uint32_t>(count));
+        put16(p + 6, 0);
+        put32(p + 8, id);
+        put32(p + 12, static_cast<uint32_t>(len));
+        if (n) std::memcpy(p + FRAG_HEADER, data + off, n);
+        p += FRAG_HEADER + n;
+        off += n;
+    }
+    return count;
+}
+
+Reassembler::Reassembler(const FragmentConfig &cfg) : m_cfg(cfg), m_bytes(0) {}
+
+void Reassembler::drop(std::unordered_map<msg_key, pending, key_hash>::iterator it) {
+    m_bytes -= it->second.data.size();
+    m_age.erase(it->second.age);
+    m_pending.erase(it);
+}
+
+void Reassembler::make_room(size_t bytes, FragmentCounters &counters) {
+    while (!m_age.empty() && (m_pending.size() >= m_cfg.max_pending || m_bytes + bytes > m_cfg.max_pending_bytes)) {
+        drop(m_pending.find(m_age.front()));
+        counters.evicted++;
+    }
+}
+
+FRAG_RECV Reassembler::add(uint64_t peer, const uint8_t *pkt, size_t len, std::vector<uint8_t> &message,
+                           FragmentCounters &counters) {
+    expire(counters);
+    if (len < FRAG_HEADER || pkt[0] != FRAG_MAGIC) {
+        counters.rejected++;
+        return FRAG_RECV::REJECTED;
+    }
+    uint32_t index = get16(pkt + 2);
+    uint32_t count = get16(pkt + 4);
+    uint32_t id = get32(pkt + 8);
+    uint32_t total = get32(pkt + 12);
+    size_t payload = len - FRAG_HEADER;
+    bool last = index + 1 == count;
+    bool ok = count && index < count && total <= m_cfg.max_message;
+    if (ok && count == 1) {
+        if (payload == total) return FRAG_RECV::WHOLE;
+        ok = false;
+    }
+    // every fragment but the last is full, the last one is not empty
+    if (ok && last) ok = payload && payload < total;
+    else if (ok) ok = payload && static_cast<uint64_t>(payload) * (count - 1) < total &&
+                      static_cast<uint64_t>(payload) * count >= total;
+    if (!ok || total > m_cfg.max_pending_bytes) {
+        counters.rejected++;
+        return FRAG_RECV::REJECTED;
+    }
+    msg_key key{peer, id};
+    auto it = m_pending.find(key);
+    if (it == m_pending.end()) {
+        make_room(total, counters);
+        pending msg;
+        msg.data.resize(total);
+        msg.have.assign(count, false);
+        msg.missing = count;
+        msg.fragment_size = 0;
+        msg.last_len = 0;
+        msg.started_ms = now_ms();
+        msg.age = m_age.insert(m_age.end(), key);
+        it = m_pending.emplace(key, std::move(msg)).first;
+        m_bytes += total;
+    }
+    pending &msg = it->second;
+    if (msg.have.size() != count || msg.data.size() != total) {
+        counters.rejected++;
+        return FRAG_RECV::REJECTED;
+    }
+    if (msg.have[index]) return FRAG_RECV::DUPLICATE;
+    uint32_t fragment_size = last ? msg.fragment_size : static_cast<uint32_t>(payload);
+    size_t last_len = last ? payload : msg.last_len;
+    // the full fragments and the last one have to agree where the last one starts
+    if ((!last && msg.fragment_size && msg.fragment_size != payload) ||
+        (fragment_size && last_len && static_cast<uint64_t>(fragment_size) * (count - 1) + last_len != total)) {
+        counters.rejected++;
+        return FRAG_RECV::REJECTED;
+    }
+    msg.fragment_size = fragment_size;
+    msg.last_len = static_cast<uint32_t>(last_len);
+    size_t off = last ? total - payload : index * payload;
+    std::memcpy(msg.data.data() + off, pkt + FRAG_HEADER, payload);
+    msg.have[index] = true;
+    if (--msg.missing) return FRAG_RECV::PENDING;
+    m_bytes -= total;
+    message = std::move(msg.data);
+    m_age.erase(msg.age);
+    m_pending.erase(it);
+    counters.reassembled++;
+    return FRAG_RECV::COMPLETE;
+}
+
+void Reassembler::expire(FragmentCounters &counters) {
+    if (m_age.empty()) return;
+    uint64_t now = now_ms();
+    while (!m_age.empty()) {
+        auto it = m_pending.find(m_age.front());
+        if (now - it->second.started_ms < m_cfg.timeout_ms) break;
+        drop(it);
+        counters.expired++;
+    }
+}
+
+void Reassembler::forget(uint64_t peer) {
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        auto next = std::next(it);
+        if (it->first.peer == peer) drop(it);
+        it = next;
+    }
+}
+
+void Reassembler::clear() {
+    m_pending.clear();
+    m_age.clear();
+    m_bytes = 0;
+}
@@ -0,0 +1,128 @@
+#ifndef JSTDLIB_FRAGMENTATION_H
+#define JSTDLIB_FRAGMENTATION_H
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Messages larger than a datagram, split into fragments by the sender and put back together by the receiver.
+ *  - fragment::split() frames a message as count fragments of fragment_size payload bytes, the last one shorter.
+ *    Every fragment but the last is the same size, so the train can leave in one UDP_SEGMENT send
+ *  - a message that fits one fragment is framed all the same, count 1, and the receiver hands its payload on
+ *    in place
+ *  - Reassembler collects the fragments per peer and message id into a buffer of the message's size, allocated
+ *    on the first fragment. Fragments may arrive in any order, duplicates are ignored
+ *  - bounded by max_pending messages and max_pending_bytes of buffers over all peers, a message that does not
+ *    fit evicts the oldest ones. A message still incomplete timeout_ms after its first fragment is dropped when
+ *    the next fragment of any peer arrives
+ *  - no retransmission, one lost fragment loses the message. Run it over ReliableUdp for that
+ *  - not synchronized, the owning server guards it with its own mutex
+ * UdpServerBase frames every message to its clients with it, see set_fragmentation(), send_item and broadcasts
+ * included, with GSO when it is on. Messages are put back together before they reach the cache, coalescing or
+ * process_item, and a datagram larger than the receive buffer is counted and dropped, never processed truncated.
+ *
+ * Wire format, network byte order
+ *  [ 0xF5 | 0 | index 16 ][ count 16 | 0 ][ message id 32 ][ message length 32 ] payload
+ */
+namespace jstd {
+    namespace net {
+        struct FragmentConfig {
+            uint16_t fragment_size;         // payload bytes per fragment
+            uint32_t max_message;           // largest message sent or reassembled
+            uint32_t max_pending;           // messages being reassembled, over all peers
+            size_t max_pending_bytes;       // their buffers together
+            uint32_t timeout_ms;            // from the first fragment of a message
+
+            FragmentConfig() : fragment_size(1400), max_message(1 << 20), max_pending(1024),
+                               max_pending_bytes(64 << 20), timeout_ms(1000) {}
+        };
+
+        constexpr size_t FRAG_HEADER = 16;
+        constexpr uint8_t FRAG_MAGIC = 0xF5;
+        constexpr size_t FRAG_MAX_COUNT = 0xFFFF;
+
+        // counters of both directions
+        struct FragmentCounters {
+            uint64_t split;         // messages sent in more than one fragment
+            uint64_t fragments;     // fragments of those
+            uint64_t reassembled;
+            uint64_t expired;       // incomplete after timeout_ms
+            uint64_t evicted;       // to make room under max_pending / max_pending_bytes
+            uint64_t rejected;      // malformed or larger than max_message
+
+            FragmentCounters() : split(0), fragments(0), reassembled(0), expired(0), evicted(0), rejected(0) {}
+        };
+
+        enum class FRAG_RECV : uint8_t {
+            WHOLE,          // a message of one fragment, its payload follows the header
+            COMPLETE,       // the last missing fragment, the message was moved out
+            PENDING,        // stored, more to come
+            DUPLICATE,      // already had that fragment
+            REJECTED        // malformed, inconsistent with the fragments before it or too large
+        };
+
+        namespace fragment {
+            // frame len bytes of data as message id into out, fragments of FRAG_HEADER + fragment_size bytes back
+            // to back. Returns the fragment count, 0 if the message needs more than FRAG_MAX_COUNT
+            size_t split(uint32_t id, const uint8_t *data, size_t len, uint16_t fragment_size, std::vector<uint8_t> &out);
+        }
+
+        class Reassembler {
+            struct msg_key {
+                uint64_t peer;
+                uint32_t id;
+
+                inline bool operator==(const msg_key &other) const { return peer == other.peer && id == other.id; }
+            };
+
+            struct key_hash {
+                inline size_t operator()(const msg_key &key) const {
+                    return static_cast<size_t>((key.peer * 0x9E3779B97F4A7C15ULL) ^ key.id);
+                }
+            };
+
+            struct pending {
+                std::vector<uint8_t> data;
+                std::vector<bool> have;
+                uint32_t missing;
+                uint32_t fragment_size;         // payload of a fragment but the last, 0 until one arrived
+                uint32_t last_len;              // payload of the last fragment, 0 until it arrived
+                uint64_t started_ms;
+                std::list<msg_key>::iterator age;
+            };
+
+            FragmentConfig m_cfg;
+            std::unordered_map<msg_key, pending, key_hash> m_pending;
+            std::list<msg_key> m_age;           // oldest first
+            size_t m_bytes;
+
+            void drop(std::unordered_map<msg_key, pending, key_hash>::iterator it);
+
+            // evict the oldest until bytes more fit
+            void make_room(size_t bytes, FragmentCounters &counters);
+
+        public:
+            explicit Reassembler(const FragmentConfig &cfg);
+
+            // a fragment of peer. WHOLE leaves message alone, with COMPLETE the message is moved into it
+            FRAG_RECV add(uint64_t peer, const uint8_t *pkt, size_t len, std::vector<uint8_t> &message,
+                          FragmentCounters &counters);
+
+            // drop what is incomplete after timeout_ms
+            void expire(FragmentCounters &counters);
+
+            // drop the messages of peer, it was removed
+            void forget(uint64_t peer);
+
+            void clear();
+
+            inline size_t pending_messages() const { return m_pending.size(); }
+
+            inline size_t pending_bytes() const { return m_bytes; }
+        };
+    }
+}
+
+#endif //JSTDLIB_FRAGMENTATION_H
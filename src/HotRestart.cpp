@@ -0,0 +1,288 @@
+#include "HotRestart.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace jstd::net;
+
+namespace {
+    const size_t RECORD_FIXED_BYTES = sizeof(sockaddr_in) + sizeof(uint32_t) + 2 + sizeof(uint32_t);
+    const std::vector<uint8_t> NO_STATE;
+
+    bool unix_addr(const std::string &path, sockaddr_un &addr) {
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size());
+        return true;
+    }
+
+    inline void put(std::vector<uint8_t> &out, const void *data, size_t len) {
+        const uint8_t *p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + len);
+    }
+
+    inline bool get(const std::vector<uint8_t> &in, size_t &pos, void *data, size_t len) {
+        if (in.size() - pos < len) return false;
+        std::memcpy(data, in.data() + pos, len);
+        pos += len;
+        return true;
+    }
+
+    void close_fds(const std::vector<int> &fds) {
+        for (int fd : fds)
+            if (fd >= 0) ::close(fd);
+    }
+}
+
+void HandoffState::close_all() {
+    if (listen_fd >= 0) ::close(listen_fd);
+    listen_fd = INVALID_SOCKET;
+    for (auto &conn : conns) {
+        if (conn.sockfd >= 0) ::close(conn.sockfd);
+        conn.sockfd = INVALID_SOCKET;
+    }
+}
+
+HotRestart::HotRestart() : m_path_ino(0), m_listen_fd(-1), m_fd(-1) { }
+
+HotRestart::~HotRestart() {
+    close();
+}
+
+bool HotRestart::listen(const std::string &path) {
+    sockaddr_un addr{};
+    if (m_listen_fd >= 0 || !unix_addr(path, addr)) return false;
+    struct stat st{};
+    // only a socket file is taken to be stale, anything else at path is left alone and bind fails
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 1) < 0 ||
+        lstat(path.c_str(), &st) < 0) {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        return false;
+    }
+    m_listen_fd = fd;
+    m_path = path;
+    m_path_ino = static_cast<uint64_t>(st.st_ino);
+    return true;
+}
+
+bool HotRestart::accept(int timeout_ms) {
+    if (m_listen_fd < 0) return false;
+    pollfd pfd{m_listen_fd, POLLIN, 0};
+    int rc;
+    while ((rc = poll(&pfd, 1, timeout_ms)) < 0 && errno == EINTR) { }
+    if (rc <= 0) return false;
+    int fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) return false;
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = fd;
+    return true;
+}
+
+bool HotRestart::connect(const std::string &path) {
+    sockaddr_un addr{};
+    if (m_fd >= 0 || !unix_addr(path, addr)) return false;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        return false;
+    }
+    m_fd = fd;
+    return true;
+}
+
+void HotRestart::close() {
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+    if (m_listen_fd < 0) return;
+    ::close(m_listen_fd);
+    m_listen_fd = -1;
+    struct stat st{};
+    if (lstat(m_path.c_str(), &st) == 0 && static_cast<uint64_t>(st.st_ino) == m_path_ino)
+        unlink(m_path.c_str());
+    m_path.clear();
+}
+
+bool HotRestart::send_msg(HANDOFF_MSG type, const void *payload, size_t len, const int *fds, size_t fd_cnt) {
+    HandoffHeader hdr{HOT_RESTART_MAGIC, HOT_RESTART_VERSION, static_cast<uint8_t>(type), 0};
+    iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = const_cast<void*>(payload);
+    iov[1].iov_len = len;
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = len ? 2 : 1;
+    std::vector<uint8_t> control;
+    if (fd_cnt) {
+        control.assign(CMSG_SPACE(fd_cnt * sizeof(int)), 0);
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(fd_cnt * sizeof(int));
+        std::memcpy(CMSG_DATA(cm), fds, fd_cnt * sizeof(int));
+    }
+    ssize_t n;
+    while ((n = sendmsg(m_fd, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR) { }
+    return n == static_cast<ssize_t>(sizeof(hdr) + len);
+}
+
+uint8_t HotRestart::recv_msg(std::vector<uint8_t> &buff, std::vector<int> &fds, int timeout_ms) {
+    pollfd pfd{m_fd, POLLIN, 0};
+    int rc;
+    while ((rc = poll(&pfd, 1, timeout_ms)) < 0 && errno == EINTR) { }
+    if (rc <= 0) return 0;
+    HandoffHeader hdr{};
+    buff.resize(HOT_RESTART_CHUNK_BYTES);
+    iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = buff.data();
+    iov[1].iov_len = buff.size();
+    std::vector<uint8_t> control(CMSG_SPACE(HOT_RESTART_FDS_PER_MSG * sizeof(int)), 0);
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    ssize_t n;
+    while ((n = recvmsg(m_fd, &msg, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR) { }
+    if (n <= 0) return 0;
+    // descriptors are installed even when the message turns out bad, collect them so the caller closes them
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        size_t cnt = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        size_t first = fds.size();
+        fds.resize(first + cnt);
+        std::memcpy(fds.data() + first, CMSG_DATA(cm), cnt * sizeof(int));
+    }
+    if ((msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || static_cast<size_t>(n) < sizeof(hdr) ||
+        hdr.magic != HOT_RESTART_MAGIC || hdr.version != HOT_RESTART_VERSION) {
+        errno = EPROTO;
+        return 0;
+    }
+    buff.resize(static_cast<size_t>(n) - sizeof(hdr));
+    return hdr.type;
+}
+
+bool HotRestart::send_state(const HandoffState &state, int timeout_ms) {
+    if (m_fd < 0 || state.listen_fd < 0) return false;
+    std::vector<uint8_t> meta;
+    std::vector<int> fds;
+    for (size_t i = 0; i < state.conns.size(); i++) {
+        const NetConnection &conn = state.conns[i];
+        const std::vector<uint8_t> &blob = i < state.conn_state.size() ? state.conn_state[i] : NO_STATE;
+        uint32_t sock_type = conn.sock_type;
+        bool bypass = i < state.cache_bypass.size() && state.cache_bypass[i];
+        uint8_t flags[2] = {static_cast<uint8_t>(bypass), static_cast<uint8_t>(conn.sockfd >= 0)};
+        uint32_t blob_len = static_cast<uint32_t>(blob.size());
+        put(meta, &conn.sa, sizeof(conn.sa));
+        put(meta, &sock_type, sizeof(sock_type));
+        put(meta, flags, sizeof(flags));
+        put(meta, &blob_len, sizeof(blob_len));
+        put(meta, blob.data(), blob.size());
+        if (conn.sockfd >= 0) fds.push_back(conn.sockfd);
+    }
+    if (meta.size() > HOT_RESTART_MAX_META_BYTES) {
+        errno = EMSGSIZE;
+        return false;
+    }
+    HandoffBegin begin{static_cast<uint8_t>(state.proto), {0, 0, 0}, static_cast<uint32_t>(state.conns.size()),
+                       static_cast<uint32_t>(fds.size()), meta.size()};
+    if (!send_msg(HANDOFF_MSG::BEGIN, &begin, sizeof(begin), &state.listen_fd, 1)) return false;
+    for (size_t off = 0; off < fds.size(); off += HOT_RESTART_FDS_PER_MSG) {
+        size_t cnt = std::min(HOT_RESTART_FDS_PER_MSG, fds.size() - off);
+        if (!send_msg(HANDOFF_MSG::FDS, nullptr, 0, fds.data() + off, cnt)) return false;
+    }
+    for (size_t off = 0; off < meta.size(); off += HOT_RESTART_CHUNK_BYTES) {
+        size_t len = std::min(HOT_RESTART_CHUNK_BYTES, meta.size() - off);
+        if (!send_msg(HANDOFF_MSG::META, meta.data() + off, len, nullptr, 0)) return false;
+    }
+    std::vector<uint8_t> buff;
+    std::vector<int> stray;
+    uint8_t type = recv_msg(buff, stray, timeout_ms);
+    close_fds(stray);
+    return type == static_cast<uint8_t>(HANDOFF_MSG::ACK);
+}
+
+bool HotRestart::recv_state(HandoffState &state, int timeout_ms) {
+    state = HandoffState();
+    if (m_fd < 0) return false;
+    std::vector<uint8_t> buff;
+    std::vector<int> fds;
+    HandoffBegin begin{};
+    if (recv_msg(buff, fds, timeout_ms) != static_cast<uint8_t>(HANDOFF_MSG::BEGIN) || buff.size() != sizeof(begin) ||
+        fds.size() != 1) {
+        close_fds(fds);
+        errno = EPROTO;
+        return false;
+    }
+    std::memcpy(&begin, buff.data(), sizeof(begin));
+    int listen_fd = fds[0];
+    fds.clear();
+    // the sizes come off the socket, bound them before reserving anything
+    if (begin.meta_bytes > HOT_RESTART_MAX_META_BYTES || begin.fd_cnt > begin.conn_cnt ||
+        static_cast<uint64_t>(begin.conn_cnt) * RECORD_FIXED_BYTES > begin.meta_bytes) {
+        ::close(listen_fd);
+        errno = EPROTO;
+        return false;
+    }
+    std::vector<uint8_t> meta;
+    meta.reserve(begin.meta_bytes);
+    bool ok = true;
+    while (ok && (fds.size() < begin.fd_cnt || meta.size() < begin.meta_bytes)) {
+        uint8_t type = recv_msg(buff, fds, timeout_ms);
+        if (type == static_cast<uint8_t>(HANDOFF_MSG::META)) meta.insert(meta.end(), buff.begin(), buff.end());
+        else if (type != static_cast<uint8_t>(HANDOFF_MSG::FDS)) ok = false;
+        ok = ok && fds.size() <= begin.fd_cnt && meta.size() <= begin.meta_bytes;
+    }
+    size_t pos = 0;
+    size_t next_fd = 0;
+    for (uint32_t i = 0; ok && i < begin.conn_cnt; i++) {
+        NetConnection conn;
+        uint32_t sock_type = 0;
+        uint8_t flags[2] = {0, 0};
+        uint32_t blob_len = 0;
+        ok = meta.size() - pos >= RECORD_FIXED_BYTES && get(meta, pos, &conn.sa, sizeof(conn.sa)) &&
+             get(meta, pos, &sock_type, sizeof(sock_type)) && get(meta, pos, flags, sizeof(flags)) &&
+             get(meta, pos, &blob_len, sizeof(blob_len)) && meta.size() - pos >= blob_len &&
+             (!flags[1] || next_fd < fds.size());
+        if (!ok) break;
+        conn.sock_type = sock_type;
+        conn.port = ntohs(conn.sa.sin_port);
+        conn.sockfd = flags[1] ? fds[next_fd++] : INVALID_SOCKET;
+        state.conns.push_back(conn);
+        state.cache_bypass.push_back(flags[0] != 0);
+        state.conn_state.emplace_back(meta.begin() + static_cast<std::ptrdiff_t>(pos),
+                                      meta.begin() + static_cast<std::ptrdiff_t>(pos + blob_len));
+        pos += blob_len;
+    }
+    ok = ok && pos == meta.size() && next_fd == fds.size() && send_msg(HANDOFF_MSG::ACK, nullptr, 0, nullptr, 0);
+    if (!ok) {
+        ::close(listen_fd);
+        close_fds(fds);
+        state = HandoffState();
+        errno = EPROTO;
+        return false;
+    }
+    state.proto = static_cast<PROTOCOL>(begin.proto);
+    state.listen_fd = listen_fd;
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef JSTDLIB_HOTRESTART_H
+#define JSTDLIB_HOTRESTART_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "net_types.h"
+
+/*
+ * Unix socket channel a running server process hands its sockets to a successor over, for restarts that keep
+ * every client connected (see TcpServerBase::hand_off()).
+ *  - the running process listen()s on a path, the successor connect()s to it, both ends are SOCK_SEQPACKET so
+ *    every message keeps its boundary and the descriptors travelling with it
+ *  - send_state() passes one server's listening socket and client descriptors as SCM_RIGHTS (at most
+ *    HOT_RESTART_FDS_PER_MSG per message, the kernel caps a message at 253) with the connection records
+ *    serialized next to them, then waits for the successor to confirm. Without the confirmation the sender
+ *    still owns every descriptor and can keep serving
+ *  - several servers of one process are handed over one after the other on the same channel, the successor
+ *    calls recv_state() in the same order
+ *  - received descriptors are close-on-exec and belong to the caller of recv_state()
+ *  - TcpServerBase::hand_off() stops reading, processes what it already took in, then passes its listener and
+ *    client sockets with their records and whatever the on_hand_off hook packs per connection (e.g. a partly
+ *    received request). Bytes arriving meanwhile wait in the socket buffers. The successor builds its server
+ *    on HandoffState::listen_fd and take_over() re-registers the clients, handing each its packed state
+ *    through on_take_over
+ *  - UdpServerBase::hand_off() passes its socket and client records the same way, datagrams arriving meanwhile
+ *    queue in the socket buffer the successor takes over
+ *
+ * message layout: HandoffHeader, then type specific payload, descriptors in the control message
+ *  BEGIN  HandoffBegin, the listening socket attached
+ *  FDS    client descriptors, in record order
+ *  META   the next chunk of the serialized records
+ *  ACK    successor confirms a complete state
+ * record: sockaddr_in, uint32 sock_type, uint8 cache_bypass, uint8 has_fd, uint32 state len, state bytes
+ */
+namespace jstd {
+    namespace net {
+        constexpr uint32_t HOT_RESTART_MAGIC = 0x5248534a;     // "JSHR"
+        constexpr uint16_t HOT_RESTART_VERSION = 1;
+        constexpr size_t HOT_RESTART_FDS_PER_MSG = 250;
+        constexpr size_t HOT_RESTART_CHUNK_BYTES = 32 << 10;
+        constexpr uint64_t HOT_RESTART_MAX_META_BYTES = 256 << 20;   // larger announced states are rejected
+        constexpr int HOT_RESTART_TIMEOUT_MS = 5000;
+
+        enum class HANDOFF_MSG : uint8_t { BEGIN = 1, FDS, META, ACK };
+
+#pragma pack(push, 1)
+        struct HandoffHeader {
+            uint32_t magic;
+            uint16_t version;
+            uint8_t type;       // HANDOFF_MSG
+            uint8_t reserved;
+        };
+
+        struct HandoffBegin {
+            uint8_t proto;      // PROTOCOL
+            uint8_t reserved[3];
+            uint32_t conn_cnt;
+            uint32_t fd_cnt;
+            uint64_t meta_bytes;
+        };
+#pragma pack(pop)
+
+        // one server's sockets and clients, conn_state[i] is the opaque per connection state of conns[i]
+        struct HandoffState {
+            PROTOCOL proto;
+            int listen_fd;
+            std::vector<NetConnection> conns;       // sockfd INVALID_SOCKET for peers sharing listen_fd (UDP)
+            std::vector<std::vector<uint8_t>> conn_state;
+            std::vector<bool> cache_bypass;         // conns[i] skips the server's ResponseCache
+
+            HandoffState() : proto(PROTOCOL::TCP), listen_fd(INVALID_SOCKET) {}
+
+            // close every descriptor, for a state that is not taken over
+            void close_all();
+        };
+
+        class HotRestart {
+            std::string m_path;
+            uint64_t m_path_ino;    // inode of the socket file this process bound, a successor may rebind the path
+            int m_listen_fd;        // running process, successors connect here
+            int m_fd;               // channel to the peer
+
+            bool send_msg(HANDOFF_MSG type, const void *payload, size_t len, const int *fds, size_t fd_cnt);
+
+            // next message into buff, descriptors appended to fds, type 0 on failure
+            uint8_t recv_msg(std::vector<uint8_t> &buff, std::vector<int> &fds, int timeout_ms);
+
+        public:
+            HotRestart();
+
+            HotRestart(const HotRestart&) = delete;
+            HotRestart& operator = (const HotRestart&) = delete;
+
+            ~HotRestart();
+
+            // running process: bind path, a stale socket file left by a crashed process is replaced
+            bool listen(const std::string &path);
+
+            // readable once a successor connects, can be watched by an EventLoop
+            inline int listen_fd() const { return m_listen_fd; }
+
+            // running process: wait up to timeout_ms (-1 forever) for a successor to connect
+            bool accept(int timeout_ms);
+
+            // successor: connect to the process listening on path
+            bool connect(const std::string &path);
+
+            inline bool is_connected() const { return m_fd >= 0; }
+
+            // pass state to the successor, true once it confirmed, the descriptors stay open either way
+            bool send_state(const HandoffState &state, int timeout_ms = HOT_RESTART_TIMEOUT_MS);
+
+            // next server's state from the running process, confirmed before returning true
+            bool recv_state(HandoffState &state, int timeout_ms = HOT_RESTART_TIMEOUT_MS);
+
+            // drop the channel and the listening socket, the socket file goes too unless a successor rebound it
+            void close();
+        };
+    }
+}
+
+#endif //JSTDLIB_HOTRESTART_H
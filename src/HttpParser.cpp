@@ -0,0 +1,191 @@
+#include "HttpParser.h"
+#include <cstring>
+
+using namespace jstd::net;
+
+namespace {
+    inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+    inline bool is_ows(char c) { return c == ' ' || c == '\t'; }
+
+    // header name characters (RFC 9110 tchar)
+    inline bool is_tchar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               (c != 0 && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+    }
+
+    // control characters other than HTAB, e.g. a bare LF that would end the line for another parser
+    inline bool is_ctl(char c) { return (static_cast<unsigned char>(c) < 0x20 && c != '\t') || c == 0x7f; }
+
+    inline HttpRange range(const char *base, const char *start, const char *end) {
+        return HttpRange{static_cast<uint32_t>(start - base), static_cast<uint32_t>(end - start)};
+    }
+
+    // true if the header value contains token, comma separated and case insensitive (Connection: keep-alive)
+    bool has_token(const char *val, size_t len, const char *token) {
+        size_t tlen = std::strlen(token);
+        size_t i = 0;
+        while (i < len) {
+            while (i < len && (is_ows(val[i]) || val[i] == ',')) i++;
+            size_t start = i;
+            while (i < len && val[i] != ',') i++;
+            size_t end = i;
+            while (end > start && is_ows(val[end - 1])) end--;
+            if (end - start == tlen && http_iequals(val + start, token, tlen)) return true;
+        }
+        return false;
+    }
+}
+
+bool jstd::net::http_iequals(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        if (lower(a[i]) != lower(b[i])) return false;
+    return true;
+}
+
+bool HttpRequest::equals(HttpRange r, const char *s) const {
+    size_t len = std::strlen(s);
+    return r.len == len && std::memcmp(base + r.off, s, len) == 0;
+}
+
+bool HttpRequest::header(const char *name, HttpRange &value) const {
+    size_t len = std::strlen(name);
+    for (unsigned i = 0; i < header_cnt; i++) {
+        if (headers[i].name.len == len && http_iequals(base + headers[i].name.off, name, len)) {
+            value = headers[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+HttpRange HttpRequest::path() const {
+    const char *start = base + target.off;
+    const void *q = std::memchr(start, '?', target.len);
+    if (!q) return target;
+    return HttpRange{target.off, static_cast<uint32_t>(static_cast<const char*>(q) - start)};
+}
+
+HttpParser::HttpParser(): m_scanned(0), m_error_status(0) { }
+
+void HttpParser::reset() {
+    m_scanned = 0;
+    m_error_status = 0;
+}
+
+HTTP_PARSE HttpParser::parse(const char *buf, size_t len, HttpRequest &req) {
+    // locate the end of the header block, resuming 3 bytes back in case "\r\n\r\n" straddled two reads
+    size_t from = (m_scanned > 3) ? m_scanned - 3 : 0;
+    const char *hdr_end = nullptr;
+    for (size_t i = from; i + 3 < len; i++) {
+        const void *cr = std::memchr(buf + i, '\r', len - i - 3);
+        if (!cr) break;
+        i = static_cast<size_t>(static_cast<const char*>(cr) - buf);
+        if (buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
+            hdr_end = buf + i + 4;
+            break;
+        }
+    }
+    if (!hdr_end) {
+        m_scanned = len;
+        if (len > HTTP_MAX_HEADER_BYTES) {
+            m_error_status = 431;
+            return HTTP_PARSE::ERROR;
+        }
+        return HTTP_PARSE::INCOMPLETE;
+    }
+    m_scanned = static_cast<size_t>(hdr_end - buf) - 4;
+    if (m_scanned + 4 > HTTP_MAX_HEADER_BYTES) {
+        m_error_status = 431;
+        return HTTP_PARSE::ERROR;
+    }
+
+    req.base = buf;
+    req.header_cnt = 0;
+    req.content_length = 0;
+    m_error_status = 400;
+
+    // request line: METHOD SP target SP HTTP/1.x CRLF
+    const char *p = buf;
+    const char *end = hdr_end - 2;   // last CRLF of the block terminates the final header line
+    const char *tok = p;
+    while (p < end && *p >= 'A' && *p <= 'Z') p++;
+    if (p == tok || p >= end || *p != ' ') return HTTP_PARSE::ERROR;
+    req.method = range(buf, tok, p);
+    tok = ++p;
+    while (p < end && *p != ' ' && *p != '\r' && static_cast<unsigned char>(*p) > 0x20) p++;
+    if (p == tok || p >= end || *p != ' ') return HTTP_PARSE::ERROR;
+    req.target = range(buf, tok, p);
+    p++;
+    if (end - p < 10 || std::memcmp(p, "HTTP/1.", 7) != 0) {
+        if (end - p >= 5 && std::memcmp(p, "HTTP/", 5) == 0) m_error_status = 505;
+        return HTTP_PARSE::ERROR;
+    }
+    if (p[7] != '0' && p[7] != '1') {
+        m_error_status = 505;
+        return HTTP_PARSE::ERROR;
+    }
+    req.version_minor = p[7] - '0';
+    if (p[8] != '\r' || p[9] != '\n') return HTTP_PARSE::ERROR;
+    p += 10;
+    req.keep_alive = req.version_minor == 1;
+
+    // header lines: name ":" OWS value OWS CRLF
+    bool have_length = false;
+    while (p < end) {
+        const char *line_end = static_cast<const char*>(std::memchr(p, '\r', end - p + 1));
+        if (!line_end || line_end[1] != '\n') return HTTP_PARSE::ERROR;
+        const char *colon = static_cast<const char*>(std::memchr(p, ':', line_end - p));
+        if (!colon || colon == p) return HTTP_PARSE::ERROR;
+        for (const char *c = p; c < colon; c++)
+            if (!is_tchar(*c)) return HTTP_PARSE::ERROR;
+        if (req.header_cnt == HTTP_MAX_HEADERS) {
+            m_error_status = 431;
+            return HTTP_PARSE::ERROR;
+        }
+        const char *val = colon + 1;
+        const char *val_end = line_end;
+        while (val < val_end && is_ows(*val)) val++;
+        while (val_end > val && is_ows(val_end[-1])) val_end--;
+        for (const char *c = val; c < val_end; c++)
+            if (is_ctl(*c)) return HTTP_PARSE::ERROR;
+        HttpHeader &h = req.headers[req.header_cnt++];
+        h.name = range(buf, p, colon);
+        h.value = range(buf, val, val_end);
+        size_t name_len = static_cast<size_t>(colon - p);
+        size_t val_len = static_cast<size_t>(val_end - val);
+        if (name_len == 14 && http_iequals(p, "content-length", 14)) {
+            if (val_len == 0 || have_length) return HTTP_PARSE::ERROR;
+            size_t cl = 0;
+            for (const char *d = val; d < val_end; d++) {
+                if (*d < '0' || *d > '9') return HTTP_PARSE::ERROR;
+                cl = cl * 10 + static_cast<size_t>(*d - '0');
+                if (cl > HTTP_MAX_BODY_BYTES) {
+                    m_error_status = 413;
+                    return HTTP_PARSE::ERROR;
+                }
+            }
+            req.content_length = cl;
+            have_length = true;
+        } else if (name_len == 17 && http_iequals(p, "transfer-encoding", 17)) {
+            m_error_status = 501;
+            return HTTP_PARSE::ERROR;
+        } else if (name_len == 10 && http_iequals(p, "connection", 10)) {
+            if (has_token(val, val_len, "close"))
+                req.keep_alive = false;
+            else if (has_token(val, val_len, "keep-alive"))
+                req.keep_alive = true;
+        }
+        p = line_end + 2;
+    }
+
+    size_t hdr_len = static_cast<size_t>(hdr_end - buf);
+    if (len - hdr_len < req.content_length) {
+        m_error_status = 0;
+        return HTTP_PARSE::INCOMPLETE;
+    }
+    req.body = HttpRange{static_cast<uint32_t>(hdr_len), static_cast<uint32_t>(req.content_length)};
+    req.total_len = hdr_len + req.content_length;
+    reset();
+    return HTTP_PARSE::COMPLETE;
+}
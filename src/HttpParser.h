@@ -0,0 +1,86 @@
+#ifndef JSTDLIB_HTTPPARSER_H
+#define JSTDLIB_HTTPPARSER_H
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/*
+ * Incremental HTTP/1.x request parser working in place on the connection receive buffer.
+ *  - nothing is copied or allocated, the request line, headers and body are (offset, length) ranges
+ *    relative to the buffer handed to parse(), headers go into a fixed array
+ *  - parse() is called again whenever more bytes arrive, the search for the end of the header block
+ *    resumes where the previous call stopped
+ *  - a COMPLETE request reports how many bytes it consumed, pipelined requests behind it are parsed by
+ *    calling parse() again at buf + total_len
+ *  - request bodies need a Content-Length, chunked uploads are answered with 501
+ *  - header names have to be tokens and values free of control characters, so a bare LF can not smuggle a
+ *    header past a proxy that splits lines differently
+ */
+namespace jstd {
+    namespace net {
+        constexpr unsigned HTTP_MAX_HEADERS = 64;
+        constexpr size_t HTTP_MAX_HEADER_BYTES = 8192;
+        constexpr size_t HTTP_MAX_BODY_BYTES = 1 << 20;
+
+        enum class HTTP_PARSE { COMPLETE, INCOMPLETE, ERROR };
+
+        struct HttpRange {
+            uint32_t off;
+            uint32_t len;
+        };
+
+        struct HttpHeader {
+            HttpRange name;
+            HttpRange value;
+        };
+
+        struct HttpRequest {
+            const char *base;        // buffer the ranges are relative to, only valid until the buffer changes
+            HttpRange method;
+            HttpRange target;
+            HttpRange body;
+            int version_minor;
+            HttpHeader headers[HTTP_MAX_HEADERS];
+            unsigned header_cnt;
+            size_t content_length;
+            bool keep_alive;
+            size_t total_len;        // bytes of the buffer taken up by this request
+
+            inline const char *ptr(HttpRange r) const { return base + r.off; }
+
+            // allocates, for logging and handlers that want to keep a field
+            inline std::string str(HttpRange r) const { return std::string(base + r.off, r.len); }
+
+            // exact, case sensitive comparison, e.g. method
+            bool equals(HttpRange r, const char *s) const;
+
+            // case insensitive header lookup
+            bool header(const char *name, HttpRange &value) const;
+
+            // target without the query string
+            HttpRange path() const;
+        };
+
+        class HttpParser {
+            size_t m_scanned;
+            int m_error_status;
+
+        public:
+            HttpParser();
+
+            // forget partial progress, e.g. when the connection slot is reused
+            void reset();
+
+            // parse the request at the start of buf, INCOMPLETE asks for more data
+            HTTP_PARSE parse(const char *buf, size_t len, HttpRequest &req);
+
+            // status code to answer with after ERROR (400, 413, 431, 501, 505)
+            inline int error_status() const { return m_error_status; }
+        };
+
+        // ascii case insensitive comparison of len bytes
+        bool http_iequals(const char *a, const char *b, size_t len);
+    }
+}
+
+#endif //JSTDLIB_HTTPPARSER_H
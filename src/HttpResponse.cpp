@@ -0,0 +1,107 @@
+#include "HttpResponse.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace jstd::net;
+
+HttpResponse::HttpResponse():
+    m_status(200), m_chunked(false), m_close(false), m_head_only(false), m_file_fd(-1), m_file_size(0) { }
+
+HttpResponse::~HttpResponse() {
+    if (m_file_fd >= 0) close(m_file_fd);
+}
+
+void HttpResponse::add_header(const std::string &name, const std::string &value) {
+    m_headers.append(name).append(": ").append(value).append("\r\n");
+}
+
+void HttpResponse::set_body(const std::string &body, const std::string &content_type) {
+    m_body = body;
+    m_chunked = false;
+    if (!content_type.empty()) add_header("Content-Type", content_type);
+}
+
+void HttpResponse::write_chunk(const char *data, size_t len) {
+    if (len == 0) return;   // a zero sized chunk would terminate the body
+    if (!m_chunked) {
+        m_body.clear();
+        m_chunked = true;
+    }
+    char size_line[24];
+    int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+    m_body.append(size_line, static_cast<size_t>(n));
+    m_body.append(data, len);
+    m_body.append("\r\n");
+}
+
+bool HttpResponse::set_file(const std::string &path, const std::string &content_type) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (m_file_fd >= 0) close(m_file_fd);
+    m_file_fd = fd;
+    m_file_size = static_cast<size_t>(st.st_size);
+    m_body.clear();
+    m_chunked = false;
+    add_header("Content-Type", content_type.empty() ? mime_type(path) : content_type);
+    return true;
+}
+
+void HttpResponse::serialize(std::string &out, bool keep_alive) const {
+    char line[64];
+    int n = std::snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", m_status, reason(m_status));
+    out.append(line, static_cast<size_t>(n));
+    out.append(m_headers);
+    if (m_chunked) {
+        out.append("Transfer-Encoding: chunked\r\n");
+    } else {
+        n = std::snprintf(line, sizeof(line), "Content-Length: %zu\r\n", has_file() ? m_file_size : m_body.size());
+        out.append(line, static_cast<size_t>(n));
+    }
+    out.append(keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    if (m_head_only) return;
+    out.append(m_body);
+    if (m_chunked) out.append("0\r\n\r\n");
+}
+
+const char *HttpResponse::reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+const char *HttpResponse::mime_type(const std::string &path) {
+    static const struct { const char *ext; const char *type; } types[] = {
+        {".html", "text/html"}, {".htm", "text/html"}, {".css", "text/css"}, {".js", "application/javascript"},
+        {".json", "application/json"}, {".txt", "text/plain"}, {".png", "image/png"}, {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"}, {".gif", "image/gif"}, {".svg", "image/svg+xml"}, {".ico", "image/x-icon"},
+    };
+    size_t dot = path.rfind('.');
+    if (dot != std::string::npos) {
+        for (const auto &t : types)
+            if (path.compare(dot, std::string::npos, t.ext) == 0) return t.type;
+    }
+    return "application/octet-stream";
+}
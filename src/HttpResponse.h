@@ -0,0 +1,73 @@
+#ifndef JSTDLIB_HTTPRESPONSE_H
+#define JSTDLIB_HTTPRESPONSE_H
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+/*
+ * Response built by an HttpServer handler.
+ *  - set_body() sends a Content-Length response
+ *  - write_chunk() switches to Transfer-Encoding: chunked, every call becomes one chunk
+ *  - set_file() streams a file with sendfile() after the header, the body is never copied into user space
+ */
+namespace jstd {
+    namespace net {
+        class HttpResponse {
+            int m_status;
+            std::string m_headers;
+            std::string m_body;
+            bool m_chunked;
+            bool m_close;
+            bool m_head_only;
+            int m_file_fd;
+            size_t m_file_size;
+
+        public:
+            HttpResponse();
+
+            HttpResponse(const HttpResponse&) = delete;
+            HttpResponse& operator = (const HttpResponse&) = delete;
+
+            // closes the file handed to set_file(), if any
+            ~HttpResponse();
+
+            inline void set_status(int status) { m_status = status; }
+
+            inline int status() const { return m_status; }
+
+            // extra header line, Content-Length / Transfer-Encoding / Connection are managed here
+            void add_header(const std::string &name, const std::string &value);
+
+            void set_body(const std::string &body, const std::string &content_type = "text/plain");
+
+            void write_chunk(const char *data, size_t len);
+
+            // open path for streaming, false (status untouched) if it is not a readable regular file
+            bool set_file(const std::string &path, const std::string &content_type = "");
+
+            inline bool has_file() const { return m_file_fd >= 0; }
+
+            inline int file_fd() const { return m_file_fd; }
+
+            inline size_t file_size() const { return m_file_size; }
+
+            // drop the connection after this response
+            inline void set_close(bool close) { m_close = close; }
+
+            inline bool wants_close() const { return m_close; }
+
+            // HEAD request, headers only but with the real Content-Length
+            inline void set_head_only(bool head_only) { m_head_only = head_only; }
+
+            // append status line, headers and the in memory body to out, a file body is sent separately
+            void serialize(std::string &out, bool keep_alive) const;
+
+            static const char *reason(int status);
+
+            // content type from the file extension, application/octet-stream if unknown
+            static const char *mime_type(const std::string &path);
+        };
+    }
+}
+
+#endif //JSTDLIB_HTTPRESPONSE_H
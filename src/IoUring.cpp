@@ -0,0 +1,380 @@
+#include "IoUring.h"
+#ifdef LINUX_OS
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+using namespace jstd::net;
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params *p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+IoUring::IoUring():
+m_ring_fd(-1),
+m_features(0),
+m_sq_ptr(nullptr),
+m_sq_ring_sz(0),
+m_sq_head(nullptr),
+m_sq_tail(nullptr),
+m_sq_mask(0),
+m_sq_entries(0),
+m_sqes(nullptr),
+m_sqes_sz(0),
+m_cq_ptr(nullptr),
+m_cq_ring_sz(0),
+m_cq_head(nullptr),
+m_cq_tail(nullptr),
+m_cq_mask(0),
+m_cqes(nullptr),
+m_arena(nullptr),
+m_arena_sz(0),
+m_buff_sz(0),
+m_buff_cnt(0),
+m_buf_ring(nullptr),
+m_buf_ring_sz(0),
+m_bgid(0),
+m_buf_ring_active(false) { }
+
+IoUring::~IoUring() {
+    close();
+}
+
+bool IoUring::init(unsigned entries) {
+    if (is_active()) return true;
+    io_uring_params params{};
+    int fd = sys_io_uring_setup(entries, &params);
+    if (fd < 0) return false;
+    m_ring_fd = fd;
+    m_features = params.features;
+
+    m_sq_ring_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_ring_sz = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        if (m_cq_ring_sz > m_sq_ring_sz) m_sq_ring_sz = m_cq_ring_sz;
+        m_cq_ring_sz = m_sq_ring_sz;
+    }
+    m_sq_ptr = mmap(nullptr, m_sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ptr == MAP_FAILED) {
+        m_sq_ptr = nullptr;
+        close();
+        return false;
+    }
+    if (single_mmap) {
+        m_cq_ptr = m_sq_ptr;
+    } else {
+        m_cq_ptr = mmap(nullptr, m_cq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ring_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ptr == MAP_FAILED) {
+            m_cq_ptr = nullptr;
+            close();
+            return false;
+        }
+    }
+    m_sqes_sz = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, m_sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        close();
+        return false;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto *sq = static_cast<uint8_t*>(m_sq_ptr);
+    m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_sq_entries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    // sqe slots are used in order, the index array is an identity mapping
+    auto *sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < m_sq_entries; i++) sq_array[i] = i;
+
+    auto *cq = static_cast<uint8_t*>(m_cq_ptr);
+    m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    probe_ops();
+    return true;
+}
+
+void IoUring::close() {
+    if (m_buf_ring) {
+        munmap(m_buf_ring, m_buf_ring_sz);
+        m_buf_ring = nullptr;
+        m_buf_ring_active = false;
+    }
+    if (m_arena) {
+        munmap(m_arena, m_arena_sz);
+        m_arena = nullptr;
+        m_buff_cnt = 0;
+        m_free_buffs.clear();
+    }
+    if (m_sqes) {
+        munmap(m_sqes, m_sqes_sz);
+        m_sqes = nullptr;
+    }
+    if (m_cq_ptr && m_cq_ptr != m_sq_ptr) munmap(m_cq_ptr, m_cq_ring_sz);
+    m_cq_ptr = nullptr;
+    if (m_sq_ptr) {
+        munmap(m_sq_ptr, m_sq_ring_sz);
+        m_sq_ptr = nullptr;
+    }
+    if (m_ring_fd >= 0) {
+        ::close(m_ring_fd);
+        m_ring_fd = -1;
+    }
+    m_ops.clear();
+}
+
+bool IoUring::is_supported() {
+    IoUring ring;
+    return ring.init(2);
+}
+
+void IoUring::probe_ops() {
+    constexpr unsigned nr_ops = 256;
+    size_t len = sizeof(io_uring_probe) + nr_ops * sizeof(io_uring_probe_op);
+    auto *probe = static_cast<io_uring_probe*>(std::calloc(1, len));
+    m_ops.assign(nr_ops, false);
+    if (!probe) return;
+    if (sys_io_uring_register(m_ring_fd, IORING_REGISTER_PROBE, probe, nr_ops) == 0) {
+        for (unsigned i = 0; i < probe->ops_len && i < nr_ops; i++)
+            m_ops[probe->ops[i].op] = (probe->ops[i].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+    std::free(probe);
+}
+
+bool IoUring::supports_op(uint8_t op) const {
+    return op < m_ops.size() && m_ops[op];
+}
+
+bool IoUring::register_buffers(unsigned cnt, size_t sz) {
+    if (!is_active() || m_arena || cnt == 0) return false;
+    m_arena_sz = cnt * sz;
+    void *mem = mmap(nullptr, m_arena_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return false;
+    m_arena = static_cast<uint8_t*>(mem);
+    m_buff_sz = sz;
+    m_buff_cnt = cnt;
+    std::vector<iovec> iovs(cnt);
+    for (unsigned i = 0; i < cnt; i++) {
+        iovs[i].iov_base = buffer(i);
+        iovs[i].iov_len = sz;
+    }
+    if (sys_io_uring_register(m_ring_fd, IORING_REGISTER_BUFFERS, iovs.data(), cnt) < 0) {
+        munmap(m_arena, m_arena_sz);
+        m_arena = nullptr;
+        m_buff_cnt = 0;
+        return false;
+    }
+    m_free_buffs.clear();
+    for (unsigned i = cnt; i > 0; i--) m_free_buffs.push_back(i - 1);
+    return true;
+}
+
+bool IoUring::setup_buffer_ring(uint16_t bgid) {
+    if (!m_arena || m_buf_ring_active) return false;
+    if ((m_buff_cnt & (m_buff_cnt - 1)) != 0 || m_buff_cnt > 32768) return false;
+    if (!m_buf_ring) {
+        m_buf_ring_sz = m_buff_cnt * sizeof(io_uring_buf);
+        void *mem = mmap(nullptr, m_buf_ring_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return false;
+        m_buf_ring = static_cast<io_uring_buf_ring*>(mem);
+    }
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = m_buff_cnt;
+    reg.bgid = bgid;
+    if (sys_io_uring_register(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        munmap(m_buf_ring, m_buf_ring_sz);
+        m_buf_ring = nullptr;
+        return false;
+    }
+    m_bgid = bgid;
+    m_buf_ring->tail = 0;
+    // the uapi flex array carries an empty struct, which is one byte in C++ and shifts bufs[] by 8,
+    // index the ring as a plain io_uring_buf array to keep the kernel layout
+    auto *bufs = reinterpret_cast<io_uring_buf*>(m_buf_ring);
+    for (unsigned i = 0; i < m_buff_cnt; i++) {
+        io_uring_buf &b = bufs[i];
+        b.addr = reinterpret_cast<uint64_t>(buffer(i));
+        b.len = static_cast<uint32_t>(m_buff_sz);
+        b.bid = static_cast<uint16_t>(i);
+    }
+    __atomic_store_n(&m_buf_ring->tail, static_cast<uint16_t>(m_buff_cnt), __ATOMIC_RELEASE);
+    m_free_buffs.clear();
+    m_buf_ring_active = true;
+    return true;
+}
+
+bool IoUring::release_buffer_ring() {
+    if (!m_buf_ring_active) return true;
+    io_uring_buf_reg reg{};
+    reg.bgid = m_bgid;
+    if (sys_io_uring_register(m_ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1) < 0) return false;
+    m_buf_ring_active = false;
+    m_free_buffs.clear();
+    for (unsigned i = m_buff_cnt; i > 0; i--) m_free_buffs.push_back(i - 1);
+    return true;
+}
+
+void IoUring::recycle_buffer(uint16_t bid) {
+    if (!m_buf_ring_active) return;
+    uint16_t tail = m_buf_ring->tail;
+    io_uring_buf &b = reinterpret_cast<io_uring_buf*>(m_buf_ring)[tail & (m_buff_cnt - 1)];
+    b.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    b.len = static_cast<uint32_t>(m_buff_sz);
+    b.bid = bid;
+    __atomic_store_n(&m_buf_ring->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+int IoUring::acquire_buffer() {
+    if (m_buf_ring_active || m_free_buffs.empty()) return -1;
+    unsigned idx = m_free_buffs.back();
+    m_free_buffs.pop_back();
+    return static_cast<int>(idx);
+}
+
+void IoUring::release_buffer(unsigned idx) {
+    if (idx < m_buff_cnt) m_free_buffs.push_back(idx);
+}
+
+int IoUring::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    int rc = sys_io_uring_enter(m_ring_fd, to_submit, min_complete, flags);
+    return (rc < 0) ? -errno : rc;
+}
+
+io_uring_sqe *IoUring::get_sqe() {
+    if (!is_active()) return nullptr;
+    unsigned tail = *m_sq_tail;
+    if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+        enter(m_sq_entries, 0, 0);
+        if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) return nullptr;
+    }
+    io_uring_sqe *sqe = &m_sqes[tail & m_sq_mask];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+}
+
+// publish the sqe written at the current tail
+#define JSTD_URING_PUSH_SQE() __atomic_store_n(m_sq_tail, *m_sq_tail + 1, __ATOMIC_RELEASE)
+
+bool IoUring::prep_nop(uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_accept(int fd, bool multishot, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    if (multishot) sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_recv_multishot(int fd, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = m_bgid;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_read_fixed(int fd, unsigned buff_idx, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer(buff_idx));
+    sqe->len = static_cast<uint32_t>(m_buff_sz);
+    sqe->buf_index = static_cast<uint16_t>(buff_idx);
+    sqe->off = 0;   // sockets reject any other position
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_send(int fd, const void *data, size_t len, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_recvmsg(int fd, msghdr *msg, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(msg);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+bool IoUring::prep_sendmsg(int fd, const msghdr *msg, uint64_t user_data) {
+    std::lock_guard<std::mutex> lck(m_sq_mtx);
+    io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    JSTD_URING_PUSH_SQE();
+    return true;
+}
+
+#undef JSTD_URING_PUSH_SQE
+
+int IoUring::submit() {
+    return enter(m_sq_entries, 0, 0);
+}
+
+int IoUring::submit_and_wait(unsigned min_complete) {
+    return enter(m_sq_entries, min_complete, IORING_ENTER_GETEVENTS);
+}
+
+#endif // LINUX_OS
@@ -0,0 +1,178 @@
+#ifndef JSTDLIB_IOURING_H
+#define JSTDLIB_IOURING_H
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#ifdef LINUX_OS
+#include <linux/io_uring.h>
+#endif
+
+/*
+ * Minimal io_uring wrapper built directly on the raw syscalls (no liburing dependency)
+ *  - init() fails cleanly when the kernel, or a container seccomp profile, rejects io_uring.
+ *    callers are expected to fall back to epoll when that happens
+ *  - submission side is guarded by a mutex, the processing thread may queue sends while the
+ *    receiving thread is parked inside submit_and_wait()
+ *  - completion side (for_each_cqe, recycle_buffer) must only be driven by a single thread
+ *  - one arena of equally sized buffers is registered with the kernel (READ_FIXED), the same arena
+ *    can instead be handed to a provided buffer ring for multishot recv
+ *
+ * TcpServerBase runs multishot accept and recv over a provided buffer ring when the kernel supports it, single
+ * shot READ_FIXED recvs otherwise, UdpServerBase keeps a batch of recvmsg requests in flight. Both fall back to
+ * epoll when init() fails, see set_io_backend().
+ *
+ * user_data layout: [ 8 bit tag | 56 bit value ], see pack_user_data()
+ */
+namespace jstd {
+    namespace net {
+#ifdef LINUX_OS
+        class IoUring {
+            int m_ring_fd;
+            unsigned m_features;
+
+            // submission queue ring
+            void *m_sq_ptr;
+            size_t m_sq_ring_sz;
+            unsigned *m_sq_head;
+            unsigned *m_sq_tail;
+            unsigned m_sq_mask;
+            unsigned m_sq_entries;
+            io_uring_sqe *m_sqes;
+            size_t m_sqes_sz;
+            std::mutex m_sq_mtx;
+
+            // completion queue ring
+            void *m_cq_ptr;
+            size_t m_cq_ring_sz;
+            unsigned *m_cq_head;
+            unsigned *m_cq_tail;
+            unsigned m_cq_mask;
+            io_uring_cqe *m_cqes;
+
+            // supported opcodes, filled in by IORING_REGISTER_PROBE
+            std::vector<bool> m_ops;
+
+            // registered buffer arena
+            uint8_t *m_arena;
+            size_t m_arena_sz;
+            size_t m_buff_sz;
+            unsigned m_buff_cnt;
+            std::vector<unsigned> m_free_buffs;
+
+            // provided buffer ring (multishot recv)
+            io_uring_buf_ring *m_buf_ring;
+            size_t m_buf_ring_sz;
+            uint16_t m_bgid;
+            bool m_buf_ring_active;
+
+        public:
+            IoUring();
+            IoUring(const IoUring&) = delete;
+            IoUring& operator = (const IoUring&) = delete;
+            ~IoUring();
+
+            // create the ring, returns false (errno preserved) if io_uring is unavailable
+            bool init(unsigned entries);
+
+            // tear the ring down, safe to call more than once
+            void close();
+
+            inline bool is_active() const { return m_ring_fd >= 0; }
+
+            inline unsigned features() const { return m_features; }
+
+            // true if the kernel reported support for opcode op via IORING_REGISTER_PROBE
+            bool supports_op(uint8_t op) const;
+
+            // cheap runtime check, creates and destroys a tiny ring
+            static bool is_supported();
+
+            // allocate and register cnt buffers of sz bytes each (IORING_REGISTER_BUFFERS)
+            bool register_buffers(unsigned cnt, size_t sz);
+
+            // hand the registered arena to the kernel as provided buffer group bgid, cnt must be a power of 2
+            bool setup_buffer_ring(uint16_t bgid);
+
+            // return arena to fixed buffer mode, used when multishot recv is rejected by the kernel
+            bool release_buffer_ring();
+
+            inline bool buffer_ring_active() const { return m_buf_ring_active; }
+
+            // give buffer bid back to the provided buffer ring
+            void recycle_buffer(uint16_t bid);
+
+            // fixed buffer bookkeeping when the arena is not handed to a buffer ring, -1 when exhausted
+            int acquire_buffer();
+
+            void release_buffer(unsigned idx);
+
+            inline uint8_t *buffer(unsigned idx) const { return m_arena + (idx * m_buff_sz); }
+
+            inline size_t buffer_size() const { return m_buff_sz; }
+
+            inline unsigned buffer_count() const { return m_buff_cnt; }
+
+            // request preparation, all return false if the submission queue could not be flushed
+            bool prep_nop(uint64_t user_data);
+
+            bool prep_accept(int fd, bool multishot, uint64_t user_data);
+
+            bool prep_recv_multishot(int fd, uint64_t user_data);
+
+            bool prep_read_fixed(int fd, unsigned buff_idx, uint64_t user_data);
+
+            bool prep_send(int fd, const void *data, size_t len, uint64_t user_data);
+
+            bool prep_recvmsg(int fd, msghdr *msg, uint64_t user_data);
+
+            bool prep_sendmsg(int fd, const msghdr *msg, uint64_t user_data);
+
+            // submit everything queued, does not wait for completions
+            int submit();
+
+            // submit everything queued and block until at least min_complete completions are ready
+            int submit_and_wait(unsigned min_complete);
+
+            // reap all ready completions, fn(const io_uring_cqe&) is invoked once per entry
+            template<typename Fn>
+            unsigned for_each_cqe(Fn &&fn) {
+                unsigned head = *m_cq_head;
+                unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                unsigned cnt = 0;
+                while (head != tail) {
+                    fn(m_cqes[head & m_cq_mask]);
+                    head++;
+                    cnt++;
+                }
+                __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                return cnt;
+            }
+
+            static inline uint64_t pack_user_data(uint8_t tag, uint64_t value) {
+                return (static_cast<uint64_t>(tag) << 56) | (value & 0x00FFFFFFFFFFFFFFull);
+            }
+
+            static inline uint8_t user_data_tag(uint64_t user_data) {
+                return static_cast<uint8_t>(user_data >> 56);
+            }
+
+            static inline uint64_t user_data_value(uint64_t user_data) {
+                return user_data & 0x00FFFFFFFFFFFFFFull;
+            }
+
+        private:
+            // caller must hold m_sq_mtx, flushes the queue once if it is full
+            io_uring_sqe *get_sqe();
+
+            int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+
+            void probe_ops();
+        };
+#endif
+    }
+}
+
+#endif //JSTDLIB_IOURING_H
@@ -0,0 +1,242 @@
+#include "KvStore.h"
+#include <chrono>
+
+using namespace jstd;
+
+namespace {
+    inline uint64_t fnv1a(const char *key, size_t klen) {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < klen; i++) {
+            h ^= static_cast<uint8_t>(key[i]);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    inline uint64_t xorshift(uint64_t &state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    inline size_t entry_bytes(size_t klen, size_t vlen) {
+        return klen + vlen + KV_ENTRY_OVERHEAD;
+    }
+}
+
+KvStore::KvStore(size_t max_bytes, unsigned shards, unsigned tick_ms, unsigned wheel_slots):
+    m_shard_limit(0), m_tick_ms(tick_ms ? tick_ms : 1), m_last_tick(0) {
+    if (!shards) shards = 1;
+    if (!wheel_slots) wheel_slots = 1;
+    if (max_bytes) m_shard_limit = (max_bytes / shards) ? (max_bytes / shards) : 1;
+    uint64_t start_tick = now_ms() / m_tick_ms;
+    m_last_tick = start_tick;
+    for (unsigned i = 0; i < shards; i++) {
+        std::unique_ptr<kv_shard> s(new kv_shard);
+        s->wheel.resize(wheel_slots);
+        s->wheel_tick = start_tick;
+        s->bytes = 0;
+        s->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+        m_shards.push_back(std::move(s));
+    }
+}
+
+uint64_t KvStore::now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+KvStore::kv_shard &KvStore::shard_of(const char *key, size_t klen) {
+    return *m_shards[fnv1a(key, klen) % m_shards.size()];
+}
+
+std::unordered_map<std::string, KvStore::kv_entry>::iterator
+KvStore::find(kv_shard &s, const char *key, size_t klen, uint64_t now) {
+    s.key.assign(key, klen);
+    auto it = s.map.find(s.key);
+    if (it != s.map.end() && it->second.expire_at && it->second.expire_at <= now) {
+        s.stats.expirations++;
+        erase(s, it);
+        return s.map.end();
+    }
+    return it;
+}
+
+void KvStore::erase(kv_shard &s, std::unordered_map<std::string, kv_entry>::iterator it) {
+    s.bytes -= entry_bytes(it->first.size(), it->second.value.size());
+    s.map.erase(it);
+}
+
+void KvStore::schedule(kv_shard &s, const std::string &key, uint64_t expire_at) {
+    uint64_t tick = expire_at / m_tick_ms;
+    if (tick <= s.wheel_tick) tick = s.wheel_tick + 1;  // already due, picked up by the next tick
+    s.wheel[tick % s.wheel.size()].push_back(wheel_entry{key, expire_at});
+}
+
+void KvStore::evict(kv_shard &s, const std::string &keep) {
+    uint32_t now = static_cast<uint32_t>(now_ms());
+    while (s.bytes > m_shard_limit && s.map.size() > 1) {
+        auto victim = s.map.end();
+        uint32_t victim_age = 0;
+        size_t buckets = s.map.bucket_count();
+        for (unsigned n = 0; n < KV_EVICTION_SAMPLES; n++) {
+            // random non empty bucket, first node in it
+            size_t b = xorshift(s.rng) % buckets;
+            for (size_t probe = 0; probe < buckets && s.map.bucket_size(b) == 0; probe++)
+                b = (b + 1) % buckets;
+            auto local = s.map.begin(b);
+            if (local == s.map.end(b) || local->first == keep) continue;
+            uint32_t age = now - local->second.lru;
+            if (victim == s.map.end() || age > victim_age) {
+                victim = s.map.find(local->first);
+                victim_age = age;
+            }
+        }
+        if (victim == s.map.end()) break;
+        erase(s, victim);
+        s.stats.evictions++;
+    }
+}
+
+bool KvStore::get(const char *key, size_t klen, std::string &val) {
+    kv_shard &s = shard_of(key, klen);
+    uint64_t now = now_ms();
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = find(s, key, klen, now);
+    if (it == s.map.end()) {
+        s.stats.misses++;
+        return false;
+    }
+    it->second.lru = static_cast<uint32_t>(now);
+    val.assign(it->second.value);
+    s.stats.hits++;
+    return true;
+}
+
+void KvStore::set(const char *key, size_t klen, const char *val, size_t vlen, int64_t ttl_ms) {
+    kv_shard &s = shard_of(key, klen);
+    uint64_t now = now_ms();
+    std::lock_guard<std::mutex> lck(s.mtx);
+    s.key.assign(key, klen);
+    auto it = s.map.find(s.key);
+    if (it == s.map.end()) {
+        it = s.map.emplace(s.key, kv_entry{std::string(), 0, 0}).first;
+        s.bytes += entry_bytes(klen, 0);
+    }
+    kv_entry &e = it->second;
+    s.bytes = s.bytes - e.value.size() + vlen;
+    e.value.assign(val, vlen);
+    e.lru = static_cast<uint32_t>(now);
+    e.expire_at = (ttl_ms >= 0) ? now + static_cast<uint64_t>(ttl_ms) : 0;
+    if (e.expire_at) schedule(s, it->first, e.expire_at);
+    if (m_shard_limit && s.bytes > m_shard_limit) evict(s, it->first);
+}
+
+bool KvStore::del(const char *key, size_t klen) {
+    kv_shard &s = shard_of(key, klen);
+    uint64_t now = now_ms();
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = find(s, key, klen, now);
+    if (it == s.map.end()) return false;
+    erase(s, it);
+    return true;
+}
+
+bool KvStore::expire(const char *key, size_t klen, int64_t ttl_ms) {
+    kv_shard &s = shard_of(key, klen);
+    uint64_t now = now_ms();
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = find(s, key, klen, now);
+    if (it == s.map.end()) return false;
+    if (ttl_ms <= 0) {
+        erase(s, it);
+        return true;
+    }
+    it->second.expire_at = now + static_cast<uint64_t>(ttl_ms);
+    schedule(s, it->first, it->second.expire_at);
+    return true;
+}
+
+int64_t KvStore::ttl(const char *key, size_t klen) {
+    kv_shard &s = shard_of(key, klen);
+    uint64_t now = now_ms();
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = find(s, key, klen, now);
+    if (it == s.map.end()) return -2;
+    if (!it->second.expire_at) return -1;
+    return static_cast<int64_t>(it->second.expire_at - now);
+}
+
+size_t KvStore::expire_shard(kv_shard &s, uint64_t now) {
+    uint64_t now_tick = now / m_tick_ms;
+    if (now_tick <= s.wheel_tick) return 0;
+    size_t expired = 0;
+    // after a long stall every slot is visited once, due entries are recognized by expire_at
+    uint64_t first = (now_tick - s.wheel_tick > s.wheel.size()) ? now_tick - s.wheel.size() + 1 : s.wheel_tick + 1;
+    for (uint64_t t = first; t <= now_tick; t++) {
+        std::vector<wheel_entry> &slot = s.wheel[t % s.wheel.size()];
+        size_t i = 0;
+        while (i < slot.size()) {
+            wheel_entry &w = slot[i];
+            if (w.expire_at > now) {    // a later round of the wheel
+                i++;
+                continue;
+            }
+            auto it = s.map.find(w.key);
+            if (it != s.map.end() && it->second.expire_at == w.expire_at) {
+                erase(s, it);
+                s.stats.expirations++;
+                expired++;
+            }
+            if (i + 1 != slot.size()) slot[i] = std::move(slot.back());
+            slot.pop_back();
+        }
+    }
+    s.wheel_tick = now_tick;
+    return expired;
+}
+
+size_t KvStore::expire_tick() {
+    uint64_t now = now_ms();
+    uint64_t tick = now / m_tick_ms;
+    uint64_t last = m_last_tick.load(std::memory_order_relaxed);
+    if (tick <= last || !m_last_tick.compare_exchange_strong(last, tick))
+        return 0;
+    size_t expired = 0;
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        expired += expire_shard(*s, now);
+    }
+    return expired;
+}
+
+size_t KvStore::size() {
+    size_t cnt = 0;
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        cnt += s->map.size();
+    }
+    return cnt;
+}
+
+size_t KvStore::memory_used() {
+    size_t bytes = 0;
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        bytes += s->bytes;
+    }
+    return bytes;
+}
+
+KvStats KvStore::stats() {
+    KvStats total;
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        total.hits += s->stats.hits;
+        total.misses += s->stats.misses;
+        total.evictions += s->stats.evictions;
+        total.expirations += s->stats.expirations;
+    }
+    return total;
+}
@@ -0,0 +1,112 @@
+#ifndef JSTDLIB_KVSTORE_H
+#define JSTDLIB_KVSTORE_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * In memory key/value store behind the RESP cache server.
+ *  - keys are spread over independently locked shards (FNV-1a of the key), each shard owns a hash map,
+ *    its share of the memory limit and a timing wheel of pending expirations
+ *  - TTLs are kept in the entry and in a wheel slot (expire_at / tick_ms) % slots, expire_tick() walks the
+ *    slots that came due since the previous call, so active expiry costs O(due keys) instead of a scan,
+ *    wheel entries made stale by SET/EXPIRE/DEL are recognized by their expire_at and dropped
+ *  - reads also expire lazily, an expired key is never returned even between ticks
+ *  - with a memory limit, SET evicts from the written shard until it fits again, the victim is the least
+ *    recently used of KV_EVICTION_SAMPLES randomly sampled keys (approximate LRU, as redis does)
+ */
+namespace jstd {
+    constexpr unsigned KV_EVICTION_SAMPLES = 5;
+    constexpr size_t KV_ENTRY_OVERHEAD = 64;    // estimated bytes of map node and entry bookkeeping per key
+
+    struct KvStats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t expirations;
+        KvStats() : hits(0), misses(0), evictions(0), expirations(0) {}
+    };
+
+    class KvStore {
+        struct kv_entry {
+            std::string value;
+            uint64_t expire_at;     // steady clock ms, 0 for no TTL
+            uint32_t lru;           // low 32 bits of the ms clock at the last access
+        };
+
+        struct wheel_entry {
+            std::string key;
+            uint64_t expire_at;
+        };
+
+        struct kv_shard {
+            std::mutex mtx;
+            std::unordered_map<std::string, kv_entry> map;
+            std::vector<std::vector<wheel_entry>> wheel;
+            uint64_t wheel_tick;    // last processed tick
+            size_t bytes;
+            uint64_t rng;
+            std::string key;        // lookup scratch, keeps its capacity
+            KvStats stats;
+        };
+
+        std::vector<std::unique_ptr<kv_shard>> m_shards;
+        size_t m_shard_limit;       // 0 for unlimited
+        unsigned m_tick_ms;
+        std::atomic<uint64_t> m_last_tick;
+
+        kv_shard &shard_of(const char *key, size_t klen);
+
+        // entry for key or end() if missing or expired, an expired entry is removed on the way
+        std::unordered_map<std::string, kv_entry>::iterator find(kv_shard &s, const char *key, size_t klen,
+                                                                 uint64_t now);
+
+        void erase(kv_shard &s, std::unordered_map<std::string, kv_entry>::iterator it);
+
+        void schedule(kv_shard &s, const std::string &key, uint64_t expire_at);
+
+        void evict(kv_shard &s, const std::string &keep);
+
+        size_t expire_shard(kv_shard &s, uint64_t now);
+
+    public:
+        // max_bytes of 0 disables eviction, tick_ms is the active expiry resolution
+        explicit KvStore(size_t max_bytes = 0, unsigned shards = 16, unsigned tick_ms = 100,
+                         unsigned wheel_slots = 1024);
+
+        KvStore(const KvStore &) = delete;
+
+        KvStore &operator=(const KvStore &) = delete;
+
+        // copies the value into val, false if the key does not exist
+        bool get(const char *key, size_t klen, std::string &val);
+
+        // ttl_ms < 0 stores without TTL (clearing an existing one)
+        void set(const char *key, size_t klen, const char *val, size_t vlen, int64_t ttl_ms = -1);
+
+        bool del(const char *key, size_t klen);
+
+        // false if the key does not exist, ttl_ms <= 0 deletes it
+        bool expire(const char *key, size_t klen, int64_t ttl_ms);
+
+        // remaining ms, -1 without TTL, -2 if the key does not exist
+        int64_t ttl(const char *key, size_t klen);
+
+        // expire everything that came due since the last call, cheap when no tick elapsed
+        size_t expire_tick();
+
+        size_t size();
+
+        size_t memory_used();
+
+        KvStats stats();
+
+        static uint64_t now_ms();
+    };
+}
+
+#endif //JSTDLIB_KVSTORE_H
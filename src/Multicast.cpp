@@ -0,0 +1,62 @@
+#include "Multicast.h"
+#include <cerrno>
+#include <unistd.h>
+
+using namespace jstd::net;
+
+namespace {
+    bool membership(int sockfd, int opt, const in_addr &group, const in_addr &iface) {
+        if (!multicast::is_group(group)) {
+            errno = EINVAL;
+            return false;
+        }
+        ip_mreq mreq{};
+        mreq.imr_multiaddr = group;
+        mreq.imr_interface = iface;
+        return setsockopt(sockfd, IPPROTO_IP, opt, &mreq, sizeof(mreq)) == 0;
+    }
+}
+
+bool multicast::is_group(const in_addr &addr) {
+    return IN_MULTICAST(ntohl(addr.s_addr));
+}
+
+bool multicast::configure_sender(int sockfd, const MulticastConfig &cfg) {
+    unsigned char ttl = cfg.ttl;
+    unsigned char loop = cfg.loopback ? 1 : 0;
+    return setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_IF, &cfg.interface, sizeof(cfg.interface)) == 0 &&
+           setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0 &&
+           setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) == 0;
+}
+
+int multicast::bind_socket(in_port_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    int one = 1;
+#ifdef IP_MULTICAST_ALL
+    int zero = 0;
+#endif
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+#ifdef IP_MULTICAST_ALL
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &zero, sizeof(zero)) < 0 ||
+#endif
+        bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+bool multicast::join(int sockfd, const in_addr &group, const in_addr &iface) {
+    return membership(sockfd, IP_ADD_MEMBERSHIP, group, iface);
+}
+
+bool multicast::leave(int sockfd, const in_addr &group, const in_addr &iface) {
+    return membership(sockfd, IP_DROP_MEMBERSHIP, group, iface);
+}
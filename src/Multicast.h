@@ -0,0 +1,48 @@
+#ifndef JSTDLIB_MULTICAST_H
+#define JSTDLIB_MULTICAST_H
+#include <cstdint>
+#include "net_types.h"
+
+/*
+ * IPv4 multicast on UDP sockets, one send reaches every socket that joined the group on the route's interface.
+ *  - senders pick the outgoing interface, the TTL (1 keeps datagrams on the local network) and whether their own
+ *    host gets a copy (loopback, needed when sender and receivers share a host)
+ *  - receivers bind the group's port on any address, with SO_REUSEADDR so several sockets of a host can, and join
+ *    the group on an interface. Every socket of the host bound to the port that joined gets its own copy
+ *  - memberships end with the socket, leave() drops one earlier. Linux caps them per socket by
+ *    net.ipv4.igmp_max_memberships (20)
+ * UdpServerBase builds its broadcasts on it, see set_multicast() and join_group(): one send per broadcast
+ * however many subscribers there are, fragmentation works across it, the reliability layer is per client and
+ * keeps its broadcasts unicast.
+ */
+namespace jstd {
+    namespace net {
+        struct MulticastConfig {
+            in_addr interface;      // outgoing interface by address, INADDR_ANY lets the routing table pick
+            uint8_t ttl;
+            bool loopback;          // deliver to sockets on this host as well
+
+            MulticastConfig() : ttl(1), loopback(true) { interface.s_addr = htonl(INADDR_ANY); }
+        };
+
+        namespace multicast {
+            // true for 224.0.0.0/4
+            bool is_group(const in_addr &addr);
+
+            // apply cfg to a sending socket, false (errno set) if an option was refused
+            bool configure_sender(int sockfd, const MulticastConfig &cfg);
+
+            // new UDP socket with SO_REUSEADDR bound to port on any address, -1 with errno set on failure. On Linux it
+            // only gets the groups it joined itself, not every group some socket of the host joined on the port
+            int bind_socket(in_port_t port);
+
+            // receive the group on sockfd through the interface with address iface (INADDR_ANY for the default
+            // route's), false with errno set
+            bool join(int sockfd, const in_addr &group, const in_addr &iface);
+
+            bool leave(int sockfd, const in_addr &group, const in_addr &iface);
+        }
+    }
+}
+
+#endif //JSTDLIB_MULTICAST_H
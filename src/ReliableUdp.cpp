@@ -0,0 +1,273 @@
+#include "ReliableUdp.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace jstd::net;
+
+namespace {
+    inline void put32(uint8_t *p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    inline uint32_t get32(const uint8_t *p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    inline void put64(uint8_t *p, uint64_t v) {
+        put32(p, static_cast<uint32_t>(v >> 32));
+        put32(p + 4, static_cast<uint32_t>(v));
+    }
+
+    inline uint64_t get64(const uint8_t *p) {
+        return (static_cast<uint64_t>(get32(p)) << 32) | get32(p + 4);
+    }
+}
+
+ReliablePeer::ReliablePeer(const ReliableConfig &cfg, uint32_t session): m_cfg(cfg),
+                                                                         m_session(session ? session : 1),
+                                                                         m_next_seq(0),
+                                                                         m_snd_una(0),
+                                                                         m_srtt_us(0),
+                                                                         m_rttvar_us(0),
+                                                                         m_min_rtt_us(0),
+                                                                         m_rack_sent_us(0),
+                                                                         m_rcv_session(0),
+                                                                         m_rcv_next(0),
+                                                                         m_rcv_fresh(true) {
+    m_cfg.window = std::max<uint32_t>(1, std::min(m_cfg.window, RUDP_MAX_WINDOW));
+    m_rto_us = static_cast<uint64_t>(m_cfg.initial_rto_ms) * 1000;
+    m_sent.resize(m_cfg.window, sent_slot{std::vector<uint8_t>(), 0, 0, true});
+}
+
+uint8_t ReliablePeer::packet_type(const uint8_t *pkt, size_t len) {
+    if (len >= RUDP_DATA_HEADER && pkt[0] == RUDP_DATA) return RUDP_DATA;
+    if (len >= RUDP_ACK_LEN && pkt[0] == RUDP_ACK) return RUDP_ACK;
+    return 0;
+}
+
+uint64_t ReliablePeer::now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool ReliablePeer::send(const uint8_t *data, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                        ReliableCounters &counters) {
+    if (!m_queued.empty() || in_flight() >= m_cfg.window) {
+        if (m_queued.size() >= m_cfg.max_queued) return false;
+        m_queued.emplace_back(data, data + len);
+        return true;
+    }
+    send_next(data, len, now_us, out, counters);
+    return true;
+}
+
+void ReliablePeer::send_next(const uint8_t *data, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                             ReliableCounters &counters) {
+    uint32_t seq = m_next_seq++;
+    sent_slot &slot = m_sent[seq % m_cfg.window];
+    slot.pkt.resize(RUDP_DATA_HEADER + len);
+    uint8_t *hdr = slot.pkt.data();
+    hdr[0] = RUDP_DATA;
+    hdr[1] = hdr[2] = hdr[3] = 0;
+    put32(hdr + 4, m_session);
+    put32(hdr + 8, seq);
+    if (len) std::memcpy(hdr + RUDP_DATA_HEADER, data, len);
+    slot.retries = 0;
+    slot.acked = false;
+    counters.sent++;
+    transmit(seq, now_us, out);
+}
+
+void ReliablePeer::transmit(uint32_t seq, uint64_t now_us, std::vector<ReliablePacket> &out) {
+    sent_slot &slot = m_sent[seq % m_cfg.window];
+    slot.sent_us = now_us;
+    out.push_back(ReliablePacket{slot.pkt.data(), slot.pkt.size()});
+}
+
+void ReliablePeer::fill_window(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters) {
+    while (!m_queued.empty() && in_flight() < m_cfg.window) {
+        send_next(m_queued.front().data(), m_queued.front().size(), now_us, out, counters);
+        m_queued.pop_front();
+    }
+}
+
+void ReliablePeer::sample_rtt(uint64_t rtt_us) {
+    rtt_us = std::max<uint64_t>(rtt_us, 1);
+    m_min_rtt_us = m_min_rtt_us ? std::min(m_min_rtt_us, rtt_us) : rtt_us;
+    if (!m_srtt_us) {
+        m_srtt_us = rtt_us;
+        m_rttvar_us = rtt_us / 2;
+    } else {
+        uint64_t delta = m_srtt_us > rtt_us ? m_srtt_us - rtt_us : rtt_us - m_srtt_us;
+        m_rttvar_us = (3 * m_rttvar_us + delta) / 4;
+        m_srtt_us = (7 * m_srtt_us + rtt_us) / 8;
+    }
+    // on a steady path RTTVAR decays towards 0, min_rto_ms bounds the margin over SRTT instead of the timeout so
+    // scheduling jitter does not fire it, the way Linux applies rto_min to the variance term
+    uint64_t margin = std::max<uint64_t>(std::max(m_cfg.min_rto_ms, m_cfg.tick_ms) * 1000ULL, 4 * m_rttvar_us);
+    m_rto_us = std::min<uint64_t>(m_srtt_us + margin, static_cast<uint64_t>(m_cfg.max_rto_ms) * 1000);
+}
+
+void ReliablePeer::ack_slot(uint32_t seq, uint64_t now_us, uint64_t &newest_sent_us) {
+    sent_slot &slot = m_sent[seq % m_cfg.window];
+    if (slot.acked) return;
+    slot.acked = true;
+    // Karn: the ack of a retransmitted datagram could be for any of its copies
+    if (!slot.retries) sample_rtt(now_us - slot.sent_us);
+    // acked sooner after the retransmission than any RTT, it was the original that made it (RFC 8985). Taking the
+    // retransmission's time would have everything sent since declared lost
+    else if (now_us - slot.sent_us < m_min_rtt_us) return;
+    newest_sent_us = std::max(newest_sent_us, slot.sent_us);
+}
+
+void ReliablePeer::on_ack(const uint8_t *pkt, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                          ReliableCounters &counters) {
+    if (packet_type(pkt, len) != RUDP_ACK || get32(pkt + 4) != m_session) return;
+    if (pkt[1] & RUDP_ACK_RESYNC) {
+        restart_session(now_us, out, counters);
+        return;
+    }
+    uint32_t ack = get32(pkt + 8);
+    uint64_t bits = get64(pkt + 12);
+    uint32_t flight = in_flight();
+    // behind snd_una (late) or past what was sent (bogus)
+    if (ack - m_snd_una > flight) return;
+    uint64_t newest_sent_us = 0;
+    for (uint32_t seq = m_snd_una; seq != ack; seq++) ack_slot(seq, now_us, newest_sent_us);
+    for (unsigned i = 0; bits && i < 64; i++, bits >>= 1) {
+        uint32_t seq = ack + 1 + i;
+        if ((bits & 1) && seq - m_snd_una < flight) ack_slot(seq, now_us, newest_sent_us);
+    }
+    while (m_snd_una != m_next_seq && m_sent[m_snd_una % m_cfg.window].acked) m_snd_una++;
+    if (newest_sent_us > m_rack_sent_us) {
+        m_rack_sent_us = newest_sent_us;
+        // sent a while before something that made it, lost rather than reordered
+        uint64_t reorder_us = m_srtt_us / 4;
+        for (uint32_t seq = m_snd_una; seq != m_next_seq; seq++) {
+            sent_slot &slot = m_sent[seq % m_cfg.window];
+            if (slot.acked || slot.sent_us + reorder_us >= m_rack_sent_us) continue;
+            slot.retries++;
+            counters.retransmitted++;
+            counters.fast_retransmitted++;
+            transmit(seq, now_us, out);
+        }
+    }
+    fill_window(now_us, out, counters);
+}
+
+RUDP_RECV ReliablePeer::on_data(const uint8_t *pkt, size_t len, uint8_t *ack,
+                                std::vector<std::vector<uint8_t>> &ready, ReliableCounters &counters) {
+    if (packet_type(pkt, len) != RUDP_DATA) return RUDP_RECV::REJECTED;
+    uint32_t session = get32(pkt + 4);
+    uint32_t seq = get32(pkt + 8);
+    uint32_t window = m_cfg.window;
+    if (m_recvd.empty()) m_recvd.resize(window, recv_slot{std::vector<uint8_t>(), false});
+    if (session != m_rcv_session) {
+        // a retransmission of a session the peer has moved on from, it must not wipe the current one
+        uint32_t behind = m_rcv_session - session;
+        if (m_rcv_session && behind <= RUDP_STALE_SESSIONS) return RUDP_RECV::STALE;
+        // the peer restarted or gave up on us, whatever was buffered belongs to the old session
+        m_rcv_session = session;
+        m_rcv_next = 0;
+        m_rcv_fresh = true;
+        for (auto &slot : m_recvd) {
+            slot.have = false;
+            slot.payload.clear();
+        }
+    }
+    RUDP_RECV res;
+    uint32_t off = seq - m_rcv_next;
+    if (m_rcv_fresh && seq) {
+        // where the session stands is only known from its start, an ack of 0 would be taken for a late one
+        res = RUDP_RECV::DROPPED;
+    } else if (off >= 0x80000000u) {
+        res = RUDP_RECV::DUPLICATE;
+    } else if (off >= window) {
+        res = RUDP_RECV::DROPPED;
+    } else if (m_recvd[seq % window].have) {
+        res = RUDP_RECV::DUPLICATE;
+    } else if (off == 0) {
+        res = RUDP_RECV::DELIVER;
+        m_rcv_next++;
+        // whatever arrived early is next now, unordered it was delivered on arrival
+        for (recv_slot *slot = &m_recvd[m_rcv_next % window]; slot->have; slot = &m_recvd[m_rcv_next % window]) {
+            if (m_cfg.ordered) ready.push_back(std::move(slot->payload));
+            slot->payload.clear();
+            slot->have = false;
+            m_rcv_next++;
+        }
+    } else {
+        recv_slot &slot = m_recvd[seq % window];
+        slot.have = true;
+        if (m_cfg.ordered) {
+            slot.payload.assign(pkt + RUDP_DATA_HEADER, pkt + len);
+            res = RUDP_RECV::BUFFERED;
+        } else {
+            res = RUDP_RECV::DELIVER;
+        }
+    }
+    if (res == RUDP_RECV::DUPLICATE) counters.duplicates++;
+    // a session never seen from its start, the sender has to start over for this receiver
+    bool resync = res == RUDP_RECV::DROPPED && m_rcv_fresh;
+    if (res == RUDP_RECV::DELIVER || res == RUDP_RECV::BUFFERED) m_rcv_fresh = false;
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < 64 && i + 1 < window; i++)
+        if (m_recvd[(m_rcv_next + 1 + i) % window].have) bits |= 1ULL << i;
+    ack[0] = RUDP_ACK;
+    ack[1] = resync ? RUDP_ACK_RESYNC : 0;
+    ack[2] = ack[3] = 0;
+    put32(ack + 4, m_rcv_session);
+    put32(ack + 8, m_rcv_next);
+    put64(ack + 12, bits);
+    return res;
+}
+
+bool ReliablePeer::poll(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters) {
+    bool backoff = false;
+    for (uint32_t seq = m_snd_una; seq != m_next_seq; seq++) {
+        sent_slot &slot = m_sent[seq % m_cfg.window];
+        if (slot.acked || now_us - slot.sent_us < m_rto_us) continue;
+        if (slot.retries >= m_cfg.max_retries) {
+            reset_send(counters);
+            return false;
+        }
+        slot.retries++;
+        counters.retransmitted++;
+        transmit(seq, now_us, out);
+        backoff = true;
+    }
+    // exponential backoff until the next RTT sample recomputes the timeout
+    if (backoff) m_rto_us = std::min<uint64_t>(m_rto_us * 2, static_cast<uint64_t>(m_cfg.max_rto_ms) * 1000);
+    return true;
+}
+
+void ReliablePeer::restart_session(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters) {
+    counters.resyncs++;
+    std::deque<std::vector<uint8_t>> resend;
+    for (uint32_t seq = m_snd_una; seq != m_next_seq; seq++) {
+        const sent_slot &slot = m_sent[seq % m_cfg.window];
+        if (!slot.acked) resend.emplace_back(slot.pkt.begin() + RUDP_DATA_HEADER, slot.pkt.end());
+    }
+    for (auto &data : m_queued) resend.push_back(std::move(data));
+    m_queued.swap(resend);
+    m_session = m_session + 1 ? m_session + 1 : 1;
+    m_next_seq = 0;
+    m_snd_una = 0;
+    m_rack_sent_us = 0;
+    fill_window(now_us, out, counters);
+}
+
+void ReliablePeer::reset_send(ReliableCounters &counters) {
+    counters.resets++;
+    m_session = m_session + 1 ? m_session + 1 : 1;
+    m_next_seq = 0;
+    m_snd_una = 0;
+    m_queued.clear();
+    m_rack_sent_us = 0;
+    m_rto_us = static_cast<uint64_t>(m_cfg.initial_rto_ms) * 1000;
+}
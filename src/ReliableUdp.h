@@ -0,0 +1,180 @@
+#ifndef JSTDLIB_RELIABLEUDP_H
+#define JSTDLIB_RELIABLEUDP_H
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/*
+ * Reliable delivery over datagrams, the state a server keeps per peer. No I/O, the server frames what it sends
+ * through send(), passes every datagram from the peer to on_ack() / on_data() and calls poll() every tick. The
+ * packets handed back point into buffers of the peer and stay valid until the next call on it.
+ *  - every datagram carries the sender's session and a sequence number, the receiver answers each one with an ack
+ *    of the next sequence number it expects plus a bitmap of the 64 after it it already has (selective acks)
+ *  - at most window datagrams are unacknowledged, the rest wait in a queue of up to max_queued
+ *  - the retransmission timeout follows the measured RTT (RFC 6298, Karn's rule), and a datagram sent more than
+ *    a quarter RTT before one that was acknowledged is retransmitted right away instead of waiting for it (RACK)
+ *  - the receiver delivers in sequence order, buffering what arrives early, or with ordered off as datagrams
+ *    arrive, each exactly once
+ *  - after max_retries retransmissions of one datagram the peer is given up on, its unacknowledged and queued
+ *    datagrams are dropped and sending starts over under a new session, the receiver starts over when it sees one.
+ *    A session up to RUDP_STALE_SESSIONS behind the current one is a delayed datagram of an earlier session and
+ *    ignored, anything else is a new one (the sender restarted, its sessions are seeded from the clock)
+ *  - a receiver takes a new session from seq 0. Without state for it (it restarted, took the socket over or
+ *    dropped the client) any other datagram gets an ack flagged RESYNC until seq 0 arrives, the sender then sends
+ *    what is unacknowledged again under a new session starting at 0. Delivery is at least once across such a loss
+ *    of state
+ *  - both ends should run the same window, the receiver only buffers window datagrams past the next expected one
+ *  - not synchronized, the owning server guards it with its own mutex
+ * UdpServerBase keeps one per client, see set_reliability(), so a lost datagram only holds back the client it
+ * belongs to, and with ordered delivery off not even that one. Its inject_loss hook drops datagrams of the layer
+ * in either direction to test it locally.
+ *
+ * Wire format, network byte order
+ *  data  [ 0xD7 | 0 | 0 | 0 ][ session 32 ][ seq 32 ] payload
+ *  ack   [ 0xA7 | flags | 0 | 0 ][ session 32 ][ next expected seq 32 ][ received bitmap of next + 1 .. next + 64, 64 ]
+ */
+namespace jstd {
+    namespace net {
+        struct ReliableConfig {
+            bool ordered;               // deliver in sequence order, otherwise as datagrams arrive
+            uint32_t window;            // unacknowledged datagrams per peer, at most RUDP_MAX_WINDOW
+            uint32_t max_queued;        // datagrams per peer waiting for the window before send fails
+            uint32_t initial_rto_ms;    // until the first RTT sample
+            uint32_t min_rto_ms;        // least margin of the timeout over the smoothed RTT
+            uint32_t max_rto_ms;
+            uint32_t max_retries;       // retransmissions of one datagram before the peer is given up on
+            uint32_t tick_ms;           // how often the retransmission timers are checked
+
+            ReliableConfig() : ordered(true), window(128), max_queued(4096), initial_rto_ms(100), min_rto_ms(5),
+                               max_rto_ms(1000), max_retries(20), tick_ms(2) {}
+        };
+
+        constexpr uint32_t RUDP_MAX_WINDOW = 1024;
+        constexpr size_t RUDP_DATA_HEADER = 12;
+        constexpr size_t RUDP_ACK_LEN = 20;
+        constexpr uint8_t RUDP_DATA = 0xD7;
+        constexpr uint8_t RUDP_ACK = 0xA7;
+        constexpr uint8_t RUDP_ACK_RESYNC = 0x01;
+        constexpr uint32_t RUDP_STALE_SESSIONS = 1u << 16;
+
+        // counters of the reliable layer, summed over the peers
+        struct ReliableCounters {
+            uint64_t sent;              // datagrams sent the first time
+            uint64_t retransmitted;
+            uint64_t fast_retransmitted;    // of those, before their timeout because a later datagram was acked
+            uint64_t duplicates;        // received again after they were acked
+            uint64_t resets;            // peers given up on after max_retries
+            uint64_t resyncs;           // sessions restarted for a receiver that lost its state
+            uint64_t injected_losses;   // datagrams the owner's loss injection dropped, both directions
+
+            ReliableCounters() : sent(0), retransmitted(0), fast_retransmitted(0), duplicates(0), resets(0),
+                                 resyncs(0), injected_losses(0) {}
+        };
+
+        enum class RUDP_RECV : uint8_t {
+            DELIVER,        // process the datagram's payload, ordered then what on_data() appended to ready
+            BUFFERED,       // arrived early and is held until the gap before it is filled
+            DUPLICATE,      // already had it, acked again
+            DROPPED,        // beyond the receive window, acked so the sender learns where the receiver is
+            STALE,          // of an earlier session of the peer, no ack
+            REJECTED        // malformed, no ack
+        };
+
+        struct ReliablePacket {
+            const uint8_t *data;
+            size_t len;
+        };
+
+        class ReliablePeer {
+            struct sent_slot {
+                std::vector<uint8_t> pkt;   // header and payload
+                uint64_t sent_us;           // last (re)transmission
+                uint32_t retries;
+                bool acked;
+            };
+
+            struct recv_slot {
+                std::vector<uint8_t> payload;
+                bool have;
+            };
+
+            ReliableConfig m_cfg;
+
+            // send side
+            uint32_t m_session;
+            uint32_t m_next_seq;
+            uint32_t m_snd_una;                 // oldest unacknowledged
+            std::vector<sent_slot> m_sent;      // seq % window
+            std::deque<std::vector<uint8_t>> m_queued;
+            uint64_t m_srtt_us;                 // 0 until the first sample
+            uint64_t m_rttvar_us;
+            uint64_t m_min_rtt_us;
+            uint64_t m_rto_us;
+            uint64_t m_rack_sent_us;            // latest transmission time of an acknowledged datagram
+
+            // receive side
+            uint32_t m_rcv_session;
+            uint32_t m_rcv_next;
+            bool m_rcv_fresh;                   // seq 0 of this session not accepted yet
+            std::vector<recv_slot> m_recvd;     // seq % window, allocated on the first datagram
+
+            // frame data under the next sequence number and send it, the window has room
+            void send_next(const uint8_t *data, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                           ReliableCounters &counters);
+
+            void transmit(uint32_t seq, uint64_t now_us, std::vector<ReliablePacket> &out);
+
+            // move queued datagrams into the window
+            void fill_window(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters);
+
+            void ack_slot(uint32_t seq, uint64_t now_us, uint64_t &newest_sent_us);
+
+            void sample_rtt(uint64_t rtt_us);
+
+            // drop everything unacknowledged and start a new session
+            void reset_send(ReliableCounters &counters);
+
+            // start a new session with what is unacknowledged queued in front of the rest
+            void restart_session(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters);
+
+        public:
+            ReliablePeer(const ReliableConfig &cfg, uint32_t session);
+
+            // frame len bytes of data and send them when the window allows, queue them otherwise, false if
+            // max_queued datagrams are already waiting
+            bool send(const uint8_t *data, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                      ReliableCounters &counters);
+
+            // an ack of the peer, retransmissions it reveals and datagrams the window now has room for go to out
+            void on_ack(const uint8_t *pkt, size_t len, uint64_t now_us, std::vector<ReliablePacket> &out,
+                        ReliableCounters &counters);
+
+            // a data datagram of the peer, the ack to send back is written to ack (RUDP_ACK_LEN bytes) unless
+            // REJECTED. With DELIVER the payloads that were waiting on it are appended to ready in order
+            RUDP_RECV on_data(const uint8_t *pkt, size_t len, uint8_t *ack, std::vector<std::vector<uint8_t>> &ready,
+                              ReliableCounters &counters);
+
+            // retransmit what timed out, false if the peer was given up on
+            bool poll(uint64_t now_us, std::vector<ReliablePacket> &out, ReliableCounters &counters);
+
+            inline uint32_t in_flight() const { return m_next_seq - m_snd_una; }
+
+            inline size_t queued() const { return m_queued.size(); }
+
+            inline uint64_t srtt_us() const { return m_srtt_us; }
+
+            inline uint64_t rto_us() const { return m_rto_us; }
+
+            inline uint32_t session() const { return m_session; }
+
+            // type byte of a datagram, 0 if too short to be either
+            static uint8_t packet_type(const uint8_t *pkt, size_t len);
+
+            // steady clock us, the time base of the calls above
+            static uint64_t now_us();
+        };
+    }
+}
+
+#endif //JSTDLIB_RELIABLEUDP_H
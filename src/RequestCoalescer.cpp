@@ -0,0 +1,57 @@
+#include "RequestCoalescer.h"
+#include <cstring>
+
+using namespace jstd::net;
+
+// MurmurHash64A mixing, 8 bytes per multiply
+uint64_t RequestCoalescer::hash(const uint8_t *data, size_t len, uint64_t seed) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = seed ^ (len * m);
+    const uint8_t *end = data + (len & ~static_cast<size_t>(7));
+    for (const uint8_t *p = data; p != end; p += 8) {
+        uint64_t k;
+        std::memcpy(&k, p, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    size_t tail = len & 7;
+    if (tail) {
+        uint64_t k = 0;
+        std::memcpy(&k, end, tail);
+        h ^= k;
+        h *= m;
+    }
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h ? h : 1;
+}
+
+COALESCE RequestCoalescer::join(const uint8_t *data, size_t len, ConnHandle conn, uint64_t &key) {
+    uint64_t h = hash(data, len);
+    key = 0;
+    auto it = m_flights.find(h);
+    if (it == m_flights.end()) {
+        Flight &f = m_flights[h];
+        f.payload.assign(data, data + len);
+        key = h;
+        return COALESCE::LEADER;
+    }
+    const std::vector<uint8_t> &payload = it->second.payload;
+    if (payload.size() != len || (len && std::memcmp(payload.data(), data, len) != 0))
+        return COALESCE::BYPASS;
+    it->second.waiters.push_back(conn);
+    return COALESCE::JOINED;
+}
+
+bool RequestCoalescer::finish(uint64_t key, Flight &out) {
+    auto it = m_flights.find(key);
+    if (it == m_flights.end()) return false;
+    out = std::move(it->second);
+    m_flights.erase(it);
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef JSTDLIB_REQUESTCOALESCER_H
+#define JSTDLIB_REQUESTCOALESCER_H
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "net_types.h"
+
+/*
+ * Table of requests in flight keyed by a hash of their payload, so byte identical requests arriving while one
+ * is queued or being processed attach to it instead of being processed again.
+ *  - the first request of a payload leads a flight, later identical ones join it as waiters
+ *  - a payload whose hash matches a flight with different bytes bypasses coalescing, it is never attached
+ *  - finish() ends the flight and hands back its waiters, the server fans the leader's response out to them
+ *  - not synchronized, the owning server guards it with its own mutex
+ * TcpServerBase repeats whatever process_item sends to the leader (send_item, send_to, send_file) to every
+ * waiter, UdpServerBase its send_item. Only for requests whose answer does not depend on how often they run
+ * (reads, subscriptions), and a waiter can get its answer ahead of answers to its own earlier requests.
+ */
+namespace jstd {
+    namespace net {
+        enum class COALESCE : uint8_t {
+            LEADER,     // new flight, process the request and finish() it with the returned key
+            JOINED,     // attached to a flight, the request is answered when the flight finishes
+            BYPASS      // hash collision with a different payload, process the request on its own
+        };
+
+        class RequestCoalescer {
+        public:
+            struct Flight {
+                std::vector<uint8_t> payload;
+                std::vector<ConnHandle> waiters;
+            };
+
+        private:
+            std::unordered_map<uint64_t, Flight> m_flights;
+
+        public:
+            // 64 bit hash of data, read a word at a time, never 0 so 0 can stand for "no flight"
+            // hashes under different seeds are independent, two of them make a 128 bit fingerprint
+            static uint64_t hash(const uint8_t *data, size_t len, uint64_t seed = 0x9e3779b97f4a7c15ULL);
+
+            // lead or join the flight of data, key is set for LEADER and 0 otherwise
+            COALESCE join(const uint8_t *data, size_t len, ConnHandle conn, uint64_t &key);
+
+            // end the flight key leads, moves payload and waiters into out, false if there is no such flight
+            bool finish(uint64_t key, Flight &out);
+
+            inline size_t in_flight() const { return m_flights.size(); }
+        };
+    }
+}
+
+#endif //JSTDLIB_REQUESTCOALESCER_H
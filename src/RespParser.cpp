@@ -0,0 +1,153 @@
+#include "RespParser.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace jstd::net;
+
+namespace {
+    // parse the decimal number terminated by CRLF at p, returns the position after CRLF or nullptr
+    // if the line is incomplete, sets bad on a malformed line
+    const char *read_int(const char *p, const char *end, int64_t &val, bool &bad) {
+        const char *eol = static_cast<const char*>(std::memchr(p, '\r', end - p));
+        if (!eol || eol + 1 >= end) {
+            if (end - p > 32) bad = true;
+            return nullptr;
+        }
+        if (eol[1] != '\n' || eol == p) {
+            bad = true;
+            return nullptr;
+        }
+        bool neg = (*p == '-');
+        if (neg && ++p == eol) {
+            bad = true;
+            return nullptr;
+        }
+        int64_t v = 0;
+        for (; p < eol; p++) {
+            if (*p < '0' || *p > '9' || v > (INT64_MAX - (*p - '0')) / 10) {
+                bad = true;
+                return nullptr;
+            }
+            v = v * 10 + (*p - '0');
+        }
+        val = neg ? -v : v;
+        return eol + 2;
+    }
+}
+
+bool RespCommand::arg_is(size_t i, const char *name) const {
+    size_t len = std::strlen(name);
+    if (i >= args.size() || args[i].len != len) return false;
+    const char *a = base + args[i].off;
+    for (size_t n = 0; n < len; n++) {
+        char c = a[n];
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - ('a' - 'A'));
+        if (c != name[n]) return false;
+    }
+    return true;
+}
+
+RespParser::RespParser(): m_error(nullptr) { }
+
+RESP_PARSE RespParser::parse(const char *buf, size_t len, RespCommand &cmd) {
+    cmd.base = buf;
+    cmd.args.clear();
+    const char *end = buf + len;
+    if (len == 0) return RESP_PARSE::INCOMPLETE;
+
+    if (*buf != '*') {
+        // inline command, space separated words on one line
+        const char *eol = static_cast<const char*>(std::memchr(buf, '\n', len));
+        // the same limit whether or not the newline has arrived yet
+        if ((eol ? static_cast<size_t>(eol - buf) : len) > RESP_MAX_INLINE_BYTES) {
+            m_error = "Protocol error: too big inline request";
+            return RESP_PARSE::ERROR;
+        }
+        if (!eol) return RESP_PARSE::INCOMPLETE;
+        const char *line_end = (eol > buf && eol[-1] == '\r') ? eol - 1 : eol;
+        const char *p = buf;
+        while (p < line_end) {
+            while (p < line_end && (*p == ' ' || *p == '\t')) p++;
+            const char *word = p;
+            while (p < line_end && *p != ' ' && *p != '\t') p++;
+            if (p > word)
+                cmd.args.push_back(RespRange{static_cast<uint32_t>(word - buf), static_cast<uint32_t>(p - word)});
+        }
+        cmd.total_len = static_cast<size_t>(eol + 1 - buf);
+        return RESP_PARSE::COMPLETE;
+    }
+
+    bool bad = false;
+    int64_t cnt = 0;
+    const char *p = read_int(buf + 1, end, cnt, bad);
+    if (!p) {
+        m_error = "Protocol error: invalid multibulk length";
+        return bad ? RESP_PARSE::ERROR : RESP_PARSE::INCOMPLETE;
+    }
+    if (cnt < 0 || static_cast<size_t>(cnt) > RESP_MAX_ARGS) {
+        m_error = "Protocol error: invalid multibulk length";
+        return RESP_PARSE::ERROR;
+    }
+    for (int64_t i = 0; i < cnt; i++) {
+        if (p >= end) return RESP_PARSE::INCOMPLETE;
+        if (*p != '$') {
+            m_error = "Protocol error: expected '$'";
+            return RESP_PARSE::ERROR;
+        }
+        int64_t blen = 0;
+        const char *data = read_int(p + 1, end, blen, bad);
+        if (!data) {
+            m_error = "Protocol error: invalid bulk length";
+            return bad ? RESP_PARSE::ERROR : RESP_PARSE::INCOMPLETE;
+        }
+        if (blen < 0 || static_cast<size_t>(blen) > RESP_MAX_BULK_BYTES) {
+            m_error = "Protocol error: invalid bulk length";
+            return RESP_PARSE::ERROR;
+        }
+        if (end - data < blen + 2) return RESP_PARSE::INCOMPLETE;
+        if (data[blen] != '\r' || data[blen + 1] != '\n') {
+            m_error = "Protocol error: bulk string not terminated";
+            return RESP_PARSE::ERROR;
+        }
+        cmd.args.push_back(RespRange{static_cast<uint32_t>(data - buf), static_cast<uint32_t>(blen)});
+        p = data + blen + 2;
+    }
+    cmd.total_len = static_cast<size_t>(p - buf);
+    return RESP_PARSE::COMPLETE;
+}
+
+void jstd::net::resp::ok(std::string &out) {
+    out.append("+OK\r\n", 5);
+}
+
+void jstd::net::resp::simple(std::string &out, const char *msg) {
+    out.append("+").append(msg).append("\r\n");
+}
+
+void jstd::net::resp::error(std::string &out, const char *msg) {
+    out.append("-").append(msg).append("\r\n");
+}
+
+void jstd::net::resp::integer(std::string &out, int64_t val) {
+    char line[32];
+    int n = std::snprintf(line, sizeof(line), ":%lld\r\n", static_cast<long long>(val));
+    out.append(line, static_cast<size_t>(n));
+}
+
+void jstd::net::resp::bulk(std::string &out, const char *data, size_t len) {
+    char line[32];
+    int n = std::snprintf(line, sizeof(line), "$%zu\r\n", len);
+    out.append(line, static_cast<size_t>(n));
+    out.append(data, len);
+    out.append("\r\n", 2);
+}
+
+void jstd::net::resp::null_bulk(std::string &out) {
+    out.append("$-1\r\n", 5);
+}
+
+void jstd::net::resp::array_header(std::string &out, size_t cnt) {
+    char line[32];
+    int n = std::snprintf(line, sizeof(line), "*%zu\r\n", cnt);
+    out.append(line, static_cast<size_t>(n));
+}
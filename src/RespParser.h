@@ -0,0 +1,77 @@
+#ifndef JSTDLIB_RESPPARSER_H
+#define JSTDLIB_RESPPARSER_H
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * Redis serialization protocol (RESP2) request parser and reply encoders.
+ *  - requests are arrays of bulk strings (*N\r\n$len\r\narg\r\n...) or inline commands (PING\r\n)
+ *  - arguments are (offset, length) ranges into the caller's buffer, the argument vector keeps its capacity
+ *    between commands so steady state parsing does not allocate
+ *  - a COMPLETE command reports the bytes it consumed, pipelined commands follow at buf + total_len
+ */
+namespace jstd {
+    namespace net {
+        constexpr size_t RESP_MAX_BULK_BYTES = 16 << 20;
+        constexpr size_t RESP_MAX_ARGS = 1 << 20;
+        constexpr size_t RESP_MAX_INLINE_BYTES = 64 << 10;
+
+        enum class RESP_PARSE { COMPLETE, INCOMPLETE, ERROR };
+
+        struct RespRange {
+            uint32_t off;
+            uint32_t len;
+        };
+
+        struct RespCommand {
+            const char *base;
+            std::vector<RespRange> args;
+            size_t total_len;
+
+            inline const char *ptr(size_t i) const { return base + args[i].off; }
+
+            inline size_t len(size_t i) const { return args[i].len; }
+
+            inline std::string str(size_t i) const { return std::string(base + args[i].off, args[i].len); }
+
+            // case insensitive match of argument i against an upper case word
+            bool arg_is(size_t i, const char *name) const;
+
+            // case insensitive match of the command name (argument 0)
+            inline bool is(const char *name) const { return arg_is(0, name); }
+        };
+
+        class RespParser {
+            const char *m_error;
+
+        public:
+            RespParser();
+
+            RESP_PARSE parse(const char *buf, size_t len, RespCommand &cmd);
+
+            // protocol error description after ERROR
+            inline const char *error() const { return m_error; }
+        };
+
+        // reply encoders, append to out
+        namespace resp {
+            void ok(std::string &out);
+
+            void simple(std::string &out, const char *msg);
+
+            void error(std::string &out, const char *msg);
+
+            void integer(std::string &out, int64_t val);
+
+            void bulk(std::string &out, const char *data, size_t len);
+
+            void null_bulk(std::string &out);
+
+            void array_header(std::string &out, size_t cnt);
+        }
+    }
+}
+
+#endif //JSTDLIB_RESPPARSER_H
@@ -0,0 +1,201 @@
+#include "ResponseCache.h"
+#include "RequestCoalescer.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace jstd::net;
+
+namespace {
+    const uint64_t CHECK_SEED = 0x2545f4914f6cdd1dULL;
+    const unsigned SKETCH_PROBES = 4;
+    const uint64_t SKETCH_MAX = 15;
+
+    inline uint64_t next_pow2(uint64_t v) {
+        uint64_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+}
+
+ResponseCache::ResponseCache(size_t capacity_bytes, unsigned ttl_ms, unsigned shards): m_ttl_ms(ttl_ms) {
+    if (!shards) shards = 1;
+    size_t shard_cap = capacity_bytes / shards;
+    m_window_max = shard_cap / 100;
+    m_main_max = shard_cap - m_window_max;
+    m_protected_max = m_main_max / 10 * 8;
+    // a word of 16 counters per expected entry, as Caffeine sizes its sketch, fewer saturate every counter
+    uint64_t words = std::min<uint64_t>(next_pow2(std::max<size_t>(16, shard_cap / RESPONSE_CACHE_SKETCH_BYTES)),
+                                        1ULL << 22);
+    uint64_t counters = words * 16;
+    for (unsigned i = 0; i < shards; i++) {
+        std::unique_ptr<cache_shard> s(new cache_shard());
+        std::fill(s->bytes, s->bytes + REGION_CNT, 0);
+        s->sketch.assign(counters / 16, 0);
+        s->sketch_mask = counters - 1;
+        s->additions = 0;
+        m_shards.push_back(std::move(s));
+    }
+}
+
+uint64_t ResponseCache::now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void ResponseCache::fingerprint(const uint8_t *data, size_t len, uint64_t &key, uint64_t &check) {
+    key = RequestCoalescer::hash(data, len);
+    check = RequestCoalescer::hash(data, len, CHECK_SEED);
+}
+
+// probes are spread by double hashing a remix of the key, its high bits already picked the shard
+void ResponseCache::sketch_add(cache_shard &s, uint64_t key) {
+    uint64_t h = key * 0x9e3779b97f4a7c15ULL;
+    uint64_t step = (h >> 32) | 1;
+    bool added = false;
+    for (unsigned i = 0; i < SKETCH_PROBES; i++) {
+        uint64_t c = (h + i * step) & s.sketch_mask;
+        uint64_t &word = s.sketch[c >> 4];
+        unsigned shift = static_cast<unsigned>(c & 15) * 4;
+        if (((word >> shift) & SKETCH_MAX) < SKETCH_MAX) {
+            word += 1ULL << shift;
+            added = true;
+        }
+    }
+    if (added && ++s.additions >= 10 * s.sketch.size()) {
+        // halve every counter so popularity that stopped being requested fades
+        for (auto &word : s.sketch) word = (word >> 1) & 0x7777777777777777ULL;
+        s.additions /= 2;
+    }
+}
+
+unsigned ResponseCache::frequency(const cache_shard &s, uint64_t key) const {
+    uint64_t h = key * 0x9e3779b97f4a7c15ULL;
+    uint64_t step = (h >> 32) | 1;
+    uint64_t freq = SKETCH_MAX;
+    for (unsigned i = 0; i < SKETCH_PROBES; i++) {
+        uint64_t c = (h + i * step) & s.sketch_mask;
+        freq = std::min(freq, (s.sketch[c >> 4] >> (static_cast<unsigned>(c & 15) * 4)) & SKETCH_MAX);
+    }
+    return static_cast<unsigned>(freq);
+}
+
+void ResponseCache::move_to(cache_shard &s, entry &e, REGION region) {
+    s.bytes[e.region] -= charge(e);
+    s.bytes[region] += charge(e);
+    s.lru[region].splice(s.lru[region].begin(), s.lru[e.region], e.pos);
+    e.region = region;
+}
+
+void ResponseCache::remove(cache_shard &s, std::unordered_map<uint64_t, entry>::iterator it) {
+    s.bytes[it->second.region] -= charge(it->second);
+    s.lru[it->second.region].erase(it->second.pos);
+    s.map.erase(it);
+}
+
+void ResponseCache::admit(cache_shard &s, uint64_t candidate) {
+    entry &cand = s.map.find(candidate)->second;
+    move_to(s, cand, PROBATION);
+    unsigned cand_freq = frequency(s, candidate);
+    while (s.bytes[PROBATION] + s.bytes[PROTECTED] > m_main_max) {
+        uint64_t victim = s.lru[PROBATION].size() > 1 ? s.lru[PROBATION].back() : 0;
+        if (!victim && !s.lru[PROTECTED].empty()) victim = s.lru[PROTECTED].back();
+        if (!victim || victim == candidate || cand_freq <= frequency(s, victim)) {
+            remove(s, s.map.find(candidate));
+            s.stats.rejections++;
+            return;
+        }
+        remove(s, s.map.find(victim));
+        s.stats.evictions++;
+    }
+}
+
+bool ResponseCache::lookup(uint64_t key, uint64_t check, std::vector<uint8_t> &out) {
+    cache_shard &s = shard_of(key);
+    std::lock_guard<std::mutex> lck(s.mtx);
+    sketch_add(s, key);
+    auto it = s.map.find(key);
+    if (it == s.map.end() || it->second.check != check) {
+        s.stats.misses++;
+        return false;
+    }
+    entry &e = it->second;
+    if (e.expire_at && e.expire_at <= now_ms()) {
+        remove(s, it);
+        s.stats.expirations++;
+        s.stats.misses++;
+        return false;
+    }
+    out.assign(e.response.begin(), e.response.end());
+    s.stats.hits++;
+    switch (e.region) {
+        case WINDOW:
+        case PROTECTED:
+            s.lru[e.region].splice(s.lru[e.region].begin(), s.lru[e.region], e.pos);
+            break;
+        default:
+            // hit again in main, protect it and demote the protected LRU entries it pushes out
+            move_to(s, e, PROTECTED);
+            while (s.bytes[PROTECTED] > m_protected_max && s.lru[PROTECTED].size() > 1)
+                move_to(s, s.map.find(s.lru[PROTECTED].back())->second, PROBATION);
+            break;
+    }
+    return true;
+}
+
+void ResponseCache::insert(uint64_t key, uint64_t check, const uint8_t *data, size_t len) {
+    cache_shard &s = shard_of(key);
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = s.map.find(key);
+    if (it != s.map.end()) remove(s, it);
+    if (len + RESPONSE_CACHE_ENTRY_OVERHEAD > m_window_max + m_main_max) {
+        s.stats.rejections++;
+        return;
+    }
+    entry &e = s.map[key];
+    e.check = check;
+    e.response.assign(data, data + len);
+    e.expire_at = m_ttl_ms ? now_ms() + m_ttl_ms : 0;
+    e.region = WINDOW;
+    s.lru[WINDOW].push_front(key);
+    e.pos = s.lru[WINDOW].begin();
+    s.bytes[WINDOW] += charge(e);
+    s.stats.inserts++;
+    while (s.bytes[WINDOW] > m_window_max && !s.lru[WINDOW].empty())
+        admit(s, s.lru[WINDOW].back());
+}
+
+bool ResponseCache::erase(uint64_t key) {
+    cache_shard &s = shard_of(key);
+    std::lock_guard<std::mutex> lck(s.mtx);
+    auto it = s.map.find(key);
+    if (it == s.map.end()) return false;
+    remove(s, it);
+    return true;
+}
+
+void ResponseCache::clear() {
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        s->map.clear();
+        for (unsigned r = 0; r < REGION_CNT; r++) {
+            s->lru[r].clear();
+            s->bytes[r] = 0;
+        }
+    }
+}
+
+CacheStats ResponseCache::stats() {
+    CacheStats total;
+    for (auto &s : m_shards) {
+        std::lock_guard<std::mutex> lck(s->mtx);
+        total.hits += s->stats.hits;
+        total.misses += s->stats.misses;
+        total.inserts += s->stats.inserts;
+        total.evictions += s->stats.evictions;
+        total.rejections += s->stats.rejections;
+        total.expirations += s->stats.expirations;
+        total.entries += s->map.size();
+        for (unsigned r = 0; r < REGION_CNT; r++) total.bytes += s->bytes[r];
+    }
+    return total;
+}
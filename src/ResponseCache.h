@@ -0,0 +1,119 @@
+#ifndef JSTDLIB_RESPONSECACHE_H
+#define JSTDLIB_RESPONSECACHE_H
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Memory bounded cache of serialized responses keyed by a 128 bit fingerprint of the request bytes, for servers
+ * whose process_item is a pure function of the request (see TcpServerBase::set_response_cache()).
+ *  - keys are spread over independently locked shards, each shard owns its share of the byte budget
+ *  - W-TinyLFU: new entries go to a small LRU window (1% of the budget), an entry falling out of the window is
+ *    admitted to the main area only if it was requested more often than the entry the main area would evict
+ *    for it. Main is a segmented LRU, probation for entries seen once there and protected (80%) for entries hit
+ *    again, so one-off requests pass through the window without flushing the popular ones
+ *  - request frequencies live in a count-min sketch of 4 bit counters, 4 probes per key, 16 counters per
+ *    expected entry, halved every 10 * expected entries requests so old popularity fades
+ *  - entries cost their response size plus RESPONSE_CACHE_ENTRY_OVERHEAD, with a TTL an expired entry is
+ *    never returned and is dropped on the lookup that finds it
+ * A server answers a hit from its recv thread without queueing, logging or processing the request, connections
+ * set with set_cache_bypass() (e.g. one that just wrote) neither look up nor store.
+ */
+namespace jstd {
+    namespace net {
+        constexpr size_t RESPONSE_CACHE_ENTRY_OVERHEAD = 96;   // estimated bytes of map, list node and entry
+        constexpr size_t RESPONSE_CACHE_SKETCH_BYTES = 256;    // assumed bytes per entry when sizing the sketch
+
+        struct CacheStats {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t inserts;
+            uint64_t evictions;     // removed from the main area to make room
+            uint64_t rejections;    // lost admission against the main area's victim, or larger than a shard
+            uint64_t expirations;
+            size_t entries;
+            size_t bytes;
+            CacheStats() : hits(0), misses(0), inserts(0), evictions(0), rejections(0), expirations(0), entries(0),
+                           bytes(0) {}
+
+            inline double hit_ratio() const {
+                return hits + misses ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+            }
+        };
+
+        class ResponseCache {
+            enum REGION : uint8_t { WINDOW, PROBATION, PROTECTED, REGION_CNT };
+
+            struct entry {
+                uint64_t check;
+                std::vector<uint8_t> response;
+                uint64_t expire_at;     // steady clock ms, 0 for no TTL
+                REGION region;
+                std::list<uint64_t>::iterator pos;
+            };
+
+            struct cache_shard {
+                std::mutex mtx;
+                std::unordered_map<uint64_t, entry> map;
+                std::list<uint64_t> lru[REGION_CNT];     // front is the most recently used
+                size_t bytes[REGION_CNT];
+                std::vector<uint64_t> sketch;            // 16 counters per word
+                uint64_t sketch_mask;                    // counter count - 1
+                uint64_t additions;                      // since the last halving, every 10 * entries
+                CacheStats stats;
+            };
+
+            std::vector<std::unique_ptr<cache_shard>> m_shards;
+            size_t m_window_max;
+            size_t m_main_max;
+            size_t m_protected_max;
+            unsigned m_ttl_ms;
+
+            inline cache_shard &shard_of(uint64_t key) { return *m_shards[(key >> 32) % m_shards.size()]; }
+
+            static inline size_t charge(const entry &e) { return e.response.size() + RESPONSE_CACHE_ENTRY_OVERHEAD; }
+
+            void sketch_add(cache_shard &s, uint64_t key);
+
+            unsigned frequency(const cache_shard &s, uint64_t key) const;
+
+            void move_to(cache_shard &s, entry &e, REGION region);
+
+            void remove(cache_shard &s, std::unordered_map<uint64_t, entry>::iterator it);
+
+            // the window LRU entry moves to probation, then main gives up victims or the candidate itself
+            void admit(cache_shard &s, uint64_t candidate);
+
+        public:
+            // capacity_bytes is the total budget, ttl_ms 0 keeps entries until evicted
+            explicit ResponseCache(size_t capacity_bytes, unsigned ttl_ms = 0, unsigned shards = 16);
+
+            ResponseCache(const ResponseCache &) = delete;
+
+            ResponseCache &operator=(const ResponseCache &) = delete;
+
+            // fingerprint of a request, key selects the entry and check has to match for a hit
+            static void fingerprint(const uint8_t *data, size_t len, uint64_t &key, uint64_t &check);
+
+            // copies the response into out on a hit, counts the request towards the key's frequency either way
+            bool lookup(uint64_t key, uint64_t check, std::vector<uint8_t> &out);
+
+            // store the response of a missed request, replaces an entry with the same key
+            void insert(uint64_t key, uint64_t check, const uint8_t *data, size_t len);
+
+            bool erase(uint64_t key);
+
+            void clear();
+
+            CacheStats stats();
+
+            static uint64_t now_ms();
+        };
+    }
+}
+
+#endif //JSTDLIB_RESPONSECACHE_H
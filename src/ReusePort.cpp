@@ -0,0 +1,69 @@
+#include "ReusePort.h"
+#include <cerrno>
+#include <unistd.h>
+#ifdef LINUX_OS
+#include <linux/filter.h>
+#endif
+
+using namespace jstd::net;
+
+int reuseport::bind_socket(const sockaddr_in &addr) {
+#ifdef SO_REUSEPORT
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 ||
+        bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+#else
+    (void)addr;
+    errno = ENOPROTOOPT;
+    return -1;
+#endif
+}
+
+bool reuseport::is_set(int sockfd) {
+#ifdef SO_REUSEPORT
+    int on = 0;
+    socklen_t len = sizeof(on);
+    return getsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &on, &len) == 0 && on;
+#else
+    (void)sockfd;
+    return false;
+#endif
+}
+
+bool reuseport::steer_by_source(int sockfd, unsigned sockets) {
+#if defined(LINUX_OS) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    // the program sees the datagram past its UDP header, the headers are reached through SKF_NET_OFF
+    sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF)),         // A = version / ihl
+        BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xf),
+        BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 2),                                          // A = ip header bytes
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, static_cast<uint32_t>(SKF_NET_OFF)),          // A = source port
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),    // A = source address
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, sockets),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    sock_fprog prog{static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+    return sockets > 0 && setsockopt(sockfd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0;
+#else
+    (void)sockfd;
+    (void)sockets;
+    errno = EOPNOTSUPP;
+    return false;
+#endif
+}
+
+unsigned reuseport::steered_index(const sockaddr_in &from, unsigned sockets) {
+    // BPF loads in host order
+    return sockets ? (ntohl(from.sin_addr.s_addr) ^ ntohs(from.sin_port)) % sockets : 0;
+}
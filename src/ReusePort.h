@@ -0,0 +1,34 @@
+#ifndef JSTDLIB_REUSEPORT_H
+#define JSTDLIB_REUSEPORT_H
+#include <cstdint>
+#include "net_types.h"
+
+/*
+ * SO_REUSEPORT groups of UDP sockets bound to one address, the kernel spreads incoming datagrams over the group
+ * by a hash of the 4-tuple so each socket can be read by its own thread.
+ *  - every socket of a group sets SO_REUSEPORT before bind, a socket bound without it keeps the address to itself
+ *  - steer_by_source() attaches a classic BPF program to the group that picks socket
+ *    (source address ^ source port) % sockets, in bind order, so a client stays on the same socket regardless of
+ *    the kernel's hash seed or sockets joining later (Linux 4.5)
+ * UdpServerBase builds its receive lanes on it, see set_reuseport().
+ */
+namespace jstd {
+    namespace net {
+        namespace reuseport {
+            // new UDP socket with SO_REUSEPORT bound to addr, -1 with errno set on failure
+            int bind_socket(const sockaddr_in &addr);
+
+            // true if sockfd was bound with SO_REUSEPORT
+            bool is_set(int sockfd);
+
+            // steer the group of sockfd by source address and port over its first sockets members, false (errno
+            // set) if the kernel refused the program, the group then keeps hashing
+            bool steer_by_source(int sockfd, unsigned sockets);
+
+            // the socket index steer_by_source() picks for a datagram from addr
+            unsigned steered_index(const sockaddr_in &from, unsigned sockets);
+        }
+    }
+}
+
+#endif //JSTDLIB_REUSEPORT_H
@@ -0,0 +1,44 @@
+#include "TcpInfo.h"
+#include <chrono>
+#include <cstring>
+#ifdef LINUX_OS
+#include <linux/tcp.h>  // struct tcp_info with the fields glibc's netinet/tcp.h lacks
+#endif
+
+using namespace jstd::net;
+
+bool tcp_info::sample(int sockfd, TcpInfoSample &out, uint64_t now_ms) {
+#ifdef LINUX_OS
+    struct tcp_info ti;
+    std::memset(&ti, 0, sizeof(ti));
+    socklen_t len = sizeof(ti);
+    // older kernels copy a shorter struct, the tail stays zeroed
+    if (getsockopt(sockfd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0) return false;
+    out.sampled_ms = now_ms;
+    out.rtt_us = ti.tcpi_rtt;
+    out.rttvar_us = ti.tcpi_rttvar;
+    out.snd_cwnd = ti.tcpi_snd_cwnd;
+    out.snd_mss = ti.tcpi_snd_mss;
+    out.total_retrans = ti.tcpi_total_retrans;
+    out.unacked = ti.tcpi_unacked;
+    out.notsent_bytes = ti.tcpi_notsent_bytes;
+    out.delivery_rate = ti.tcpi_delivery_rate;
+    return true;
+#else
+    (void)sockfd;
+    (void)out;
+    (void)now_ms;
+    errno = EOPNOTSUPP;
+    return false;
+#endif
+}
+
+bool tcp_info::over_limits(const TcpInfoSample &s, const TcpInfoConfig &cfg) {
+    return (cfg.rtt_limit_us && s.rtt_us > cfg.rtt_limit_us) ||
+           (cfg.send_queue_limit && s.send_queue_bytes() > cfg.send_queue_limit);
+}
+
+uint64_t tcp_info::now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
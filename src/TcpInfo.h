@@ -0,0 +1,40 @@
+#ifndef JSTDLIB_TCPINFO_H
+#define JSTDLIB_TCPINFO_H
+#include <cstdint>
+#include "net_types.h"
+
+/*
+ * Kernel view of a TCP connection through getsockopt(TCP_INFO), to tell a slow network from slow processing.
+ *  - one getsockopt per connection and sample, no extra socket state or ioctls, fields the running kernel
+ *    does not fill are left 0
+ *  - a sample is flagged when its RTT or its send queue (unsent plus unacknowledged bytes) is over the limits
+ *    of a TcpInfoConfig, limits of 0 are off
+ * TcpServerBase samples its clients with it every interval_ms, see set_tcp_info_sampling(), on a thread of its
+ * own for threaded policies, a loop timer when attached and from the recv loop of an InlinePolicy server. The
+ * latest sample is kept in the connection record, aggregates in stats(), and a connection crossing a limit is
+ * reported to on_tcp_flagged.
+ */
+namespace jstd {
+    namespace net {
+        struct TcpInfoConfig {
+            unsigned interval_ms;           // 0 disables sampling
+            uint32_t rtt_limit_us;
+            uint64_t send_queue_limit;      // bytes
+
+            TcpInfoConfig() : interval_ms(0), rtt_limit_us(0), send_queue_limit(0) {}
+        };
+
+        namespace tcp_info {
+            // read TCP_INFO of sockfd into out, stamped with now_ms, false (errno set) if the socket has none
+            bool sample(int sockfd, TcpInfoSample &out, uint64_t now_ms);
+
+            // out of the RTT or send queue limit of cfg
+            bool over_limits(const TcpInfoSample &s, const TcpInfoConfig &cfg);
+
+            // steady clock ms, the time base of TcpInfoSample::sampled_ms
+            uint64_t now_ms();
+        }
+    }
+}
+
+#endif //JSTDLIB_TCPINFO_H
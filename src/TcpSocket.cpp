@@ -25,6 +25,19 @@ m_listening(false) {
     m_sockfd = socket(AF_INET, SOCK_STREAM, 0);
 }
 
+TcpSocket::TcpSocket(const IPAddress& ipaddr, int port) :
+m_ipaddr(ipaddr),
+m_port(port),
+m_addr{},
+m_bound(false),
+m_connected(false),
+m_listening(false) {
+    m_addr.sin_addr.s_addr = m_ipaddr();
+    m_addr.sin_family = AF_INET;
+    m_addr.sin_port = htons(port);
+    m_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+}
+
 std::ostream &jstd::net::operator<<(std::ostream &os, const TcpSocket &sock) {
     os << sock.to_string();
     return os;
@@ -26,6 +26,8 @@ namespace jstd {
         public:
             TcpSocket() = delete;
             explicit TcpSocket(std::string ipstr, int port);
+            // already resolved local address, no name lookup
+            TcpSocket(const IPAddress& ipaddr, int port);
             TcpSocket(const TcpSocket&) = delete;
             TcpSocket(TcpSocket&&) = delete;
             TcpSocket& operator = (const TcpSocket& sock) noexcept;
@@ -0,0 +1,128 @@
+#include "TrafficCapture.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace jstd::net;
+
+TrafficCapture::TrafficCapture(size_t buff_sz):
+    m_fd(-1), m_buff_sz(buff_sz ? buff_sz : CAPTURE_BUFF_SIZE), m_start_ns(0), m_flush_pending(false),
+    m_writer_active(false), m_frames(0), m_dropped(0), m_write_errors(0) { }
+
+TrafficCapture::~TrafficCapture() {
+    close();
+}
+
+uint64_t TrafficCapture::monotonic_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool TrafficCapture::open(const std::string &path) {
+    if (m_fd >= 0) return false;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    timespec wall{};
+    clock_gettime(CLOCK_REALTIME, &wall);
+    CaptureFileHeader hdr{CAPTURE_MAGIC, CAPTURE_VERSION, 0,
+                          static_cast<uint64_t>(wall.tv_sec) * 1000000000ULL + static_cast<uint64_t>(wall.tv_nsec)};
+    m_fd = fd;
+    if (!write_all(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr))) {
+        ::close(fd);
+        m_fd = -1;
+        return false;
+    }
+    m_active.clear();
+    m_active.reserve(m_buff_sz);
+    m_flushing.clear();
+    m_flushing.reserve(m_buff_sz);
+    m_flush_pending = false;
+    m_frames = 0;
+    m_dropped = 0;
+    m_write_errors = 0;
+    m_start_ns = monotonic_ns();
+    m_writer_active = true;
+    m_writer = std::thread(&TrafficCapture::writer_loop, this);
+    return true;
+}
+
+void TrafficCapture::close() {
+    if (m_fd < 0) return;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_writer_active = false;
+    }
+    m_cv.notify_one();
+    if (m_writer.joinable()) m_writer.join();
+    // the writer has flushed its buffer, the active one still holds the tail
+    if (!m_active.empty() && !write_all(m_active.data(), m_active.size()))
+        m_write_errors++;
+    m_active.clear();
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+void TrafficCapture::record(CAPTURE_PROTO proto, uint64_t conn_id, const uint8_t *data, size_t len,
+                            CAPTURE_EVENT event) {
+    CaptureRecord rec{monotonic_ns() - m_start_ns, conn_id, static_cast<uint32_t>(len),
+                      static_cast<uint8_t>(proto), static_cast<uint8_t>(event), 0};
+    size_t need = sizeof(rec) + len;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        if (!m_writer_active) return;
+        if (m_active.size() + need > m_buff_sz && !m_active.empty()) {
+            if (m_flush_pending) {      // writer still busy with the other buffer
+                m_dropped++;
+                return;
+            }
+            m_active.swap(m_flushing);
+            m_flush_pending = true;
+            wake = true;
+        }
+        const uint8_t *hdr = reinterpret_cast<const uint8_t*>(&rec);
+        m_active.insert(m_active.end(), hdr, hdr + sizeof(rec));
+        if (len) m_active.insert(m_active.end(), data, data + len);
+    }
+    m_frames++;
+    if (wake) m_cv.notify_one();
+}
+
+void TrafficCapture::writer_loop() {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        bool woken = m_cv.wait_for(lck, std::chrono::milliseconds(CAPTURE_FLUSH_MS),
+                                   [this] { return m_flush_pending || !m_writer_active; });
+        if (!woken && !m_active.empty()) {     // quiet period, write out what trickled in
+            m_active.swap(m_flushing);
+            m_flush_pending = true;
+        }
+        if (m_flush_pending) {
+            lck.unlock();
+            if (!write_all(m_flushing.data(), m_flushing.size()))
+                m_write_errors++;
+            m_flushing.clear();
+            lck.lock();
+            m_flush_pending = false;
+            continue;
+        }
+        if (!m_writer_active) break;
+    }
+}
+
+bool TrafficCapture::write_all(const uint8_t *data, size_t len) {
+    while (len) {
+        ssize_t n = ::write(m_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef JSTDLIB_TRAFFICCAPTURE_H
+#define JSTDLIB_TRAFFICCAPTURE_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Records received frames to a binary file for later replay (testing/trafficReplay).
+ *  - servers call record() from their recv path when a capture is set (set_capture()), the call stamps the
+ *    frame with CLOCK_MONOTONIC ns since open() and appends it to an in memory buffer, a background thread
+ *    writes full buffers out, so the recv thread never waits on the disk
+ *  - two buffers of buff_sz bytes alternate, if the writer falls behind and both are full, frames are
+ *    dropped and counted instead of blocking
+ *  - a partly filled buffer is written after CAPTURE_FLUSH_MS as well, so a killed process loses at most that
+ *
+ * file layout, little endian:
+ *  CaptureFileHeader, then per frame a CaptureRecord followed by len payload bytes
+ */
+namespace jstd {
+    namespace net {
+        constexpr uint32_t CAPTURE_MAGIC = 0x5043544a;     // "JTCP"
+        constexpr uint16_t CAPTURE_VERSION = 1;
+        constexpr size_t CAPTURE_BUFF_SIZE = 4 << 20;
+        constexpr unsigned CAPTURE_FLUSH_MS = 1000;
+
+        enum class CAPTURE_PROTO : uint8_t { TCP = 1, UDP = 2 };
+
+        enum class CAPTURE_EVENT : uint8_t {
+            DATA = 0,
+            CLOSE = 1       // connection closed, no payload
+        };
+
+#pragma pack(push, 1)
+        struct CaptureFileHeader {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t reserved;
+            uint64_t start_realtime_ns;     // wall clock at open(), informational
+        };
+
+        struct CaptureRecord {
+            uint64_t ts_ns;                 // since open()
+            uint64_t conn_id;               // ConnHandle value for TCP, address and port for UDP
+            uint32_t len;
+            uint8_t proto;                  // CAPTURE_PROTO
+            uint8_t event;                  // CAPTURE_EVENT
+            uint16_t reserved;
+        };
+#pragma pack(pop)
+
+        class TrafficCapture {
+            int m_fd;
+            size_t m_buff_sz;
+            uint64_t m_start_ns;
+            std::vector<uint8_t> m_active;      // filled by record()
+            std::vector<uint8_t> m_flushing;    // owned by the writer while m_flush_pending
+            bool m_flush_pending;
+            bool m_writer_active;
+            std::mutex m_mtx;
+            std::condition_variable m_cv;
+            std::thread m_writer;
+            std::atomic<uint64_t> m_frames;
+            std::atomic<uint64_t> m_dropped;
+            std::atomic<uint64_t> m_write_errors;
+
+            void writer_loop();
+
+            bool write_all(const uint8_t *data, size_t len);
+
+        public:
+            explicit TrafficCapture(size_t buff_sz = CAPTURE_BUFF_SIZE);
+
+            TrafficCapture(const TrafficCapture&) = delete;
+            TrafficCapture& operator = (const TrafficCapture&) = delete;
+
+            ~TrafficCapture();
+
+            // create/truncate path, write the header and start the writer thread
+            bool open(const std::string &path);
+
+            // flush what is buffered, stop the writer and close the file
+            void close();
+
+            inline bool is_open() const { return m_fd >= 0; }
+
+            // thread safe, never blocks on file io
+            void record(CAPTURE_PROTO proto, uint64_t conn_id, const uint8_t *data, size_t len,
+                        CAPTURE_EVENT event = CAPTURE_EVENT::DATA);
+
+            inline uint64_t frames() const { return m_frames; }
+
+            inline uint64_t dropped() const { return m_dropped; }
+
+            inline uint64_t write_errors() const { return m_write_errors; }
+
+            static uint64_t monotonic_ns();
+        };
+    }
+}
+
+#endif //JSTDLIB_TRAFFICCAPTURE_H
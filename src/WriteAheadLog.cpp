@@ -0,0 +1,354 @@
+#include "WriteAheadLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace jstd::net;
+
+namespace {
+    const char SEGMENT_PREFIX[] = "wal-";
+    const char SEGMENT_SUFFIX[] = ".log";
+    const char CHECKPOINT_FILE[] = "checkpoint";
+
+    struct crc_table {
+        uint32_t v[256];
+        crc_table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    };
+
+    bool pwrite_all(int fd, const uint8_t *data, size_t len, off_t off) {
+        while (len) {
+            ssize_t n = ::pwrite(fd, data, len, off);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+            off += n;
+        }
+        return true;
+    }
+
+    uint32_t record_crc(const uint8_t *payload, size_t len, uint64_t seq) {
+        uint32_t crc = WriteAheadLog::crc32(0, payload, len);
+        return WriteAheadLog::crc32(crc, reinterpret_cast<const uint8_t*>(&seq), sizeof(seq));
+    }
+}
+
+WriteAheadLog::WriteAheadLog(unsigned batch_window_us, size_t segment_size, size_t max_batch_bytes):
+    m_window_us(batch_window_us), m_segment_size(segment_size ? segment_size : WAL_SEGMENT_SIZE),
+    m_max_batch(max_batch_bytes ? max_batch_bytes : WAL_MAX_BATCH_BYTES), m_fd(-1), m_write_off(0),
+    m_checkpoint_fd(-1), m_last_seq(0), m_committed(0), m_done(0), m_checkpoint(0), m_active(false),
+    m_stopped(true) { }
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+uint32_t WriteAheadLog::crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    static const crc_table table;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+        crc = table.v[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool WriteAheadLog::open(const std::string &dir) {
+    if (m_fd >= 0) return false;
+    if (::mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) return false;
+    m_dir = dir;
+    m_checkpoint_fd = ::open((m_dir + "/" + CHECKPOINT_FILE).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_checkpoint_fd < 0) return false;
+    if (!recover()) {
+        ::close(m_checkpoint_fd);
+        m_checkpoint_fd = -1;
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = -1;
+        m_segments.clear();
+        m_recovered.clear();
+        return false;
+    }
+    m_pending.clear();
+    m_pending.reserve(m_max_batch);
+    m_done_ahead.clear();
+    m_stats = WalStats();
+    m_active = true;
+    m_stopped = false;
+    m_committer = std::thread(&WriteAheadLog::commit_loop, this);
+    return true;
+}
+
+bool WriteAheadLog::recover() {
+    uint64_t cp = 0;
+    if (::pread(m_checkpoint_fd, &cp, sizeof(cp), 0) != static_cast<ssize_t>(sizeof(cp))) cp = 0;
+    m_segments.clear();
+    m_recovered.clear();
+    DIR *d = ::opendir(m_dir.c_str());
+    if (!d) return false;
+    const size_t plen = sizeof(SEGMENT_PREFIX) - 1;
+    const size_t slen = sizeof(SEGMENT_SUFFIX) - 1;
+    while (dirent *ent = ::readdir(d)) {
+        std::string name = ent->d_name;
+        if (name.size() <= plen + slen || name.compare(0, plen, SEGMENT_PREFIX) != 0 ||
+            name.compare(name.size() - slen, slen, SEGMENT_SUFFIX) != 0)
+            continue;
+        m_segments.push_back(segment{std::strtoull(name.c_str() + plen, nullptr, 10), m_dir + "/" + name});
+    }
+    ::closedir(d);
+    std::sort(m_segments.begin(), m_segments.end(),
+              [](const segment &a, const segment &b) { return a.first_seq < b.first_seq; });
+
+    m_last_seq = cp;
+    size_t end_off = 0;
+    for (const auto &seg : m_segments)
+        end_off = scan_segment(seg, cp);
+    m_committed = m_last_seq;
+    m_done = cp;
+    m_checkpoint = cp;
+    if (m_segments.empty()) return open_segment(m_last_seq + 1);
+    m_fd = ::open(m_segments.back().path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (m_fd < 0) return false;
+    // drop the torn tail, the pages of a batch reach the disk in any order, so valid looking records could
+    // sit past the first broken one and would otherwise be picked up behind newer records later
+    m_write_off = end_off;
+    if (::ftruncate(m_fd, static_cast<off_t>(end_off)) < 0) return false;
+    ::fallocate(m_fd, 0, 0, static_cast<off_t>(m_segment_size));
+    return ::fsync(m_fd) == 0;
+}
+
+size_t WriteAheadLog::scan_segment(const segment &seg, uint64_t checkpoint) {
+    int fd = ::open(seg.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    struct stat st{};
+    std::vector<uint8_t> buff;
+    if (::fstat(fd, &st) == 0) buff.resize(static_cast<size_t>(st.st_size));
+    size_t got = 0;
+    while (got < buff.size()) {
+        ssize_t n = ::pread(fd, buff.data() + got, buff.size() - got, static_cast<off_t>(got));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+        got += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    size_t off = 0;
+    uint64_t prev = seg.first_seq - 1;
+    while (off + sizeof(WalRecordHeader) <= got) {
+        WalRecordHeader hdr;
+        std::memcpy(&hdr, buff.data() + off, sizeof(hdr));
+        // preallocated space reads as zeros, anything else that does not check out is a torn write
+        if (hdr.seq <= prev) break;
+        if (hdr.len > got - off - sizeof(hdr)) break;
+        const uint8_t *payload = buff.data() + off + sizeof(hdr);
+        if (record_crc(payload, hdr.len, hdr.seq) != hdr.crc) break;
+        if (hdr.seq > checkpoint)
+            m_recovered.push_back(recovered{hdr.seq, std::vector<uint8_t>(payload, payload + hdr.len)});
+        m_last_seq = std::max(m_last_seq, hdr.seq);
+        prev = hdr.seq;
+        off += sizeof(hdr) + hdr.len;
+    }
+    return off;
+}
+
+bool WriteAheadLog::open_segment(uint64_t first_seq) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%020" PRIu64 "%s", SEGMENT_PREFIX, first_seq, SEGMENT_SUFFIX);
+    std::string path = m_dir + "/" + name;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    // allocated up front so fdatasync does not have to persist a growing file size, best effort
+    ::fallocate(fd, 0, 0, static_cast<off_t>(m_segment_size));
+    ::fsync(fd);
+    int dfd = ::open(m_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        ::fsync(dfd);   // the new directory entry
+        ::close(dfd);
+    }
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = fd;
+    m_write_off = 0;
+    m_segments.push_back(segment{first_seq, path});
+    return true;
+}
+
+bool WriteAheadLog::write_batch(const std::vector<uint8_t> &batch) {
+    size_t pos = 0;
+    while (pos < batch.size()) {
+        // records that still fit the segment, an empty segment takes at least one however big
+        size_t end = pos;
+        size_t room = m_segment_size > m_write_off ? m_segment_size - m_write_off : 0;
+        while (end < batch.size()) {
+            WalRecordHeader hdr;
+            std::memcpy(&hdr, batch.data() + end, sizeof(hdr));
+            size_t rec = sizeof(hdr) + hdr.len;
+            if (end - pos + rec > room && !(end == pos && m_write_off == 0)) break;
+            end += rec;
+        }
+        if (end > pos) {
+            if (!pwrite_all(m_fd, batch.data() + pos, end - pos, static_cast<off_t>(m_write_off))) return false;
+            m_write_off += end - pos;
+            pos = end;
+        }
+        if (pos < batch.size()) {
+            if (::fdatasync(m_fd) < 0) return false;
+            WalRecordHeader next;
+            std::memcpy(&next, batch.data() + pos, sizeof(next));
+            if (!open_segment(next.seq)) return false;
+        }
+    }
+    return ::fdatasync(m_fd) == 0;
+}
+
+void WriteAheadLog::checkpoint() {
+    uint64_t done;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        done = m_done;
+    }
+    if (done == m_checkpoint) return;
+    // not synced, losing it only means replaying processed items again
+    if (!pwrite_all(m_checkpoint_fd, reinterpret_cast<const uint8_t*>(&done), sizeof(done), 0)) return;
+    m_checkpoint = done;
+    // a segment is processed when the next one starts at or below the watermark, the last one is kept
+    size_t drop = 0;
+    while (drop + 1 < m_segments.size() && m_segments[drop + 1].first_seq <= done + 1) {
+        ::unlink(m_segments[drop].path.c_str());
+        drop++;
+    }
+    if (drop) m_segments.erase(m_segments.begin(), m_segments.begin() + static_cast<long>(drop));
+}
+
+void WriteAheadLog::commit_loop() {
+    std::vector<uint8_t> batch;
+    batch.reserve(m_max_batch);
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [this] { return !m_pending.empty() || !m_active; });
+        if (m_pending.empty()) break;       // closed and drained
+        if (m_window_us) {
+            m_cv.wait_until(lck, m_batch_start + std::chrono::microseconds(m_window_us),
+                            [this] { return m_pending.size() >= m_max_batch || !m_active; });
+        }
+        batch.swap(m_pending);
+        m_pending.clear();
+        uint64_t upto = m_last_seq;
+        lck.unlock();
+        bool ok = write_batch(batch);
+        batch.clear();
+        lck.lock();
+        if (!ok) {
+            // nothing after this point can be made durable, refuse further appends
+            m_stats.write_errors++;
+            m_active = false;
+            break;
+        }
+        m_committed = upto;
+        m_stats.syncs++;
+        m_commit_cv.notify_all();
+        lck.unlock();
+        if (m_on_commit) m_on_commit(upto);
+        checkpoint();
+        lck.lock();
+    }
+    m_stopped = true;
+    m_commit_cv.notify_all();
+}
+
+void WriteAheadLog::close() {
+    if (m_fd < 0) return;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_active = false;
+    }
+    m_cv.notify_one();
+    if (m_committer.joinable()) m_committer.join();
+    checkpoint();
+    ::close(m_fd);
+    m_fd = -1;
+    ::close(m_checkpoint_fd);
+    m_checkpoint_fd = -1;
+    m_segments.clear();
+    m_recovered.clear();
+}
+
+uint64_t WriteAheadLog::append(const uint8_t *data, size_t len) {
+    if (len > UINT32_MAX) return 0;
+    WalRecordHeader hdr{static_cast<uint32_t>(len), 0, 0};
+    uint32_t crc = crc32(0, data, len);
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        if (!m_active) return 0;
+        hdr.seq = ++m_last_seq;
+        hdr.crc = crc32(crc, reinterpret_cast<const uint8_t*>(&hdr.seq), sizeof(hdr.seq));
+        wake = m_pending.empty();
+        if (wake) m_batch_start = std::chrono::steady_clock::now();
+        const uint8_t *h = reinterpret_cast<const uint8_t*>(&hdr);
+        m_pending.insert(m_pending.end(), h, h + sizeof(hdr));
+        if (len) m_pending.insert(m_pending.end(), data, data + len);
+        wake = wake || m_pending.size() >= m_max_batch;
+        m_stats.records++;
+        m_stats.bytes += len;
+    }
+    if (wake) m_cv.notify_one();
+    return hdr.seq;
+}
+
+bool WriteAheadLog::wait_committed(uint64_t seq) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_commit_cv.wait(lck, [this, seq] { return m_committed >= seq || m_stopped; });
+    return m_committed >= seq;
+}
+
+uint64_t WriteAheadLog::committed() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_committed;
+}
+
+bool WriteAheadLog::drained() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_done >= m_last_seq;
+}
+
+void WriteAheadLog::complete(uint64_t seq) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (seq <= m_done) return;
+    if (seq != m_done + 1) {
+        m_done_ahead.insert(seq);
+        return;
+    }
+    m_done = seq;
+    while (!m_done_ahead.empty() && *m_done_ahead.begin() == m_done + 1) {
+        m_done_ahead.erase(m_done_ahead.begin());
+        m_done++;
+    }
+}
+
+size_t WriteAheadLog::replay(const replay_handler &handler) {
+    size_t n = m_recovered.size();
+    for (const auto &rec : m_recovered)
+        handler(rec.seq, rec.data.data(), rec.data.size());
+    m_recovered.clear();
+    m_recovered.shrink_to_fit();
+    return n;
+}
+
+WalStats WriteAheadLog::stats() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_stats;
+}
@@ -0,0 +1,160 @@
+#ifndef JSTDLIB_WRITEAHEADLOG_H
+#define JSTDLIB_WRITEAHEADLOG_H
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Durable log of received items with group commit.
+ *  - append() copies a record into the pending batch and returns its sequence number, a commit thread writes
+ *    the whole batch with one pwrite and one fdatasync, so concurrent appends share the sync cost
+ *  - the batch is committed batch_window_us after its first append (the latency budget) or as soon as it
+ *    reaches max_batch_bytes, a window of 0 commits whatever gathered while the previous sync ran
+ *  - records go to segment files preallocated with fallocate, fdatasync then has no size metadata to flush,
+ *    a full segment rolls over to the next, segments are deleted once every record in them is complete()
+ *  - complete(seq) marks a record processed, the contiguous processed watermark is the checkpoint, written
+ *    without sync, a stale checkpoint only replays a few processed items again (at least once)
+ *  - open() recovers: records above the checkpoint with a valid crc are handed to replay(), a torn tail is
+ *    cut off and overwritten by the next batch
+ *
+ * TcpServerBase / UdpServerBase put it between receiving and processing, see set_wal(): received bytes are
+ * appended and their item is held back until the group commit covering it returns, so whatever process_item
+ * sends (the ack) leaves only once the item is durable. Processed items are completed, items recovered on open
+ * are replayed with an invalid ConnHandle. Needs a threaded policy or an attached server.
+ *
+ * record layout: WalRecordHeader, then len payload bytes, crc32 covers seq and payload
+ */
+namespace jstd {
+    namespace net {
+        constexpr size_t WAL_SEGMENT_SIZE = 64 << 20;
+        constexpr size_t WAL_MAX_BATCH_BYTES = 1 << 20;
+
+#pragma pack(push, 1)
+        struct WalRecordHeader {
+            uint32_t len;
+            uint32_t crc;
+            uint64_t seq;
+        };
+#pragma pack(pop)
+
+        struct WalStats {
+            uint64_t records;
+            uint64_t bytes;
+            uint64_t syncs;
+            uint64_t write_errors;
+            WalStats() : records(0), bytes(0), syncs(0), write_errors(0) {}
+        };
+
+        class WriteAheadLog {
+        public:
+            // runs on the commit thread after every sync with the highest durable sequence number
+            typedef std::function<void(uint64_t committed)> commit_handler;
+            typedef std::function<void(uint64_t seq, const uint8_t *data, size_t len)> replay_handler;
+
+        private:
+            struct segment {
+                uint64_t first_seq;
+                std::string path;
+            };
+
+            struct recovered {
+                uint64_t seq;
+                std::vector<uint8_t> data;
+            };
+
+            std::string m_dir;
+            unsigned m_window_us;
+            size_t m_segment_size;
+            size_t m_max_batch;
+
+            // segment files, the last one is written
+            std::vector<segment> m_segments;
+            int m_fd;
+            size_t m_write_off;
+            int m_checkpoint_fd;
+            std::vector<recovered> m_recovered;
+
+            // guarded by m_mtx
+            std::mutex m_mtx;
+            std::condition_variable m_cv;           // commit thread waits for work
+            std::condition_variable m_commit_cv;    // wait_committed() callers
+            std::vector<uint8_t> m_pending;
+            std::chrono::steady_clock::time_point m_batch_start;
+            uint64_t m_last_seq;
+            uint64_t m_committed;
+            uint64_t m_done;                        // every seq <= m_done is complete
+            std::set<uint64_t> m_done_ahead;        // completed out of order above m_done
+            uint64_t m_checkpoint;                  // m_done as last written to the checkpoint file
+            bool m_active;                          // appends accepted
+            bool m_stopped;                         // commit thread gone, nothing more becomes durable
+            WalStats m_stats;
+            commit_handler m_on_commit;
+
+            std::thread m_committer;
+
+            bool recover();
+
+            // scan one segment, returns the offset after its last valid record
+            size_t scan_segment(const segment &seg, uint64_t checkpoint);
+
+            bool open_segment(uint64_t first_seq);
+
+            // write the batch, rolls segments as needed, called by the commit thread only
+            bool write_batch(const std::vector<uint8_t> &batch);
+
+            // write the watermark to the checkpoint file and delete segments it covers
+            void checkpoint();
+
+            void commit_loop();
+
+        public:
+            explicit WriteAheadLog(unsigned batch_window_us = 1000, size_t segment_size = WAL_SEGMENT_SIZE,
+                                   size_t max_batch_bytes = WAL_MAX_BATCH_BYTES);
+
+            WriteAheadLog(const WriteAheadLog&) = delete;
+            WriteAheadLog& operator = (const WriteAheadLog&) = delete;
+
+            ~WriteAheadLog();
+
+            // create or recover the log in dir (created if missing) and start the commit thread
+            bool open(const std::string &dir);
+
+            // commit what is pending, stop the commit thread and close the files
+            void close();
+
+            inline bool is_open() const { return m_fd >= 0; }
+
+            // set before open() or while nothing is appended
+            inline void set_commit_handler(commit_handler handler) { m_on_commit = std::move(handler); }
+
+            // sequence number of the record, 0 if the log is not open
+            uint64_t append(const uint8_t *data, size_t len);
+
+            // block until seq is durable, false if the log was closed first
+            bool wait_committed(uint64_t seq);
+
+            uint64_t committed();
+
+            // the item seq was built from has been processed
+            void complete(uint64_t seq);
+
+            // every record appended or recovered so far is complete()
+            bool drained();
+
+            // hand the records recovered by open() to handler in order and forget them, returns the count
+            size_t replay(const replay_handler &handler);
+
+            WalStats stats();
+
+            static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len);
+        };
+    }
+}
+
+#endif //JSTDLIB_WRITEAHEADLOG_H
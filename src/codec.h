@@ -0,0 +1,490 @@
+#ifndef JSTDLIB_CODEC_H
+#define JSTDLIB_CODEC_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "net_types.h"
+
+/*
+ * Compact binary encoding of application structs, for QItem payloads (see CodecItem).
+ *  - a struct lists its encoded members in order with JSTD_CODEC_FIELDS(a, b, c), nothing else is declared,
+ *    members are encoded back to back without tags, both ends have to agree on the field list
+ *  - unsigned integers are LEB128 varints, signed integers zigzag varints (small magnitudes stay small either
+ *    way), enums follow their underlying type, bool is a byte, float/double are fixed little endian
+ *  - BytesView and std::string are a varint length followed by the bytes, std::vector<T> a varint count then
+ *    the elements, members that declare JSTD_CODEC_FIELDS themselves are nested inline
+ *  - Optional<T> members cost nothing when absent, a struct with optional members starts with a varint of
+ *    presence bits, one per optional member in field order (at most CODEC_MAX_OPTIONALS)
+ *  - encode() writes into a caller provided buffer and fails instead of growing it, encoded_size() tells how
+ *    much a value needs
+ *  - decode() validates every length against the input and never allocates for BytesView members, they point
+ *    into the decoded buffer and are only valid while it is. std::string and std::vector members copy
+ *
+ *  struct Order {
+ *      uint64_t id;
+ *      int32_t qty;
+ *      BytesView symbol;
+ *      Optional<double> limit;
+ *      JSTD_CODEC_FIELDS(id, qty, symbol, limit)
+ *  };
+ */
+namespace jstd {
+	namespace net {
+		constexpr size_t CODEC_MAX_VARINT = 10;
+		constexpr size_t CODEC_MAX_OPTIONALS = 64;
+
+		// bytes owned by someone else, a decoded BytesView points into the decoded buffer
+		struct BytesView {
+			const uint8_t *data;
+			size_t len;
+
+			BytesView() : data(nullptr), len(0) {}
+
+			BytesView(const void *d, size_t l) : data(static_cast<const uint8_t*>(d)), len(l) {}
+
+			BytesView(const char *s) : data(reinterpret_cast<const uint8_t*>(s)), len(std::strlen(s)) {}
+
+			BytesView(const std::string &s) : data(reinterpret_cast<const uint8_t*>(s.data())), len(s.size()) {}
+
+			inline const char *chars() const { return reinterpret_cast<const char*>(data); }
+
+			inline std::string str() const { return std::string(chars(), len); }
+
+			inline bool operator == (const BytesView &v) const {
+				return len == v.len && (!len || std::memcmp(data, v.data, len) == 0);
+			}
+
+			inline bool operator != (const BytesView &v) const { return !(*this == v); }
+		};
+
+		// member that may be absent, absent ones take no bytes on the wire
+		template<typename T>
+		struct Optional {
+			bool has;
+			T value;
+
+			Optional() : has(false), value() {}
+
+			Optional(const T &v) : has(true), value(v) {}
+
+			inline Optional &operator = (const T &v) {
+				has = true;
+				value = v;
+				return *this;
+			}
+
+			inline void reset() {
+				has = false;
+				value = T();
+			}
+
+			inline explicit operator bool() const { return has; }
+		};
+
+// lists the members a struct encodes, in wire order
+#define JSTD_CODEC_FIELDS(...) \
+	inline auto codec_fields() { return std::tie(__VA_ARGS__); } \
+	inline auto codec_fields() const { return std::tie(__VA_ARGS__); }
+
+		namespace codec {
+			inline size_t varint_size(uint64_t v) {
+				size_t n = 1;
+				while (v >= 0x80) {
+					v >>= 7;
+					n++;
+				}
+				return n;
+			}
+
+			inline uint64_t zigzag(int64_t v) {
+				return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+			}
+
+			inline int64_t unzigzag(uint64_t v) {
+				return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+			}
+
+			// bounded output, a write that does not fit fails the writer and every write after it
+			class Writer {
+				uint8_t *m_p;
+				uint8_t *m_end;
+				bool m_ok;
+
+			public:
+				Writer(uint8_t *buf, size_t cap) : m_p(buf), m_end(buf + cap), m_ok(true) {}
+
+				inline bool ok() const { return m_ok; }
+
+				inline uint8_t *pos() const { return m_p; }
+
+				inline void put_varint(uint64_t v) {
+					if (static_cast<size_t>(m_end - m_p) < CODEC_MAX_VARINT && static_cast<size_t>(m_end - m_p) < varint_size(v)) {
+						m_ok = false;
+						m_p = m_end;
+						return;
+					}
+					while (v >= 0x80) {
+						*m_p++ = static_cast<uint8_t>(v | 0x80);
+						v >>= 7;
+					}
+					*m_p++ = static_cast<uint8_t>(v);
+				}
+
+				inline void put_raw(const void *data, size_t len) {
+					if (static_cast<size_t>(m_end - m_p) < len) {
+						m_ok = false;
+						m_p = m_end;
+						return;
+					}
+					if (len) std::memcpy(m_p, data, len);
+					m_p += len;
+				}
+			};
+
+			// bounded input, a read past the end or a malformed varint fails the reader and every read after it
+			class Reader {
+				const uint8_t *m_p;
+				const uint8_t *m_end;
+				bool m_ok;
+
+			public:
+				Reader(const uint8_t *buf, size_t len) : m_p(buf), m_end(buf + len), m_ok(true) {}
+
+				inline bool ok() const { return m_ok; }
+
+				inline const uint8_t *pos() const { return m_p; }
+
+				inline size_t remaining() const { return static_cast<size_t>(m_end - m_p); }
+
+				inline void fail() {
+					m_ok = false;
+					m_p = m_end;
+				}
+
+				inline uint64_t get_varint() {
+					if (m_p < m_end && *m_p < 0x80) return *m_p++;
+					uint64_t v = 0;
+					for (unsigned shift = 0; shift < 64 && m_p < m_end; shift += 7) {
+						uint8_t b = *m_p++;
+						v |= static_cast<uint64_t>(b & 0x7f) << shift;
+						if (!(b & 0x80)) return v;
+					}
+					fail();
+					return 0;
+				}
+
+				// len bytes in place, nullptr when fewer are left
+				inline const uint8_t *get_raw(size_t len) {
+					if (remaining() < len) {
+						fail();
+						return nullptr;
+					}
+					const uint8_t *p = m_p;
+					m_p += len;
+					return p;
+				}
+			};
+
+			template<typename T, typename = void>
+			struct has_fields : std::false_type {};
+
+			template<typename T>
+			struct has_fields<T, decltype(std::declval<T&>().codec_fields(), void())> : std::true_type {};
+
+			template<typename T>
+			struct is_optional : std::false_type {};
+
+			template<typename T>
+			struct is_optional<Optional<T>> : std::true_type {};
+
+			// wire format of one member type
+			template<typename T, typename = void>
+			struct field {
+				static_assert(sizeof(T) == 0, "type has no codec, declare JSTD_CODEC_FIELDS on it");
+			};
+
+			template<typename T>
+			struct field<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value &&
+			                                        !std::is_same<T, bool>::value>::type> {
+				static inline size_t size(T v) { return varint_size(v); }
+
+				static inline void write(Writer &w, T v) { w.put_varint(v); }
+
+				static inline void read(Reader &r, T &v) {
+					uint64_t u = r.get_varint();
+					if (u > std::numeric_limits<T>::max()) r.fail();
+					v = static_cast<T>(u);
+				}
+			};
+
+			template<typename T>
+			struct field<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+				static inline size_t size(T v) { return varint_size(zigzag(v)); }
+
+				static inline void write(Writer &w, T v) { w.put_varint(zigzag(v)); }
+
+				static inline void read(Reader &r, T &v) {
+					int64_t s = unzigzag(r.get_varint());
+					if (s < std::numeric_limits<T>::min() || s > std::numeric_limits<T>::max()) r.fail();
+					v = static_cast<T>(s);
+				}
+			};
+
+			template<>
+			struct field<bool> {
+				static inline size_t size(bool) { return 1; }
+
+				static inline void write(Writer &w, bool v) {
+					uint8_t b = v ? 1 : 0;
+					w.put_raw(&b, 1);
+				}
+
+				static inline void read(Reader &r, bool &v) {
+					const uint8_t *p = r.get_raw(1);
+					if (p && *p > 1) r.fail();
+					v = p && *p;
+				}
+			};
+
+			template<typename T>
+			struct field<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+				typedef typename std::underlying_type<T>::type base;
+
+				static inline size_t size(T v) { return field<base>::size(static_cast<base>(v)); }
+
+				static inline void write(Writer &w, T v) { field<base>::write(w, static_cast<base>(v)); }
+
+				static inline void read(Reader &r, T &v) {
+					base b = 0;
+					field<base>::read(r, b);
+					v = static_cast<T>(b);
+				}
+			};
+
+			static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "floats are copied as little endian");
+
+			template<typename T>
+			struct field<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+				static inline size_t size(T) { return sizeof(T); }
+
+				static inline void write(Writer &w, T v) { w.put_raw(&v, sizeof(T)); }
+
+				static inline void read(Reader &r, T &v) {
+					const uint8_t *p = r.get_raw(sizeof(T));
+					if (p) std::memcpy(&v, p, sizeof(T));
+				}
+			};
+
+			template<>
+			struct field<BytesView> {
+				static inline size_t size(const BytesView &v) { return varint_size(v.len) + v.len; }
+
+				static inline void write(Writer &w, const BytesView &v) {
+					w.put_varint(v.len);
+					w.put_raw(v.data, v.len);
+				}
+
+				static inline void read(Reader &r, BytesView &v) {
+					uint64_t len = r.get_varint();
+					if (len > r.remaining()) {
+						r.fail();
+						return;
+					}
+					v.data = r.get_raw(static_cast<size_t>(len));
+					v.len = static_cast<size_t>(len);
+				}
+			};
+
+			template<>
+			struct field<std::string> {
+				static inline size_t size(const std::string &v) { return varint_size(v.size()) + v.size(); }
+
+				static inline void write(Writer &w, const std::string &v) {
+					w.put_varint(v.size());
+					w.put_raw(v.data(), v.size());
+				}
+
+				static inline void read(Reader &r, std::string &v) {
+					BytesView view;
+					field<BytesView>::read(r, view);
+					if (r.ok()) v.assign(view.chars(), view.len);
+				}
+			};
+
+			template<typename T>
+			struct field<std::vector<T>> {
+				static inline size_t size(const std::vector<T> &v) {
+					size_t n = varint_size(v.size());
+					for (const auto &e : v) n += field<T>::size(e);
+					return n;
+				}
+
+				static inline void write(Writer &w, const std::vector<T> &v) {
+					w.put_varint(v.size());
+					for (const auto &e : v) field<T>::write(w, e);
+				}
+
+				static inline void read(Reader &r, std::vector<T> &v) {
+					uint64_t cnt = r.get_varint();
+					// every element takes at least a byte, a count beyond the input is malformed, not a huge resize
+					if (cnt > r.remaining()) {
+						r.fail();
+						return;
+					}
+					v.resize(static_cast<size_t>(cnt));
+					for (auto &e : v) {
+						field<T>::read(r, e);
+						if (!r.ok()) return;
+					}
+				}
+			};
+
+			// presence bits of the Optional members of a struct, in field order
+			template<typename T>
+			inline void presence(const T &, uint64_t &, unsigned &) {}
+
+			template<typename T>
+			inline void presence(const Optional<T> &v, uint64_t &mask, unsigned &bit) {
+				if (v.has) mask |= 1ULL << bit;
+				bit++;
+			}
+
+			template<typename T>
+			inline size_t member_size(const T &v) { return field<T>::size(v); }
+
+			template<typename T>
+			inline size_t member_size(const Optional<T> &v) { return v.has ? field<T>::size(v.value) : 0; }
+
+			template<typename T>
+			inline void write_member(Writer &w, const T &v) { field<T>::write(w, v); }
+
+			template<typename T>
+			inline void write_member(Writer &w, const Optional<T> &v) {
+				if (v.has) field<T>::write(w, v.value);
+			}
+
+			template<typename T>
+			inline void read_member(Reader &r, T &v, uint64_t, unsigned &) { field<T>::read(r, v); }
+
+			template<typename T>
+			inline void read_member(Reader &r, Optional<T> &v, uint64_t mask, unsigned &bit) {
+				v.has = (mask >> bit++) & 1;
+				if (v.has) field<T>::read(r, v.value);
+				else v.value = T();
+			}
+
+			template<typename Tuple, size_t... I>
+			inline constexpr size_t count_optionals(std::index_sequence<I...>) {
+				size_t n = 0;
+				bool opt[] = {false, is_optional<typename std::decay<typename std::tuple_element<I, Tuple>::type>::type>::value...};
+				for (bool o : opt) n += o;
+				return n;
+			}
+
+			// a struct declaring JSTD_CODEC_FIELDS, [presence varint] then its members in order
+			template<typename T>
+			struct field<T, typename std::enable_if<has_fields<T>::value>::type> {
+				typedef decltype(std::declval<const T&>().codec_fields()) tuple_type;
+				static constexpr size_t members = std::tuple_size<tuple_type>::value;
+				static constexpr size_t optionals = count_optionals<tuple_type>(std::make_index_sequence<members>());
+				static_assert(optionals <= CODEC_MAX_OPTIONALS, "presence bits of a struct fit a uint64");
+
+				template<size_t... I>
+				static inline uint64_t mask(const tuple_type &t, std::index_sequence<I...>) {
+					uint64_t m = 0;
+					unsigned bit = 0;
+					int unused[] = {0, (presence(std::get<I>(t), m, bit), 0)...};
+					(void)unused;
+					return m;
+				}
+
+				template<size_t... I>
+				static inline size_t size(const tuple_type &t, std::index_sequence<I...>) {
+					size_t n = optionals ? varint_size(mask(t, std::index_sequence<I...>())) : 0;
+					size_t sizes[] = {0, member_size(std::get<I>(t))...};
+					for (size_t s : sizes) n += s;
+					return n;
+				}
+
+				template<size_t... I>
+				static inline void write(Writer &w, const tuple_type &t, std::index_sequence<I...>) {
+					if (optionals) w.put_varint(mask(t, std::index_sequence<I...>()));
+					int unused[] = {0, (write_member(w, std::get<I>(t)), 0)...};
+					(void)unused;
+				}
+
+				template<typename Tuple, size_t... I>
+				static inline void read(Reader &r, Tuple &&t, std::index_sequence<I...>) {
+					uint64_t m = optionals ? r.get_varint() : 0;
+					unsigned bit = 0;
+					int unused[] = {0, (r.ok() ? read_member(r, std::get<I>(t), m, bit) : void(), 0)...};
+					(void)unused;
+				}
+
+				static inline size_t size(const T &v) { return size(v.codec_fields(), std::make_index_sequence<members>()); }
+
+				static inline void write(Writer &w, const T &v) {
+					write(w, v.codec_fields(), std::make_index_sequence<members>());
+				}
+
+				static inline void read(Reader &r, T &v) { read(r, v.codec_fields(), std::make_index_sequence<members>()); }
+			};
+
+			template<typename T>
+			constexpr size_t field<T, typename std::enable_if<has_fields<T>::value>::type>::optionals;
+
+			// bytes encode() needs for v
+			template<typename T>
+			inline size_t encoded_size(const T &v) { return field<T>::size(v); }
+
+			// encode v into buf, the bytes written or 0 when it does not fit cap
+			template<typename T>
+			inline size_t encode(const T &v, uint8_t *buf, size_t cap) {
+				Writer w(buf, cap);
+				field<T>::write(w, v);
+				return w.ok() ? static_cast<size_t>(w.pos() - buf) : 0;
+			}
+
+			// append v to out, sized exactly with encoded_size()
+			template<typename T>
+			inline void encode(const T &v, std::vector<uint8_t> &out) {
+				size_t at = out.size();
+				out.resize(at + encoded_size(v));
+				encode(v, out.data() + at, out.size() - at);
+			}
+
+			// decode v from the front of buf, consumed (if given) gets the bytes it took
+			// false on truncated or malformed input, v is then partly overwritten
+			template<typename T>
+			inline bool decode(const uint8_t *buf, size_t len, T &v, size_t *consumed = nullptr) {
+				Reader r(buf, len);
+				field<T>::read(r, v);
+				if (consumed) *consumed = r.ok() ? static_cast<size_t>(r.pos() - buf) : 0;
+				return r.ok();
+			}
+		}
+
+		// NetItem carrying a codec encoded T, serialize() encodes msg, parse() decodes buff into it
+		// BytesView members of msg point into buff, a copied item has to parse() again
+		template<typename T>
+		struct CodecItem : public NetItem {
+			T msg;
+
+			std::vector<uint8_t> serialize() const override {
+				std::vector<uint8_t> out;
+				codec::encode(msg, out);
+				return out;
+			}
+
+			inline bool parse() { return codec::decode(buff.data(), buff.size(), msg); }
+		};
+	}
+}
+
+#endif //JSTDLIB_CODEC_H
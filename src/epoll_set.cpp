@@ -0,0 +1,46 @@
+#include "epoll_set.h"
+#ifdef LINUX_OS
+#include <cerrno>
+#include <unistd.h>
+
+
+epoll_set::epoll_set(int max_events): epfd(epoll_create1(EPOLL_CLOEXEC)), events(max_events > 0 ? max_events:1), nready(0) {}
+
+epoll_set::~epoll_set() {
+    if (epfd >= 0) close(epfd);
+}
+
+bool epoll_set::add_fd(int fd, uint32_t ev) {
+    epoll_event e{};
+    e.events = ev;
+    e.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &e) == 0) return true;
+    return (errno == EEXIST) && modify_fd(fd, ev);
+}
+
+bool epoll_set::modify_fd(int fd, uint32_t ev) {
+    epoll_event e{};
+    e.events = ev;
+    e.data.fd = fd;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &e) == 0;
+}
+
+void epoll_set::clear_fd(int fd) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int epoll_set::wait(int timeout_ms) {
+    int rc = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), timeout_ms);
+    nready = (rc > 0) ? rc : 0;
+    return rc;
+}
+
+std::vector<int> epoll_set::get_active_fds() const {
+    std::vector<int> fds;
+    fds.reserve(nready);
+    for (int i = 0; i < nready; i++)
+        fds.push_back(events[i].data.fd);
+    return fds;
+}
+
+#endif // LINUX_OS
@@ -0,0 +1,54 @@
+#ifndef JSTDLIB_EPOLL_SET_H
+#define JSTDLIB_EPOLL_SET_H
+#include <cstdint>
+#include <vector>
+#ifdef LINUX_OS
+#include <sys/epoll.h>
+#endif
+
+/*
+ * epoll counterpart of fd_sets, readiness cost is O(active fds) instead of O(max fd)
+ * level triggered, one instance is owned and waited on by a single thread
+ */
+#ifdef LINUX_OS
+class epoll_set {
+    private:
+        int epfd;
+        std::vector<epoll_event> events;
+        int nready;
+
+    public:
+        explicit epoll_set(int max_events=256);
+
+        ~epoll_set();
+
+        epoll_set(const epoll_set&) = delete;
+        epoll_set& operator = (const epoll_set&) = delete;
+
+        inline bool is_valid() const { return epfd >= 0; }
+
+        // register fd for the requested events, EPOLLIN by default
+        bool add_fd(int fd, uint32_t ev=EPOLLIN);
+
+        // change the event mask of an already registered fd
+        bool modify_fd(int fd, uint32_t ev);
+
+        // remove descriptor from the interest list
+        void clear_fd(int fd);
+
+        // wrapper around epoll_wait(), timeout of -1 blocks indefinitely
+        int wait(int timeout_ms);
+
+        // ready descriptors from the last wait()
+        inline int ready_count() const { return nready; }
+
+        inline int ready_fd(int idx) const { return events[idx].data.fd; }
+
+        inline uint32_t ready_events(int idx) const { return events[idx].events; }
+
+        // return vector containing active fds from the last wait()
+        std::vector<int> get_active_fds() const;
+};
+#endif
+
+#endif //JSTDLIB_EPOLL_SET_H
@@ -0,0 +1,208 @@
+#ifndef JSTDLIB_HTTP_SERVER_H
+#define JSTDLIB_HTTP_SERVER_H
+#include <functional>
+#include <string>
+#include <vector>
+#include "tcp_server.h"
+#include "HttpParser.h"
+#include "HttpResponse.h"
+
+/*
+ * Description:
+ *  HTTP/1.1 front end on TcpServerBase, requests are parsed and answered from the on_recv() hook
+ *  - each connection keeps one receive buffer, the parser works on it in place and every complete request
+ *    in it is answered in order (pipelining), responses of one read are written with a single send
+ *  - connections are kept alive unless the client (Connection: close, HTTP/1.0) or handler asks otherwise
+ *  - set_static_root() serves GET/HEAD requests for files below a directory through send_file() (sendfile),
+ *    anything else goes to the handler set with set_handler(), 404 without one
+ *  - handlers run on the thread reading the socket, so InlinePolicy or attach() to an EventLoop is the
+ *    natural fit, the processing threads of the other policies are left idle
+ */
+#define HSVR LOG_MODULE::HTTPSERVER
+
+namespace jstd {
+	namespace net {
+		template<typename ThreadPolicy = InlinePolicy>
+		class HttpServer : public TcpServerBase<HttpServer<ThreadPolicy>, NetItem, ThreadPolicy> {
+			typedef TcpServerBase<HttpServer<ThreadPolicy>, NetItem, ThreadPolicy> Base;
+			friend Base;
+
+		public:
+			typedef std::function<void(const HttpRequest &req, HttpResponse &resp)> handler_type;
+
+			struct HttpStats {
+				uint64_t requests;
+				uint64_t bad_requests;
+				uint64_t files_sent;
+				HttpStats() : requests(0), bad_requests(0), files_sent(0) {}
+			};
+
+		private:
+			// per connection parse state, indexed by ConnHandle::index(), only touched by the reading thread
+			struct http_conn {
+				ConnHandle handle;
+				std::vector<char> buff;
+				HttpParser parser;
+			};
+			std::vector<http_conn> m_conns;
+			handler_type m_handler;
+			std::string m_static_root;
+			HttpStats m_http_stats;
+
+			http_conn &conn_state(ConnHandle handle);
+
+			void handle_request(const HttpRequest &req, HttpResponse &resp);
+
+			bool serve_static(const HttpRequest &req, HttpResponse &resp) const;
+
+			// answer with status and drop the connection
+			void reject(ConnHandle handle, std::string &out, int status);
+
+		public:
+			HttpServer(const std::string &ip, const in_port_t &port) : Base(ip, port) {}
+
+			// serve on a listener handed over by the previous process, see TcpServerBase::hand_off()
+			explicit HttpServer(int listen_fd) : Base(listen_fd) {}
+
+			inline void set_handler(handler_type handler) { m_handler = std::move(handler); }
+
+			// directory GET/HEAD requests are resolved against, empty disables static files
+			inline void set_static_root(const std::string &root) { m_static_root = root; }
+
+			inline const HttpStats &http_stats() const { return m_http_stats; }
+
+			// TcpServerBase hook, parse and answer everything complete in the connection buffer
+			void on_recv(const uint8_t *buff, size_t len, ConnHandle conn);
+
+			// TcpServerBase hooks, a partly received request travels to the successor with its connection
+			void on_hand_off(ConnHandle conn, std::vector<uint8_t> &state);
+
+			void on_take_over(ConnHandle conn, const std::vector<uint8_t> &state);
+		};
+	}  // namespace net
+}  // namespace jstd
+
+
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+template<typename ThreadPolicy>
+typename jstd::net::HttpServer<ThreadPolicy>::http_conn &
+jstd::net::HttpServer<ThreadPolicy>::conn_state(ConnHandle handle) {
+	if (handle.index() >= m_conns.size())
+		m_conns.resize(handle.index() + 1);
+	http_conn &c = m_conns[handle.index()];
+	if (c.handle != handle) {   // slot reused by a new connection, keep the buffer capacity
+		c.handle = handle;
+		c.buff.clear();
+		c.parser.reset();
+	}
+	return c;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::HttpServer<ThreadPolicy>::on_hand_off(ConnHandle conn, std::vector<uint8_t> &state) {
+	if (conn.index() < m_conns.size() && m_conns[conn.index()].handle == conn)
+		state.assign(m_conns[conn.index()].buff.begin(), m_conns[conn.index()].buff.end());
+}
+
+// the parser restarts on the whole buffer, it only ever holds the unparsed tail
+template<typename ThreadPolicy>
+void jstd::net::HttpServer<ThreadPolicy>::on_take_over(ConnHandle conn, const std::vector<uint8_t> &state) {
+	conn_state(conn).buff.assign(state.begin(), state.end());
+}
+
+template<typename ThreadPolicy>
+void jstd::net::HttpServer<ThreadPolicy>::on_recv(const uint8_t *buff, size_t len, ConnHandle conn) {
+	http_conn &c = conn_state(conn);
+	c.buff.insert(c.buff.end(), buff, buff + len);
+	std::string out;
+	size_t pos = 0;
+	while (pos < c.buff.size()) {
+		HttpRequest req;
+		HTTP_PARSE rc = c.parser.parse(c.buff.data() + pos, c.buff.size() - pos, req);
+		if (rc == HTTP_PARSE::INCOMPLETE)
+			break;
+		if (rc == HTTP_PARSE::ERROR) {
+			LOG_WARNING(HSVR, "malformed request from ", this->peer_address(conn), " answering ", c.parser.error_status());
+			reject(conn, out, c.parser.error_status());
+			return;
+		}
+		m_http_stats.requests++;
+		HttpResponse resp;
+		handle_request(req, resp);
+		bool keep_alive = req.keep_alive && !resp.wants_close();
+		resp.serialize(out, keep_alive);
+		pos += req.total_len;
+		if (resp.has_file() && !req.equals(req.method, "HEAD")) {
+			// headers of everything before this response have to go out first
+			if (!this->send_to(conn, reinterpret_cast<const uint8_t*>(out.data()), out.size()))
+				return;
+			out.clear();
+			if (this->send_file(conn, resp.file_fd(), 0, resp.file_size()))
+				m_http_stats.files_sent++;
+		}
+		if (!keep_alive) {
+			if (!out.empty()) this->send_to(conn, reinterpret_cast<const uint8_t*>(out.data()), out.size());
+			c.buff.clear();
+			c.parser.reset();
+			this->close_client(conn);
+			return;
+		}
+	}
+	if (!out.empty())
+		this->send_to(conn, reinterpret_cast<const uint8_t*>(out.data()), out.size());
+	// keep only the unparsed tail, normally nothing or the start of the next pipelined request
+	if (pos == c.buff.size())
+		c.buff.clear();
+	else if (pos > 0)
+		c.buff.erase(c.buff.begin(), c.buff.begin() + static_cast<std::ptrdiff_t>(pos));
+}
+
+template<typename ThreadPolicy>
+void jstd::net::HttpServer<ThreadPolicy>::handle_request(const HttpRequest &req, HttpResponse &resp) {
+	bool head = req.equals(req.method, "HEAD");
+	resp.set_head_only(head);
+	if ((head || req.equals(req.method, "GET")) && serve_static(req, resp))
+		return;
+	if (m_handler) {
+		m_handler(req, resp);
+		return;
+	}
+	resp.set_status(404);
+	resp.set_body("not found\n");
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::HttpServer<ThreadPolicy>::serve_static(const HttpRequest &req, HttpResponse &resp) const {
+	if (m_static_root.empty()) return false;
+	HttpRange path = req.path();
+	const char *p = req.ptr(path);
+	if (path.len == 0 || p[0] != '/') return false;
+	std::string rel(p, path.len);
+	// no escaping the root, reject any ".." segment
+	size_t seg = 0;
+	while (seg < rel.size()) {
+		size_t next = rel.find('/', seg + 1);
+		if (next == std::string::npos) next = rel.size();
+		if (rel.compare(seg, next - seg, "/..") == 0) return false;
+		seg = next;
+	}
+	if (rel.back() == '/') rel += "index.html";
+	return resp.set_file(m_static_root + rel);
+}
+
+template<typename ThreadPolicy>
+void jstd::net::HttpServer<ThreadPolicy>::reject(ConnHandle handle, std::string &out, int status) {
+	m_http_stats.bad_requests++;
+	HttpResponse resp;
+	resp.set_status(status);
+	resp.set_body(std::string(HttpResponse::reason(status)) + "\n");
+	resp.serialize(out, false);
+	this->send_to(handle, reinterpret_cast<const uint8_t*>(out.data()), out.size());
+	http_conn &c = conn_state(handle);
+	c.buff.clear();
+	c.parser.reset();
+	this->close_client(handle);
+}
+
+#endif //JSTDLIB_HTTP_SERVER_H
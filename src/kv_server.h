@@ -0,0 +1,278 @@
+#ifndef JSTDLIB_KV_SERVER_H
+#define JSTDLIB_KV_SERVER_H
+#include <string>
+#include <vector>
+#include "tcp_server.h"
+#include "KvStore.h"
+#include "RespParser.h"
+
+/*
+ * Description:
+ *  RESP (redis protocol) key/value cache on TcpServerBase, commands are parsed and answered from on_recv()
+ *  - GET, SET key value [EX seconds | PX ms], DEL key.., EXPIRE key seconds, MGET key.., TTL, DBSIZE, PING,
+ *    QUIT, so redis-cli, redis-benchmark and client libraries can talk to it
+ *  - every complete command in a connection buffer is executed in order and the replies of one read go out
+ *    with a single send (pipelining), the unparsed tail is kept for the next read
+ *  - data lives in a KvStore (sharded hash table, timing wheel TTLs, approximate LRU under max_bytes),
+ *    active expiry runs from on_recv() and the select timeout, an attached server that can go idle should
+ *    also call store().expire_tick() from an EventLoop timer
+ *  - commands run on the thread reading the socket, InlinePolicy or attach() is the natural fit
+ */
+#define KSVR LOG_MODULE::KVSERVER
+
+namespace jstd {
+	namespace net {
+		// a client that sends more than this without completing a command is dropped
+		constexpr size_t KV_MAX_REQUEST_BYTES = 64 << 20;
+
+		template<typename ThreadPolicy = InlinePolicy>
+		class KvServer : public TcpServerBase<KvServer<ThreadPolicy>, NetItem, ThreadPolicy> {
+			typedef TcpServerBase<KvServer<ThreadPolicy>, NetItem, ThreadPolicy> Base;
+			friend Base;
+
+			// per connection receive buffer, indexed by ConnHandle::index(), only touched by the reading thread
+			struct kv_conn {
+				ConnHandle handle;
+				std::vector<char> buff;
+			};
+			std::vector<kv_conn> m_conns;
+			KvStore m_store;
+			RespParser m_parser;
+			RespCommand m_cmd;
+			std::string m_out;
+			std::string m_val;
+			uint64_t m_commands;
+
+			kv_conn &conn_state(ConnHandle handle);
+
+			// appends the reply to m_out, false if the connection should be closed afterwards
+			bool execute(const RespCommand &cmd);
+
+			static bool parse_int(const char *p, size_t len, int64_t &val);
+
+			// largest EX / EXPIRE seconds whose milliseconds fit int64_t
+			static constexpr int64_t MAX_EXPIRE_SECS = INT64_MAX / 1000;
+
+		public:
+			KvServer(const std::string &ip, const in_port_t &port, size_t max_bytes = 0, unsigned shards = 16) :
+				Base(ip, port), m_store(max_bytes, shards), m_commands(0) {}
+
+			// serve on a listener handed over by the previous process, the store starts empty
+			explicit KvServer(int listen_fd, size_t max_bytes = 0, unsigned shards = 16) :
+				Base(listen_fd), m_store(max_bytes, shards), m_commands(0) {}
+
+			inline KvStore &store() { return m_store; }
+
+			inline uint64_t commands() const { return m_commands; }
+
+			// TcpServerBase hook, execute every complete command in the connection buffer
+			void on_recv(const uint8_t *buff, size_t len, ConnHandle conn);
+
+			// TcpServerBase hook, active expiry while no traffic arrives
+			bool process_select_timeout();
+
+			// TcpServerBase hooks, a partly received command travels to the successor with its connection
+			void on_hand_off(ConnHandle conn, std::vector<uint8_t> &state);
+
+			void on_take_over(ConnHandle conn, const std::vector<uint8_t> &state);
+		};
+	}  // namespace net
+}  // namespace jstd
+
+
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+template<typename ThreadPolicy>
+typename jstd::net::KvServer<ThreadPolicy>::kv_conn &
+jstd::net::KvServer<ThreadPolicy>::conn_state(ConnHandle handle) {
+	if (handle.index() >= m_conns.size())
+		m_conns.resize(handle.index() + 1);
+	kv_conn &c = m_conns[handle.index()];
+	if (c.handle != handle) {   // slot reused by a new connection, keep the buffer capacity
+		c.handle = handle;
+		c.buff.clear();
+	}
+	return c;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::KvServer<ThreadPolicy>::on_hand_off(ConnHandle conn, std::vector<uint8_t> &state) {
+	if (conn.index() < m_conns.size() && m_conns[conn.index()].handle == conn)
+		state.assign(m_conns[conn.index()].buff.begin(), m_conns[conn.index()].buff.end());
+}
+
+template<typename ThreadPolicy>
+void jstd::net::KvServer<ThreadPolicy>::on_take_over(ConnHandle conn, const std::vector<uint8_t> &state) {
+	conn_state(conn).buff.assign(state.begin(), state.end());
+}
+
+template<typename ThreadPolicy>
+void jstd::net::KvServer<ThreadPolicy>::on_recv(const uint8_t *buff, size_t len, ConnHandle conn) {
+	m_store.expire_tick();
+	kv_conn &c = conn_state(conn);
+	const char *data = reinterpret_cast<const char*>(buff);
+	bool buffered = !c.buff.empty();
+	if (buffered) {
+		c.buff.insert(c.buff.end(), buff, buff + len);
+		data = c.buff.data();
+		len = c.buff.size();
+	}
+	// common case, whole commands in one read are parsed straight from the receive buffer
+	m_out.clear();
+	size_t pos = 0;
+	bool keep_open = true;
+	while (pos < len && keep_open) {
+		RESP_PARSE rc = m_parser.parse(data + pos, len - pos, m_cmd);
+		if (rc == RESP_PARSE::INCOMPLETE)
+			break;
+		if (rc == RESP_PARSE::ERROR) {
+			LOG_WARNING(KSVR, "protocol error from ", this->peer_address(conn), ": ", m_parser.error());
+			resp::error(m_out, (std::string("ERR ") + m_parser.error()).c_str());
+			keep_open = false;
+			break;
+		}
+		pos += m_cmd.total_len;
+		if (m_cmd.args.empty()) continue;   // empty inline line
+		m_commands++;
+		keep_open = execute(m_cmd);
+	}
+	if (!m_out.empty())
+		this->send_to(conn, reinterpret_cast<const uint8_t*>(m_out.data()), m_out.size());
+	if (keep_open && len - pos > KV_MAX_REQUEST_BYTES) {
+		LOG_WARNING(KSVR, "dropping ", this->peer_address(conn), ", request exceeds ", KV_MAX_REQUEST_BYTES, " bytes");
+		keep_open = false;
+	}
+	if (!keep_open) {
+		c.buff.clear();
+		this->close_client(conn);
+		return;
+	}
+	// keep only the unparsed tail, normally nothing or the start of the next pipelined command
+	if (buffered) {
+		if (pos == c.buff.size())
+			c.buff.clear();
+		else if (pos > 0)
+			c.buff.erase(c.buff.begin(), c.buff.begin() + static_cast<std::ptrdiff_t>(pos));
+	} else if (pos < len) {
+		c.buff.assign(data + pos, data + len);
+	}
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::KvServer<ThreadPolicy>::execute(const RespCommand &cmd) {
+	size_t argc = cmd.args.size();
+	if (cmd.is("GET")) {
+		if (argc != 2) {
+			resp::error(m_out, "ERR wrong number of arguments for 'get' command");
+		} else if (m_store.get(cmd.ptr(1), cmd.len(1), m_val)) {
+			resp::bulk(m_out, m_val.data(), m_val.size());
+		} else {
+			resp::null_bulk(m_out);
+		}
+	} else if (cmd.is("SET")) {
+		if (argc != 3 && argc != 5) {
+			resp::error(m_out, "ERR syntax error");
+			return true;
+		}
+		int64_t ttl_ms = -1;
+		if (argc == 5) {
+			int64_t val = 0;
+			if (!parse_int(cmd.ptr(4), cmd.len(4), val) || val <= 0) {
+				resp::error(m_out, "ERR invalid expire time in 'set' command");
+				return true;
+			}
+			if (cmd.arg_is(3, "EX")) {
+				if (val > MAX_EXPIRE_SECS) {
+					resp::error(m_out, "ERR invalid expire time in 'set' command");
+					return true;
+				}
+				ttl_ms = val * 1000;
+			} else if (cmd.arg_is(3, "PX")) {
+				ttl_ms = val;
+			} else {
+				resp::error(m_out, "ERR syntax error");
+				return true;
+			}
+		}
+		m_store.set(cmd.ptr(1), cmd.len(1), cmd.ptr(2), cmd.len(2), ttl_ms);
+		resp::ok(m_out);
+	} else if (cmd.is("MGET")) {
+		if (argc < 2) {
+			resp::error(m_out, "ERR wrong number of arguments for 'mget' command");
+			return true;
+		}
+		resp::array_header(m_out, argc - 1);
+		for (size_t i = 1; i < argc; i++) {
+			if (m_store.get(cmd.ptr(i), cmd.len(i), m_val))
+				resp::bulk(m_out, m_val.data(), m_val.size());
+			else
+				resp::null_bulk(m_out);
+		}
+	} else if (cmd.is("DEL")) {
+		if (argc < 2) {
+			resp::error(m_out, "ERR wrong number of arguments for 'del' command");
+			return true;
+		}
+		int64_t removed = 0;
+		for (size_t i = 1; i < argc; i++)
+			if (m_store.del(cmd.ptr(i), cmd.len(i))) removed++;
+		resp::integer(m_out, removed);
+	} else if (cmd.is("EXPIRE")) {
+		int64_t secs = 0;
+		if (argc != 3) {
+			resp::error(m_out, "ERR wrong number of arguments for 'expire' command");
+		} else if (!parse_int(cmd.ptr(2), cmd.len(2), secs)) {
+			resp::error(m_out, "ERR value is not an integer or out of range");
+		} else if (secs > MAX_EXPIRE_SECS || secs < -MAX_EXPIRE_SECS) {
+			resp::error(m_out, "ERR invalid expire time in 'expire' command");
+		} else {
+			resp::integer(m_out, m_store.expire(cmd.ptr(1), cmd.len(1), secs * 1000) ? 1 : 0);
+		}
+	} else if (cmd.is("TTL")) {
+		if (argc != 2) {
+			resp::error(m_out, "ERR wrong number of arguments for 'ttl' command");
+			return true;
+		}
+		int64_t ttl = m_store.ttl(cmd.ptr(1), cmd.len(1));
+		resp::integer(m_out, ttl < 0 ? ttl : (ttl + 999) / 1000);
+	} else if (cmd.is("DBSIZE")) {
+		resp::integer(m_out, static_cast<int64_t>(m_store.size()));
+	} else if (cmd.is("PING")) {
+		if (argc > 1)
+			resp::bulk(m_out, cmd.ptr(1), cmd.len(1));
+		else
+			resp::simple(m_out, "PONG");
+	} else if (cmd.is("QUIT")) {
+		resp::ok(m_out);
+		return false;
+	} else if (cmd.is("COMMAND")) {
+		resp::array_header(m_out, 0);   // redis-cli asks on connect, no command docs
+	} else {
+		std::string msg = "ERR unknown command '" + cmd.str(0) + "'";
+		resp::error(m_out, msg.c_str());
+	}
+	return true;
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::KvServer<ThreadPolicy>::parse_int(const char *p, size_t len, int64_t &val) {
+	if (len == 0 || len > 18) return false;
+	bool neg = (*p == '-');
+	size_t i = neg ? 1 : 0;
+	if (i == len) return false;
+	int64_t v = 0;
+	for (; i < len; i++) {
+		if (p[i] < '0' || p[i] > '9') return false;
+		v = v * 10 + (p[i] - '0');
+	}
+	val = neg ? -v : v;
+	return true;
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::KvServer<ThreadPolicy>::process_select_timeout() {
+	m_store.expire_tick();
+	return true;
+}
+
+#endif //JSTDLIB_KV_SERVER_H
@@ -45,7 +45,9 @@ enum class LOG_MODULE {
     TEXASHOLDEM,
     UDPSERVER,
     TCPSERVER,
-    TCPCONNCMGR
+    TCPCONNCMGR,
+    HTTPSERVER,
+    KVSERVER
 };
 
 enum LOG_LEVEL {
@@ -92,7 +94,10 @@ public:
 
     inline void set_std_out(bool stdout_on) { output_stdout = stdout_on; }
 
-    inline void stopLogging() { logger::log_proc_is_alive = false; g_QProcThread.join(); }
+    inline void stopLogging() {
+        logger::log_proc_is_alive = false;
+        if (g_QProcThread.joinable()) g_QProcThread.join();
+    }
 
     inline bool isFileOpen() { return (strm_uptr) ? strm_uptr->is_open():false; }
 
@@ -177,6 +182,8 @@ const std::string log_module(LOG_MODULE mld) {
         case LOG_MODULE::UDPSERVER:           return "<USVR>";
         case LOG_MODULE::TCPSERVER:           return "<TSVR>";
         case LOG_MODULE::TCPCONNCMGR:         return "<TCM>";
+        case LOG_MODULE::HTTPSERVER:          return "<HSVR>";
+        case LOG_MODULE::KVSERVER:            return "<KSVR>";
     }
 }
 
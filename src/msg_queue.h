@@ -0,0 +1,252 @@
+#ifndef JSTDLIB_MSG_QUEUE_H
+#define JSTDLIB_MSG_QUEUE_H
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * Processing queue between the recv thread and the workers of TcpServerBase / UdpServerBase.
+ * Not synchronized, the servers hold their queue mutex around every call.
+ *
+ * Scheduling (QUEUE_DISCIPLINE):
+ *  - FIFO       one queue in arrival order
+ *  - DRR        a sub queue per flow (the connection of the item), served with deficit round robin: every
+ *               flow with queued items gets quantum credit per round and is served while its head item costs
+ *               no more than its credit, the cost being 1 per message (DRR_MESSAGES) or the item size
+ *               (DRR_BYTES). A client flooding the server then only delays itself, a light client waits at
+ *               most one round. Flows live while they have items queued, push and pop stay O(1)
+ *
+ * Items that waited too long to be worth processing are shed on the way out instead of handed to a worker:
+ *  - deadline   an item pushed with a deadline that has passed when it reaches the head
+ *  - CoDel      controlled delay as used for RPC queues: a queue that drains now and then is absorbing bursts
+ *               and items may wait up to interval_ms, a queue that has not been empty for a whole interval is
+ *               standing, then only items that waited less than target_us are processed. The packet CoDel
+ *               control law (drop rate rising with sqrt(drops)) is meant for senders that back off on loss,
+ *               request load does not, so the standing queue is cut down right away instead
+ *  Shedding old work keeps the workers busy with items that can still be answered in time, so goodput holds
+ *  under overload instead of every reply arriving too late.
+ */
+namespace jstd {
+	namespace net {
+		enum class SHED_REASON : uint8_t {
+			QUEUE_DELAY,     // CoDel drop
+			DEADLINE         // the item deadline passed while queued
+		};
+
+		// default DRR_BYTES credit per round, a quantum below the item size costs extra rounds per item
+		constexpr uint32_t DRR_BYTE_QUANTUM = 1500;
+
+		enum class QUEUE_DISCIPLINE : uint8_t {
+			FIFO,
+			DRR_MESSAGES,    // fair by message count
+			DRR_BYTES        // fair by payload bytes
+		};
+
+		// sub queue of one flow, wait times cover the items taken by a worker while the flow had items queued
+		struct FlowStats {
+			uint64_t flow;           // ConnHandle value of the client
+			size_t depth;
+			uint64_t bytes;          // queued payload
+			uint64_t served;
+			uint64_t shed;
+			uint64_t wait_us_total;  // of the served items
+			uint64_t wait_us_max;
+			uint64_t head_wait_us;   // how long the oldest queued item has been waiting
+		};
+
+		struct ShedConfig {
+			bool codel;              // CoDel on queue delay
+			unsigned target_us;      // longest wait of a processed item while the queue is standing
+			unsigned interval_ms;    // queue not empty for this long is standing, longest wait otherwise
+			unsigned deadline_ms;    // default item budget from enqueue, 0 for none
+
+			ShedConfig() : codel(false), target_us(5000), interval_ms(100), deadline_ms(0) {}
+		};
+
+		template<typename T>
+		class MsgQueue {
+		public:
+			typedef std::chrono::steady_clock clock_type;
+			typedef std::vector<std::pair<T, SHED_REASON>> shed_list;
+
+		private:
+			struct entry {
+				T item;
+				clock_type::time_point enqueued;
+				clock_type::time_point deadline;
+				uint32_t bytes;
+			};
+
+			struct flow {
+				uint64_t key;
+				std::deque<entry> items;
+				uint64_t deficit;
+				bool in_turn;            // got its quantum for the current visit
+				uint64_t bytes;
+				uint64_t served;
+				uint64_t shed;
+				uint64_t wait_us_total;
+				uint64_t wait_us_max;
+			};
+
+			// flows with items queued, m_active is the round robin order, front is served next
+			std::unordered_map<uint64_t, flow> m_flows;
+			std::deque<flow*> m_active;
+			size_t m_size;
+
+			QUEUE_DISCIPLINE m_discipline;
+			uint32_t m_quantum;
+			ShedConfig m_cfg;
+			clock_type::duration m_target;
+			clock_type::duration m_interval;
+
+			// last time the queue was seen empty, overloaded when longer than an interval ago
+			clock_type::time_point m_last_empty;
+
+			inline uint64_t cost(const entry &e) const {
+				switch (m_discipline) {
+					case QUEUE_DISCIPLINE::DRR_MESSAGES: return 1;
+					case QUEUE_DISCIPLINE::DRR_BYTES: return e.bytes;
+					default: return 0;
+				}
+			}
+
+			// take the head item off the front flow, a drained flow leaves the round and is dropped
+			void pop_head(flow &f);
+
+		public:
+			MsgQueue() : m_size(0), m_discipline(QUEUE_DISCIPLINE::FIFO), m_quantum(1),
+			             m_last_empty(clock_type::now()) { configure(ShedConfig()); }
+
+			void configure(const ShedConfig &cfg);
+
+			inline const ShedConfig &config() const { return m_cfg; }
+
+			// quantum is the credit per round in messages or bytes, 0 for 1 message or DRR_BYTE_QUANTUM
+			// switch only while the queue is empty
+			void set_discipline(QUEUE_DISCIPLINE discipline, uint32_t quantum);
+
+			inline QUEUE_DISCIPLINE discipline() const { return m_discipline; }
+
+			inline uint32_t quantum() const { return m_quantum; }
+
+			// flow is the key of the client sub queue, bytes the item size for DRR_BYTES
+			// deadline_ms 0 falls back to the configured default
+			void push(T &&item, uint64_t flow, uint32_t bytes, unsigned deadline_ms = 0);
+
+			// next item to process into out and the us it was queued, false when nothing is left
+			// items shed on the way are appended to shed
+			bool pop(T &out, uint64_t &sojourn_us, shed_list &shed);
+
+			// one record per flow with queued items, FIFO has a single flow 0
+			void flow_stats(std::vector<FlowStats> &out) const;
+
+			inline size_t size() const { return m_size; }
+
+			inline bool empty() const { return m_size == 0; }
+		};
+	}
+}
+
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+template<typename T>
+void jstd::net::MsgQueue<T>::configure(const ShedConfig &cfg) {
+	m_cfg = cfg;
+	m_target = std::chrono::microseconds(cfg.target_us);
+	m_interval = std::chrono::milliseconds(cfg.interval_ms ? cfg.interval_ms : 1);
+}
+
+template<typename T>
+void jstd::net::MsgQueue<T>::set_discipline(QUEUE_DISCIPLINE discipline, uint32_t quantum) {
+	if (m_size) return;
+	m_discipline = discipline;
+	m_quantum = quantum ? quantum : (discipline == QUEUE_DISCIPLINE::DRR_BYTES ? DRR_BYTE_QUANTUM : 1);
+}
+
+template<typename T>
+void jstd::net::MsgQueue<T>::push(T &&item, uint64_t flow_key, uint32_t bytes, unsigned deadline_ms) {
+	clock_type::time_point now = clock_type::now();
+	if (!m_size) m_last_empty = now;
+	if (!deadline_ms) deadline_ms = m_cfg.deadline_ms;
+	clock_type::time_point deadline = deadline_ms ? now + std::chrono::milliseconds(deadline_ms)
+	                                              : clock_type::time_point::max();
+	if (m_discipline == QUEUE_DISCIPLINE::FIFO) flow_key = 0;
+	flow &f = m_flows[flow_key];
+	if (f.items.empty()) {
+		f = flow{flow_key, std::deque<entry>(), 0, false, 0, 0, 0, 0, 0};
+		m_active.push_back(&f);     // map nodes do not move, the pointer stays valid until the flow is erased
+	}
+	f.items.push_back(entry{std::move(item), now, deadline, bytes});
+	f.bytes += bytes;
+	m_size++;
+}
+
+template<typename T>
+void jstd::net::MsgQueue<T>::pop_head(flow &f) {
+	f.bytes -= f.items.front().bytes;
+	f.items.pop_front();
+	m_size--;
+	if (!f.items.empty()) return;
+	m_active.pop_front();
+	m_flows.erase(f.key);
+}
+
+template<typename T>
+bool jstd::net::MsgQueue<T>::pop(T &out, uint64_t &sojourn_us, shed_list &shed) {
+	clock_type::time_point now = clock_type::now();
+	clock_type::duration limit = clock_type::duration::max();
+	if (m_cfg.codel) limit = now - m_last_empty > m_interval ? m_target : m_interval;
+	while (!m_active.empty()) {
+		flow &f = *m_active.front();
+		entry &head = f.items.front();
+		clock_type::duration sojourn = now - head.enqueued;
+		if (head.deadline < now || sojourn > limit) {
+			shed.emplace_back(std::move(head.item), head.deadline < now ? SHED_REASON::DEADLINE : SHED_REASON::QUEUE_DELAY);
+			f.shed++;
+			pop_head(f);
+			continue;
+		}
+		if (!f.in_turn) {
+			f.deficit += m_quantum;
+			f.in_turn = true;
+		}
+		uint64_t c = cost(head);
+		if (c > f.deficit) {
+			// out of credit, keep the remainder for the next round
+			f.in_turn = false;
+			m_active.pop_front();
+			m_active.push_back(&f);
+			continue;
+		}
+		f.deficit -= c;
+		uint64_t wait_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sojourn).count());
+		f.served++;
+		f.wait_us_total += wait_us;
+		if (wait_us > f.wait_us_max) f.wait_us_max = wait_us;
+		out = std::move(head.item);
+		sojourn_us = wait_us;
+		pop_head(f);
+		if (!m_size) m_last_empty = now;
+		return true;
+	}
+	m_last_empty = now;
+	return false;
+}
+
+template<typename T>
+void jstd::net::MsgQueue<T>::flow_stats(std::vector<FlowStats> &out) const {
+	clock_type::time_point now = clock_type::now();
+	for (const flow *f : m_active) {
+		uint64_t head_wait = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+			now - f->items.front().enqueued).count());
+		out.push_back(FlowStats{f->key, f->items.size(), f->bytes, f->served, f->shed, f->wait_us_total,
+		                        f->wait_us_max, head_wait});
+	}
+}
+
+#endif //JSTDLIB_MSG_QUEUE_H
@@ -0,0 +1,276 @@
+#ifndef JSTDLIB_MSG_ROUTER_H
+#define JSTDLIB_MSG_ROUTER_H
+#include <array>
+#include <chrono>
+#include <cstddef>      // offsetof
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include "net_types.h"
+#include "server_policy.h"
+
+/*
+ * Dispatch of framed messages to per type handlers, for process_item overrides that would otherwise parse
+ * item.buff and switch on it themselves.
+ *  - every message starts with a MsgHeader, the router reads its type and calls the handler registered for it
+ *  - handlers are registered at compile time as a list of MsgRoute<type, Owner, Item, &Owner::handler>, the
+ *    router builds a constexpr table indexed by type from it, so dispatch is a bounds check and one indirect
+ *    call, no map lookup and no virtual call. Type ids index the table directly, keep them small and dense
+ *  - types without a route, and items too short for a header, go to the MsgFallback handler with the type
+ *    that was read (MSG_TYPE_UNKNOWN for a short item)
+ *  - count, failures (handler returned false) and a latency histogram are kept per type and for the fallback,
+ *    each slot guarded by its own Mutex, null_mutex for an InlinePolicy server, the policy's mutex_type when
+ *    several workers dispatch. Reading the clock costs more than the dispatch itself, so by default only every
+ *    MSG_ROUTER_LATENCY_SAMPLE-th message (counted per thread) is timed, see set_latency_sampling()
+ *
+ *  class Server : public TcpServerBase<Server, NetItem> {
+ *      ...
+ *      bool on_get(NetItem &&item);
+ *      bool on_put(NetItem &&item);
+ *      bool on_unknown(NetItem &&item, uint16_t type);
+ *      typedef MsgRouter<std::mutex, MsgFallback<Server, NetItem, &Server::on_unknown>,
+ *                        MsgRoute<1, Server, NetItem, &Server::on_get>,
+ *                        MsgRoute<2, Server, NetItem, &Server::on_put>> router_type;
+ *      router_type m_router;
+ *  public:
+ *      bool process_item(NetItem &&item) { return m_router.dispatch(*this, std::move(item)); }
+ *  };
+ *
+ * Item needs a std::vector<uint8_t> buff holding one whole frame, msg_frame_len() finds frame boundaries
+ * in a stream for on_data overrides that reassemble them.
+ *
+ * frame layout: MsgHeader (network byte order), then len payload bytes
+ */
+namespace jstd {
+	namespace net {
+		constexpr uint16_t MSG_TYPE_UNKNOWN = 0xffff;
+		constexpr uint16_t MSG_ROUTER_MAX_TYPES = 1024;     // table slots, type ids of routes stay below
+		constexpr unsigned MSG_ROUTER_LATENCY_SAMPLE = 16;
+
+#pragma pack(push, 1)
+		struct MsgHeader {
+			uint32_t len;       // payload bytes following the header
+			uint16_t type;
+			uint16_t flags;     // application defined
+		};
+#pragma pack(pop)
+
+		constexpr size_t MSG_HEADER_LEN = sizeof(MsgHeader);
+
+		// type of the frame at data, MSG_TYPE_UNKNOWN when shorter than a header
+		inline uint16_t msg_type(const uint8_t *data, size_t len) {
+			if (len < MSG_HEADER_LEN) return MSG_TYPE_UNKNOWN;
+			uint16_t type;
+			std::memcpy(&type, data + offsetof(MsgHeader, type), sizeof(type));
+			return ntohs(type);
+		}
+
+		// bytes of the whole frame starting at data, 0 while its header or payload is still incomplete
+		inline size_t msg_frame_len(const uint8_t *data, size_t len) {
+			if (len < MSG_HEADER_LEN) return 0;
+			uint32_t payload;
+			std::memcpy(&payload, data + offsetof(MsgHeader, len), sizeof(payload));
+			size_t frame = MSG_HEADER_LEN + ntohl(payload);
+			return frame <= len ? frame : 0;
+		}
+
+		// append a frame of type carrying payload to out
+		inline void msg_frame(std::vector<uint8_t> &out, uint16_t type, const void *payload, uint32_t len,
+		                      uint16_t flags = 0) {
+			MsgHeader hdr{htonl(len), htons(type), htons(flags)};
+			const uint8_t *h = reinterpret_cast<const uint8_t*>(&hdr);
+			out.insert(out.end(), h, h + MSG_HEADER_LEN);
+			if (len) out.insert(out.end(), static_cast<const uint8_t*>(payload), static_cast<const uint8_t*>(payload) + len);
+		}
+
+		struct MsgTypeStats {
+			uint16_t type;          // MSG_TYPE_UNKNOWN for the fallback
+			uint64_t count;
+			uint64_t failed;        // handler returned false
+			LatencyHistogram latency_us;    // of the timed messages only
+
+			MsgTypeStats() : type(MSG_TYPE_UNKNOWN), count(0), failed(0) {}
+		};
+
+		// handler of one message type, Handler gets the whole frame
+		template<uint16_t Type, typename Owner, typename Item, bool (Owner::*Handler)(Item &&)>
+		struct MsgRoute {
+			static_assert(Type < MSG_ROUTER_MAX_TYPES, "message type ids index the dispatch table, keep them small");
+			static constexpr uint16_t type = Type;
+
+			static inline bool call(Owner &owner, Item &&item, uint16_t) {
+				return (owner.*Handler)(std::move(item));
+			}
+		};
+
+		// handler of every type without a route, gets the type that was read
+		template<typename Owner, typename Item, bool (Owner::*Handler)(Item &&, uint16_t)>
+		struct MsgFallback {
+			typedef Owner owner_type;
+			typedef Item item_type;
+
+			static inline bool call(Owner &owner, Item &&item, uint16_t type) {
+				return (owner.*Handler)(std::move(item), type);
+			}
+		};
+
+		namespace detail {
+			constexpr uint16_t max_msg_type(const uint16_t *types, size_t n) {
+				uint16_t m = 0;
+				for (size_t i = 0; i < n; i++)
+					if (types[i] > m) m = types[i];
+				return m;
+			}
+
+			constexpr bool unique_msg_types(const uint16_t *types, size_t n) {
+				for (size_t i = 0; i < n; i++)
+					for (size_t j = i + 1; j < n; j++)
+						if (types[i] == types[j]) return false;
+				return true;
+			}
+
+			// handler of type T, the first route registered for it or the fallback
+			template<typename Fallback, uint16_t T, typename... Routes>
+			struct msg_route_of {
+				static constexpr auto fn = &Fallback::call;
+			};
+
+			template<typename Fallback, uint16_t T, typename Route, typename... Routes>
+			struct msg_route_of<Fallback, T, Route, Routes...> {
+				static constexpr auto fn = Route::type == T ? &Route::call : msg_route_of<Fallback, T, Routes...>::fn;
+			};
+
+			template<typename Fallback, typename... Routes, size_t... I>
+			constexpr std::array<decltype(&Fallback::call), sizeof...(I)> build_msg_route_table(std::index_sequence<I...>) {
+				return {{msg_route_of<Fallback, static_cast<uint16_t>(I), Routes...>::fn...}};
+			}
+
+			// slot per type id up to the largest registered one, built at compile time
+			template<typename Fallback, typename... Routes>
+			struct msg_route_table {
+				typedef decltype(&Fallback::call) handler_fn;
+
+				static constexpr uint16_t types[] = {Routes::type..., 0};
+				static constexpr size_t size = max_msg_type(types, sizeof...(Routes)) + 1;
+				static constexpr std::array<handler_fn, size> table =
+					build_msg_route_table<Fallback, Routes...>(std::make_index_sequence<size>());
+			};
+
+			template<typename Fallback, typename... Routes>
+			constexpr uint16_t msg_route_table<Fallback, Routes...>::types[];
+
+			template<typename Fallback, typename... Routes>
+			constexpr std::array<typename msg_route_table<Fallback, Routes...>::handler_fn,
+			                     msg_route_table<Fallback, Routes...>::size> msg_route_table<Fallback, Routes...>::table;
+		}
+
+		template<typename Mutex, typename Fallback, typename... Routes>
+		class MsgRouter {
+		public:
+			typedef typename Fallback::owner_type owner_type;
+			typedef typename Fallback::item_type item_type;
+
+		private:
+			typedef detail::msg_route_table<Fallback, Routes...> table_type;
+			typedef std::chrono::steady_clock clock_type;
+
+			static_assert(sizeof...(Routes) > 0, "a router needs at least one route");
+			static_assert(detail::unique_msg_types(table_type::types, sizeof...(Routes)),
+			              "two routes registered for the same message type");
+
+			struct slot {
+				Mutex mtx;
+				MsgTypeStats stats;
+			};
+
+			// one per table entry, the last one counts the fallback
+			std::array<slot, table_type::size + 1> m_slots;
+			uint32_t m_sample_mask;
+			bool m_sampling;
+
+		public:
+			static constexpr size_t table_size = table_type::size;
+
+			MsgRouter() : m_sample_mask(MSG_ROUTER_LATENCY_SAMPLE - 1), m_sampling(true) {
+				for (size_t i = 0; i < table_type::size; i++) m_slots[i].stats.type = static_cast<uint16_t>(i);
+			}
+
+			MsgRouter(const MsgRouter &) = delete;
+
+			MsgRouter &operator=(const MsgRouter &) = delete;
+
+			// true if a route is registered for type
+			static constexpr bool routes(uint16_t type) {
+				return type < table_type::size && table_type::table[type] != &Fallback::call;
+			}
+
+			// hand item to the handler of its type, returns what the handler returned
+			bool dispatch(owner_type &owner, item_type &&item);
+
+			// a record per registered type in type order, then the fallback
+			std::vector<MsgTypeStats> stats();
+
+			void reset_stats();
+
+			// time one in every messages, rounded up to a power of 2, 1 times all and 0 none (counts stay exact)
+			void set_latency_sampling(unsigned every);
+		};
+	}
+}
+
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+template<typename Mutex, typename Fallback, typename... Routes>
+constexpr size_t jstd::net::MsgRouter<Mutex, Fallback, Routes...>::table_size;
+
+template<typename Mutex, typename Fallback, typename... Routes>
+bool jstd::net::MsgRouter<Mutex, Fallback, Routes...>::dispatch(owner_type &owner, item_type &&item) {
+	uint16_t type = msg_type(item.buff.data(), item.buff.size());
+	auto fn = type < table_type::size ? table_type::table[type] : &Fallback::call;
+	slot &s = m_slots[fn == &Fallback::call ? table_type::size : type];
+	static thread_local uint32_t t_tick = 0;
+	bool timed = m_sampling && !(++t_tick & m_sample_mask);
+	clock_type::time_point start = timed ? clock_type::now() : clock_type::time_point();
+	bool ok = fn(owner, std::move(item), type);
+	uint64_t us = timed ? static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - start).count()) : 0;
+	std::lock_guard<Mutex> lck(s.mtx);
+	s.stats.count++;
+	if (!ok) s.stats.failed++;
+	if (timed) s.stats.latency_us.record(us);
+	return ok;
+}
+
+template<typename Mutex, typename Fallback, typename... Routes>
+std::vector<jstd::net::MsgTypeStats> jstd::net::MsgRouter<Mutex, Fallback, Routes...>::stats() {
+	std::vector<MsgTypeStats> out;
+	for (size_t i = 0; i <= table_type::size; i++) {
+		if (i < table_type::size && !routes(static_cast<uint16_t>(i))) continue;
+		std::lock_guard<Mutex> lck(m_slots[i].mtx);
+		out.push_back(m_slots[i].stats);
+	}
+	return out;
+}
+
+template<typename Mutex, typename Fallback, typename... Routes>
+void jstd::net::MsgRouter<Mutex, Fallback, Routes...>::reset_stats() {
+	for (size_t i = 0; i <= table_type::size; i++) {
+		std::lock_guard<Mutex> lck(m_slots[i].mtx);
+		uint16_t type = m_slots[i].stats.type;
+		m_slots[i].stats = MsgTypeStats();
+		m_slots[i].stats.type = type;
+	}
+}
+
+template<typename Mutex, typename Fallback, typename... Routes>
+void jstd::net::MsgRouter<Mutex, Fallback, Routes...>::set_latency_sampling(unsigned every) {
+	m_sampling = every != 0;
+	uint32_t p = 1;
+	while (p < every && p < (1u << 31)) p <<= 1;
+	m_sample_mask = p - 1;
+}
+
+#endif //JSTDLIB_MSG_ROUTER_H
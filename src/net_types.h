@@ -8,6 +8,7 @@
 #include <ostream>
 #include <sstream>
 #include <netinet/in.h>
+#include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/errno.h>
 #include <sys/select.h>
@@ -38,6 +39,27 @@ constexpr int DEFAULT_SVR_THREAD_SLEEP = 5; // in ms
 // max number of back logged connection requests that will be listened to
 constexpr int MAX_NUMBER_TCP_CONNECTIONS = 100;
 
+// epoll wait timeout, bounds how long a recv thread takes to notice shutdown
+constexpr int DEFAULT_EPOLL_TIMEOUT_MILLI = 100;
+
+// io_uring sizing, buffer count must be a power of 2 so it can back a provided buffer ring
+constexpr unsigned DEFAULT_URING_ENTRIES = 1024;
+constexpr unsigned DEFAULT_URING_BUFF_CNT = 1024;
+constexpr unsigned DEFAULT_URING_UDP_RECV_DEPTH = 64;
+constexpr uint16_t DEFAULT_URING_BUFF_GROUP = 1;
+
+// upper bound of a recvmmsg / sendmmsg batch, the kernel's UIO_MAXIOV
+constexpr unsigned MAX_UDP_BATCH = 1024;
+
+// UDP segmentation offload, segments per GSO send (the kernel's UDP_MAX_SEGMENTS) and the payload limit of one
+// datagram, a GRO receive buffer has to hold the largest coalesced one
+constexpr unsigned UDP_MAX_GSO_SEGMENTS = 64;
+constexpr size_t UDP_MAX_PAYLOAD = 65507;
+constexpr size_t UDP_GRO_BUFF_SIZE = 65536;
+
+// SO_REUSEPORT receive lanes block in recv with this timeout, bounds how long they take to notice shutdown
+constexpr int DEFAULT_LANE_RECV_TIMEOUT_MILLI = 100;
+
 namespace jstd {
 	namespace net {
 
@@ -60,6 +82,24 @@ namespace jstd {
             UDP
         };
 
+        // mechanism used by the recv thread to wait on sockets
+        enum class IO_BACKEND {
+            SELECT,
+            EPOLL,
+            IO_URING
+        };
+
+        // tags stored in the top byte of io_uring user_data
+        enum class URING_TAG : uint8_t {
+            ACCEPT = 1,
+            RECV,
+            RECV_FIXED,
+            RECVMSG,
+            SEND,
+            SENDMSG,
+            WAKE
+        };
+
 #ifdef LINUX_OS
 		// error codes for recv, accept, listen, bind, and send
 		inline std::string sockErrToString(int32_t type) {
@@ -133,12 +173,102 @@ namespace jstd {
 
 #endif
 
+		// log linear histogram of microsecond values, 4 buckets per power of two (values within 25%)
+		struct LatencyHistogram {
+			static constexpr unsigned BUCKETS = 128;
+			uint64_t counts[BUCKETS];
+			uint64_t total;
+
+			LatencyHistogram() : counts(), total(0) {}
+
+			static inline unsigned bucket(uint64_t us) {
+				if (us < 4) return static_cast<unsigned>(us);
+				unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(us));
+				unsigned idx = 4 + (msb - 2) * 4 + static_cast<unsigned>((us >> (msb - 2)) & 3);
+				return idx < BUCKETS ? idx : BUCKETS - 1;
+			}
+
+			// largest value that lands in bucket idx
+			static inline uint64_t upper_bound(unsigned idx) {
+				if (idx < 4) return idx;
+				unsigned msb = (idx - 4) / 4 + 2;
+				return ((4ULL + (idx - 4) % 4 + 1) << (msb - 2)) - 1;
+			}
+
+			inline void record(uint64_t us) {
+				counts[bucket(us)]++;
+				total++;
+			}
+
+			// upper bound of the bucket holding the p quantile, 0 < p <= 1
+			uint64_t percentile(double p) const {
+				if (!total) return 0;
+				uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total));
+				if (rank >= total) rank = total - 1;
+				uint64_t seen = 0;
+				for (unsigned i = 0; i < BUCKETS; i++) {
+					seen += counts[i];
+					if (seen > rank) return upper_bound(i);
+				}
+				return upper_bound(BUCKETS - 1);
+			}
+
+			inline void merge(const LatencyHistogram &other) {
+				for (unsigned i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+				total += other.total;
+			}
+		};
+
+		// last TCP_INFO reading of a connection, see TcpInfo.h, fields the kernel does not report stay 0
+		struct TcpInfoSample {
+			uint64_t sampled_ms;        // steady clock ms, 0 while the connection was never sampled
+			uint32_t rtt_us;            // smoothed round trip time
+			uint32_t rttvar_us;
+			uint32_t snd_cwnd;          // congestion window, segments
+			uint32_t snd_mss;
+			uint32_t total_retrans;     // segments retransmitted over the connection's life
+			uint32_t unacked;           // segments sent and not acknowledged yet
+			uint32_t notsent_bytes;     // written by us, not sent yet (4.6+)
+			uint64_t delivery_rate;     // bytes/s the peer recently took (4.18+)
+			bool flagged;               // over a TcpInfoConfig limit at the last sample
+
+			TcpInfoSample() : sampled_ms(0), rtt_us(0), rttvar_us(0), snd_cwnd(0), snd_mss(0), total_retrans(0),
+			                  unacked(0), notsent_bytes(0), delivery_rate(0), flagged(false) {}
+
+			// bytes waiting in the send queue, unsent plus in flight (estimated from unacked segments)
+			inline uint64_t send_queue_bytes() const {
+				return static_cast<uint64_t>(notsent_bytes) + static_cast<uint64_t>(unacked) * snd_mss;
+			}
+		};
+
 		struct ServerStats {
 			ServerStats() : msg_recvd_cnt(0),
 			                msg_processed_cnt(0),
 			                sock_err_cnt(0),
 			                clients_added_cnt(0),
-			                clients_removed_cnt(0) {}
+			                clients_removed_cnt(0),
+			                shed_delay_cnt(0),
+			                shed_deadline_cnt(0),
+			                coalesced_cnt(0),
+			                tcp_sampled_cnt(0),
+			                tcp_flagged_cnt(0),
+			                tcp_retrans_cnt(0),
+			                tcp_send_queue_max(0),
+			                rel_sent_cnt(0),
+			                rel_retrans_cnt(0),
+			                rel_fast_retrans_cnt(0),
+			                rel_dup_cnt(0),
+			                rel_reset_cnt(0),
+			                rel_resync_cnt(0),
+			                rel_injected_loss_cnt(0),
+			                trunc_cnt(0),
+			                frag_split_cnt(0),
+			                frag_sent_cnt(0),
+			                frag_reassembled_cnt(0),
+			                frag_expired_cnt(0),
+			                frag_evicted_cnt(0),
+			                frag_rejected_cnt(0),
+			                mcast_sent_cnt(0) {}
 
 			uint64_t msg_recvd_cnt;
 			uint64_t msg_processed_cnt;
@@ -146,6 +276,79 @@ namespace jstd {
 			uint64_t clients_added_cnt;
 			uint64_t clients_removed_cnt;
 
+			// items dropped from the processing queue, see MsgQueue
+			uint64_t shed_delay_cnt;
+			uint64_t shed_deadline_cnt;
+
+			// requests answered with the response of an identical request in flight, see RequestCoalescer
+			uint64_t coalesced_cnt;
+
+			// time items spent in the processing queue before a worker took them, in us
+			LatencyHistogram sojourn_us;
+
+			// TCP_INFO of the connections at the last sampling round, see set_tcp_info_sampling()
+			uint64_t tcp_sampled_cnt;
+			uint64_t tcp_flagged_cnt;
+			uint64_t tcp_retrans_cnt;       // sum of the connections' total_retrans
+			uint64_t tcp_send_queue_max;    // bytes, largest send_queue_bytes()
+			LatencyHistogram tcp_rtt_us;
+
+			// reliable delivery over UDP, see ReliableUdp.h
+			uint64_t rel_sent_cnt;
+			uint64_t rel_retrans_cnt;
+			uint64_t rel_fast_retrans_cnt;
+			uint64_t rel_dup_cnt;
+			uint64_t rel_reset_cnt;
+			uint64_t rel_resync_cnt;
+			uint64_t rel_injected_loss_cnt;
+
+			// datagrams larger than the receive buffer, dropped
+			uint64_t trunc_cnt;
+
+			// messages split over several datagrams and put back together, see Fragmentation.h
+			uint64_t frag_split_cnt;
+			uint64_t frag_sent_cnt;
+			uint64_t frag_reassembled_cnt;
+			uint64_t frag_expired_cnt;
+			uint64_t frag_evicted_cnt;
+			uint64_t frag_rejected_cnt;
+
+			// broadcasts sent once to a multicast group instead of to every client
+			uint64_t mcast_sent_cnt;
+
+			// add the counters of other, e.g. of another receive lane
+			void merge(const ServerStats &other) {
+				msg_recvd_cnt += other.msg_recvd_cnt;
+				msg_processed_cnt += other.msg_processed_cnt;
+				sock_err_cnt += other.sock_err_cnt;
+				clients_added_cnt += other.clients_added_cnt;
+				clients_removed_cnt += other.clients_removed_cnt;
+				shed_delay_cnt += other.shed_delay_cnt;
+				shed_deadline_cnt += other.shed_deadline_cnt;
+				coalesced_cnt += other.coalesced_cnt;
+				sojourn_us.merge(other.sojourn_us);
+				tcp_sampled_cnt += other.tcp_sampled_cnt;
+				tcp_flagged_cnt += other.tcp_flagged_cnt;
+				tcp_retrans_cnt += other.tcp_retrans_cnt;
+				if (other.tcp_send_queue_max > tcp_send_queue_max) tcp_send_queue_max = other.tcp_send_queue_max;
+				tcp_rtt_us.merge(other.tcp_rtt_us);
+				rel_sent_cnt += other.rel_sent_cnt;
+				rel_retrans_cnt += other.rel_retrans_cnt;
+				rel_fast_retrans_cnt += other.rel_fast_retrans_cnt;
+				rel_dup_cnt += other.rel_dup_cnt;
+				rel_reset_cnt += other.rel_reset_cnt;
+				rel_resync_cnt += other.rel_resync_cnt;
+				rel_injected_loss_cnt += other.rel_injected_loss_cnt;
+				trunc_cnt += other.trunc_cnt;
+				frag_split_cnt += other.frag_split_cnt;
+				frag_sent_cnt += other.frag_sent_cnt;
+				frag_reassembled_cnt += other.frag_reassembled_cnt;
+				frag_expired_cnt += other.frag_expired_cnt;
+				frag_evicted_cnt += other.frag_evicted_cnt;
+				frag_rejected_cnt += other.frag_rejected_cnt;
+				mcast_sent_cnt += other.mcast_sent_cnt;
+			}
+
 			std::string to_string() const {
 				std::stringstream ss;
 				ss
@@ -155,6 +358,25 @@ namespace jstd {
 				ss << "\tClients Added: " << clients_added_cnt << "\n";
 				ss << "\tClients Removed: " << clients_removed_cnt << "\n";
 				ss << "\tSocket Errors: " << sock_err_cnt << "\n";
+				ss << "\tShed (queue delay / deadline): " << shed_delay_cnt << " / " << shed_deadline_cnt << "\n";
+				if (coalesced_cnt) ss << "\tCoalesced: " << coalesced_cnt << "\n";
+				if (sojourn_us.total)
+					ss << "\tQueue Sojourn us p50: " << sojourn_us.percentile(0.5) << " p99: " << sojourn_us.percentile(0.99)
+					   << " p99.9: " << sojourn_us.percentile(0.999) << "\n";
+				if (tcp_sampled_cnt)
+					ss << "\tTCP Connections Sampled: " << tcp_sampled_cnt << " flagged: " << tcp_flagged_cnt
+					   << " retransmits: " << tcp_retrans_cnt << " send queue max: " << tcp_send_queue_max
+					   << " rtt us p50: " << tcp_rtt_us.percentile(0.5) << " p99: " << tcp_rtt_us.percentile(0.99) << "\n";
+				if (rel_sent_cnt)
+					ss << "\tReliable Sent: " << rel_sent_cnt << " retransmitted: " << rel_retrans_cnt << " (fast "
+					   << rel_fast_retrans_cnt << ") duplicates: " << rel_dup_cnt << " resets: " << rel_reset_cnt
+					   << " resyncs: " << rel_resync_cnt << " injected losses: " << rel_injected_loss_cnt << "\n";
+				if (trunc_cnt) ss << "\tTruncated Datagrams: " << trunc_cnt << "\n";
+				if (frag_split_cnt || frag_reassembled_cnt)
+					ss << "\tFragmented Sent: " << frag_split_cnt << " (" << frag_sent_cnt << " fragments) reassembled: "
+					   << frag_reassembled_cnt << " expired: " << frag_expired_cnt << " evicted: " << frag_evicted_cnt
+					   << " rejected: " << frag_rejected_cnt << "\n";
+				if (mcast_sent_cnt) ss << "\tMulticast Broadcasts: " << mcast_sent_cnt << "\n";
 				ss
 					<< "-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-\n";
 				return ss.str();
@@ -166,43 +388,85 @@ namespace jstd {
 			return os;
 		}
 
-		// defaults type to UDP
+		// 64 bit reference to a connection record owned by a server, [ 32 bit generation | 32 bit index ]
+		// the generation of a slot is bumped whenever its connection is removed, so a handle kept across a
+		// disconnect/reconnect no longer resolves instead of silently reaching whoever reused the slot
+		struct ConnHandle {
+			uint64_t value;
+
+			ConnHandle() : value(UINT64_MAX) {}
+
+			ConnHandle(uint32_t index, uint32_t generation) :
+				value((static_cast<uint64_t>(generation) << 32) | index) {}
+
+			inline uint32_t index() const { return static_cast<uint32_t>(value); }
+
+			inline uint32_t generation() const { return static_cast<uint32_t>(value >> 32); }
+
+			inline bool is_valid() const { return value != UINT64_MAX; }
+
+			inline bool operator == (const ConnHandle &h) const { return value == h.value; }
+
+			inline bool operator != (const ConnHandle &h) const { return value != h.value; }
+		};
+
+		inline std::ostream &operator<<(std::ostream &os, const ConnHandle &h) {
+			if (h.is_valid())
+				os << h.index() << "/" << h.generation();
+			else
+				os << "invalid";
+			return os;
+		}
+
+		// connection record, defaults type to UDP
+		// trivially copyable, the dotted ip string is only produced on demand by ip_addr()
 		struct NetConnection {
-			std::string ip_addr;
 			sockaddr_in sa;
 			uint32_t sock_type;
 			int sockfd;
 			int port;
 			socklen_t addr_len;
+			ConnHandle handle;
 
-			NetConnection &operator=(const NetConnection &conn) = default;
-
-			NetConnection() : ip_addr("127.0.0.1"),
-			                  sa{},
+			NetConnection() : sa{},
 			                  sock_type(SOCK_DGRAM),
 			                  sockfd(INVALID_SOCKET),
-			                  addr_len(sizeof(sockaddr_in)) {}
-
-			NetConnection(const NetConnection &conn):
-				ip_addr(conn.ip_addr),
-				sa(conn.sa),
-				sock_type(conn.sock_type),
-				sockfd(conn.sockfd),
-				addr_len(sizeof(sockaddr_in)) {}
+			                  port(0),
+			                  addr_len(sizeof(sockaddr_in)) {
+				sa.sin_family = AF_INET;
+				sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			}
+
+			std::string ip_addr() const {
+				char ip[INET_ADDRSTRLEN];
+				if (!inet_ntop(AF_INET, &sa.sin_addr, ip, sizeof(ip))) return "";
+				return std::string(ip);
+			}
+
+			// "ip:port" of the peer
+			std::string to_string() const {
+				return ip_addr() + ":" + std::to_string(ntohs(sa.sin_port));
+			}
 		};
 
 		// std item to hold a buffer
-		// contains socket information for easy usage
+		// conn :: handle of the connection the item came from / goes to, resolved by the owning server
 		// id :: identifies type of message being sent out || or hash_id
 		// serialize() :: converts entire data structure to a buffer, reciever of this item should be able to
-		//                reconstruct the data structure. Note serialize does not serialize NetConnection
+		//                reconstruct the data structure. Note serialize does not serialize the connection
 		struct NetItem {
-			NetConnection conn;
+			ConnHandle conn;
 			std::vector<uint8_t> buff;
 
 			NetItem() = default;
 
-			NetItem(const NetItem &conn) : conn{conn.conn} { buff = conn.buff; }
+			NetItem(const NetItem &item) = default;
+
+			NetItem(NetItem &&item) noexcept = default;
+
+			NetItem &operator=(const NetItem &item) = default;
+
+			NetItem &operator=(NetItem &&item) noexcept = default;
 
 			virtual ~NetItem() = default;
 
@@ -214,9 +478,8 @@ namespace jstd {
 
 			std::string to_string() const {
 				std::stringstream ss;
-				ss << "ip: " << conn.ip_addr;
-				ss << "port: " << conn.sa.sin_port;
-				ss << "buff size: " << buff.size();
+				ss << "conn: " << conn;
+				ss << " buff size: " << buff.size();
 				return ss.str();
 			}
 
@@ -0,0 +1,81 @@
+#ifndef JSTDLIB_SERVER_POLICY_H
+#define JSTDLIB_SERVER_POLICY_H
+#include <mutex>
+#include <thread>
+#ifdef LINUX_OS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * Threading policies for TcpServerBase / UdpServerBase, picked per server instance as a template parameter
+ *  - mutex_type       lock guarding the client table, item queue and in flight io_uring sends
+ *  - threaded         false: run() drives the recv loop on the calling thread and items are processed
+ *                     inline as they are received, no queue, no threads, no locking
+ *  - worker_count()   number of processing threads fed from the item queue when threaded
+ *  - on_worker_start  called first thing on every processing thread
+ *
+ * MULTITHREADED_SRVR only selects DefaultThreadPolicy, all policies are available in every build.
+ */
+namespace jstd {
+	namespace net {
+		// satisfies BasicLockable, compiles away entirely
+		struct null_mutex {
+			inline void lock() {}
+
+			inline void unlock() {}
+
+			inline bool try_lock() { return true; }
+		};
+
+		// run to completion on the thread that calls run(), lowest latency, one core
+		struct InlinePolicy {
+			typedef null_mutex mutex_type;
+			static constexpr bool threaded = false;
+
+			static inline unsigned worker_count() { return 0; }
+
+			static inline void on_worker_start(unsigned) {}
+		};
+
+		// recv thread feeding a single processing thread, the original server model
+		struct PipelinePolicy {
+			typedef std::mutex mutex_type;
+			static constexpr bool threaded = true;
+
+			static inline unsigned worker_count() { return 1; }
+
+			static inline void on_worker_start(unsigned) {}
+		};
+
+		// recv thread feeding one processing thread per core, workers are pinned to their core on linux
+		struct ThreadPerCorePolicy {
+			typedef std::mutex mutex_type;
+			static constexpr bool threaded = true;
+
+			static inline unsigned worker_count() {
+				unsigned cores = std::thread::hardware_concurrency();
+				return cores ? cores : 1;
+			}
+
+			static inline void on_worker_start(unsigned worker) {
+#ifdef LINUX_OS
+				cpu_set_t cpus;
+				CPU_ZERO(&cpus);
+				CPU_SET(worker % worker_count(), &cpus);
+				pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+#else
+				(void)worker;
+#endif
+			}
+		};
+
+#ifdef MULTITHREADED_SRVR
+		typedef PipelinePolicy DefaultThreadPolicy;
+#else
+		typedef InlinePolicy DefaultThreadPolicy;
+#endif
+	}
+}
+
+#endif //JSTDLIB_SERVER_POLICY_H
@@ -0,0 +1,424 @@
+#ifndef JSTDLIB_TCP_PROXY_H
+#define JSTDLIB_TCP_PROXY_H
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include "tcp_server.h"
+#include "TcpSocket.h"
+#include "BackendPool.h"
+
+/*
+ * Description:
+ *  L4 forwarder on TcpServerBase. Accepted clients are taken over in on_accept() with release_client(),
+ *  a backend picked by BackendPool (round robin or least connections) is connected through TcpSocket and
+ *  bytes are moved in both directions with splice() through a pipe per direction, so payload never gets
+ *  copied to user space.
+ *  - everything runs on an EventLoop, run() drives a loop owned by the proxy, attach() shares the
+ *    application's loop instead
+ *  - a direction stops reading its source while the pipe still holds bytes the destination did not take,
+ *    so a slow peer throttles the fast one instead of growing buffers
+ *  - half close is forwarded (EOF from one side shuts down writes to the other), the session ends once
+ *    both directions are finished or on any error
+ *  - failed backend connects are retried on the next backend, BackendPool tracks health from them
+ *  Linux only (splice, EventLoop).
+ */
+#define TPRX LOG_MODULE::TCPSERVER
+
+namespace jstd {
+	namespace net {
+#ifdef LINUX_OS
+		constexpr size_t PROXY_PIPE_SIZE = 1 << 20;     // requested with F_SETPIPE_SZ, the kernel may cap it
+		constexpr unsigned PROXY_PUMP_ROUNDS = 16;      // splice rounds per event before yielding to other fds
+
+		struct ProxyStats {
+			uint64_t sessions;
+			uint64_t active;
+			uint64_t bytes_up;          // client to backend
+			uint64_t bytes_down;        // backend to client
+			uint64_t connect_failures;
+			uint64_t rejected;          // no usable backend
+			ProxyStats() : sessions(0), active(0), bytes_up(0), bytes_down(0), connect_failures(0), rejected(0) {}
+		};
+
+		template<typename ThreadPolicy = InlinePolicy>
+		class TcpProxy : public TcpServerBase<TcpProxy<ThreadPolicy>, NetItem, ThreadPolicy> {
+			typedef TcpServerBase<TcpProxy<ThreadPolicy>, NetItem, ThreadPolicy> Base;
+			friend Base;
+
+			// one direction of a session, bytes sit in the pipe between the two splice calls
+			struct proxy_pipe {
+				int rd;
+				int wr;
+				size_t pending;
+				bool eof;       // source reached EOF
+				bool shut;      // EOF forwarded to the destination
+			};
+
+			struct proxy_session {
+				int client_fd;
+				int backend_fd;
+				int backend;                // BackendPool index, -1 without one
+				unsigned attempts;
+				bool connecting;
+				uint32_t client_mask;       // events registered with the loop
+				uint32_t backend_mask;
+				proxy_pipe up;              // client to backend
+				proxy_pipe down;            // backend to client
+			};
+
+			BackendPool m_backends;
+			EventLoop m_own_loop;
+			EventLoop *m_ploop;
+			std::vector<std::unique_ptr<proxy_session>> m_sessions;     // indexed by client socket
+			std::vector<std::unique_ptr<proxy_session>> m_free;         // closed sessions, pipes kept open
+			ProxyStats m_proxy_stats;
+
+			proxy_session *new_session(int client_fd);
+
+			bool open_pipe(proxy_pipe &p);
+
+			// connect the session to the next usable backend, false if none is left
+			bool connect_backend(proxy_session &s);
+
+			void finish_connect(proxy_session &s);
+
+			void on_client_event(proxy_session &s, uint32_t events);
+
+			void on_backend_event(proxy_session &s, uint32_t events);
+
+			// move bytes from src through p into dst until both sides would block, false on errors
+			bool pump(int src, int dst, proxy_pipe &p, uint64_t &bytes);
+
+			// re-register interest after pumping, closes the session once both directions are done
+			void update(proxy_session &s);
+
+			void close_session(proxy_session &s);
+
+		public:
+			TcpProxy(const std::string &ip, const in_port_t &port, LB_POLICY policy = LB_POLICY::ROUND_ROBIN) :
+				Base(ip, port), m_backends(policy), m_ploop(nullptr) {}
+
+			~TcpProxy();
+
+			inline size_t add_backend(const std::string &ip, uint16_t port) { return m_backends.add(ip, port); }
+
+			inline BackendPool &backends() { return m_backends; }
+
+			inline const ProxyStats &proxy_stats() const { return m_proxy_stats; }
+
+			// serve from an application owned loop
+			bool attach(EventLoop &loop);
+
+			void detach();
+
+			// serve from the proxy's own loop on the calling thread until stop()
+			bool run();
+
+			// safe from any thread
+			void stop();
+
+			// TcpServerBase hook, take the client over from the server and connect it to a backend
+			void on_accept(ConnHandle conn);
+		};
+#endif
+	}  // namespace net
+}  // namespace jstd
+
+
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+#ifdef LINUX_OS
+template<typename ThreadPolicy>
+jstd::net::TcpProxy<ThreadPolicy>::~TcpProxy() {
+	detach();
+	for (auto &s : m_free) {
+		close(s->up.rd); close(s->up.wr);
+		close(s->down.rd); close(s->down.wr);
+	}
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::TcpProxy<ThreadPolicy>::attach(EventLoop &loop) {
+	if (!Base::attach(loop)) return false;
+	m_ploop = &loop;
+	return true;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::detach() {
+	if (!m_ploop) return;
+	for (auto &s : m_sessions)
+		if (s) close_session(*s);
+	Base::detach();
+	m_ploop = nullptr;
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::TcpProxy<ThreadPolicy>::run() {
+	if (m_backends.size() == 0) {
+		LOG_ERROR(TPRX, "proxy has no backends");
+		return false;
+	}
+	if (!attach(m_own_loop)) return false;
+	m_own_loop.run();
+	detach();
+	return true;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::stop() {
+	m_own_loop.stop();
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::TcpProxy<ThreadPolicy>::open_pipe(proxy_pipe &p) {
+	int fds[2];
+	if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) return false;
+	fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(PROXY_PIPE_SIZE));   // best effort
+	p.rd = fds[0];
+	p.wr = fds[1];
+	return true;
+}
+
+template<typename ThreadPolicy>
+typename jstd::net::TcpProxy<ThreadPolicy>::proxy_session *
+jstd::net::TcpProxy<ThreadPolicy>::new_session(int client_fd) {
+	std::unique_ptr<proxy_session> s;
+	if (!m_free.empty()) {
+		s = std::move(m_free.back());
+		m_free.pop_back();
+	} else {
+		s.reset(new proxy_session());
+		if (!open_pipe(s->up)) return nullptr;
+		if (!open_pipe(s->down)) {
+			close(s->up.rd); close(s->up.wr);
+			return nullptr;
+		}
+	}
+	s->client_fd = client_fd;
+	s->backend_fd = -1;
+	s->backend = -1;
+	s->attempts = 0;
+	s->connecting = false;
+	s->client_mask = 0;
+	s->backend_mask = 0;
+	s->up.pending = s->down.pending = 0;
+	s->up.eof = s->down.eof = false;
+	s->up.shut = s->down.shut = false;
+	if (static_cast<size_t>(client_fd) >= m_sessions.size())
+		m_sessions.resize(client_fd + 1);
+	m_sessions[client_fd] = std::move(s);
+	return m_sessions[client_fd].get();
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::on_accept(ConnHandle conn) {
+	if (!m_ploop) {
+		LOG_ERROR(TPRX, "proxy must be attached to an event loop, dropping connection");
+		this->close_client(conn);
+		return;
+	}
+	int fd = this->release_client(conn);
+	if (fd < 0) return;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	int one = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	proxy_session *s = new_session(fd);
+	if (!s) {
+		LOG_ERROR(TPRX, "failed to create session pipes errno: ", errno);
+		close(fd);
+		return;
+	}
+	m_proxy_stats.sessions++;
+	m_proxy_stats.active++;
+	m_ploop->add_fd(fd, 0, [this, s](int, uint32_t events) { on_client_event(*s, events); });
+	if (!connect_backend(*s)) {
+		m_proxy_stats.rejected++;
+		LOG_WARNING(TPRX, "no usable backend, dropping client");
+		close_session(*s);
+	}
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::TcpProxy<ThreadPolicy>::connect_backend(proxy_session &s) {
+	while (s.attempts < m_backends.size()) {
+		s.attempts++;
+		int idx = m_backends.select();
+		if (idx < 0) return false;
+		const Backend &be = m_backends.at(static_cast<size_t>(idx));
+		TcpSocket sock(IPAddress(), 0);
+		int fd = sock.get_fd();
+		if (fd < 0) {
+			m_backends.released(static_cast<size_t>(idx));
+			return false;
+		}
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (!sock.connect(be.addr, be.port) && errno != EINPROGRESS) {
+			LOG_WARNING(TPRX, "connect to backend ", be.addr.to_string(), ":", be.port, " failed errno: ", errno);
+			close(fd);
+			m_proxy_stats.connect_failures++;
+			m_backends.failed(static_cast<size_t>(idx));
+			m_backends.released(static_cast<size_t>(idx));
+			continue;
+		}
+		s.backend = idx;
+		s.backend_fd = fd;
+		s.connecting = true;
+		s.backend_mask = EPOLLOUT;
+		proxy_session *sp = &s;
+		m_ploop->add_fd(fd, EPOLLOUT, [this, sp](int, uint32_t events) { on_backend_event(*sp, events); });
+		return true;
+	}
+	return false;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::finish_connect(proxy_session &s) {
+	int err = 0;
+	socklen_t len = sizeof(err);
+	getsockopt(s.backend_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+	if (err != 0) {
+		const Backend &be = m_backends.at(static_cast<size_t>(s.backend));
+		LOG_WARNING(TPRX, "backend ", be.addr.to_string(), ":", be.port, " refused connection: ", sockErrToString(err));
+		m_proxy_stats.connect_failures++;
+		m_backends.failed(static_cast<size_t>(s.backend));
+		m_backends.released(static_cast<size_t>(s.backend));
+		m_ploop->remove_fd(s.backend_fd);
+		close(s.backend_fd);
+		s.backend_fd = -1;
+		s.backend = -1;
+		s.connecting = false;
+		if (!connect_backend(s)) {
+			m_proxy_stats.rejected++;
+			close_session(s);
+		}
+		return;
+	}
+	m_backends.connected(static_cast<size_t>(s.backend));
+	s.connecting = false;
+	if (!pump(s.client_fd, s.backend_fd, s.up, m_proxy_stats.bytes_up)) {
+		close_session(s);
+		return;
+	}
+	update(s);
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::on_client_event(proxy_session &s, uint32_t events) {
+	if ((events & EPOLLERR) || (s.connecting && (events & EPOLLHUP))) {
+		close_session(s);
+		return;
+	}
+	bool ok = true;
+	if (!s.connecting && (events & (EPOLLIN | EPOLLHUP)))
+		ok = pump(s.client_fd, s.backend_fd, s.up, m_proxy_stats.bytes_up);
+	if (ok && (events & EPOLLOUT))
+		ok = pump(s.backend_fd, s.client_fd, s.down, m_proxy_stats.bytes_down);
+	if (!ok || ((events & EPOLLHUP) && s.down.pending)) {     // client gone, nothing left to deliver to it
+		close_session(s);
+		return;
+	}
+	update(s);
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::on_backend_event(proxy_session &s, uint32_t events) {
+	if (s.connecting) {
+		finish_connect(s);
+		return;
+	}
+	if (events & EPOLLERR) {
+		close_session(s);
+		return;
+	}
+	bool ok = true;
+	if (events & (EPOLLIN | EPOLLHUP))
+		ok = pump(s.backend_fd, s.client_fd, s.down, m_proxy_stats.bytes_down);
+	if (ok && (events & EPOLLOUT))
+		ok = pump(s.client_fd, s.backend_fd, s.up, m_proxy_stats.bytes_up);
+	if (!ok || ((events & EPOLLHUP) && s.up.pending)) {
+		close_session(s);
+		return;
+	}
+	update(s);
+}
+
+template<typename ThreadPolicy>
+bool jstd::net::TcpProxy<ThreadPolicy>::pump(int src, int dst, proxy_pipe &p, uint64_t &bytes) {
+	for (unsigned round = 0; round < PROXY_PUMP_ROUNDS; round++) {
+		if (p.pending) {
+			ssize_t n = splice(p.rd, nullptr, dst, nullptr, p.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+			if (n < 0)
+				return errno == EAGAIN;     // destination full, its EPOLLOUT resumes the direction
+			p.pending -= static_cast<size_t>(n);
+			bytes += static_cast<uint64_t>(n);
+			if (p.pending) continue;
+		}
+		if (p.eof) {
+			if (!p.shut) {
+				shutdown(dst, SHUT_WR);
+				p.shut = true;
+			}
+			return true;
+		}
+		// the pipe is empty here, so EAGAIN can only mean the source has nothing to read
+		ssize_t n = splice(src, nullptr, p.wr, nullptr, PROXY_PIPE_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (n == 0) {
+			p.eof = true;
+			continue;
+		}
+		if (n < 0)
+			return errno == EAGAIN;
+		p.pending += static_cast<size_t>(n);
+	}
+	return true;
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::update(proxy_session &s) {
+	if (s.up.shut && s.down.shut) {
+		close_session(s);
+		return;
+	}
+	// read a source only while its pipe is empty, wait for writability while a pipe holds bytes
+	uint32_t client_mask = ((!s.up.eof && !s.up.pending) ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+	                       (s.down.pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+	uint32_t backend_mask = ((!s.down.eof && !s.down.pending) ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+	                        (s.up.pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+	if (client_mask != s.client_mask) {
+		m_ploop->modify_fd(s.client_fd, client_mask);
+		s.client_mask = client_mask;
+	}
+	if (backend_mask != s.backend_mask) {
+		m_ploop->modify_fd(s.backend_fd, backend_mask);
+		s.backend_mask = backend_mask;
+	}
+}
+
+template<typename ThreadPolicy>
+void jstd::net::TcpProxy<ThreadPolicy>::close_session(proxy_session &s) {
+	int client_fd = s.client_fd;
+	m_ploop->remove_fd(client_fd);
+	close(client_fd);
+	if (s.backend_fd >= 0) {
+		m_ploop->remove_fd(s.backend_fd);
+		close(s.backend_fd);
+	}
+	if (s.backend >= 0) m_backends.released(static_cast<size_t>(s.backend));
+	m_proxy_stats.active--;
+	std::unique_ptr<proxy_session> owned = std::move(m_sessions[client_fd]);
+	if (s.up.pending || s.down.pending) {
+		// aborted with bytes in flight, the pipes can not be reused
+		close(s.up.rd); close(s.up.wr);
+		close(s.down.rd); close(s.down.wr);
+		return;
+	}
+	m_free.push_back(std::move(owned));
+}
+#endif // LINUX_OS
+
+#endif //JSTDLIB_TCP_PROXY_H
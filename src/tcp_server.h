@@ -7,8 +7,10 @@
 #include <thread>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <chrono>
 #include <functional>   // std::hash
+#include <algorithm>    // std::min
 #include "logger.h"
 #include "udp_server.h"
 #include <arpa/inet.h>
@@ -20,8 +22,24 @@
 #endif
 #include <sys/ioctl.h>  // ioctl()
 #include <unistd.h>     // close()
+#include <poll.h>       // poll()
+#ifdef LINUX_OS
+#include <sys/sendfile.h>
+#endif
 #include "net_types.h"
 #include "fd_sets.h"
+#include "epoll_set.h"
+#include "ConnectionTable.h"
+#include "IoUring.h"
+#include "server_policy.h"
+#include "EventLoop.h"
+#include "TrafficCapture.h"
+#include "WriteAheadLog.h"
+#include "msg_queue.h"
+#include "RequestCoalescer.h"
+#include "ResponseCache.h"
+#include "HotRestart.h"
+#include "TcpInfo.h"
 
 /*
  * Description:
@@ -32,11 +50,30 @@
  *  Broadcast mode can be enabled. This is not true UDP bcast as all active clients will recv the same message.
  *  This makes having bcast/multicast routers not a requirement
  *
- *  This Server can also be built SINGLE or MULTITHREADED
+ *  Threading is selected per instance through the ThreadPolicy parameter (server_policy.h): InlinePolicy runs
+ *  recv and processing to completion on the thread calling run(), PipelinePolicy (default when built with
+ *  MULTITHREADED_SRVR) adds a processing thread, ThreadPerCorePolicy one pinned processing thread per core.
+ *
+ *  Connections are owned by the server and referenced through 64 bit ConnHandles (slot index + generation),
+ *  items only carry the handle. Handles of closed connections go stale and are rejected by send_item().
+ *
+ *  Everything else is opt-in per instance and documented at its setter and in the module it is built on:
+ *  set_io_backend() (IoUring.h), attach() (EventLoop.h), set_queue_discipline() and set_load_shedding()
+ *  (msg_queue.h), set_coalescing() (RequestCoalescer.h), set_response_cache() (ResponseCache.h), set_wal()
+ *  (WriteAheadLog.h), hand_off() (HotRestart.h) and set_tcp_info_sampling() (TcpInfo.h).
+ *
+ *  TcpServerBase<Derived, QItem> is the statically dispatched core. The hooks (process_item, on_accept, on_recv,
+ *  on_data, build_qitem, on_shed, item_deadline_ms, on_hand_off, on_take_over, on_tcp_flagged, hash_conn,
+ *  process_select_timeout, handle_select_error, broadcast_data) are looked up on Derived at compile time, so
+ *  they inline into the recv and processing loops, hooks Derived does not declare fall through to the
+ *  defaults here. Derived hooks must be public or Derived must befriend the base, and overriding one overload
+ *  of process_item/hash_conn hides the other (pull it in with a using declaration).
+ *
+ *  TcpServer<QItem> keeps the original virtual interface on top of the base for code that subclasses at runtime.
  *
  *  QItem template type should have the following public interface
  *  struct QItem {
- *      NetConnection conn;
+ *      ConnHandle conn;
  *      fields...
  *      fields...
  *      fields...
@@ -55,19 +92,57 @@
 
 namespace jstd {
 	namespace net {
-		template<typename QItem>
-		class TcpServer {
-			// create a hash from ip str and and port
-			std::unordered_map<uint64_t, NetConnection> m_client_connections;
+		template<typename Derived, typename QItem, typename ThreadPolicy = DefaultThreadPolicy>
+		class TcpServerBase {
+			typedef typename ThreadPolicy::mutex_type mutex_type;
+
+			// connection records, indexed by socket descriptor and by hash_conn() of ip and port
+			ConnectionTable m_clients;
+			std::vector<ConnHandle> m_fd_handles;
+			std::unordered_map<uint64_t, ConnHandle> m_addr_index;
 
 			std::thread m_recv_thread;
-			std::thread m_q_proc_thread;
-			std::queue<QItem> m_msg_queue;
-			std::mutex m_qmtx;
-			std::mutex m_cmtx;
+			std::vector<std::thread> m_workers;
+			// travels with an item to processing, 0 for none: wal_seq is the log record the item was built from,
+			// flight the RequestCoalescer key it leads, cache_key/cache_check the fingerprint to cache its response under
+			struct item_ctx {
+				uint64_t wal_seq;
+				uint64_t flight;
+				uint64_t cache_key;
+				uint64_t cache_check;
+			};
+			struct queued_item {
+				QItem item;
+				item_ctx ctx;
+			};
+			MsgQueue<queued_item> m_msg_queue;
+			mutex_type m_qmtx;
+			mutex_type m_cmtx;
 			bool m_qproc_active;
 			bool m_recv_active;
 			fd_sets m_fd_sets;   	// read sets
+			IO_BACKEND m_io_backend;
+#ifdef LINUX_OS
+			epoll_set m_epoll;
+			IoUring m_uring;
+			bool m_uring_multishot;
+
+			// outgoing buffers per socket, only the front one is on the ring. io_uring does not order
+			// independent sends on one fd, the next buffer is prepped from the completion of the previous
+			struct uring_send {
+				std::deque<std::vector<uint8_t>> queue;
+				size_t offset;   	// bytes of the front buffer already sent
+				uint64_t id;     	// user_data value of the send in flight, [ sockfd | sequence ]
+			};
+			mutex_type m_smtx;
+			std::unordered_map<int, uring_send> m_uring_sends;
+			// in flight buffers of closed sockets, kept until the kernel is done with them
+			std::unordered_map<uint64_t, std::vector<uint8_t>> m_uring_orphans;
+			uint64_t m_next_send_id;
+
+			// set while attached to an application owned loop
+			EventLoop *m_loop;
+#endif
 
 			// listening socket
 			NetConnection m_svr_conn;
@@ -78,38 +153,99 @@ namespace jstd {
 			// message counter
 			ServerStats m_stats;
 
+			// optional recorder of received frames
+			std::atomic<TrafficCapture*> m_capture;
+
+			// optional durability stage, items wait in m_wal_pending for their commit, in log order
+			WriteAheadLog *m_wal;
+			std::mutex m_wal_mtx;
+			struct wal_item {
+				uint32_t bytes;
+				item_ctx ctx;
+				QItem item;
+			};
+			std::deque<wal_item> m_wal_pending;
+			int m_wal_event;
+
+			// optional coalescing of identical requests in flight
+			bool m_coalesce;
+			mutex_type m_co_mtx;
+			RequestCoalescer m_coalescer;
+
+			// optional cache of responses, m_cache_hit holds a hit on its way out (recv thread only)
+			ResponseCache *m_cache;
+			std::vector<uint8_t> m_cache_hit;
+			// connections exempt from it, m_cache_bypass[index] holds the handle while set, guarded by m_cmtx
+			std::vector<ConnHandle> m_cache_bypass;
+
+			// m_cmtx held
+			inline bool is_cache_bypassed(ConnHandle conn) const {
+				return conn.index() < m_cache_bypass.size() && m_cache_bypass[conn.index()] == conn;
+			}
+
+			// sends to conn while an item with a flight or cache key is processed on this thread are copied to data
+			struct response_capture {
+				const TcpServerBase *owner;
+				ConnHandle conn;
+				std::vector<uint8_t> data;
+			};
+			static thread_local response_capture *t_capture;
+
+			// optional TCP_INFO sampling, m_tcp_info_due is the next round of an InlinePolicy recv loop
+			TcpInfoConfig m_tcp_cfg;
+			std::thread m_tcp_info_thread;
+			uint64_t m_tcp_info_due;
+			int m_tcp_info_timer;
+
+			// last sample per connection, indexed by ConnHandle::index() and guarded by m_cmtx. A slot belongs to
+			// the connection whose handle it holds, one of a closed connection is ignored until the index is reused
+			struct tcp_info_slot {
+				ConnHandle handle;
+				TcpInfoSample sample;
+			};
+			std::vector<tcp_info_slot> m_tcp_info;
+
 		public:
 			// ctors
-			TcpServer();
+			TcpServerBase();
+
+			TcpServerBase(const std::string &ip, const in_port_t &port);
 
-			TcpServer(const std::string &ip, const in_port_t &port);
+			// adopt a socket that is already bound and listening, e.g. HandoffState::listen_fd after a hot restart
+			explicit TcpServerBase(int listen_fd);
 
-			~TcpServer();
+			~TcpServerBase();
 
-			// adds udpclient to connection map
-			void add_client(const NetConnection &conn);
+			// adds client to the connection table, returns the handle items should carry
+			ConnHandle add_client(const NetConnection &conn);
 
 			bool add_client(const std::string &ip, const uint16_t &port);
 
-			// find client by socket descriptor
-			auto lookup_client(const std::string &ipaddr, const in_port_t &port);
+			// find client by address or socket descriptor, returns an invalid handle if not found
+			ConnHandle lookup_client(const std::string &ipaddr, const in_port_t &port);
+
+			ConnHandle lookup_client(int sockfd);
+
+			// copy of the connection record, false if the handle is unknown or stale
+			bool get_connection(ConnHandle handle, NetConnection &conn);
 
-			auto lookup_client(int sockfd);
+			// "ip:port" of the connection, formatted on demand
+			std::string peer_address(ConnHandle handle);
 
 			// remove client identified by
 			bool remove_client(const std::string &ipaddr, const in_port_t &port);
 
-			bool remove_client(const NetConnection &conn);
+			bool remove_client(ConnHandle handle);
 
-			// process methods
-			virtual bool process_item(QItem &item);
+			// process hooks, resolved on Derived at compile time
+			bool process_item(QItem &item);
 
-			virtual bool process_item(QItem &&item);
+			bool process_item(QItem &&item);
 
-			virtual bool process_select_timeout();
+			bool process_select_timeout();
 
 			// broadcast message to all active clients, returns number of clients succesfully sent out to
-			virtual int broadcast_data(const std::vector<uint8_t> &data);
+			int broadcast_data(const std::vector<uint8_t> &data);
 
 			// activate or deactivate bcast_mode
 			inline bool set_bcast_mode(bool is_set);
@@ -117,25 +253,132 @@ namespace jstd {
 			// clear client map
 			inline void clear_clients();
 
-			// sends generic network message to client with hash_id
+			// sends generic network message to the client item.conn refers to
 			bool send_item(const QItem &item);
 
 			// send message to connection associated with the socket descriptor
 			bool send_item(const QItem &item, const std::string &ipaddr, const in_port_t &port);
 
+			// raw bytes to the connection handle refers to, bypasses QItem serialization
+			bool send_to(ConnHandle handle, const uint8_t *data, size_t len);
+
+			// stream count bytes of file_fd from offset with sendfile(), ordered after earlier sends
+			bool send_file(ConnHandle handle, int file_fd, off_t offset, size_t count);
+
+			// shut the connection down, its handle goes stale
+			bool close_client(ConnHandle handle);
+
+			// stop serving the connection and hand its socket to the caller, who then owns (and closes) it
+			// returns -1 for unknown handles and on the io_uring backend, where an armed recv owns the socket
+			int release_client(ConnHandle handle);
+
 			// sets recv time out for blocking  recvfrom call
 			bool set_recv_timeout(int milli);
 
+			// record received frames and closes to capture, nullptr stops, the capture has to outlive the server
+			inline void set_capture(TrafficCapture *capture) { m_capture = capture; }
+
+			// log received data to wal and process it once committed, wal has to be open, must be called before
+			// run() or after attach(), replays the records wal recovered, the log has to be closed before the
+			// server goes away
+			bool set_wal(WriteAheadLog *wal);
+
+			// select how the recv thread waits on sockets, must be called before run()
+			// returns false if the backend is unavailable, IO_URING falls back to EPOLL in that case
+			bool set_io_backend(IO_BACKEND backend);
+
+			// process identical requests in flight once and fan the response out, must be called before run()
+			inline void set_coalescing(bool on) { m_coalesce = on; }
+
+			// answer repeated requests from cache, nullptr disables, must be called before run() and the cache has to
+			// outlive the server, one cache can serve several servers with the same process_item
+			inline void set_response_cache(ResponseCache *cache) { m_cache = cache; }
+
+			// neither look up nor store responses for conn, false if the handle is unknown or stale
+			bool set_cache_bypass(ConnHandle conn, bool bypass);
+
+			// shed queued items by deadline and/or CoDel, only threaded servers queue items
+			void set_load_shedding(const ShedConfig &cfg);
+
+			// FIFO or per connection deficit round robin with quantum messages/bytes per round (0 for the
+			// msg_queue.h default), only while nothing is queued, false otherwise
+			bool set_queue_discipline(QUEUE_DISCIPLINE discipline, uint32_t quantum = 0);
+
+			// depth and wait times of the connections with queued items
+			std::vector<FlowStats> queue_stats();
+
+			// stop reading, finish what was taken in and pass listener and clients to the successor on channel,
+			// the server is left without sockets. An InlinePolicy server has to be stopped (run() returned), an
+			// attached one is handed off from the loop thread. Not with io_uring, its armed recvs would consume
+			// bytes meant for the successor. false if the successor did not confirm, the server then serves on
+			// (a stopped InlinePolicy server needs run() again)
+			bool hand_off(HotRestart &channel);
+
+			// register the clients of a handed off state, after set_io_backend()/attach(), returns their count
+			size_t take_over(HandoffState &state);
+
+			// sample TCP_INFO of every client each cfg.interval_ms (0 stops), flag connections over its limits
+			// must be called before run() or after attach()
+			void set_tcp_info_sampling(const TcpInfoConfig &cfg);
+
+			// one sampling round now, returns the number of connections sampled
+			size_t sample_tcp_info();
+
+			// latest sample of the connection, false if the handle is unknown or stale or it was never sampled
+			bool get_tcp_info(ConnHandle handle, TcpInfoSample &sample);
+
+			// connections that were over a limit at their last sample
+			std::vector<ConnHandle> flagged_connections();
+
+			// copy of the counters
+			ServerStats stats();
+
+			inline IO_BACKEND get_io_backend() const { return m_io_backend; }
+
+#ifdef LINUX_OS
+			// serve from loop instead of run(), items are processed inline on the loop thread
+			// must be called from the loop thread or while the loop is not running
+			bool attach(EventLoop &loop);
+
+			// deregister the listener and every client socket from the loop
+			void detach();
+
+			inline bool is_attached() const { return m_loop != nullptr; }
+#else
+			inline bool is_attached() const { return false; }
+#endif
+
+			// a client was accepted and is being watched, default does nothing
+			void on_accept(ConnHandle conn);
+
+			// bytes read from a connection, valid for the duration of the call, default copies them into on_data()
+			void on_recv(const uint8_t *buff, size_t len, ConnHandle conn);
+
 			// process data from associated connection
-			virtual void on_data(std::vector<uint8_t> &&data, const NetConnection &conn);
+			void on_data(std::vector<uint8_t> &&data, ConnHandle conn);
+
+			// item dropped from the queue instead of processed (can send a NACK), runs on a worker, default discards it
+			void on_shed(QItem &&item, SHED_REASON reason);
+
+			// processing budget of item from enqueue in ms, 0 uses the ShedConfig default
+			unsigned item_deadline_ms(const QItem &item) const;
+
+			// pack per connection state for the successor into state during hand_off(), default packs nothing
+			void on_hand_off(ConnHandle conn, std::vector<uint8_t> &state);
+
+			// a client taken over from the previous process, state is what its on_hand_off packed
+			void on_take_over(ConnHandle conn, const std::vector<uint8_t> &state);
+
+			// a connection went over a TcpInfoConfig limit, on the sampling thread, default does nothing
+			void on_tcp_flagged(ConnHandle conn, const TcpInfoSample &sample);
 
 			// recvs msg and queues item for processing (thread)
 			void msg_recving();
 
-			// msg processing
-			void msg_processing();
+			// msg processing, worker is the index of the processing thread
+			void msg_processing(unsigned worker);
 
-			// run threads
+			// start the threads, with a non threaded policy this runs the recv loop until kill_threads()
 			bool run();
 
 			// make server run call blocking
@@ -144,18 +387,71 @@ namespace jstd {
 			// kill and join threads
 			void kill_threads();
 
-		private:
-			virtual QItem build_qitem(std::vector<uint8_t> &&data, const NetConnection &conn) const;
+		protected:
+			QItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const;
+
+			uint64_t hash_conn(const NetConnection &conn) const;
 
-			virtual uint64_t hash_conn(const NetConnection &conn) const;
+			uint64_t hash_conn(const std::string &ipaddr, const int &port) const;
 
-			virtual uint64_t hash_conn(const std::string &ipaddr, const int &port) const;
+			void handle_select_error();
 
-			inline bool _remove_client(const std::string &ipaddr, const int &port) noexcept;
+			inline Derived &derived() { return static_cast<Derived&>(*this); }
+
+			inline const Derived &derived() const { return static_cast<const Derived&>(*this); }
+
+		private:
+			// drop record and index entries, caller holds m_cmtx
+			bool _remove_client(ConnHandle handle);
+
+			// write a buffer to a resolved connection
+			bool send_data(const NetConnection &conn, const uint8_t *data, size_t len);
 
 			bool init_listen_socket();
 
-			void push_qitem(const QItem &item);
+			// stop reading and wait until every item taken in so far is processed
+			void quiesce();
+
+			// sampling thread of threaded policies
+			void tcp_info_sampling();
+
+			// sampling from an InlinePolicy recv loop, a round once it is due
+			inline void tcp_info_tick() {
+				if (ThreadPolicy::threaded || !m_tcp_cfg.interval_ms) return;
+				uint64_t now = tcp_info::now_ms();
+				if (now < m_tcp_info_due) return;
+				m_tcp_info_due = now + m_tcp_cfg.interval_ms;
+				sample_tcp_info();
+			}
+
+			// queue item for the processing threads, or process it right away when not threaded
+			// bytes is the size of the data the item was built from
+			void push_qitem(QItem &&item, uint32_t bytes, const item_ctx &ctx);
+
+			// process_item, then cache the response and, for a flight leader, end the flight and send the
+			// response to its waiters
+			bool process_entry(QItem &&item, const item_ctx &ctx);
+
+			// send the cached response to data when there is one, on a miss ctx gets the fingerprint of data
+			bool answer_from_cache(const std::vector<uint8_t> &data, ConnHandle conn, item_ctx &ctx);
+
+			// the leader of flight was shed, its waiters are shed with it
+			void shed_flight(uint64_t flight, SHED_REASON reason);
+
+			// copy of data when it goes to the connection of the item being captured on this thread
+			inline void capture_response(ConnHandle handle, const uint8_t *data, size_t len) const {
+				if (t_capture && t_capture->owner == this && t_capture->conn == handle)
+					t_capture->data.insert(t_capture->data.end(), data, data + len);
+			}
+
+			// append data to the log and hold its item until committed
+			void wal_append(std::vector<uint8_t> &&data, ConnHandle conn, item_ctx ctx);
+
+			// commit handler, runs on the log's commit thread
+			void wal_committed();
+
+			// pass the committed items on to processing
+			void wal_release();
 
 			std::vector<int> select_active_sockets();
 
@@ -163,7 +459,102 @@ namespace jstd {
 
 			void recv_data(int sockfd);
 
-			virtual void handle_select_error();
+			void recv_data(int sockfd, uint8_t *buff, size_t len);
+
+			// recv loops, one per IO_BACKEND
+			void select_recving();
+
+			void epoll_recving();
+
+			void uring_recving();
+
+			// start or stop waiting for data on a client socket with the active backend
+			void watch_fd(int sockfd);
+
+			void unwatch_fd(int sockfd);
+
+			// deregister, forget and close a client connection
+			void close_connection(int sockfd);
+
+#ifdef LINUX_OS
+			bool init_uring();
+
+			void arm_uring_recv(int sockfd);
+
+			void uring_complete(const io_uring_cqe &cqe);
+
+			bool uring_send_data(int sockfd, std::vector<uint8_t> &&data);
+
+			void uring_accept_complete(const io_uring_cqe &cqe);
+
+			void uring_recv_complete(const io_uring_cqe &cqe);
+
+			void uring_send_complete(const io_uring_cqe &cqe);
+
+			// queue a send of the front buffer of sockfd's queue, caller holds m_smtx
+			bool uring_prep_send(int sockfd, uring_send &pending);
+
+			// drop sockfd's queue, count the error and shut the socket down, caller holds m_smtx
+			void uring_send_failed(int sockfd);
+
+			// forget sockfd's queue when it is closed, caller holds m_smtx
+			void uring_drop_sends(int sockfd);
+#endif
+		};
+
+		/*
+		 * Runtime polymorphic server, every hook is virtual and forwards to the TcpServerBase default.
+		 * Costs an indirect call per hook invocation, derive from TcpServerBase when that matters.
+		 */
+		template<typename QItem, typename ThreadPolicy = DefaultThreadPolicy>
+		class TcpServer : public TcpServerBase<TcpServer<QItem, ThreadPolicy>, QItem, ThreadPolicy> {
+			typedef TcpServerBase<TcpServer<QItem, ThreadPolicy>, QItem, ThreadPolicy> Base;
+			friend Base;
+
+		public:
+			using Base::Base;
+
+			// stop the threads while the virtual hooks are still callable
+			virtual ~TcpServer() { this->kill_threads(); }
+
+			virtual bool process_item(QItem &item) { return Base::process_item(item); }
+
+			virtual bool process_item(QItem &&item) { return Base::process_item(std::move(item)); }
+
+			virtual bool process_select_timeout() { return Base::process_select_timeout(); }
+
+			virtual int broadcast_data(const std::vector<uint8_t> &data) { return Base::broadcast_data(data); }
+
+			virtual void on_accept(ConnHandle conn) { Base::on_accept(conn); }
+
+			virtual void on_recv(const uint8_t *buff, size_t len, ConnHandle conn) { Base::on_recv(buff, len, conn); }
+
+			virtual void on_data(std::vector<uint8_t> &&data, ConnHandle conn) { Base::on_data(std::move(data), conn); }
+
+			virtual void on_shed(QItem &&item, SHED_REASON reason) { Base::on_shed(std::move(item), reason); }
+
+			virtual unsigned item_deadline_ms(const QItem &item) const { return Base::item_deadline_ms(item); }
+
+			virtual void on_hand_off(ConnHandle conn, std::vector<uint8_t> &state) { Base::on_hand_off(conn, state); }
+
+			virtual void on_take_over(ConnHandle conn, const std::vector<uint8_t> &state) {
+				Base::on_take_over(conn, state);
+			}
+
+			virtual void on_tcp_flagged(ConnHandle conn, const TcpInfoSample &sample) { Base::on_tcp_flagged(conn, sample); }
+
+		protected:
+			virtual QItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+				return Base::build_qitem(std::move(data), conn);
+			}
+
+			virtual uint64_t hash_conn(const NetConnection &conn) const { return Base::hash_conn(conn); }
+
+			virtual uint64_t hash_conn(const std::string &ipaddr, const int &port) const {
+				return Base::hash_conn(ipaddr, port);
+			}
+
+			virtual void handle_select_error() { Base::handle_select_error(); }
 		};
 	}  // namespace net
 }  // namespace jstd
@@ -171,8 +562,12 @@ namespace jstd {
 
 
 // =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::init_listen_socket() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+thread_local typename jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::response_capture *
+	jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::t_capture = nullptr;
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::init_listen_socket() {
 	LOG_DEBUG(TSVR, "initializing listener socket");
 	int on;
 	int rc = bind(m_svr_conn.sockfd, (const struct sockaddr *) &m_svr_conn.sa, sizeof(m_svr_conn.sa));
@@ -206,11 +601,15 @@ bool jstd::net::TcpServer<QItem>::init_listen_socket() {
 }
 
 // default connection settings
-template<typename QItem>
-jstd::net::TcpServer<QItem>::TcpServer()
-	: m_qproc_active(false), m_recv_active(false), m_is_bcast(false) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::TcpServerBase()
+	: m_qproc_active(false), m_recv_active(false), m_io_backend(IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_uring_multishot(false), m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false),
+	  m_cache(nullptr), m_tcp_info_due(0), m_tcp_info_timer(-1) {
 	LOG_TRACE(TSVR);
-	m_svr_conn.ip_addr = LOCALHOSTIP;
 	m_svr_conn.sock_type = SOCK_STREAM;
 	m_svr_conn.sa.sin_port = DEFAULT_TCP_SERVER_PORT;
 	if (!inet_aton(LOCALHOSTIP, &m_svr_conn.sa.sin_addr)) {
@@ -229,14 +628,19 @@ jstd::net::TcpServer<QItem>::TcpServer()
 	}
 }
 
-template<typename QItem>
-jstd::net::TcpServer<QItem>::TcpServer(const std::string &ip, const in_port_t &port)
-	: m_qproc_active(false), m_recv_active(false), m_is_bcast(false) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::TcpServerBase(const std::string &ip, const in_port_t &port)
+	: m_qproc_active(false), m_recv_active(false), m_io_backend(IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_uring_multishot(false), m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false),
+	  m_cache(nullptr), m_tcp_info_due(0), m_tcp_info_timer(-1) {
 	LOG_TRACE(TSVR);
-	m_svr_conn.ip_addr = ip;
 	m_svr_conn.sock_type = SOCK_STREAM;
 	m_svr_conn.sa.sin_port = htons(port);
-	if (inet_aton(m_svr_conn.ip_addr.c_str(), &m_svr_conn.sa.sin_addr) == 0) {
+	m_svr_conn.port = port;
+	if (inet_aton(ip.c_str(), &m_svr_conn.sa.sin_addr) == 0) {
 		LOG_ERROR(TSVR, "invalid ip address supplied errno #", errno, " descr: ", sockErrToString(errno));
 		util::chrono::sleep_milli(1000);
 		std::exit((static_cast<int>(FATAL_ERR::IP_INET_FAIL)));
@@ -254,32 +658,57 @@ jstd::net::TcpServer<QItem>::TcpServer(const std::string &ip, const in_port_t &p
 	}
 }
 
-template<typename QItem>
-jstd::net::TcpServer<QItem>::~TcpServer() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::TcpServerBase(int listen_fd)
+	: m_qproc_active(false), m_recv_active(false), m_io_backend(IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_uring_multishot(false), m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false),
+	  m_cache(nullptr), m_tcp_info_due(0), m_tcp_info_timer(-1) {
+	LOG_TRACE(TSVR);
+	m_svr_conn.sock_type = SOCK_STREAM;
+	m_svr_conn.sockfd = listen_fd;
+	if (listen_fd < 0 || getsockname(listen_fd, (struct sockaddr *) &m_svr_conn.sa, &m_svr_conn.addr_len) < 0) {
+		LOG_ERROR(TSVR, "can not adopt listening socket ", listen_fd, " errno #", errno, " descr: ", sockErrToString(errno));
+		util::chrono::sleep_milli(1000);
+		std::exit((static_cast<int>(FATAL_ERR::SOCK_FAIL)));
+	}
+	m_svr_conn.port = ntohs(m_svr_conn.sa.sin_port);
+	m_fd_sets.add_fd(listen_fd);
+	LOG_INFO(TSVR, "adopted listening socket ", m_svr_conn.to_string());
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::~TcpServerBase() {
 	LOG_TRACE(TSVR);
 	kill_threads();
 	logger::get_instance().stopLogging();
 }
 
-template<typename QItem>
-uint64_t jstd::net::TcpServer<QItem>::hash_conn(const NetConnection &conn) const {
-	return std::hash<int>{}(conn.sockfd);
+// binary address and port, no string building per lookup
+template<typename Derived, typename QItem, typename ThreadPolicy>
+uint64_t jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::hash_conn(const NetConnection &conn) const {
+	return std::hash<uint64_t>{}((static_cast<uint64_t>(conn.sa.sin_addr.s_addr) << 16) | conn.sa.sin_port);
 }
 
-template<typename QItem>
-uint64_t jstd::net::TcpServer<QItem>::hash_conn(const std::string &ipaddr, const int &port) const {
-	return std::hash<std::string>{}(ipaddr + std::to_string(port));
+template<typename Derived, typename QItem, typename ThreadPolicy>
+uint64_t jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::hash_conn(const std::string &ipaddr, const int &port) const {
+	NetConnection conn;
+	inet_aton(ipaddr.c_str(), &conn.sa.sin_addr);
+	conn.sa.sin_port = htons(static_cast<uint16_t>(port));
+	return derived().hash_conn(conn);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::add_client(const std::string &ip, const uint16_t &port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::add_client(const std::string &ip, const uint16_t &port) {
 	LOG_TRACE(TSVR);
 	NetConnection conn;
-	conn.ip_addr = ip;
 	conn.sock_type = SOCK_STREAM;
-	conn.sa.sin_port = port;
+	conn.sa.sin_port = htons(port);
+	conn.port = port;
 	conn.sa.sin_family = AF_INET;
-	if (inet_aton(conn.ip_addr.c_str(), &conn.sa.sin_addr) < 0) {
+	if (inet_aton(ip.c_str(), &conn.sa.sin_addr) == 0) {
 		LOG_ERROR(TSVR, "there was an error converting ip str:", ip, " to binary form");
 		return false;
 	}
@@ -297,20 +726,65 @@ bool jstd::net::TcpServer<QItem>::add_client(const std::string &ip, const uint16
 	return true;
 }
 
-// add client only if not currently in map, overwrites if on same ip and port
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::add_client(const NetConnection &conn) {
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-	LOG_DEBUG(TSVR, "adding new client with ip: ", conn.ip_addr, " port: ", htons(conn.port));
-	m_client_connections[hash_conn(conn)] = conn;
-	m_stats.clients_added_cnt++;
-	m_fd_sets.add_fd(conn.sockfd);
+// add client to the table, a previous client on the same descriptor or ip and port is replaced
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ConnHandle jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::add_client(const NetConnection &conn) {
+	ConnHandle handle;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		if (conn.sockfd >= 0 && static_cast<size_t>(conn.sockfd) < m_fd_handles.size())
+			_remove_client(m_fd_handles[conn.sockfd]);
+		auto prev = m_addr_index.find(derived().hash_conn(conn));
+		if (prev != m_addr_index.end())
+			_remove_client(prev->second);
+		handle = m_clients.insert(conn);
+		if (conn.sockfd >= 0) {
+			if (static_cast<size_t>(conn.sockfd) >= m_fd_handles.size())
+				m_fd_handles.resize(conn.sockfd + 1);
+			m_fd_handles[conn.sockfd] = handle;
+		}
+		m_addr_index[derived().hash_conn(conn)] = handle;
+		m_stats.clients_added_cnt++;
+	}
+	LOG_DEBUG(TSVR, "adding new client ", conn.to_string(), " handle: ", handle);
+	watch_fd(conn.sockfd);
+	return handle;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::_remove_client(ConnHandle handle) {
+	const NetConnection *conn = m_clients.find(handle);
+	if (!conn) return false;
+	if (conn->sockfd >= 0 && static_cast<size_t>(conn->sockfd) < m_fd_handles.size() &&
+		m_fd_handles[conn->sockfd] == handle)
+		m_fd_handles[conn->sockfd] = ConnHandle();
+	auto it = m_addr_index.find(derived().hash_conn(*conn));
+	if (it != m_addr_index.end() && it->second == handle)
+		m_addr_index.erase(it);
+	m_clients.erase(handle);
+	m_stats.clients_removed_cnt++;
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::get_connection(ConnHandle handle, NetConnection &conn) {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	const NetConnection *rec = m_clients.find(handle);
+	if (!rec) return false;
+	conn = *rec;
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::string jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::peer_address(ConnHandle handle) {
+	NetConnection conn;
+	return get_connection(handle, conn) ? conn.to_string() : std::string("unknown");
 }
 
 // process item off the msg queue
 // assumes item has valid connection information
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::process_item(QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::process_item(QItem &item) {
 	LOG_TRACE(TSVR);
 	LOG_INFO(TSVR, "processing item recvd:\n", item);
 	std::stringstream ss;
@@ -323,8 +797,8 @@ bool jstd::net::TcpServer<QItem>::process_item(QItem &item) {
 	return send_item(resp);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::process_item(QItem&& item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::process_item(QItem&& item) {
 	LOG_TRACE(TSVR);
 	LOG_INFO(TSVR, "processing rval ref item recvd:\n", item);
 	std::stringstream ss;
@@ -337,16 +811,35 @@ bool jstd::net::TcpServer<QItem>::process_item(QItem&& item) {
 	return send_item(resp);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::send_item(const QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::send_item(const QItem &item) {
 	LOG_TRACE(TSVR);
 	std::vector<uint8_t> outBoundBuff = item.serialize();
+	capture_response(item.conn, outBoundBuff.data(), outBoundBuff.size());
 	if (m_is_bcast) {
-		int num_clients = broadcast_data(outBoundBuff);
+		int num_clients = derived().broadcast_data(outBoundBuff);
 		LOG_DEBUG(TSVR, num_clients, " have been broadcasted data");
 		return true;
 	}
-	ssize_t bytes_sent = send(item.conn.sockfd, outBoundBuff.data(), outBoundBuff.size(), 0);
+	NetConnection conn;
+	if (!get_connection(item.conn, conn)) {
+		LOG_WARNING(TSVR, "connection handle ", item.conn, " is stale, not sending message");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING)
+		return uring_send_data(conn.sockfd, std::move(outBoundBuff));
+#endif
+	return send_data(conn, outBoundBuff.data(), outBoundBuff.size());
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::send_data(const NetConnection &conn, const uint8_t *data, size_t len) {
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING)
+		return uring_send_data(conn.sockfd, std::vector<uint8_t>(data, data + len));
+#endif
+	ssize_t bytes_sent = send(conn.sockfd, data, len, MSG_NOSIGNAL);
 	if (bytes_sent == SOCKET_ERROR) {
 		LOG_ERROR(TSVR,
 		          "failed to send data, errno# ",
@@ -356,41 +849,128 @@ bool jstd::net::TcpServer<QItem>::send_item(const QItem &item) {
 		return false;
 	} else if (bytes_sent == 0) {
 		LOG_WARNING(TSVR, "client is no longer connected, removing connection from client map :(");
-		LOG_DEBUG(TSVR, (remove_client(item.conn)) ? "successfully removed client":"failed to remove client");
-	}
-	LOG_INFO(TSVR,
-	         "successfully sent out ",
-	         bytes_sent,
-	         " bytes of data to ",
-	         item.conn.ip_addr,
-	         ":",
-	         item.conn.sa.sin_port);
+		LOG_DEBUG(TSVR, (remove_client(conn.handle)) ? "successfully removed client":"failed to remove client");
+	}
+	LOG_INFO(TSVR, "successfully sent out ", bytes_sent, " bytes of data to ", conn.to_string());
 	return true;
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::send_item(const QItem &item, const std::string& ipaddr, const in_port_t& port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::send_item(const QItem &item, const std::string& ipaddr, const in_port_t& port) {
 	LOG_TRACE(TSVR);
 	if (m_is_bcast) {
-		int num_clients = broadcast_data(item.serialize());
+		int num_clients = derived().broadcast_data(item.serialize());
 		LOG_DEBUG(TSVR, num_clients, " clients have been broadcasted data to");
 		return true;
 	}
-	auto client_it = lookup_client(ipaddr, port);
-	if (client_it == m_client_connections.end()) {
+	NetConnection conn;
+	if (!get_connection(lookup_client(ipaddr, port), conn)) {
 		LOG_ERROR(TSVR, "client not found, not sending message");
 		return false;
 	}
-	item.conn = client_it->second;
-	return send_item(item);
+	std::vector<uint8_t> outBoundBuff = item.serialize();
+	return send_data(conn, outBoundBuff.data(), outBoundBuff.size());
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::send_to(ConnHandle handle, const uint8_t *data, size_t len) {
+	capture_response(handle, data, len);
+	NetConnection conn;
+	if (!get_connection(handle, conn)) {
+		LOG_WARNING(TSVR, "connection handle ", handle, " is stale, not sending data");
+		return false;
+	}
+	return send_data(conn, data, len);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::set_bcast_mode(bool is_set) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::send_file(ConnHandle handle, int file_fd, off_t offset, size_t count) {
+	if (t_capture && t_capture->owner == this && t_capture->conn == handle) {
+		std::vector<uint8_t> data(count);
+		ssize_t n = pread(file_fd, data.data(), count, offset);
+		if (n > 0) capture_response(handle, data.data(), static_cast<size_t>(n));
+	}
+	NetConnection conn;
+	if (!get_connection(handle, conn)) {
+		LOG_WARNING(TSVR, "connection handle ", handle, " is stale, not sending file");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING) {
+		// earlier sends may still be queued on the ring, a direct sendfile() could overtake them
+		std::vector<uint8_t> data(count);
+		ssize_t n = pread(file_fd, data.data(), count, offset);
+		if (n < 0) {
+			LOG_ERROR(TSVR, "failed to read file for sending, errno# ", errno, " descr: ", sockErrToString(errno));
+			return false;
+		}
+		data.resize(static_cast<size_t>(n));
+		return uring_send_data(conn.sockfd, std::move(data));
+	}
+#endif
+	while (count > 0) {
+#ifdef LINUX_OS
+		ssize_t n = sendfile(conn.sockfd, file_fd, &offset, count);
+#else
+		uint8_t buff[MAX_BUFF_SIZE];
+		ssize_t n = pread(file_fd, buff, std::min(count, sizeof(buff)), offset);
+		if (n > 0) {
+			n = send(conn.sockfd, buff, static_cast<size_t>(n), MSG_NOSIGNAL);
+			if (n > 0) offset += n;
+		}
+#endif
+		if (n == 0) break;   // file shorter than advertised
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				pollfd pfd{conn.sockfd, POLLOUT, 0};
+				poll(&pfd, 1, DEFAULT_TCP_RECV_TIMEOUT_MILLI);
+				continue;
+			}
+			LOG_ERROR(TSVR, "failed to send file, errno# ", errno, " descr: ", sockErrToString(errno));
+			return false;
+		}
+		count -= static_cast<size_t>(n);
+	}
+	return count == 0;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::close_client(ConnHandle handle) {
+	NetConnection conn;
+	if (!get_connection(handle, conn)) return false;
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING && !is_attached()) {
+		// the armed recv completes with 0 and close_connection() runs from the completion
+		shutdown(conn.sockfd, SHUT_RDWR);
+		return true;
+	}
+#endif
+	close_connection(conn.sockfd);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+int jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::release_client(ConnHandle handle) {
+	NetConnection conn;
+	if (!get_connection(handle, conn)) return -1;
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING && !is_attached()) {
+		LOG_WARNING(TSVR, "io_uring backend can not release connections, sockfd: ", conn.sockfd);
+		return -1;
+	}
+#endif
+	unwatch_fd(conn.sockfd);
+	remove_client(handle);
+	LOG_DEBUG(TSVR, "released connection ", conn.to_string());
+	return conn.sockfd;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_bcast_mode(bool is_set) {
 	LOG_TRACE(TSVR);
 	if (is_set) {
-		LOG_INFO(TSVR, "setting server to broadcast mode, current client count: ",
-		         m_client_connections.size());
+		LOG_INFO(TSVR, "setting server to broadcast mode, current client count: ", m_clients.size());
 	} else {
 		LOG_INFO(TSVR, "disabling broadcast mode on server");
 	}
@@ -398,48 +978,52 @@ bool jstd::net::TcpServer<QItem>::set_bcast_mode(bool is_set) {
 	return is_set;
 }
 
-template<typename QItem>
-int jstd::net::TcpServer<QItem>::broadcast_data(const std::vector<uint8_t> &data) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+int jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::broadcast_data(const std::vector<uint8_t> &data) {
 	LOG_TRACE(TSVR);
 	if (data.empty()) {
 		LOG_WARNING(TSVR, "data buffer empty, not bcasting data");
 		return 0;
 	}
-	QItem item;
+	// snapshot the (trivially copyable) records so sends happen outside the client lock
+	std::vector<NetConnection> clients;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		clients.reserve(m_clients.size());
+		m_clients.for_each([&clients](const NetConnection &conn) { clients.push_back(conn); });
+	}
 	int client_cnt = 0;
-	item.buff = data;
-	LOG_DEBUG(TSVR, "broadcasting data to ", m_client_connections.size(), " clients");
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-	for (const auto &client : m_client_connections) {
-		item.conn = client.second;
-		if (send_item(item)) {
+	LOG_DEBUG(TSVR, "broadcasting data to ", clients.size(), " clients");
+	for (const auto &client : clients) {
+		if (send_data(client, data.data(), data.size())) {
 			client_cnt++;
 		} else {
-			LOG_WARNING(TSVR, "removing client: ", item.conn.ip_addr, ":", item.conn.sa.sin_port);
-			_remove_client(item.conn.ip_addr, item.conn.sa.sin_port);
+			LOG_WARNING(TSVR, "removing client: ", client.to_string());
+			remove_client(client.handle);
 		}
 	}
-	LOG_DEBUG(TSVR, "successfully sent data to ",
-	          client_cnt, "/", m_client_connections.size(), " clients");
+	LOG_DEBUG(TSVR, "successfully sent data to ", client_cnt, "/", clients.size(), " clients");
 	return client_cnt;
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::clear_clients() {
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-	m_client_connections.clear();
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::clear_clients() {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	m_clients.clear();
+	m_fd_handles.clear();
+	m_addr_index.clear();
 }
 
-template<typename QItem>
-QItem jstd::net::TcpServer<QItem>::build_qitem(std::vector<uint8_t>&& data, const NetConnection& conn) const {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+QItem jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::build_qitem(std::vector<uint8_t>&& data, ConnHandle conn) const {
 	QItem item;
 	item.conn = conn;
 	item.buff = std::move(data);
 	return item;
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::set_recv_timeout(int milli) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_recv_timeout(int milli) {
 	LOG_TRACE(TSVR);
 	// if zero timeout val then no timeout
 	// m_fd_sets.set_timeout_ms(milli);
@@ -447,46 +1031,71 @@ bool jstd::net::TcpServer<QItem>::set_recv_timeout(int milli) {
 	return true;
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::msg_recving() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::msg_recving() {
 	LOG_TRACE(TSVR);
 	LOG_DEBUG(TSVR, "message receiving thread started");
-	uint8_t buff[MAX_BUFF_SIZE];
-	std::memset(buff, 0, MAX_BUFF_SIZE);
+	switch (m_io_backend) {
+		case IO_BACKEND::IO_URING:
+			uring_recving();
+			break;
+		case IO_BACKEND::EPOLL:
+			epoll_recving();
+			break;
+		default:
+			select_recving();
+			break;
+	}
+	LOG_DEBUG(TSVR, "exiting message recv thread...");
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::select_recving() {
+	LOG_TRACE(TSVR);
+	// accept_new_connection() drains the backlog until EAGAIN
+	fcntl(m_svr_conn.sockfd, F_SETFL, fcntl(m_svr_conn.sockfd, F_GETFL) | O_NONBLOCK);
 	m_fd_sets.add_fd(m_svr_conn.sockfd);
 	while (m_recv_active) {
+		tcp_info_tick();
 		std::vector<int> active_sockfds = select_active_sockets();
-		std::cout << "num active sockets: " << active_sockfds.size() << std::endl; 
+		LOG_DEBUG(TSVR, "num active sockets: ", active_sockfds.size());
 		for (const auto sockfd : active_sockfds) {
 			if (sockfd == m_svr_conn.sockfd) // listener socket is active
 				accept_new_connection(sockfd);
 			else if (sockfd == SELECT_TIMEOUT)
-				process_select_timeout();
+				derived().process_select_timeout();
 			else if (sockfd == SOCKET_ERROR)
-				handle_select_error();
+				derived().handle_select_error();
 			else
 				recv_data(sockfd);
 		}
 	}
-	LOG_DEBUG(TSVR, "exiting message recv thread...");
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::recv_data(int sockfd) {
-	LOG_TRACE(TSVR);
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::recv_data(int sockfd) {
 	uint8_t buff[MAX_BUFF_SIZE];
-	ssize_t len = recv(sockfd, buff, MAX_BUFF_SIZE, 0);
+	recv_data(sockfd, buff, MAX_BUFF_SIZE);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::recv_data(int sockfd, uint8_t *buff, size_t buff_len) {
+	LOG_TRACE(TSVR);
+	ssize_t len = recv(sockfd, buff, buff_len, 0);
 	if (len > 0) {
-		auto conn_entry = lookup_client(sockfd);
-		if (conn_entry == m_client_connections.end()) {
+		ConnHandle handle = lookup_client(sockfd);
+		if (!handle.is_valid()) {
 			LOG_WARNING(TSVR, "connection associated with recvd data not found, not processing data");
 			return;
 		}
-		on_data(std::vector<uint8_t>(buff, buff + len), conn_entry->second);
+		if (TrafficCapture *cap = m_capture.load(std::memory_order_relaxed))
+			cap->record(CAPTURE_PROTO::TCP, handle.value, buff, static_cast<size_t>(len));
+		derived().on_recv(buff, static_cast<size_t>(len), handle);
 	} else if (len == 0) {
 		LOG_DEBUG(TSVR, "connection has been closed by client");
-		m_fd_sets.clear_fd(sockfd);
+		close_connection(sockfd);
 	} else if (len == SOCKET_ERROR) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
 		LOG_ERROR(TSVR, "an error occured receiving data :( errno: ", errno, " descr: ", sockErrToString(errno));
 	}
 	else {
@@ -494,69 +1103,552 @@ void jstd::net::TcpServer<QItem>::recv_data(int sockfd) {
 	}
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::on_data(std::vector<uint8_t>&& data, const NetConnection& conn) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_accept(ConnHandle) { }
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_recv(const uint8_t *buff, size_t len, ConnHandle conn) {
+	derived().on_data(std::vector<uint8_t>(buff, buff + len), conn);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_data(std::vector<uint8_t>&& data, ConnHandle conn) {
 	LOG_DEBUG(TSVR, "building qitem for processing. A ", data.size(), " byte tcp packet");
-	auto item = build_qitem(std::move(data), conn);
-	push_qitem(item);
+	item_ctx ctx{0, 0, 0, 0};
+	if (m_cache && answer_from_cache(data, conn, ctx)) return;
+	if (m_coalesce) {
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		if (m_coalescer.join(data.data(), data.size(), conn, ctx.flight) == COALESCE::JOINED) return;
+	}
+	if (m_wal) {
+		wal_append(std::move(data), conn, ctx);
+		return;
+	}
+	uint32_t bytes = static_cast<uint32_t>(data.size());
+	push_qitem(derived().build_qitem(std::move(data), conn), bytes, ctx);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_shed(QItem &&item, SHED_REASON reason) {
+	LOG_DEBUG(TSVR, "shed item of ", item.conn, reason == SHED_REASON::DEADLINE ? ", deadline passed" : ", queue delay");
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::msg_processing() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+unsigned jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::item_deadline_ms(const QItem &) const {
+	return 0;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_hand_off(ConnHandle, std::vector<uint8_t> &) { }
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_take_over(ConnHandle, const std::vector<uint8_t> &) { }
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::on_tcp_flagged(ConnHandle, const TcpInfoSample &) { }
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::msg_processing(unsigned worker) {
 	LOG_TRACE(TSVR);
-	LOG_DEBUG(TSVR, "message processing thread started");
+	LOG_DEBUG(TSVR, "message processing thread ", worker, " started");
+	ThreadPolicy::on_worker_start(worker);
+	typename MsgQueue<queued_item>::shed_list shed;
 	while (m_qproc_active) {
-		util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
-		if (!m_msg_queue.empty()) {
-			if ( process_item(std::move(m_msg_queue.front())) )
-				m_stats.msg_processed_cnt++;
-			m_qmtx.lock();
-			m_msg_queue.pop();
-			m_qmtx.unlock();
+		queued_item entry;
+		bool have_item;
+		{
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			uint64_t sojourn_us = 0;
+			have_item = m_msg_queue.pop(entry, sojourn_us, shed);
+			if (have_item) m_stats.sojourn_us.record(sojourn_us);
+			for (const auto &s : shed) {
+				if (s.second == SHED_REASON::DEADLINE) m_stats.shed_deadline_cnt++;
+				else m_stats.shed_delay_cnt++;
+			}
 		}
+		for (auto &s : shed) {
+			derived().on_shed(std::move(s.first.item), s.second);
+			if (s.first.ctx.flight) shed_flight(s.first.ctx.flight, s.second);
+			if (s.first.ctx.wal_seq) m_wal->complete(s.first.ctx.wal_seq);
+		}
+		shed.clear();
+		if (!have_item) {
+			util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
+			continue;
+		}
+		if (process_entry(std::move(entry.item), entry.ctx)) {
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			m_stats.msg_processed_cnt++;
+		}
+		if (entry.ctx.wal_seq) m_wal->complete(entry.ctx.wal_seq);
 	}
-	LOG_DEBUG(TSVR, "terminating message processing thread");
+	LOG_DEBUG(TSVR, "terminating message processing thread ", worker);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::run() {
-	LOG_DEBUG(TSVR, "starting message receiving and item processing thread");
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::run() {
 	m_qproc_active = true;
 	m_recv_active = true;
-	m_recv_thread = std::thread(&TcpServer::msg_recving, this);
-	m_q_proc_thread = std::thread(&TcpServer::msg_processing, this);
+	if (!ThreadPolicy::threaded) {
+		LOG_DEBUG(TSVR, "running receive loop inline, items are processed as they arrive");
+		msg_recving();
+		return true;
+	}
+	LOG_DEBUG(TSVR, "starting message receiving and ", ThreadPolicy::worker_count(), " item processing thread(s)");
+	m_recv_thread = std::thread(&TcpServerBase::msg_recving, this);
+	for (unsigned i = 0; i < ThreadPolicy::worker_count(); i++)
+		m_workers.emplace_back(&TcpServerBase::msg_processing, this, i);
+	if (m_tcp_cfg.interval_ms) m_tcp_info_thread = std::thread(&TcpServerBase::tcp_info_sampling, this);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::push_qitem(QItem &&item, uint32_t bytes, const item_ctx &ctx) {
+	LOG_TRACE(TSVR);
+	if (!ThreadPolicy::threaded || is_attached()) {
+		if (process_entry(std::move(item), ctx))
+			m_stats.msg_processed_cnt++;
+		if (ctx.wal_seq) m_wal->complete(ctx.wal_seq);
+		return;
+	}
+	unsigned deadline_ms = derived().item_deadline_ms(item);
+	uint64_t flow = item.conn.value;
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_msg_queue.push(queued_item{std::move(item), ctx}, flow, bytes, deadline_ms);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::process_entry(QItem &&item, const item_ctx &ctx) {
+	if (!ctx.flight && !ctx.cache_key) return derived().process_item(std::move(item));
+	response_capture capture{this, item.conn, std::vector<uint8_t>()};
+	response_capture *outer = t_capture;
+	t_capture = &capture;
+	bool processed = derived().process_item(std::move(item));
+	t_capture = outer;
+	if (processed && ctx.cache_key && !capture.data.empty())
+		m_cache->insert(ctx.cache_key, ctx.cache_check, capture.data.data(), capture.data.size());
+	if (!ctx.flight) return processed;
+	// waiters attach until the flight ends, anything joining later starts a flight of its own
+	RequestCoalescer::Flight f;
+	{
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		m_coalescer.finish(ctx.flight, f);
+	}
+	if (f.waiters.empty()) return processed;
+	if (capture.data.empty())
+		LOG_DEBUG(TSVR, "nothing was sent for the request, its ", f.waiters.size(), " waiter(s) get no response");
+	else
+		for (ConnHandle waiter : f.waiters)
+			send_to(waiter, capture.data.data(), capture.data.size());
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_stats.coalesced_cnt += f.waiters.size();
+	return processed;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::answer_from_cache(const std::vector<uint8_t> &data,
+                                                                            ConnHandle conn, item_ctx &ctx) {
+	NetConnection c;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		const NetConnection *rec = m_clients.find(conn);
+		if (!rec || is_cache_bypassed(conn)) return false;
+		c = *rec;
+	}
+	ResponseCache::fingerprint(data.data(), data.size(), ctx.cache_key, ctx.cache_check);
+	if (!m_cache->lookup(ctx.cache_key, ctx.cache_check, m_cache_hit)) return false;
+	send_data(c, m_cache_hit.data(), m_cache_hit.size());
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_cache_bypass(ConnHandle conn, bool bypass) {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	if (!m_clients.find(conn)) return false;
+	if (conn.index() >= m_cache_bypass.size()) m_cache_bypass.resize(conn.index() + 1);
+	m_cache_bypass[conn.index()] = bypass ? conn : ConnHandle();
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::shed_flight(uint64_t flight, SHED_REASON reason) {
+	RequestCoalescer::Flight f;
+	{
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		m_coalescer.finish(flight, f);
+	}
+	for (ConnHandle waiter : f.waiters)
+		derived().on_shed(derived().build_qitem(std::vector<uint8_t>(f.payload), waiter), reason);
+	if (f.waiters.empty()) return;
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	if (reason == SHED_REASON::DEADLINE) m_stats.shed_deadline_cnt += f.waiters.size();
+	else m_stats.shed_delay_cnt += f.waiters.size();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_queue_discipline(QUEUE_DISCIPLINE discipline, uint32_t quantum) {
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	if (!m_msg_queue.empty()) {
+		LOG_WARNING(TSVR, "items are queued, queue discipline left unchanged");
+		return false;
+	}
+	m_msg_queue.set_discipline(discipline, quantum);
 	return true;
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::push_qitem(const QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::vector<jstd::net::FlowStats> jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::queue_stats() {
+	std::vector<FlowStats> flows;
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_msg_queue.flow_stats(flows);
+	return flows;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_load_shedding(const ShedConfig &cfg) {
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_msg_queue.configure(cfg);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_tcp_info_sampling(const TcpInfoConfig &cfg) {
+	m_tcp_cfg = cfg;
+	m_tcp_info_due = 0;
+#ifdef LINUX_OS
+	if (!m_loop) return;
+	if (m_tcp_info_timer >= 0) m_loop->cancel_timer(m_tcp_info_timer);
+	m_tcp_info_timer = cfg.interval_ms ? m_loop->add_timer(cfg.interval_ms, true, [this]() { sample_tcp_info(); }) : -1;
+#endif
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+size_t jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::sample_tcp_info() {
+	std::vector<std::pair<ConnHandle, int>> conns;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		conns.reserve(m_clients.size());
+		m_clients.for_each([&conns](const NetConnection &conn) {
+			if (conn.sockfd >= 0) conns.emplace_back(conn.handle, conn.sockfd);
+		});
+	}
+	// the syscalls run without the client lock, a record closed meanwhile is skipped when storing
+	uint64_t now = tcp_info::now_ms();
+	std::vector<TcpInfoSample> samples(conns.size());
+	std::vector<bool> sampled(conns.size());
+	for (size_t i = 0; i < conns.size(); i++) {
+		sampled[i] = tcp_info::sample(conns[i].second, samples[i], now);
+		if (sampled[i]) samples[i].flagged = tcp_info::over_limits(samples[i], m_tcp_cfg);
+	}
+	ServerStats agg;
+	std::vector<size_t> newly_flagged;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		for (size_t i = 0; i < conns.size(); i++) {
+			ConnHandle handle = conns[i].first;
+			const NetConnection *conn = m_clients.find(handle);
+			if (!sampled[i] || !conn || conn->sockfd != conns[i].second) continue;
+			if (handle.index() >= m_tcp_info.size()) m_tcp_info.resize(handle.index() + 1);
+			tcp_info_slot &slot = m_tcp_info[handle.index()];
+			bool was_flagged = slot.handle == handle && slot.sample.flagged;
+			if (samples[i].flagged && !was_flagged) newly_flagged.push_back(i);
+			slot.handle = handle;
+			slot.sample = samples[i];
+			agg.tcp_sampled_cnt++;
+			agg.tcp_flagged_cnt += samples[i].flagged;
+			agg.tcp_retrans_cnt += samples[i].total_retrans;
+			agg.tcp_send_queue_max = std::max(agg.tcp_send_queue_max, samples[i].send_queue_bytes());
+			agg.tcp_rtt_us.record(samples[i].rtt_us);
+		}
+	}
+	{
+		std::lock_guard<mutex_type> lckm(m_qmtx);
+		m_stats.tcp_sampled_cnt = agg.tcp_sampled_cnt;
+		m_stats.tcp_flagged_cnt = agg.tcp_flagged_cnt;
+		m_stats.tcp_retrans_cnt = agg.tcp_retrans_cnt;
+		m_stats.tcp_send_queue_max = agg.tcp_send_queue_max;
+		m_stats.tcp_rtt_us = agg.tcp_rtt_us;
+	}
+	for (size_t i : newly_flagged) {
+		LOG_DEBUG(TSVR, "connection ", conns[i].first, " over its limits, rtt us: ", samples[i].rtt_us,
+		          " send queue: ", samples[i].send_queue_bytes());
+		derived().on_tcp_flagged(conns[i].first, samples[i]);
+	}
+	return static_cast<size_t>(agg.tcp_sampled_cnt);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::get_tcp_info(ConnHandle handle, TcpInfoSample &sample) {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	if (!m_clients.find(handle) || handle.index() >= m_tcp_info.size()) return false;
+	const tcp_info_slot &slot = m_tcp_info[handle.index()];
+	if (slot.handle != handle || !slot.sample.sampled_ms) return false;
+	sample = slot.sample;
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::vector<jstd::net::ConnHandle> jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::flagged_connections() {
+	std::vector<ConnHandle> out;
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	for (const auto &slot : m_tcp_info)
+		if (slot.sample.flagged && m_clients.find(slot.handle)) out.push_back(slot.handle);
+	return out;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::tcp_info_sampling() {
+	LOG_DEBUG(TSVR, "TCP_INFO sampling thread started, every ", m_tcp_cfg.interval_ms, "ms");
+	uint64_t due = tcp_info::now_ms() + m_tcp_cfg.interval_ms;
+	while (m_recv_active) {
+		// short naps so a stopping server is not held up by a long interval
+		uint64_t now = tcp_info::now_ms();
+		if (now < due) {
+			util::chrono::sleep_milli(static_cast<int>(std::min<uint64_t>(due - now, DEFAULT_EPOLL_TIMEOUT_MILLI)));
+			continue;
+		}
+		due = now + m_tcp_cfg.interval_ms;
+		sample_tcp_info();
+	}
+	LOG_DEBUG(TSVR, "terminating TCP_INFO sampling thread");
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ServerStats jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::stats() {
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	return m_stats;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_wal(WriteAheadLog *wal) {
 	LOG_TRACE(TSVR);
-	std::lock_guard<std::mutex> lckm(m_qmtx);
-	m_msg_queue.push(item);
+	if (!wal || !wal->is_open()) {
+		LOG_ERROR(TSVR, "write ahead log is not open");
+		return false;
+	}
+	if (!ThreadPolicy::threaded && !is_attached()) {
+		// commits complete on the log's thread, without workers or a loop to hand items to they would stall
+		LOG_ERROR(TSVR, "a write ahead log needs a threaded policy or an attached server");
+		return false;
+	}
+	if (m_wal) {
+		LOG_WARNING(TSVR, "write ahead log already set");
+		return false;
+	}
+	m_wal = wal;
+#ifdef LINUX_OS
+	if (m_loop) m_wal_event = m_loop->add_event([this]() { wal_release(); });
+#endif
+	wal->set_commit_handler([this](uint64_t) { wal_committed(); });
+	size_t replayed = wal->replay([this](uint64_t seq, const uint8_t *data, size_t len) {
+		std::lock_guard<std::mutex> lck(m_wal_mtx);
+		m_wal_pending.push_back(wal_item{static_cast<uint32_t>(len), item_ctx{seq, 0, 0, 0},
+		                                 derived().build_qitem(std::vector<uint8_t>(data, data + len), ConnHandle())});
+	});
+	if (replayed) LOG_INFO(TSVR, "replaying ", replayed, " unprocessed item(s) from the write ahead log");
+	wal_release();
+	return true;
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::join_threads() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::wal_append(std::vector<uint8_t> &&data, ConnHandle conn,
+                                                                     item_ctx ctx) {
+	// append and stash under one lock, a commit landing in between would otherwise miss the item
+	std::lock_guard<std::mutex> lck(m_wal_mtx);
+	ctx.wal_seq = m_wal->append(data.data(), data.size());
+	if (!ctx.wal_seq) {
+		LOG_ERROR(TSVR, "write ahead log refused ", data.size(), " bytes, dropping them");
+		if (ctx.flight) {
+			// the item never reaches processing, requests waiting on it are dropped with it
+			RequestCoalescer::Flight f;
+			std::lock_guard<mutex_type> lckc(m_co_mtx);
+			m_coalescer.finish(ctx.flight, f);
+		}
+		return;
+	}
+	uint32_t bytes = static_cast<uint32_t>(data.size());
+	m_wal_pending.push_back(wal_item{bytes, ctx, derived().build_qitem(std::move(data), conn)});
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::wal_committed() {
+#ifdef LINUX_OS
+	// attached servers process on the loop thread only
+	if (m_wal_event >= 0) {
+		EventLoop::notify(m_wal_event);
+		return;
+	}
+#endif
+	wal_release();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::wal_release() {
+	std::vector<wal_item> ready;
+	{
+		std::lock_guard<std::mutex> lck(m_wal_mtx);
+		uint64_t committed = m_wal->committed();
+		while (!m_wal_pending.empty() && m_wal_pending.front().ctx.wal_seq <= committed) {
+			ready.push_back(std::move(m_wal_pending.front()));
+			m_wal_pending.pop_front();
+		}
+	}
+	for (auto &r : ready)
+		push_qitem(std::move(r.item), r.bytes, r.ctx);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::join_threads() {
 	LOG_TRACE(TSVR);
 	LOG_DEBUG(TSVR, "server is now blocking, until app termination");
-	m_recv_thread.join();
-	m_q_proc_thread.join();
+	if (m_recv_thread.joinable()) m_recv_thread.join();
+	for (auto &worker : m_workers)
+		if (worker.joinable()) worker.join();
+	m_workers.clear();
+	if (m_tcp_info_thread.joinable()) m_tcp_info_thread.join();
 	LOG_DEBUG(TSVR, "server threads have exited...");
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::kill_threads() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::kill_threads() {
 	LOG_TRACE(TSVR);
 	LOG_DEBUG(TSVR, "shuttdown server threads");
 	LOG_DEBUG(TSVR, "\n", m_stats, "\n");
 	m_qproc_active = false;
 	m_recv_active = false;
+#ifdef LINUX_OS
+	if (m_loop) detach();
+	// completion waits have no timeout, kick the ring so the recv thread sees the flag
+	if (m_io_backend == IO_BACKEND::IO_URING && m_uring.is_active()) {
+		m_uring.prep_nop(IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::WAKE), 0));
+		m_uring.submit();
+	}
+#endif
+	join_threads();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::quiesce() {
+	LOG_TRACE(TSVR);
+#ifdef LINUX_OS
+	if (m_loop) {
+		// on the loop thread nothing new is read meanwhile, items held for the log are released inline
+		while (m_wal && !m_wal->drained()) {
+			wal_release();
+			util::chrono::sleep_milli(1);
+		}
+		detach();
+		return;
+	}
+#endif
+	m_recv_active = false;
+	if (m_recv_thread.joinable()) m_recv_thread.join();
+	if (!ThreadPolicy::threaded) return;
+	// a logged item counts until complete(), which also covers items between the log and the queue
+	while (true) {
+		bool idle = !m_wal || m_wal->drained();
+		{
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			idle = idle && m_msg_queue.empty();
+		}
+		if (idle) break;
+		util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
+	}
+	// workers finish the item in hand before they look at the flag
+	m_qproc_active = false;
 	join_threads();
 }
 
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::hand_off(HotRestart &channel) {
+	LOG_TRACE(TSVR);
+	if (!channel.is_connected()) {
+		LOG_ERROR(TSVR, "no successor connected to hand the server off to");
+		return false;
+	}
+	if (!ThreadPolicy::threaded && !is_attached() && m_recv_active) {
+		LOG_ERROR(TSVR, "stop the server with kill_threads() and hand it off once run() returned");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING && !m_loop) {
+		LOG_ERROR(TSVR, "io_uring servers can not be handed off, recvs armed on the ring would eat the successor's bytes");
+		return false;
+	}
+	EventLoop *loop = m_loop;
+#endif
+	bool was_running = m_recv_active;
+	quiesce();
+	HandoffState state;
+	state.proto = PROTOCOL::TCP;
+	state.listen_fd = m_svr_conn.sockfd;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		m_clients.for_each([this, &state](const NetConnection &conn) {
+			state.conns.push_back(conn);
+			state.cache_bypass.push_back(is_cache_bypassed(conn.handle));
+		});
+	}
+	state.conn_state.resize(state.conns.size());
+	for (size_t i = 0; i < state.conns.size(); i++)
+		derived().on_hand_off(state.conns[i].handle, state.conn_state[i]);
+	if (!channel.send_state(state)) {
+		LOG_ERROR(TSVR, "successor did not take over errno: ", errno, " descr: ", sockErrToString(errno), ", serving on");
+#ifdef LINUX_OS
+		if (loop) {
+			attach(*loop);
+			for (const auto &conn : state.conns) watch_fd(conn.sockfd);
+			return false;
+		}
+#endif
+		if (ThreadPolicy::threaded && was_running) run();
+		return false;
+	}
+	// the successor holds its own references to the sockets, closing ours leaves the connections up
+	for (const auto &conn : state.conns) {
+		unwatch_fd(conn.sockfd);
+		close(conn.sockfd);
+	}
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		m_clients.clear();
+		m_fd_handles.clear();
+		m_addr_index.clear();
+	}
+	m_fd_sets.clear_fd(m_svr_conn.sockfd);
+#ifdef LINUX_OS
+	m_epoll.clear_fd(m_svr_conn.sockfd);
+#endif
+	close(m_svr_conn.sockfd);
+	m_svr_conn.sockfd = INVALID_SOCKET;
+	LOG_INFO(TSVR, "handed listener ", m_svr_conn.to_string(), " and ", state.conns.size(), " connection(s) to the successor");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+size_t jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::take_over(HandoffState &state) {
+	LOG_TRACE(TSVR);
+	if (state.proto != PROTOCOL::TCP) {
+		LOG_ERROR(TSVR, "handed off state is not a tcp server's");
+		return 0;
+	}
+	if (state.listen_fd != m_svr_conn.sockfd)
+		LOG_WARNING(TSVR, "taking over clients of listener ", state.listen_fd, " on listener ", m_svr_conn.sockfd);
+	for (size_t i = 0; i < state.conns.size(); i++) {
+		ConnHandle handle = add_client(state.conns[i]);
+		if (i < state.cache_bypass.size() && state.cache_bypass[i]) set_cache_bypass(handle, true);
+		derived().on_take_over(handle, i < state.conn_state.size() ? state.conn_state[i] : std::vector<uint8_t>());
+	}
+	size_t cnt = state.conns.size();
+	state.conns.clear();
+	state.conn_state.clear();
+	state.cache_bypass.clear();
+	LOG_INFO(TSVR, "took over ", cnt, " connection(s) on ", m_svr_conn.to_string());
+	return cnt;
+}
+
 // function selects the active socket descriptor from the master sock fd list and returns it
-template<typename QItem>
-std::vector<int> jstd::net::TcpServer<QItem>::select_active_sockets() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::vector<int> jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::select_active_sockets() {
 	LOG_TRACE(TSVR);
 	m_fd_sets.set_working_set();
 	int rc = m_fd_sets.select_set();
@@ -574,8 +1666,8 @@ std::vector<int> jstd::net::TcpServer<QItem>::select_active_sockets() {
 	}
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::accept_new_connection(int sockfd) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::accept_new_connection(int sockfd) {
 	LOG_TRACE(TSVR);
 	int cnt = 0;
 	while(true) {
@@ -583,15 +1675,14 @@ bool jstd::net::TcpServer<QItem>::accept_new_connection(int sockfd) {
 		LOG_DEBUG(TSVR, "accepting new connection");
 		int new_fd = accept(sockfd, (struct sockaddr*)&new_conn.sa, &new_conn.addr_len);
 		if (new_fd != SOCKET_ERROR) {
-			new_conn.ip_addr = std::string(inet_ntoa(new_conn.sa.sin_addr));
-			new_conn.port = ntohl(new_conn.sa.sin_port);
+			new_conn.port = ntohs(new_conn.sa.sin_port);
 			new_conn.sockfd = new_fd;
 			new_conn.sock_type = SOCK_STREAM;
-			m_fd_sets.add_fd(new_fd);
-			add_client(new_conn);
+			derived().on_accept(add_client(new_conn));
 			cnt++;
 		} else {
-			LOG_WARNING(TSVR, "there was an error accepting connection --> ", sockErrToString(errno));
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				LOG_WARNING(TSVR, "there was an error accepting connection --> ", sockErrToString(errno));
 			break;
 		}
 	}
@@ -599,57 +1690,443 @@ bool jstd::net::TcpServer<QItem>::accept_new_connection(int sockfd) {
 	return cnt>0;
 }
 
-template<typename QItem>
-inline bool jstd::net::TcpServer<QItem>::_remove_client(const std::string &ipaddr, const int &port) noexcept {
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-	return remove_client(ipaddr, port);
-}
-
-template<typename QItem>
-auto jstd::net::TcpServer<QItem>::lookup_client(const std::string &ipaddr, const in_port_t &port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ConnHandle jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::lookup_client(const std::string &ipaddr, const in_port_t &port) {
 	LOG_TRACE(TSVR);
-	std::lock_guard<std::mutex> lck(m_cmtx);
+	std::lock_guard<mutex_type> lck(m_cmtx);
 	LOG_DEBUG(TSVR, "performing client lookup with ip: ", ipaddr, " and port: ", port);
-	return m_client_connections.find(hash_conn(ipaddr, port));
+	auto it = m_addr_index.find(derived().hash_conn(ipaddr, port));
+	return (it != m_addr_index.end()) ? it->second : ConnHandle();
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::remove_client(const std::string &ipaddr, const in_port_t &port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::remove_client(const std::string &ipaddr, const in_port_t &port) {
 	LOG_DEBUG(TSVR, "removing client connection ipaddr: ", ipaddr, " and port: ", port);
-	std::lock_guard<std::mutex> lck(m_qmtx);
-	size_t cnt = m_client_connections.erase(hash_conn(ipaddr, port));
-	return cnt > 0;
+	std::lock_guard<mutex_type> lck(m_cmtx);
+	auto it = m_addr_index.find(derived().hash_conn(ipaddr, port));
+	return (it != m_addr_index.end()) && _remove_client(it->second);
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::remove_client(const jstd::net::NetConnection &conn) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::remove_client(ConnHandle handle) {
 	LOG_TRACE(TSVR);
-	return remove_client(conn.ip_addr, static_cast<const in_port_t>(conn.port));
+	std::lock_guard<mutex_type> lck(m_cmtx);
+	return _remove_client(handle);
 }
 
-template<typename QItem>
-auto jstd::net::TcpServer<QItem>::lookup_client(int sockfd) {
-	struct sockaddr_in addr{};
-	socklen_t len = sizeof(sockaddr_in);
-	int rc = getpeername(sockfd, (struct sockaddr*)&addr, &len);
-	if (rc == SOCKET_ERROR) {
-		LOG_ERROR(TSVR, "there was an error getting the socket address. errno: ",
-			errno, " descr: ", sockErrToString(errno));
-		return m_client_connections.end();
-	}
-	return lookup_client(std::string(inet_ntoa(addr.sin_addr)), ntohs(addr.sin_port));
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ConnHandle jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::lookup_client(int sockfd) {
+	std::lock_guard<mutex_type> lck(m_cmtx);
+	if (sockfd < 0 || static_cast<size_t>(sockfd) >= m_fd_handles.size()) return ConnHandle();
+	return m_fd_handles[sockfd];
 }
 
-template<typename QItem>
-bool jstd::net::TcpServer<QItem>::process_select_timeout() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::process_select_timeout() {
 	LOG_TRACE(TSVR);
 	LOG_DEBUG(TSVR, "processing select timout event!!!");
 	return true;
 }
 
-template<typename QItem>
-void jstd::net::TcpServer<QItem>::handle_select_error() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::handle_select_error() {
 	LOG_WARNING(TSVR, "handling select error...errono: ", errno);
 }
 
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::set_io_backend(IO_BACKEND backend) {
+	LOG_TRACE(TSVR);
+	if (m_recv_active) {
+		LOG_WARNING(TSVR, "io backend can not be changed while the server is running");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (backend == IO_BACKEND::IO_URING && !init_uring()) {
+		LOG_WARNING(TSVR, "io_uring unavailable errno: ", errno, " descr: ", sockErrToString(errno),
+			", falling back to epoll");
+		m_io_backend = m_epoll.is_valid() ? IO_BACKEND::EPOLL : IO_BACKEND::SELECT;
+		return false;
+	}
+	if (backend == IO_BACKEND::EPOLL && !m_epoll.is_valid()) {
+		LOG_WARNING(TSVR, "epoll instance is invalid, staying on select");
+		return false;
+	}
+	m_io_backend = backend;
+	return true;
+#else
+	m_io_backend = IO_BACKEND::SELECT;
+	return backend == IO_BACKEND::SELECT;
+#endif
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::watch_fd(int sockfd) {
+#ifdef LINUX_OS
+	if (m_loop) {
+		m_loop->add_fd(sockfd, EPOLLIN, [this](int fd, uint32_t) {
+			PooledBuffer buff(m_loop->buffers());
+			recv_data(fd, buff.data(), buff.size());
+		});
+		return;
+	}
+#endif
+	switch (m_io_backend) {
+#ifdef LINUX_OS
+		case IO_BACKEND::IO_URING:
+			arm_uring_recv(sockfd);
+			m_uring.submit();
+			break;
+		case IO_BACKEND::EPOLL:
+			m_epoll.add_fd(sockfd);
+			break;
+#endif
+		default:
+			m_fd_sets.add_fd(sockfd);
+			break;
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::unwatch_fd(int sockfd) {
+#ifdef LINUX_OS
+	if (m_loop) {
+		m_loop->remove_fd(sockfd);
+		return;
+	}
+#endif
+	switch (m_io_backend) {
+#ifdef LINUX_OS
+		case IO_BACKEND::IO_URING:   // recv completes with 0 once the socket is shut down
+			break;
+		case IO_BACKEND::EPOLL:
+			m_epoll.clear_fd(sockfd);
+			break;
+#endif
+		default:
+			m_fd_sets.clear_fd(sockfd);
+			break;
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::close_connection(int sockfd) {
+	LOG_DEBUG(TSVR, "closing connection on sockfd: ", sockfd);
+	unwatch_fd(sockfd);
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		if (static_cast<size_t>(sockfd) < m_fd_handles.size()) {
+			TrafficCapture *cap = m_capture.load(std::memory_order_relaxed);
+			if (cap && m_fd_handles[sockfd].is_valid())
+				cap->record(CAPTURE_PROTO::TCP, m_fd_handles[sockfd].value, nullptr, 0, CAPTURE_EVENT::CLOSE);
+			_remove_client(m_fd_handles[sockfd]);
+		}
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING) {
+		std::lock_guard<mutex_type> lck(m_smtx);
+		uring_drop_sends(sockfd);
+	}
+#endif
+	close(sockfd);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::epoll_recving() {
+	LOG_TRACE(TSVR);
+#ifdef LINUX_OS
+	fcntl(m_svr_conn.sockfd, F_SETFL, fcntl(m_svr_conn.sockfd, F_GETFL) | O_NONBLOCK);
+	m_epoll.add_fd(m_svr_conn.sockfd);
+	while (m_recv_active) {
+		tcp_info_tick();
+		int rc = m_epoll.wait(DEFAULT_EPOLL_TIMEOUT_MILLI);
+		if (rc < 0) {
+			if (errno != EINTR) derived().handle_select_error();
+			continue;
+		}
+		if (rc == SELECT_TIMEOUT) {
+			derived().process_select_timeout();
+			continue;
+		}
+		for (int i = 0; i < m_epoll.ready_count(); i++) {
+			int sockfd = m_epoll.ready_fd(i);
+			if (sockfd == m_svr_conn.sockfd)
+				accept_new_connection(sockfd);
+			else
+				recv_data(sockfd);
+		}
+	}
+#endif
+}
+
+// ------------------------------------------IO_URING BACKEND-------------------------------------------------
+#ifdef LINUX_OS
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::init_uring() {
+	LOG_TRACE(TSVR);
+	if (m_uring.is_active()) return true;
+	if (!m_uring.init(DEFAULT_URING_ENTRIES))
+		return false;
+	if (!m_uring.supports_op(IORING_OP_ACCEPT) || !m_uring.supports_op(IORING_OP_RECV) ||
+		!m_uring.supports_op(IORING_OP_SEND) || !m_uring.supports_op(IORING_OP_READ_FIXED)) {
+		LOG_WARNING(TSVR, "kernel io_uring lacks accept/recv/send support");
+		m_uring.close();
+		errno = EOPNOTSUPP;
+		return false;
+	}
+	if (!m_uring.register_buffers(DEFAULT_URING_BUFF_CNT, MAX_BUFF_SIZE)) {
+		LOG_WARNING(TSVR, "failed to register io_uring buffers");
+		m_uring.close();
+		return false;
+	}
+	// provided buffer rings (5.19+) are a prerequisite for multishot accept and recv
+	m_uring_multishot = m_uring.setup_buffer_ring(DEFAULT_URING_BUFF_GROUP);
+	LOG_INFO(TSVR, "io_uring backend ready, multishot: ", m_uring_multishot ? "enabled" : "disabled");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_recving() {
+	LOG_TRACE(TSVR);
+	m_uring.prep_accept(m_svr_conn.sockfd, m_uring_multishot,
+		IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::ACCEPT), 0));
+	while (m_recv_active) {
+		tcp_info_tick();
+		// one syscall submits every re-arm and send queued since the last pass and waits for more work
+		int rc = m_uring.submit_and_wait(1);
+		if (rc < 0 && rc != -EINTR && rc != -EAGAIN && rc != -EBUSY) {
+			LOG_ERROR(TSVR, "io_uring_enter failed errno: ", -rc);
+			derived().handle_select_error();
+		}
+		m_uring.for_each_cqe([this](const io_uring_cqe &cqe) { uring_complete(cqe); });
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_complete(const io_uring_cqe &cqe) {
+	switch (static_cast<URING_TAG>(IoUring::user_data_tag(cqe.user_data))) {
+		case URING_TAG::ACCEPT:
+			uring_accept_complete(cqe);
+			break;
+		case URING_TAG::RECV:
+		case URING_TAG::RECV_FIXED:
+			uring_recv_complete(cqe);
+			break;
+		case URING_TAG::SEND:
+			uring_send_complete(cqe);
+			break;
+		default:
+			break;
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_accept_complete(const io_uring_cqe &cqe) {
+	if (cqe.res >= 0) {
+		NetConnection new_conn;
+		int new_fd = cqe.res;
+		getpeername(new_fd, (struct sockaddr*)&new_conn.sa, &new_conn.addr_len);
+		new_conn.port = ntohs(new_conn.sa.sin_port);
+		new_conn.sockfd = new_fd;
+		new_conn.sock_type = SOCK_STREAM;
+		derived().on_accept(add_client(new_conn));
+	} else if (cqe.res == -EINVAL && m_uring_multishot) {
+		LOG_WARNING(TSVR, "multishot accept rejected by kernel, using single shot accepts");
+		m_uring_multishot = false;
+	} else {
+		LOG_WARNING(TSVR, "there was an error accepting connection --> ", sockErrToString(-cqe.res));
+	}
+	// a multishot accept stays armed until the kernel clears IORING_CQE_F_MORE
+	if (!(cqe.flags & IORING_CQE_F_MORE) && m_recv_active)
+		m_uring.prep_accept(m_svr_conn.sockfd, m_uring_multishot,
+			IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::ACCEPT), 0));
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::arm_uring_recv(int sockfd) {
+	if (m_uring.buffer_ring_active()) {
+		m_uring.prep_recv_multishot(sockfd, IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::RECV),
+			static_cast<uint32_t>(sockfd)));
+		return;
+	}
+	int idx = m_uring.acquire_buffer();
+	if (idx < 0) {
+		LOG_ERROR(TSVR, "out of registered recv buffers, dropping connection on sockfd: ", sockfd);
+		close_connection(sockfd);
+		return;
+	}
+	uint64_t value = (static_cast<uint64_t>(idx) << 32) | static_cast<uint32_t>(sockfd);
+	m_uring.prep_read_fixed(sockfd, static_cast<unsigned>(idx),
+		IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::RECV_FIXED), value));
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_recv_complete(const io_uring_cqe &cqe) {
+	uint64_t value = IoUring::user_data_value(cqe.user_data);
+	auto sockfd = static_cast<int>(value & 0xFFFFFFFF);
+	bool fixed = static_cast<URING_TAG>(IoUring::user_data_tag(cqe.user_data)) == URING_TAG::RECV_FIXED;
+	unsigned idx = fixed ? static_cast<unsigned>(value >> 32) : (cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+	if (cqe.res > 0) {
+		const uint8_t *buff = m_uring.buffer(idx);
+		ConnHandle handle = lookup_client(sockfd);
+		if (handle.is_valid()) {
+			if (TrafficCapture *cap = m_capture.load(std::memory_order_relaxed))
+				cap->record(CAPTURE_PROTO::TCP, handle.value, buff, static_cast<size_t>(cqe.res));
+			derived().on_recv(buff, static_cast<size_t>(cqe.res), handle);
+		} else
+			LOG_WARNING(TSVR, "connection associated with recvd data not found, not processing data");
+		if (fixed) {
+			m_uring.prep_read_fixed(sockfd, idx, cqe.user_data);
+			return;
+		}
+		m_uring.recycle_buffer(static_cast<uint16_t>(idx));
+		if (!(cqe.flags & IORING_CQE_F_MORE) && m_recv_active)
+			arm_uring_recv(sockfd);
+		return;
+	}
+	if (fixed) m_uring.release_buffer(idx);
+	if (cqe.res == -EINVAL && !fixed && m_uring.buffer_ring_active()) {
+		// provided buffer rings exist but multishot recv does not (5.19), switch to fixed buffers
+		LOG_WARNING(TSVR, "multishot recv rejected by kernel, using registered fixed buffers");
+		m_uring.release_buffer_ring();
+	}
+	if ((cqe.res == -ENOBUFS || cqe.res == -EINVAL) && m_recv_active) {
+		arm_uring_recv(sockfd);
+	} else if (!(cqe.flags & IORING_CQE_F_MORE)) {
+		if (cqe.res < 0)
+			LOG_ERROR(TSVR, "an error occured receiving data :( errno: ", -cqe.res, " descr: ",
+				sockErrToString(-cqe.res));
+		else
+			LOG_DEBUG(TSVR, "connection has been closed by client");
+		close_connection(sockfd);
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_send_data(int sockfd, std::vector<uint8_t> &&data) {
+	std::lock_guard<mutex_type> lck(m_smtx);
+	uring_send &pending = m_uring_sends[sockfd];
+	pending.queue.push_back(std::move(data));
+	// goes out from the completion of the send ahead of it
+	if (pending.queue.size() > 1) return true;
+	pending.offset = 0;
+	if (!uring_prep_send(sockfd, pending)) {
+		LOG_ERROR(TSVR, "io_uring submission queue full, failed to send data");
+		uring_send_failed(sockfd);
+		return false;
+	}
+	m_uring.submit();
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_prep_send(int sockfd, uring_send &pending) {
+	const std::vector<uint8_t> &data = pending.queue.front();
+	pending.id = (static_cast<uint64_t>(sockfd) << 32) | (m_next_send_id++ & 0xFFFFFFFFull);
+	return m_uring.prep_send(sockfd, data.data() + pending.offset, data.size() - pending.offset,
+		IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::SEND), pending.id));
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_send_failed(int sockfd) {
+	m_uring_sends.erase(sockfd);
+	{
+		std::lock_guard<mutex_type> lckm(m_qmtx);
+		m_stats.sock_err_cnt++;
+	}
+	// the rest of the stream is lost, the armed recv completes and close_connection() cleans up
+	shutdown(sockfd, SHUT_RDWR);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_drop_sends(int sockfd) {
+	auto it = m_uring_sends.find(sockfd);
+	if (it == m_uring_sends.end()) return;
+	m_uring_orphans[it->second.id] = std::move(it->second.queue.front());
+	m_uring_sends.erase(it);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::uring_send_complete(const io_uring_cqe &cqe) {
+	uint64_t send_id = IoUring::user_data_value(cqe.user_data);
+	std::lock_guard<mutex_type> lck(m_smtx);
+	auto orphan = m_uring_orphans.find(send_id);
+	if (orphan != m_uring_orphans.end()) {
+		m_uring_orphans.erase(orphan);
+		return;
+	}
+	int sockfd = static_cast<int>(send_id >> 32);
+	auto it = m_uring_sends.find(sockfd);
+	if (it == m_uring_sends.end() || it->second.id != send_id) return;
+	uring_send &pending = it->second;
+	if (cqe.res < 0) {
+		LOG_ERROR(TSVR, "failed to send data, errno# ", -cqe.res, " descr: ", sockErrToString(-cqe.res));
+		uring_send_failed(sockfd);
+		return;
+	}
+	pending.offset += static_cast<size_t>(cqe.res);
+	if (pending.offset >= pending.queue.front().size()) {
+		pending.queue.pop_front();
+		pending.offset = 0;
+		if (pending.queue.empty()) {
+			m_uring_sends.erase(it);
+			return;
+		}
+	} else if (cqe.res == 0) {
+		LOG_ERROR(TSVR, "send made no progress, dropping queued data for sockfd: ", sockfd);
+		uring_send_failed(sockfd);
+		return;
+	}
+	// remainder of a short write or the next buffer, still the only send on this socket
+	if (!uring_prep_send(sockfd, pending)) {
+		LOG_ERROR(TSVR, "io_uring submission queue full, dropping queued data for sockfd: ", sockfd);
+		uring_send_failed(sockfd);
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::attach(EventLoop &loop) {
+	LOG_TRACE(TSVR);
+	if (m_recv_active) {
+		LOG_WARNING(TSVR, "server is already running, can not attach it to an event loop");
+		return false;
+	}
+	fcntl(m_svr_conn.sockfd, F_SETFL, fcntl(m_svr_conn.sockfd, F_GETFL) | O_NONBLOCK);
+	if (!loop.add_fd(m_svr_conn.sockfd, EPOLLIN, [this](int fd, uint32_t) { accept_new_connection(fd); })) {
+		LOG_ERROR(TSVR, "failed to register listener with the event loop errno: ", errno);
+		return false;
+	}
+	m_loop = &loop;
+	m_recv_active = true;
+	m_qproc_active = true;
+	if (m_wal) m_wal_event = loop.add_event([this]() { wal_release(); });
+	if (m_tcp_cfg.interval_ms)
+		m_tcp_info_timer = loop.add_timer(m_tcp_cfg.interval_ms, true, [this]() { sample_tcp_info(); });
+	LOG_INFO(TSVR, "listener ", m_svr_conn.to_string(), " attached to event loop");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::net::TcpServerBase<Derived, QItem, ThreadPolicy>::detach() {
+	LOG_TRACE(TSVR);
+	if (!m_loop) return;
+	std::vector<int> fds;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		m_clients.for_each([&fds](const NetConnection &conn) { fds.push_back(conn.sockfd); });
+	}
+	for (int fd : fds)
+		m_loop->remove_fd(fd);
+	m_loop->remove_fd(m_svr_conn.sockfd);
+	if (m_wal_event >= 0) m_loop->remove_event(m_wal_event);
+	m_wal_event = -1;
+	if (m_tcp_info_timer >= 0) m_loop->cancel_timer(m_tcp_info_timer);
+	m_tcp_info_timer = -1;
+	m_loop = nullptr;
+	m_recv_active = false;
+	m_qproc_active = false;
+}
+
+#endif // LINUX_OS
+
 #endif //JSTDLIB_TCP_SERVER_H
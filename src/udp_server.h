@@ -1,24 +1,41 @@
 #ifndef UPD_SERVER_H
 #define UPD_SERVER_H
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
-
-#ifdef MULTITHREADED_SRVR
 #include <mutex>
 #include <thread>
-#endif
 
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <chrono>
-#include <functional>   // std::hash
+#include <functional>   // std::ref
 #include "logger.h"
 #include "udp_server.h"
 #include <arpa/inet.h>
 #include <string>       // std::to_string
 #include <fcntl.h>      // fcntl()
+#include <unistd.h>     // close()
 #include "jstd_util.h"
 #include "net_types.h"
+#include "epoll_set.h"
+#include "IoUring.h"
+#include "ConnectionTable.h"
+#include "ClientIndex.h"
+#include "server_policy.h"
+#include "EventLoop.h"
+#include "TrafficCapture.h"
+#include "WriteAheadLog.h"
+#include "msg_queue.h"
+#include "RequestCoalescer.h"
+#include "ResponseCache.h"
+#include "HotRestart.h"
+#include "DatagramBatch.h"
+#include "ReusePort.h"
+#include "ReliableUdp.h"
+#include "Fragmentation.h"
+#include "Multicast.h"
 
 /*
  * Description:
@@ -29,11 +46,26 @@
  *  Broadcast mode can be enabled. This is not true UDP bcast as all active clients will recv the same message.
  *  This makes having bcast/multicast routers not a requirement
  *
- *  This Server can also be built SINGLE or MULTITHREADED
+ *  Threading is selected per instance through the ThreadPolicy parameter (server_policy.h), an InlinePolicy
+ *  server processes each datagram on the thread that called run() and takes no locks. With InlinePolicy and
+ *  the default recvfrom backend, stopping from another thread needs set_recv_timeout() so the loop wakes up.
+ *  Clients are referenced through 64 bit ConnHandles looked up in a ClientIndex (ClientIndex.h).
+ *
+ *  Everything else is opt-in per instance and documented at its setter and in the module it is built on:
+ *  set_io_backend() (IoUring.h), attach() (EventLoop.h), set_queue_discipline() and set_load_shedding()
+ *  (msg_queue.h), set_coalescing() (RequestCoalescer.h), set_response_cache() (ResponseCache.h), set_batching()
+ *  and set_udp_offload() (DatagramBatch.h), set_reuseport() (ReusePort.h), set_reliability() (ReliableUdp.h),
+ *  set_fragmentation() (Fragmentation.h), set_multicast() (Multicast.h), set_wal() (WriteAheadLog.h) and
+ *  hand_off() (HotRestart.h).
+ *
+ *  UdpServerBase<Derived, QItem> resolves the hooks (process_item, _build_qitem, on_shed, item_deadline_ms,
+ *  inject_loss, hash_conn, broadcast_data) on Derived at compile time, anything Derived leaves out falls
+ *  through to the defaults. UdpServer<QItem> layers the original virtual interface on top, see TcpServerBase
+ *  for the rules on overriding hooks.
  *
  *  QItem template type should have the following public interface
  *  struct QItem {
- *      NetConnection conn;
+ *      ConnHandle conn;
  *      std::vector<uint8_t> data;
  *      std::vector<uint8_t> serialize();  // serialize converts data structure to bin format
  *  };
@@ -43,56 +75,217 @@
 #define USVR LOG_MODULE::UDPSERVER
 
 namespace jstd {
-	template<typename QItem>
-	class UdpServer {
-		// create a hash from ip str and and port
-		std::unordered_map<uint64_t, jstd::net::NetConnection> m_client_connections;
+	template<typename Derived, typename QItem, typename ThreadPolicy = jstd::net::DefaultThreadPolicy>
+	class UdpServerBase {
+		typedef typename ThreadPolicy::mutex_type mutex_type;
+
+		// client records, indexed by hash_conn() of address and port. The index is read without m_cmtx, the
+		// receive path only takes the lock on a client's first datagram
+		jstd::net::ConnectionTable m_clients;
+		jstd::net::ClientIndex m_addr_index;
 
-#ifdef MULTITHREADED_SRVR
 		std::thread m_recv_thread;
-		std::thread m_q_proc_thread;
-		std::queue<QItem> m_msg_queue;
-		std::mutex m_qmtx;
-		std::mutex m_cmtx;
+		std::vector<std::thread> m_workers;
+		// travels with an item to processing, 0 for none: wal_seq is the log record the item was built from,
+		// flight the RequestCoalescer key it leads, cache_key/cache_check the fingerprint to cache its response under
+		struct item_ctx {
+			uint64_t wal_seq;
+			uint64_t flight;
+			uint64_t cache_key;
+			uint64_t cache_check;
+		};
+		struct queued_item {
+			QItem item;
+			item_ctx ctx;
+		};
+		jstd::net::MsgQueue<queued_item> m_msg_queue;
+		mutex_type m_qmtx;
+
+		// an SO_REUSEPORT socket read by its own thread, lane 0 reads the listening socket
+		struct reuseport_lane {
+			const UdpServerBase *owner;
+			unsigned index;
+			int sockfd;
+			std::thread recv_thread;
+			std::thread worker;
+			mutex_type qmtx;
+			jstd::net::MsgQueue<queued_item> queue;     // used with a worker per lane
+			jstd::net::ServerStats stats;               // received on, and with a worker processed by, this lane
+			std::unique_ptr<jstd::net::RecvBatch> rbatch;
+			std::unique_ptr<jstd::net::SendBatch> sends;
+			std::vector<uint8_t> cache_hit;
+		};
+		std::vector<std::unique_ptr<reuseport_lane>> m_lanes;
+		bool m_lane_workers;
+		static thread_local reuseport_lane *t_lane;
+		mutex_type m_cmtx;
 		bool m_qproc_active;
 		bool m_recv_active;
 		bool m_is_nonblocking;
+		jstd::net::IO_BACKEND m_io_backend;
+#ifdef LINUX_OS
+		epoll_set m_epoll;
+		jstd::net::IoUring m_uring;
+
+		// one in flight recvmsg per registered buffer
+		struct uring_recv_slot {
+			msghdr msg;
+			iovec iov;
+			sockaddr_in addr;
+		};
+		std::vector<uring_recv_slot> m_uring_slots;
+
+		// datagrams in flight on the ring, owned here until their completion is reaped
+		struct uring_sendmsg {
+			msghdr msg;
+			iovec iov;
+			sockaddr_in addr;
+			std::vector<uint8_t> data;
+		};
+		mutex_type m_smtx;
+		std::unordered_map<uint64_t, uring_sendmsg> m_uring_sends;
+		uint64_t m_next_send_id;
+
+		// set while attached to an application owned loop
+		jstd::net::EventLoop *m_loop;
 #endif
 		// listening socket
-        jstd::net::NetConnection m_svr_conn;
+		jstd::net::NetConnection m_svr_conn;
 
 		// broadcast mode flag
 		bool m_is_bcast;
 
 		// message counter
-        jstd::net::ServerStats m_stats;
+		jstd::net::ServerStats m_stats;
+
+		// optional recorder of received datagrams
+		std::atomic<jstd::net::TrafficCapture*> m_capture;
+
+		// optional durability stage, items wait in m_wal_pending for their commit, in log order
+		jstd::net::WriteAheadLog *m_wal;
+		std::mutex m_wal_mtx;
+		struct wal_item {
+			uint32_t bytes;
+			item_ctx ctx;
+			QItem item;
+		};
+		std::deque<wal_item> m_wal_pending;
+		int m_wal_event;
+
+		// optional coalescing of identical datagrams in flight
+		bool m_coalesce;
+		mutex_type m_co_mtx;
+		jstd::net::RequestCoalescer m_coalescer;
+
+		// optional cache of responses, m_cache_hit holds a hit on its way out (recv thread only)
+		jstd::net::ResponseCache *m_cache;
+		std::vector<uint8_t> m_cache_hit;
+		// clients exempt from it, m_cache_bypass[index] holds the handle while set, guarded by m_cmtx
+		std::vector<jstd::net::ConnHandle> m_cache_bypass;
+
+		// m_cmtx held
+		inline bool is_cache_bypassed(jstd::net::ConnHandle conn) const {
+			return conn.index() < m_cache_bypass.size() && m_cache_bypass[conn.index()] == conn;
+		}
 
-        void init(const std::string& ipaddr, in_port_t port);
+		// datagrams sent to conn while an item with a flight or cache key is processed on this thread
+		struct response_capture {
+			const UdpServerBase *owner;
+			jstd::net::ConnHandle conn;
+			std::vector<std::vector<uint8_t>> datagrams;
+		};
+		static thread_local response_capture *t_capture;
+
+		// recvmmsg / sendmmsg batch sizes, 1 for a syscall per datagram
+		unsigned m_recv_batch;
+		unsigned m_send_batch;
+		// recv thread (or loop thread) only, m_recv_sends collects what is sent while a batch is processed
+		std::unique_ptr<jstd::net::RecvBatch> m_rbatch;
+		std::unique_ptr<jstd::net::SendBatch> m_recv_sends;
+
+		// UDP_SEGMENT sends, cleared when the kernel refuses one, and UDP_GRO receives
+		std::atomic<bool> m_gso;
+		bool m_gro;
+
+		// optional reliable delivery, state per client keyed by ConnHandle value. m_rmtx guards the peers, the
+		// counters and m_rel_out, the packets a peer hands back. m_rel_due is the next tick of an InlinePolicy recv
+		// loop, m_rel_timer the tick while attached
+		struct reliable_peer {
+			jstd::net::NetConnection conn;
+			jstd::net::ReliablePeer state;
+		};
+		bool m_reliable;
+		jstd::net::ReliableConfig m_rel_cfg;
+		mutex_type m_rmtx;
+		std::unordered_map<uint64_t, reliable_peer> m_rel_peers;
+		std::vector<jstd::net::ReliablePacket> m_rel_out;
+		jstd::net::ReliableCounters m_rel_counters;
+		uint32_t m_rel_sessions;
+		std::thread m_rel_thread;
+		uint64_t m_rel_due;
+		int m_rel_timer;
+
+		// optional fragmentation of messages larger than a datagram. m_fmtx guards the reassembly table and the
+		// counters, message ids are drawn by whichever thread sends
+		bool m_fragmenting;
+		jstd::net::FragmentConfig m_frag_cfg;
+		std::atomic<uint32_t> m_frag_next_id;
+		mutex_type m_fmtx;
+		std::unique_ptr<jstd::net::Reassembler> m_reassembler;
+		jstd::net::FragmentCounters m_frag_counters;
+
+		// optional multicast of broadcasts, the group address and port they are sent to
+		bool m_multicast;
+		jstd::net::NetConnection m_mcast_group;
+
+		// datagrams sent by this thread are queued in batch until flush_sends()
+		struct send_batching {
+			const UdpServerBase *owner;
+			jstd::net::SendBatch *batch;
+		};
+		static thread_local send_batching *t_send_batch;
+
+		void init(const std::string& ipaddr, in_port_t port);
+
+		// stop reading and wait until every datagram taken in so far is processed
+		void quiesce();
 
 	public:
 		// ctors
-		UdpServer();
+		UdpServerBase();
 
-		UdpServer(const std::string &ip, in_port_t port);
+		UdpServerBase(const std::string &ip, in_port_t port);
 
-		~UdpServer();
+		// adopt a bound socket, e.g. HandoffState::listen_fd after a hot restart
+		explicit UdpServerBase(int sockfd);
+
+		~UdpServerBase();
 
 		// adds udpclient to connection map
 		bool add_client(const std::string &ip, const uint16_t &port);
 
-		void add_client(const jstd::net::NetConnection &conn);
+		// returns the handle of the client, it is only added on first contact
+		jstd::net::ConnHandle add_client(const jstd::net::NetConnection &conn);
+
+		// handle of the client with hash_conn() id hash_id, invalid handle if unknown
+		jstd::net::ConnHandle lookup_client(const uint64_t &hash_id);
 
-		auto lookup_client(const uint64_t &hash_id, bool &found);
+		// copy of the client record, false if the handle is unknown or stale
+		bool get_connection(jstd::net::ConnHandle handle, jstd::net::NetConnection &conn);
 
-		// virtual method to process a QItem, hash_id of connection for response lookup
-		virtual bool process_item(const QItem &item);
+		// "ip:port" of the client, formatted on demand
+		std::string peer_address(jstd::net::ConnHandle handle);
 
-		virtual bool process_item(QItem &&item);
+		// process hooks resolved on Derived at compile time, hash_id of connection for response lookup
+		bool process_item(const QItem &item);
 
-		virtual bool process_item(QItem &&item, uint64_t hash_id);
+		bool process_item(QItem &&item);
 
-		// broadcast message to all active clients, returns number of clients succesfully sent out to
-		virtual int broadcast_data(const std::vector<uint8_t> &data);
+		bool process_item(QItem &&item, uint64_t hash_id);
+
+		// broadcast message to all active clients, returns number of clients succesfully sent out to, with
+		// set_multicast() 1 if the one send to the group went out
+		int broadcast_data(const std::vector<uint8_t> &data);
 
 		// activate or deactivate bcast_mode
 		inline bool set_bcast_mode(bool is_set);
@@ -108,7 +301,7 @@ namespace jstd {
 
 		bool remove_client(const std::string &ipaddr, const int &port);
 
-		// sends generic network message to client with hash_id
+		// sends generic network message to the client item.conn refers to
 		bool send_item(const QItem &item);
 
 		bool send_item(const QItem &item, uint64_t hash_id);
@@ -116,15 +309,133 @@ namespace jstd {
 		// sets recv time out for blocking  recvfrom call
 		bool set_recv_timeout(int milli);
 
-#ifdef MULTITHREADED_SRVR
+		// record received datagrams to capture, nullptr stops, the capture has to outlive the server
+		inline void set_capture(jstd::net::TrafficCapture *capture) { m_capture = capture; }
+
+		// select how the recv thread waits for datagrams, must be called before run()
+		// SELECT keeps the blocking recvfrom loop, IO_URING falls back to EPOLL when unavailable
+		bool set_io_backend(jstd::net::IO_BACKEND backend);
+
+		inline jstd::net::IO_BACKEND get_io_backend() const { return m_io_backend; }
+
+		// datagrams per recvmmsg and per sendmmsg (up to MAX_UDP_BATCH), 1 turns batching off, must be called before
+		// run(). Sends are batched while a received batch or a run of queued items is processed, not with IO_URING
+		bool set_batching(unsigned recv_batch, unsigned send_batch);
+
+		// receive on sockets SO_REUSEPORT sockets bound to the server address, a thread each. lane_workers gives every
+		// lane a processing thread of its own instead of the ThreadPolicy workers, steer keeps a client (address and
+		// port) on one lane with a CBPF program. Needs a threaded policy and the SELECT backend, must be called
+		// before run(), 1 goes back to one socket. The listening socket is bound again when it lacks SO_REUSEPORT
+		bool set_reuseport(unsigned sockets, bool lane_workers, bool steer = false);
+
+		inline size_t lane_count() const { return m_lanes.size(); }
+
+		// counters of each lane in lane order, stats() has them merged
+		std::vector<jstd::net::ServerStats> lane_stats();
+
+		// segmentation offload, gso for send_segments() and gro for receiving, false if the kernel refused one of them
+		// (it stays off). Must be called before run(), gro does not work with IO_URING
+		bool set_udp_offload(bool gso, bool gro);
+
+		// send len bytes to conn as datagrams of seg_size, the last one shorter, in one syscall per up to
+		// UDP_MAX_GSO_SEGMENTS datagrams with gso, through send_data() otherwise
+		bool send_segments(jstd::net::ConnHandle conn, const uint8_t *data, size_t len, uint16_t seg_size);
+
+		// reliable delivery of every datagram exchanged with clients, both ends have to run it. Must be called
+		// before run(), an InlinePolicy server needs set_recv_timeout() for its retransmissions to be timely
+		bool set_reliability(const jstd::net::ReliableConfig &cfg);
+
+		inline bool is_reliable() const { return m_reliable; }
+
+		// send len bytes to conn through the reliability layer, false if the handle is stale, the datagram too large
+		// or the client's queue full (max_queued)
+		bool send_reliable(jstd::net::ConnHandle conn, const uint8_t *data, size_t len);
+
+		// smoothed RTT the reliability layer measured to conn, 0 without a sample
+		uint64_t reliable_rtt_us(jstd::net::ConnHandle conn);
+
+		// loss injection for the reliability layer, true drops the datagram received from (outbound false) or about
+		// to be sent to conn. Runs under the layer's lock, default drops nothing
+		bool inject_loss(jstd::net::ConnHandle conn, const uint8_t *data, size_t len, bool outbound);
+
+		// frame messages to and from clients with a fragment header and split the larger ones, see Fragmentation.h.
+		// Both ends have to run it, must be called before run(), false if fragment_size does not fit a datagram
+		bool set_fragmentation(const jstd::net::FragmentConfig &cfg);
+
+		inline bool is_fragmenting() const { return m_fragmenting; }
+
+		// send broadcasts once to group:port instead of to every client, "" goes back to unicast fan-out. Must be
+		// called before run(), false if group is not a multicast address or the socket refused an option of cfg
+		bool set_multicast(const std::string &group, in_port_t port,
+		                   const jstd::net::MulticastConfig &cfg = jstd::net::MulticastConfig());
+
+		inline bool is_multicast() const { return m_multicast; }
+
+		// receive what is sent to group through the interface with address iface ("" for the default route's). The
+		// server has to be bound to the group's port on any address, e.g. built on multicast::bind_socket()
+		bool join_group(const std::string &group, const std::string &iface = "");
+
+		bool leave_group(const std::string &group, const std::string &iface = "");
+
+		// process identical datagrams in flight once and fan the response out, must be called before run()
+		inline void set_coalescing(bool on) { m_coalesce = on; }
+
+		// log received messages to wal and process them once committed, same rules as TcpServerBase::set_wal().
+		// Committed items go through the shared queue, with receive lanes too
+		bool set_wal(jstd::net::WriteAheadLog *wal);
+
+		// answer repeated datagrams from cache, only replies of process_item calls that sent exactly one datagram
+		// are stored. nullptr disables, must be called before run() and the cache has to outlive the server
+		inline void set_response_cache(jstd::net::ResponseCache *cache) { m_cache = cache; }
+
+		// neither look up nor store responses for conn, false if the handle is unknown or stale
+		bool set_cache_bypass(jstd::net::ConnHandle conn, bool bypass);
+
+		// shed queued datagrams by deadline and/or CoDel, only threaded servers queue them
+		void set_load_shedding(const jstd::net::ShedConfig &cfg);
+
+		// FIFO or per client deficit round robin with quantum messages/bytes per round (0 for the
+		// msg_queue.h default), only while nothing is queued, false otherwise
+		bool set_queue_discipline(jstd::net::QUEUE_DISCIPLINE discipline, uint32_t quantum = 0);
+
+		// depth and wait times of the clients with queued datagrams
+		std::vector<jstd::net::FlowStats> queue_stats();
+
+		// copy of the counters
+		jstd::net::ServerStats stats();
+
+		// item dropped from the queue instead of processed, runs on a worker, default discards it
+		void on_shed(QItem &&item, jstd::net::SHED_REASON reason);
+
+		// processing budget of item from enqueue in ms, 0 uses the ShedConfig default
+		unsigned item_deadline_ms(const QItem &item) const;
+
+		// stop reading, finish what was taken in and pass socket and clients to the successor on channel, same
+		// rules as TcpServerBase::hand_off()
+		bool hand_off(jstd::net::HotRestart &channel);
+
+		// restore the client records of a handed off state, returns their count
+		size_t take_over(jstd::net::HandoffState &state);
+
+#ifdef LINUX_OS
+		// serve from loop instead of run(), datagrams are processed inline on the loop thread
+		// must be called from the loop thread or while the loop is not running
+		bool attach(jstd::net::EventLoop &loop);
+
+		void detach();
+
+		inline bool is_attached() const { return m_loop != nullptr; }
+#else
+		inline bool is_attached() const { return false; }
+#endif
 
 		// recvs msg and queues item for processing (thread)
 		void msg_recving();
 
-		// msg processing
-		void msg_processing();
+		// msg processing, worker is the index of the processing thread
+		void msg_processing(unsigned worker);
 
-		// run threads
+		// start the threads, with a non threaded policy this runs the recv loop until kill_threads()
 		bool run();
 
 		// make server run call blocking
@@ -133,19 +444,190 @@ namespace jstd {
 		// kill and join threads
 		void kill_threads();
 
-#endif
+	protected:
+		void _build_qitem(QItem &item, const uint8_t *buff, const ssize_t &len, jstd::net::ConnHandle conn) const;
+
+		// client key, address and port packed into the low 48 bits
+		uint64_t hash_conn(const jstd::net::NetConnection &conn) const;
+
+		uint64_t hash_conn(const std::string &ipaddr, const int &port) const;
+
+		inline Derived &derived() { return static_cast<Derived&>(*this); }
+
+		inline const Derived &derived() const { return static_cast<const Derived&>(*this); }
+
 	private:
-		virtual void _build_qitem(QItem &item, const uint8_t *buff, const ssize_t &len, const sockaddr_in &addr) const;
+		// drop record and index entry, caller holds m_cmtx
+		bool _remove_client(jstd::net::ConnHandle handle);
+
+		// write a datagram to a resolved client
+		bool send_data(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len);
+
+		// an application message to a resolved client, split into fragments and through the reliability layer when
+		// they are on
+		bool send_payload(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len);
+
+		// one datagram of a message, through the reliability layer when it is on
+		bool send_datagram(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len);
+
+		bool send_fragments(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len);
+
+		// data from off on as UDP_SEGMENT sends of seg_size datagrams, off ends up past what was sent. Stops early
+		// when the kernel refuses GSO, which turns it off, false on any other error
+		bool send_gso(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len, uint16_t seg_size,
+		              size_t &off);
+
+		bool reliable_send(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len);
+
+		// state of the client, created on first use, caller holds m_rmtx
+		reliable_peer &reliable_state(const jstd::net::NetConnection &conn);
+
+		// send what the peer put in m_rel_out, caller holds m_rmtx
+		void send_reliable_out(const jstd::net::NetConnection &conn);
+
+		// a datagram of the reliability layer, acks are consumed and payloads dispatched in order
+		void on_reliable_datagram(const uint8_t *buff, size_t len, const jstd::net::NetConnection &conn);
+
+		// retransmit what timed out
+		void reliable_tick();
 
-		virtual uint64_t hash_conn(const jstd::net::NetConnection &conn) const;
+		// thread of threaded servers calling reliable_tick()
+		void reliable_timing();
 
-		virtual uint64_t hash_conn(const std::string &ipaddr, const int &port) const;
+		inline void reliable_inline_tick() {
+			if (ThreadPolicy::threaded || !m_reliable) return;
+			uint64_t now = jstd::net::ReliablePeer::now_us();
+			if (now < m_rel_due) return;
+			m_rel_due = now + m_rel_cfg.tick_ms * 1000ULL;
+			reliable_tick();
+		}
+
+		// queue item for the processing threads, or process it right away when not threaded
+		// bytes is the datagram size
+		void push_qitem(QItem &&item, uint32_t bytes, const item_ctx &ctx);
+
+		// process_item, then cache the response and, for a flight leader, end the flight and send the
+		// response to its waiters
+		bool process_entry(QItem &&item, const item_ctx &ctx);
+
+		// send the cached response to the datagram when there is one, on a miss ctx gets its fingerprint
+		bool answer_from_cache(const uint8_t *buff, size_t len, jstd::net::ConnHandle conn, item_ctx &ctx);
+
+		// the leader of flight was shed, its waiters are shed with it
+		void shed_flight(uint64_t flight, jstd::net::SHED_REASON reason);
+
+		// append a message to the log and hold its item until committed
+		void wal_append(const uint8_t *buff, size_t len, jstd::net::ConnHandle conn, item_ctx ctx);
+
+		// commit handler, runs on the log's commit thread
+		void wal_committed();
+
+		// pass the committed items on to processing
+		void wal_release();
+
+		// build, queue and account for one received datagram
+		void on_datagram(const uint8_t *buff, ssize_t len, const sockaddr_in &from);
+
+		// the payload of a client's datagram, through reassembly when fragmentation is on
+		void dispatch_datagram(const uint8_t *buff, size_t len, jstd::net::ConnHandle handle);
+
+		// answer from cache, join a flight or queue a client's message
+		void dispatch_message(const uint8_t *buff, size_t len, jstd::net::ConnHandle handle);
+
+		// count and drop a datagram that did not fit the receive buffer
+		void on_truncated(const sockaddr_in &from, size_t len);
+
+		// recv loops, one per IO_BACKEND, the blocking one reads sockfd through rbatch when there is one
+		void recvfrom_recving(int sockfd, jstd::net::RecvBatch *rbatch, jstd::net::SendBatch *sends);
+
+		void epoll_recving();
+
+		void uring_recving();
+
+		// recvfrom with MSG_DONTWAIT until the socket is empty
+		void drain_socket(uint8_t *buff, size_t len);
+
+		// one recvmmsg on sockfd with flags, its datagrams are processed and the sends they caused, collected in
+		// sends when not nullptr, flushed. returns the datagrams received, -1 on error
+		int recv_batch(int sockfd, jstd::net::RecvBatch &rbatch, jstd::net::SendBatch *sends, int flags);
+
+		// send the datagrams batched on this thread
+		void flush_sends(jstd::net::SendBatch &batch);
+
+		// batch for the recv batch size, GRO needs one even for a batch of 1, nullptr for plain recvfrom
+		std::unique_ptr<jstd::net::RecvBatch> make_recv_batch() const;
+
+		// the lane the calling thread serves, nullptr off lane threads
+		inline reuseport_lane *current_lane() const { return t_lane && t_lane->owner == this ? t_lane : nullptr; }
+
+		// counters of the calling receive thread
+		inline jstd::net::ServerStats &recv_stats() {
+			reuseport_lane *lane = current_lane();
+			return lane ? lane->stats : m_stats;
+		}
+
+		// start a receive thread, and a worker with lane_workers, per lane
+		void start_lanes();
+
+		void lane_recving(reuseport_lane &lane);
+
+		void lane_processing(reuseport_lane &lane);
+
+		// pop and process queue until the server stops, qmtx guards queue and stats
+		void process_queue(jstd::net::MsgQueue<queued_item> &queue, mutex_type &qmtx, jstd::net::ServerStats &stats,
+		                   unsigned worker);
+
+#ifdef LINUX_OS
+		bool init_uring();
+
+		void arm_uring_recv(unsigned slot);
+
+		bool uring_send_data(const sockaddr_in &to, std::vector<uint8_t> &&data);
+
+		void uring_complete(const io_uring_cqe &cqe);
+#endif
+	};
 
-		inline bool _remove_client(const std::string &ipaddr, const int &port) noexcept {
-			return (m_client_connections.erase(hash_conn(ipaddr, port)) > 0);
+	/*
+	 * Runtime polymorphic server, every hook is virtual and forwards to the UdpServerBase default.
+	 */
+	template<typename QItem, typename ThreadPolicy = jstd::net::DefaultThreadPolicy>
+	class UdpServer : public UdpServerBase<UdpServer<QItem, ThreadPolicy>, QItem, ThreadPolicy> {
+		typedef UdpServerBase<UdpServer<QItem, ThreadPolicy>, QItem, ThreadPolicy> Base;
+		friend Base;
+
+	public:
+		using Base::Base;
+
+		// stop the threads while the virtual hooks are still callable
+		virtual ~UdpServer() { this->kill_threads(); }
+
+		virtual bool process_item(const QItem &item) { return Base::process_item(item); }
+
+		virtual bool process_item(QItem &&item) { return Base::process_item(std::move(item)); }
+
+		virtual bool process_item(QItem &&item, uint64_t hash_id) { return Base::process_item(std::move(item), hash_id); }
+
+		virtual int broadcast_data(const std::vector<uint8_t> &data) { return Base::broadcast_data(data); }
+
+		virtual void on_shed(QItem &&item, jstd::net::SHED_REASON reason) { Base::on_shed(std::move(item), reason); }
+
+		virtual unsigned item_deadline_ms(const QItem &item) const { return Base::item_deadline_ms(item); }
+
+		virtual bool inject_loss(jstd::net::ConnHandle conn, const uint8_t *data, size_t len, bool outbound) {
+			return Base::inject_loss(conn, data, len, outbound);
+		}
+
+	protected:
+		virtual void _build_qitem(QItem &item, const uint8_t *buff, const ssize_t &len, jstd::net::ConnHandle conn) const {
+			Base::_build_qitem(item, buff, len, conn);
 		}
 
-		void push_qitem(const QItem &item);
+		virtual uint64_t hash_conn(const jstd::net::NetConnection &conn) const { return Base::hash_conn(conn); }
+
+		virtual uint64_t hash_conn(const std::string &ipaddr, const int &port) const {
+			return Base::hash_conn(ipaddr, port);
+		}
 	};
 }
 
@@ -156,83 +638,160 @@ namespace jstd {
 
 
 // =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-Implementation=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+template<typename Derived, typename QItem, typename ThreadPolicy>
+thread_local typename jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::response_capture *
+	jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::t_capture = nullptr;
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+thread_local typename jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_batching *
+	jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::t_send_batch = nullptr;
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+thread_local typename jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reuseport_lane *
+	jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::t_lane = nullptr;
+
 
 // default connection settings
-template<typename QItem>
-jstd::UdpServer<QItem>::UdpServer()
-	: m_qproc_active(false), m_recv_active(false), m_is_bcast(false) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::UdpServerBase()
+	: m_lane_workers(false), m_qproc_active(false), m_recv_active(false), m_io_backend(jstd::net::IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false), m_cache(nullptr),
+	  m_recv_batch(1), m_send_batch(1), m_gso(false), m_gro(false),
+	  m_reliable(false), m_rel_sessions(0), m_rel_due(0), m_rel_timer(-1), m_fragmenting(false), m_frag_next_id(0),
+	  m_multicast(false) {
 	LOG_TRACE(USVR);
 	init(LOCALHOSTIP, DEFAULT_UDP_SERVER_PORT);
 }
 
-template<typename QItem>
-jstd::UdpServer<QItem>::UdpServer(const std::string &ip, in_port_t port)
-	: m_qproc_active(false), m_recv_active(false), m_is_bcast(false) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::UdpServerBase(const std::string &ip, in_port_t port)
+	: m_lane_workers(false), m_qproc_active(false), m_recv_active(false), m_io_backend(jstd::net::IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false), m_cache(nullptr),
+	  m_recv_batch(1), m_send_batch(1), m_gso(false), m_gro(false),
+	  m_reliable(false), m_rel_sessions(0), m_rel_due(0), m_rel_timer(-1), m_fragmenting(false), m_frag_next_id(0),
+	  m_multicast(false) {
 	LOG_TRACE(USVR);
 	init(ip, port);
 }
 
-template<typename QItem>
-jstd::UdpServer<QItem>::~UdpServer() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::UdpServerBase(int sockfd)
+	: m_lane_workers(false), m_qproc_active(false), m_recv_active(false), m_io_backend(jstd::net::IO_BACKEND::SELECT),
+#ifdef LINUX_OS
+	  m_next_send_id(0), m_loop(nullptr),
+#endif
+	  m_is_bcast(false), m_capture(nullptr), m_wal(nullptr), m_wal_event(-1), m_coalesce(false), m_cache(nullptr),
+	  m_recv_batch(1), m_send_batch(1), m_gso(false), m_gro(false),
+	  m_reliable(false), m_rel_sessions(0), m_rel_due(0), m_rel_timer(-1), m_fragmenting(false), m_frag_next_id(0),
+	  m_multicast(false) {
+	LOG_TRACE(USVR);
+	m_svr_conn.sock_type = SOCK_DGRAM;
+	m_svr_conn.sockfd = sockfd;
+	if (sockfd < 0 || getsockname(sockfd, (struct sockaddr *) &m_svr_conn.sa, &m_svr_conn.addr_len) < 0) {
+		LOG_ERROR(USVR, "can not adopt socket ", sockfd, " errno #", errno, " descr: ", jstd::net::sockErrToString(errno));
+		util::chrono::sleep_milli(1000);
+		exit(static_cast<int>(jstd::net::FATAL_ERR::SOCK_FAIL));
+	}
+	m_svr_conn.port = ntohs(m_svr_conn.sa.sin_port);
+	m_is_nonblocking = is_nonblocking();
+	LOG_INFO(USVR, "udpserver adopted socket with IP: ", m_svr_conn.ip_addr(), " port: ", m_svr_conn.port);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::~UdpServerBase() {
 	LOG_TRACE(USVR);
 	kill_threads();
+	for (size_t i = 1; i < m_lanes.size(); i++) close(m_lanes[i]->sockfd);
 	logger::get_instance().stopLogging();
 }
 
-template<typename QItem>
-uint64_t jstd::UdpServer<QItem>::hash_conn(const jstd::net::NetConnection &conn) const {
-	return hash_conn(conn.ip_addr, conn.sa.sin_port);
+// binary address and port, no string building per datagram
+template<typename Derived, typename QItem, typename ThreadPolicy>
+uint64_t jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::hash_conn(const jstd::net::NetConnection &conn) const {
+	return (static_cast<uint64_t>(conn.sa.sin_addr.s_addr) << 16) | conn.sa.sin_port;
 }
 
-template<typename QItem>
-uint64_t jstd::UdpServer<QItem>::hash_conn(const std::string &ipaddr, const int &port) const {
-	std::hash<std::string> hasher;
-	return hasher(ipaddr + std::to_string(port));
+template<typename Derived, typename QItem, typename ThreadPolicy>
+uint64_t jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::hash_conn(const std::string &ipaddr, const int &port) const {
+	jstd::net::NetConnection conn;
+	inet_aton(ipaddr.c_str(), &conn.sa.sin_addr);
+	conn.sa.sin_port = static_cast<in_port_t>(port);
+	return derived().hash_conn(conn);
 }
 
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::add_client(const std::string &ip, const uint16_t &port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::add_client(const std::string &ip, const uint16_t &port) {
 	LOG_TRACE(USVR);
     jstd::net::NetConnection conn;
-	conn.ip_addr = ip;
 	conn.sock_type = SOCK_DGRAM;
 	conn.sa.sin_port = port;
 	conn.sa.sin_family = AF_INET;
-	int rc = inet_aton(conn.ip_addr.c_str(), &conn.sa.sin_addr);
-	if (rc < 0) {
+	if (inet_aton(ip.c_str(), &conn.sa.sin_addr) == 0) {
 		LOG_ERROR(USVR, "there was an error converting ip str:", ip, " to binary form");
 		return false;
 	}
-	int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-	if (sockfd < 0) {
-		LOG_ERROR(USVR,
-		          "there was an error creating sockect discriptor, eerno: #",
-		          errno,
-		          " descr: ",
-                  jstd::net::sockErrToString(errno));
-		return false;
+	conn.sockfd = m_svr_conn.sockfd;
+	return add_client(conn).is_valid();
+}
+
+// add client only if not currently in the table
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ConnHandle jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::add_client(const jstd::net::NetConnection &conn) {
+	uint64_t hash_id = derived().hash_conn(conn);
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	jstd::net::ConnHandle known = m_addr_index.find(hash_id);
+	if (known.is_valid())
+		return known;
+	jstd::net::ConnHandle handle = m_clients.insert(conn);
+	m_addr_index.insert(hash_id, handle);
+	m_stats.clients_added_cnt++;
+	return handle;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::_remove_client(jstd::net::ConnHandle handle) {
+	const jstd::net::NetConnection *conn = m_clients.find(handle);
+	if (!conn) return false;
+	m_addr_index.erase(derived().hash_conn(*conn));
+	if (m_reliable) {
+		std::lock_guard<mutex_type> lckr(m_rmtx);
+		m_rel_peers.erase(handle.value);
 	}
-	add_client(conn);
+	if (m_fragmenting) {
+		std::lock_guard<mutex_type> lckf(m_fmtx);
+		m_reassembler->forget(handle.value);
+	}
+	m_clients.erase(handle);
+	m_stats.clients_removed_cnt++;
 	return true;
 }
 
-// add client only if not currently in map
-template<typename QItem>
-void jstd::UdpServer<QItem>::add_client(const jstd::net::NetConnection &conn) {
-#ifdef MULTITHREADED_SRVR
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-#endif
-	uint64_t hash_id = hash_conn(conn);
-	if (m_client_connections.find(hash_id) == m_client_connections.end())
-		m_client_connections[hash_id] = conn;
-	m_stats.clients_added_cnt++;
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::get_connection(jstd::net::ConnHandle handle, jstd::net::NetConnection &conn) {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	const jstd::net::NetConnection *rec = m_clients.find(handle);
+	if (!rec) return false;
+	conn = *rec;
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::string jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::peer_address(jstd::net::ConnHandle handle) {
+	jstd::net::NetConnection conn;
+	return get_connection(handle, conn) ? conn.to_string() : std::string("unknown");
 }
 
 // process item off the msg queue
 // assumes item has valid connection information
-template<typename QItem>
-bool jstd::UdpServer<QItem>::process_item(const QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::process_item(const QItem &item) {
 	LOG_TRACE(USVR);
 	LOG_INFO(USVR, "processing item recvd:\n", item);
 	std::stringstream ss;
@@ -247,8 +806,8 @@ return true;
 }
 
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::process_item(QItem &&item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::process_item(QItem &&item) {
 	LOG_TRACE(USVR);
 	LOG_INFO(USVR, "processing rval ref item recvd:\n", item);
 	std::stringstream ss;
@@ -264,43 +823,61 @@ bool jstd::UdpServer<QItem>::process_item(QItem &&item) {
 
 // process item, but perform a client lookup via hash_id
 // typically this can be called from the recv thread
-template<typename QItem>
-bool jstd::UdpServer<QItem>::process_item(QItem &&item, uint64_t hash_id) {
-	bool found = false;
-	auto connection = lookup_client(hash_id, found);
-	if (!found) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::process_item(QItem &&item, uint64_t hash_id) {
+	jstd::net::ConnHandle handle = lookup_client(hash_id);
+	if (!handle.is_valid()) {
 		LOG_WARNING(USVR, "failed to find active connection, ", "for hash_id: ", hash_id, "aborting operation");
 		return false;
 	}
-	item.conn = connection->second;
-	return process_item(item);
+	item.conn = handle;
+	return derived().process_item(item);
 }
 
-template<typename QItem>
-auto jstd::UdpServer<QItem>::lookup_client(const uint64_t &hash_id, bool &found) {
-#ifdef MULTITHREADED_SRVR
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-#endif
-	auto it = m_client_connections.find(hash_id);
-	found = (it != m_client_connections.end());
-	return it;
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ConnHandle jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::lookup_client(const uint64_t &hash_id) {
+	return m_addr_index.find(hash_id);
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::send_item(const QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_item(const QItem &item) {
 	LOG_TRACE(USVR);
 	std::vector<uint8_t> outBoundBuff = item.serialize();
+	if (t_capture && t_capture->owner == this && t_capture->conn == item.conn)
+		t_capture->datagrams.push_back(outBoundBuff);
 	if (m_is_bcast) {
-		int num_clients = broadcast_data(outBoundBuff);
+		int num_clients = derived().broadcast_data(outBoundBuff);
 		LOG_DEBUG(USVR, num_clients, " have been broadcasted data");
 		return true;
 	}
-	ssize_t bytes_sent = sendto(item.conn.sockfd,
-	                            outBoundBuff.data(),
-	                            outBoundBuff.size(),
+	jstd::net::NetConnection conn;
+	if (!get_connection(item.conn, conn)) {
+		LOG_WARNING(USVR, "connection handle ", item.conn, " is stale, not sending message");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == jstd::net::IO_BACKEND::IO_URING && !m_reliable && !m_fragmenting)
+		return uring_send_data(conn.sa, std::move(outBoundBuff));
+#endif
+	return send_payload(conn, outBoundBuff.data(), outBoundBuff.size());
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_data(const jstd::net::NetConnection &conn, const uint8_t *data, size_t len) {
+#ifdef LINUX_OS
+	if (m_io_backend == jstd::net::IO_BACKEND::IO_URING)
+		return uring_send_data(conn.sa, std::vector<uint8_t>(data, data + len));
+#endif
+	if (t_send_batch && t_send_batch->owner == this) {
+		if (t_send_batch->batch->full()) flush_sends(*t_send_batch->batch);
+		return t_send_batch->batch->add(conn.sa, data, len);
+	}
+	ssize_t bytes_sent = sendto(m_svr_conn.sockfd,
+	                            data,
+	                            len,
 	                            0,
-	                            (const struct sockaddr *) &item.conn.sa,
-	                            item.conn.addr_len);
+	                            (const struct sockaddr *) &conn.sa,
+	                            conn.addr_len);
 	if (bytes_sent < 0) {
 		LOG_ERROR(USVR,
 		          "failed to send data, errno# ",
@@ -309,37 +886,30 @@ bool jstd::UdpServer<QItem>::send_item(const QItem &item) {
                   jstd::net::sockErrToString(errno));
 		return false;
 	}
-	LOG_INFO(USVR,
-	         "successfully sent out ",
-	         bytes_sent,
-	         " bytes of data to ",
-	         item.conn.ip_addr,
-	         ":",
-	         item.conn.sa.sin_port);
+	LOG_INFO(USVR, "successfully sent out ", bytes_sent, " bytes of data to ", conn.to_string());
 	return true;
 }
 
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::send_item(const QItem &item, uint64_t hash_id) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_item(const QItem &item, uint64_t hash_id) {
 	LOG_TRACE(USVR);
 	if (m_is_bcast) {
-		int num_clients = broadcast_data(item.serialize());
+		int num_clients = derived().broadcast_data(item.serialize());
 		LOG_DEBUG(USVR, num_clients, " clients have been broadcasted data to");
 		return true;
 	}
-	bool found;
-	auto client_it = lookup_client(hash_id, found);
-	if (!found) {
+	QItem out(item);
+	out.conn = lookup_client(hash_id);
+	if (!out.conn.is_valid()) {
 		LOG_ERROR(USVR, "client with hash_id: ", hash_id, " not found, not sending message");
 		return false;
 	}
-	item.conn = client_it->second;
-	return send_item(item);
+	return send_item(out);
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::set_nonblocking(bool isblocking) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_nonblocking(bool isblocking) {
 	LOG_TRACE(USVR);
 	if (isblocking) {
 		if (m_svr_conn.sockfd == INVALID_SOCKET) {
@@ -365,17 +935,16 @@ bool jstd::UdpServer<QItem>::set_nonblocking(bool isblocking) {
 	return true;
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::is_nonblocking() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::is_nonblocking() {
 	return static_cast<bool>(fcntl(m_svr_conn.sockfd, F_GETFL) & O_NONBLOCK);
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::set_bcast_mode(bool is_set) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_bcast_mode(bool is_set) {
 	LOG_TRACE(USVR);
 	if (is_set) {
-		LOG_INFO(USVR, "setting server to broadcast mode, current client count: ",
-		         m_client_connections.size());
+		LOG_INFO(USVR, "setting server to broadcast mode, current client count: ", m_clients.size());
 	} else {
 		LOG_INFO(USVR, "disabling broadcast mode on server");
 	}
@@ -383,62 +952,95 @@ bool jstd::UdpServer<QItem>::set_bcast_mode(bool is_set) {
 	return false;
 }
 
-template<typename QItem>
-int jstd::UdpServer<QItem>::broadcast_data(const std::vector<uint8_t> &data) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+int jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::broadcast_data(const std::vector<uint8_t> &data) {
 	LOG_TRACE(USVR);
 	if (data.empty()) {
 		LOG_WARNING(USVR, "data buffer empty, not bcasting data");
 		return 0;
 	}
-	QItem item;
-	int client_cnt = 0;
-	item.buff = data;
-	LOG_DEBUG(USVR, "broadcasting data to ", m_client_connections.size(), " clients");
-#ifdef MULTITHREADED_SRVR
-	std::lock_guard<std::mutex> lckm(m_cmtx);
+	if (m_multicast && !m_reliable) {
+		if (!send_payload(m_mcast_group, data.data(), data.size())) return 0;
+		std::lock_guard<mutex_type> lckm(m_qmtx);
+		m_stats.mcast_sent_cnt++;
+		return 1;
+	}
+	// snapshot the (trivially copyable) records so sends happen outside the client lock
+	std::vector<jstd::net::NetConnection> clients;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		clients.reserve(m_clients.size());
+		m_clients.for_each([&clients](const jstd::net::NetConnection &conn) { clients.push_back(conn); });
+	}
+#ifdef LINUX_OS
+	if (m_send_batch > 1 && m_io_backend != jstd::net::IO_BACKEND::IO_URING && !m_reliable && !m_fragmenting) {
+		// whatever this thread has batched goes out first, in the order it was sent
+		if (t_send_batch && t_send_batch->owner == this) flush_sends(*t_send_batch->batch);
+		std::vector<sockaddr_in> addrs;
+		addrs.reserve(clients.size());
+		for (const auto &client : clients) addrs.push_back(client.sa);
+		std::vector<size_t> failed;
+		size_t sent = jstd::net::send_fanout(m_svr_conn.sockfd, data.data(), data.size(), addrs.data(), addrs.size(),
+			m_send_batch, failed);
+		if (!failed.empty()) {
+			std::lock_guard<mutex_type> lckm(m_cmtx);
+			for (size_t idx : failed) {
+				LOG_WARNING(USVR, "removing client: ", clients[idx].to_string());
+				_remove_client(clients[idx].handle);
+			}
+		}
+		LOG_DEBUG(USVR, "successfully sent data to ", sent, "/", clients.size(), " clients");
+		return static_cast<int>(sent);
+	}
 #endif
-	for (const auto &client : m_client_connections) {
-		item.conn = client.second;
-		if (send_item(item)) {
+	int client_cnt = 0;
+	LOG_DEBUG(USVR, "broadcasting data to ", clients.size(), " clients");
+	for (const auto &client : clients) {
+		if (send_payload(client, data.data(), data.size())) {
 			client_cnt++;
-		} else {
-			LOG_WARNING(USVR, "removing client: ", item.conn.ip_addr, ":", item.conn.sa.sin_port);
-			_remove_client(item.conn.ip_addr, item.conn.sa.sin_port);
+		} else if (!m_reliable) {
+			// a full reliable queue is back pressure, not a client that went away
+			LOG_WARNING(USVR, "removing client: ", client.to_string());
+			std::lock_guard<mutex_type> lckm(m_cmtx);
+			_remove_client(client.handle);
 		}
 	}
-	LOG_DEBUG(USVR, "successfully sent data to ",
-	          client_cnt, "/", m_client_connections.size(), " clients");
+	LOG_DEBUG(USVR, "successfully sent data to ", client_cnt, "/", clients.size(), " clients");
 	return client_cnt;
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::clear_clients() {
-#ifdef MULTITHREADED_SRVR
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-#endif
-	m_client_connections.clear();
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::clear_clients() {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	m_clients.clear();
+	m_addr_index.clear();
+	std::lock_guard<mutex_type> lckr(m_rmtx);
+	m_rel_peers.clear();
+	if (m_fragmenting) {
+		std::lock_guard<mutex_type> lckf(m_fmtx);
+		m_reassembler->clear();
+	}
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::remove_client(const std::string &ipaddr, const int &port) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::remove_client(const std::string &ipaddr, const int &port) {
 	LOG_TRACE(USVR);
 	LOG_DEBUG(USVR, "removing client ", ipaddr, ":", port);
-#ifdef MULTITHREADED_SRVR
-	std::lock_guard<std::mutex> lckm(m_cmtx);
-#endif
-	return _remove_client(ipaddr, port);
+	uint64_t hash_id = derived().hash_conn(ipaddr, port);
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	jstd::net::ConnHandle handle = m_addr_index.find(hash_id);
+	return handle.is_valid() && _remove_client(handle);
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::_build_qitem(QItem &item,
-                                          const uint8_t *buff, const ssize_t &len, const sockaddr_in &addr) const {
-	item.conn.ip_addr = std::string(inet_ntoa(addr.sin_addr));
-	item.conn.sa = addr;
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::_build_qitem(QItem &item,
+                                          const uint8_t *buff, const ssize_t &len, jstd::net::ConnHandle conn) const {
+	item.conn = conn;
 	item.buff = std::vector<uint8_t>(buff, buff + len);
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::set_recv_timeout(int milli) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_recv_timeout(int milli) {
 	LOG_TRACE(USVR);
 		struct timeval tv = {};
 	tv.tv_sec = 0;
@@ -451,123 +1053,1458 @@ bool jstd::UdpServer<QItem>::set_recv_timeout(int milli) {
 	return true;
 }
 
-// ------------------------------------------MULTITHREAD SUPPORT-------------------------------------------------
-#ifdef MULTITHREADED_SRVR
-
-template<typename QItem>
-void jstd::UdpServer<QItem>::msg_recving() {
+// ------------------------------------------THREADING POLICY SUPPORT-------------------------------------------
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::msg_recving() {
 	LOG_TRACE(USVR);
 	LOG_DEBUG(USVR, "message receiving thread started");
+	switch (m_io_backend) {
+		case jstd::net::IO_BACKEND::IO_URING:
+			uring_recving();
+			break;
+		case jstd::net::IO_BACKEND::EPOLL:
+			epoll_recving();
+			break;
+		default:
+			recvfrom_recving(m_svr_conn.sockfd, m_rbatch.get(), m_recv_sends.get());
+			break;
+	}
+	LOG_DEBUG(USVR, "exiting message recv thread...");
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::on_datagram(const uint8_t *buff, ssize_t len, const sockaddr_in &from) {
+	jstd::net::NetConnection conn;
+	conn.sa = from;
+	conn.port = ntohs(from.sin_port);
+	conn.sockfd = m_svr_conn.sockfd;   // replies go out through the listening socket
+	if (jstd::net::TrafficCapture *cap = m_capture.load(std::memory_order_relaxed))
+		cap->record(jstd::net::CAPTURE_PROTO::UDP, (static_cast<uint64_t>(from.sin_addr.s_addr) << 16) | conn.port,
+			buff, static_cast<size_t>(len));
+	// known clients resolve without m_cmtx, add_client() only runs on first contact
+	jstd::net::ConnHandle handle = m_addr_index.find(derived().hash_conn(conn));
+	if (!handle.is_valid()) handle = add_client(conn);
+	LOG_INFO(USVR, "recvd ", len, " bytes from client ", handle);
+	recv_stats().msg_recvd_cnt++;
+	if (m_reliable) {
+		conn.handle = handle;
+		on_reliable_datagram(buff, static_cast<size_t>(len), conn);
+		return;
+	}
+	dispatch_datagram(buff, static_cast<size_t>(len), handle);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::dispatch_datagram(const uint8_t *buff, size_t len,
+                                                                        jstd::net::ConnHandle handle) {
+	using namespace jstd::net;
+	if (!m_fragmenting) {
+		dispatch_message(buff, len, handle);
+		return;
+	}
+	std::vector<uint8_t> message;
+	FRAG_RECV res;
+	{
+		std::lock_guard<mutex_type> lckf(m_fmtx);
+		res = m_reassembler->add(handle.value, buff, len, message, m_frag_counters);
+	}
+	switch (res) {
+		case FRAG_RECV::WHOLE:
+			dispatch_message(buff + FRAG_HEADER, len - FRAG_HEADER, handle);
+			break;
+		case FRAG_RECV::COMPLETE:
+			LOG_DEBUG(USVR, "reassembled a message of ", message.size(), " bytes from client ", handle);
+			dispatch_message(message.data(), message.size(), handle);
+			break;
+		case FRAG_RECV::REJECTED:
+			LOG_WARNING(USVR, "datagram of client ", handle, " is not a valid fragment, dropped");
+			break;
+		default:
+			break;
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::dispatch_message(const uint8_t *buff, size_t len,
+                                                                       jstd::net::ConnHandle handle) {
+	item_ctx ctx{0, 0, 0, 0};
+	if (m_cache && answer_from_cache(buff, static_cast<size_t>(len), handle, ctx)) return;
+	if (m_coalesce) {
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		if (m_coalescer.join(buff, static_cast<size_t>(len), handle, ctx.flight) == jstd::net::COALESCE::JOINED) return;
+	}
+	if (m_wal) {
+		wal_append(buff, len, handle, ctx);
+		return;
+	}
+	QItem item;
+	derived()._build_qitem(item, buff, len, handle);
+	push_qitem(std::move(item), static_cast<uint32_t>(len), ctx);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::recvfrom_recving(int sockfd, jstd::net::RecvBatch *rbatch,
+                                                                       jstd::net::SendBatch *sends) {
+	LOG_TRACE(USVR);
+#ifdef LINUX_OS
+	if (rbatch) {
+		while (m_recv_active) {
+			recv_batch(sockfd, *rbatch, sends, MSG_WAITFORONE);
+			reliable_inline_tick();
+		}
+		return;
+	}
+#else
+	(void)rbatch;
+	(void)sends;
+#endif
 	uint8_t buff[MAX_BUFF_SIZE];
 	std::memset(buff, 0, MAX_BUFF_SIZE);
 	ssize_t num_bytes = 0;
 	sockaddr_in from_addr{};
 	socklen_t addr_len = sizeof(sockaddr_in);
 	while (m_recv_active) {
-		num_bytes = recvfrom(m_svr_conn.sockfd,
+		// MSG_TRUNC returns the datagram's real length, a larger one than the buffer was cut short
+		num_bytes = recvfrom(sockfd,
 		                     buff,
 		                     MAX_BUFF_SIZE,
-		                     0,
+		                     MSG_TRUNC,
 		                     (struct sockaddr *) &from_addr,
 		                     &addr_len);
-		if (num_bytes > 0) {
-			QItem item;
-			_build_qitem(item, buff, num_bytes, from_addr);
-			LOG_INFO(USVR, "recvd ", num_bytes, " bytes from ", item.conn.ip_addr, ":", item.conn.sa.sin_port);
-			add_client(item.conn);
-			push_qitem(item);
-			m_stats.msg_recvd_cnt++;
+		if (num_bytes > MAX_BUFF_SIZE) {
+			on_truncated(from_addr, static_cast<size_t>(num_bytes));
+		} else if (num_bytes > 0) {
+			on_datagram(buff, num_bytes, from_addr);
 			std::memset(buff, 0, sizeof(buff));
 		}
+		reliable_inline_tick();
 	}
-	LOG_DEBUG(USVR, "exiting message recv thread...");
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::msg_processing() {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::msg_processing(unsigned worker) {
 	LOG_TRACE(USVR);
-	LOG_DEBUG(USVR, "message processing thread started");
+	LOG_DEBUG(USVR, "message processing thread ", worker, " started");
+	ThreadPolicy::on_worker_start(worker);
+	process_queue(m_msg_queue, m_qmtx, m_stats, worker);
+	LOG_DEBUG(USVR, "terminating message processing thread ", worker);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::process_queue(jstd::net::MsgQueue<queued_item> &queue,
+                                                                    mutex_type &qmtx, jstd::net::ServerStats &stats,
+                                                                    unsigned) {
+	typename jstd::net::MsgQueue<queued_item>::shed_list shed;
+	// responses of back to back items share a sendmmsg, the batch is flushed whenever the queue runs dry
+	std::unique_ptr<jstd::net::SendBatch> sends(m_send_batch > 1 ? new jstd::net::SendBatch(m_send_batch) : nullptr);
+	send_batching batching{this, sends.get()};
+	if (sends) t_send_batch = &batching;
 	while (m_qproc_active) {
-		util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
-		if (!m_msg_queue.empty()) {
-			if (process_item(std::move(m_msg_queue.front())))
-				m_stats.msg_processed_cnt++;
-			m_qmtx.lock();
-			m_msg_queue.pop();
-			m_qmtx.unlock();
+		queued_item entry;
+		bool have_item;
+		{
+			std::lock_guard<mutex_type> lckm(qmtx);
+			uint64_t sojourn_us = 0;
+			have_item = queue.pop(entry, sojourn_us, shed);
+			if (have_item) stats.sojourn_us.record(sojourn_us);
+			for (const auto &s : shed) {
+				if (s.second == jstd::net::SHED_REASON::DEADLINE) stats.shed_deadline_cnt++;
+				else stats.shed_delay_cnt++;
+			}
 		}
+		for (auto &s : shed) {
+			derived().on_shed(std::move(s.first.item), s.second);
+			if (s.first.ctx.flight) shed_flight(s.first.ctx.flight, s.second);
+			if (s.first.ctx.wal_seq) m_wal->complete(s.first.ctx.wal_seq);
+		}
+		shed.clear();
+		if (!have_item) {
+			if (sends && !sends->empty()) {
+				flush_sends(*sends);
+				continue;
+			}
+			util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
+			continue;
+		}
+		if (process_entry(std::move(entry.item), entry.ctx)) {
+			std::lock_guard<mutex_type> lckm(qmtx);
+			stats.msg_processed_cnt++;
+		}
+		if (entry.ctx.wal_seq) m_wal->complete(entry.ctx.wal_seq);
+	}
+	if (sends) {
+		flush_sends(*sends);
+		t_send_batch = nullptr;
 	}
-	LOG_DEBUG(USVR, "terminating message processing thread");
 }
 
-template<typename QItem>
-bool jstd::UdpServer<QItem>::run() {
-	LOG_DEBUG(USVR, "starting message receiving and item processing thread");
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::run() {
 	m_qproc_active = true;
 	m_recv_active = true;
-	m_recv_thread = std::thread(&UdpServer::msg_recving, this);
-	m_q_proc_thread = std::thread(&UdpServer::msg_processing, this);
+	if (!ThreadPolicy::threaded) {
+		LOG_DEBUG(USVR, "running receive loop inline, datagrams are processed as they arrive");
+		msg_recving();
+		return true;
+	}
+	if (m_reliable) m_rel_thread = std::thread(&UdpServerBase::reliable_timing, this);
+	if (!m_lanes.empty()) {
+		start_lanes();
+		// committed items are released on the log's thread, off any lane, into the shared queue
+		if (m_lane_workers && !m_wal) return true;
+	} else {
+		LOG_DEBUG(USVR, "starting message receiving and ", ThreadPolicy::worker_count(), " item processing thread(s)");
+		m_recv_thread = std::thread(&UdpServerBase::msg_recving, this);
+	}
+	for (unsigned i = 0; i < ThreadPolicy::worker_count(); i++)
+		m_workers.emplace_back(&UdpServerBase::msg_processing, this, i);
 	return true;
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::push_qitem(const QItem &item) {
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::push_qitem(QItem &&item, uint32_t bytes, const item_ctx &ctx) {
 	LOG_TRACE(USVR);
-	std::lock_guard<std::mutex> lckm(m_qmtx);
-	m_msg_queue.push(item);
+	if (!ThreadPolicy::threaded || is_attached()) {
+		if (process_entry(std::move(item), ctx))
+			m_stats.msg_processed_cnt++;
+		if (ctx.wal_seq) m_wal->complete(ctx.wal_seq);
+		return;
+	}
+	unsigned deadline_ms = derived().item_deadline_ms(item);
+	uint64_t flow = item.conn.value;
+	reuseport_lane *lane = current_lane();
+	if (lane && m_lane_workers) {
+		std::lock_guard<mutex_type> lckm(lane->qmtx);
+		lane->queue.push(queued_item{std::move(item), ctx}, flow, bytes, deadline_ms);
+		return;
+	}
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_msg_queue.push(queued_item{std::move(item), ctx}, flow, bytes, deadline_ms);
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::join_threads() {
-	LOG_TRACE(USVR);
-	LOG_DEBUG(USVR, "UDP server is now blocking, until app termination");
-	m_recv_thread.join();
-	m_q_proc_thread.join();
-	LOG_DEBUG(USVR, "UDP server theads have exited");
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::start_lanes() {
+	using namespace jstd::net;
+	LOG_DEBUG(USVR, "starting ", m_lanes.size(), " receive lanes", m_lane_workers ? " with a processing thread each" : "");
+	timeval tv = {};
+	tv.tv_usec = DEFAULT_LANE_RECV_TIMEOUT_MILLI * 1000;
+	for (auto &lp : m_lanes) {
+		reuseport_lane &lane = *lp;
+		// blocked lanes have to wake up to see kill_threads()
+		setsockopt(lane.sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		if (lane.index) udp_offload::set_gro(lane.sockfd, m_gro);
+		lane.rbatch = make_recv_batch();
+		lane.sends.reset(m_send_batch > 1 ? new SendBatch(m_send_batch) : nullptr);
+		{
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			lane.queue.configure(m_msg_queue.config());
+			lane.queue.set_discipline(m_msg_queue.discipline(), m_msg_queue.quantum());
+		}
+		lane.recv_thread = std::thread(&UdpServerBase::lane_recving, this, std::ref(lane));
+		if (m_lane_workers) lane.worker = std::thread(&UdpServerBase::lane_processing, this, std::ref(lane));
+	}
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::kill_threads() {
-	LOG_TRACE(USVR);
-	LOG_DEBUG(USVR, "shuttdown server threads");
-	LOG_DEBUG(USVR, "\n", m_stats);
-	m_qproc_active = false;
-	m_recv_active = false;
-	join_threads();
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::lane_recving(reuseport_lane &lane) {
+	LOG_DEBUG(USVR, "receive lane ", lane.index, " started on socket ", lane.sockfd);
+	t_lane = &lane;
+	recvfrom_recving(lane.sockfd, lane.rbatch.get(), lane.sends.get());
+	t_lane = nullptr;
+	LOG_DEBUG(USVR, "exiting receive lane ", lane.index);
 }
 
-template<typename QItem>
-void jstd::UdpServer<QItem>::init(const std::string &ip, in_port_t port) {
-	using namespace util::chrono;
-	using namespace net;
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::lane_processing(reuseport_lane &lane) {
+	LOG_DEBUG(USVR, "processing thread of lane ", lane.index, " started");
+	ThreadPolicy::on_worker_start(lane.index);
+	process_queue(lane.queue, lane.qmtx, lane.stats, lane.index);
+	LOG_DEBUG(USVR, "terminating processing thread of lane ", lane.index);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::process_entry(QItem &&item, const item_ctx &ctx) {
+	if (!ctx.flight && !ctx.cache_key) return derived().process_item(std::move(item));
+	response_capture capture{this, item.conn, std::vector<std::vector<uint8_t>>()};
+	response_capture *outer = t_capture;
+	t_capture = &capture;
+	bool processed = derived().process_item(std::move(item));
+	t_capture = outer;
+	// a reply of several datagrams can not be stored as one response
+	if (processed && ctx.cache_key && capture.datagrams.size() == 1)
+		m_cache->insert(ctx.cache_key, ctx.cache_check, capture.datagrams[0].data(), capture.datagrams[0].size());
+	if (!ctx.flight) return processed;
+	// waiters attach until the flight ends, anything arriving later starts a flight of its own
+	jstd::net::RequestCoalescer::Flight f;
+	{
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		m_coalescer.finish(ctx.flight, f);
+	}
+	if (f.waiters.empty()) return processed;
+	jstd::net::NetConnection conn;
+	for (jstd::net::ConnHandle waiter : f.waiters) {
+		if (!get_connection(waiter, conn)) continue;
+		for (const auto &dgram : capture.datagrams)
+			send_payload(conn, dgram.data(), dgram.size());
+	}
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_stats.coalesced_cnt += f.waiters.size();
+	return processed;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::answer_from_cache(const uint8_t *buff, size_t len,
+                                                                        jstd::net::ConnHandle conn, item_ctx &ctx) {
+	jstd::net::NetConnection c;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		const jstd::net::NetConnection *rec = m_clients.find(conn);
+		if (!rec || is_cache_bypassed(conn)) return false;
+		c = *rec;
+	}
+	jstd::net::ResponseCache::fingerprint(buff, len, ctx.cache_key, ctx.cache_check);
+	reuseport_lane *lane = current_lane();
+	std::vector<uint8_t> &hit = lane ? lane->cache_hit : m_cache_hit;
+	if (!m_cache->lookup(ctx.cache_key, ctx.cache_check, hit)) return false;
+	send_payload(c, hit.data(), hit.size());
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_cache_bypass(jstd::net::ConnHandle conn, bool bypass) {
+	std::lock_guard<mutex_type> lckm(m_cmtx);
+	if (!m_clients.find(conn)) return false;
+	if (conn.index() >= m_cache_bypass.size()) m_cache_bypass.resize(conn.index() + 1);
+	m_cache_bypass[conn.index()] = bypass ? conn : jstd::net::ConnHandle();
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::shed_flight(uint64_t flight, jstd::net::SHED_REASON reason) {
+	jstd::net::RequestCoalescer::Flight f;
+	{
+		std::lock_guard<mutex_type> lck(m_co_mtx);
+		m_coalescer.finish(flight, f);
+	}
+	for (jstd::net::ConnHandle waiter : f.waiters) {
+		QItem item;
+		derived()._build_qitem(item, f.payload.data(), static_cast<ssize_t>(f.payload.size()), waiter);
+		derived().on_shed(std::move(item), reason);
+	}
+	if (f.waiters.empty()) return;
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	if (reason == jstd::net::SHED_REASON::DEADLINE) m_stats.shed_deadline_cnt += f.waiters.size();
+	else m_stats.shed_delay_cnt += f.waiters.size();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_wal(jstd::net::WriteAheadLog *wal) {
 	LOG_TRACE(USVR);
-	m_svr_conn.ip_addr = ip;
-	m_svr_conn.sock_type = SOCK_DGRAM;
-	m_svr_conn.sa.sin_port = htons(port);
-	m_svr_conn.port = port;
-	if (inet_aton(m_svr_conn.ip_addr.c_str(), &m_svr_conn.sa.sin_addr) == 0) {
-		LOG_ERROR(USVR, "invalid ip address supplied errno #", errno, " descr: ", jstd::net::sockErrToString(errno));
-		sleep_milli(1000);
-		exit(static_cast<int>(FATAL_ERR::IP_INET_FAIL));
+	if (!wal || !wal->is_open()) {
+		LOG_ERROR(USVR, "write ahead log is not open");
+		return false;
 	}
-	m_svr_conn.sa.sin_family = AF_INET;
-	m_svr_conn.sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-	if (m_svr_conn.sockfd < 0) {
-		LOG_ERROR(USVR, "error creating udp socket discriptor errno # ", errno, " descr: ", jstd::net::sockErrToString(errno));
-		sleep_milli(1000);
-		exit(static_cast<int>(FATAL_ERR::SOCK_FAIL));
+	if (!ThreadPolicy::threaded && !is_attached()) {
+		// commits complete on the log's thread, without workers or a loop to hand items to they would stall
+		LOG_ERROR(USVR, "a write ahead log needs a threaded policy or an attached server");
+		return false;
 	}
-	int rc = bind(m_svr_conn.sockfd, (const struct sockaddr *) &m_svr_conn.sa, sizeof(m_svr_conn.sa));
-	if (rc < 0) {
-		LOG_ERROR(USVR, "binding socket to addr failed errno #", errno, " descr: ", jstd::net::sockErrToString(errno));
-		sleep_milli(1000);
-		exit(static_cast<int>(FATAL_ERR::SOCK_BIND_FAIL));
+	if (m_wal) {
+		LOG_WARNING(USVR, "write ahead log already set");
+		return false;
+	}
+	m_wal = wal;
+#ifdef LINUX_OS
+	if (m_loop) m_wal_event = m_loop->add_event([this]() { wal_release(); });
+#endif
+	wal->set_commit_handler([this](uint64_t) { wal_committed(); });
+	size_t replayed = wal->replay([this](uint64_t seq, const uint8_t *data, size_t len) {
+		QItem item;
+		derived()._build_qitem(item, data, static_cast<ssize_t>(len), jstd::net::ConnHandle());
+		std::lock_guard<std::mutex> lck(m_wal_mtx);
+		m_wal_pending.push_back(wal_item{static_cast<uint32_t>(len), item_ctx{seq, 0, 0, 0}, std::move(item)});
+	});
+	if (replayed) LOG_INFO(USVR, "replaying ", replayed, " unprocessed item(s) from the write ahead log");
+	wal_release();
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::wal_append(const uint8_t *buff, size_t len,
+                                                                 jstd::net::ConnHandle conn, item_ctx ctx) {
+	QItem item;
+	derived()._build_qitem(item, buff, static_cast<ssize_t>(len), conn);
+	// append and stash under one lock, a commit landing in between would otherwise miss the item
+	std::lock_guard<std::mutex> lck(m_wal_mtx);
+	ctx.wal_seq = m_wal->append(buff, len);
+	if (!ctx.wal_seq) {
+		LOG_ERROR(USVR, "write ahead log refused ", len, " bytes, dropping them");
+		if (ctx.flight) {
+			// the item never reaches processing, datagrams waiting on it are dropped with it
+			jstd::net::RequestCoalescer::Flight f;
+			std::lock_guard<mutex_type> lckc(m_co_mtx);
+			m_coalescer.finish(ctx.flight, f);
+		}
+		return;
+	}
+	m_wal_pending.push_back(wal_item{static_cast<uint32_t>(len), ctx, std::move(item)});
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::wal_committed() {
+#ifdef LINUX_OS
+	// attached servers process on the loop thread only
+	if (m_wal_event >= 0) {
+		jstd::net::EventLoop::notify(m_wal_event);
+		return;
 	}
-#ifdef MULTITHREADED_SRVR
-	m_is_nonblocking = false;
 #endif
-	LOG_INFO(USVR, "udpserver with IP: ", m_svr_conn.ip_addr, " port: ", htons(m_svr_conn.sa.sin_port));
+	wal_release();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::wal_release() {
+	std::vector<wal_item> ready;
+	{
+		std::lock_guard<std::mutex> lck(m_wal_mtx);
+		uint64_t committed = m_wal->committed();
+		while (!m_wal_pending.empty() && m_wal_pending.front().ctx.wal_seq <= committed) {
+			ready.push_back(std::move(m_wal_pending.front()));
+			m_wal_pending.pop_front();
+		}
+	}
+	for (auto &r : ready)
+		push_qitem(std::move(r.item), r.bytes, r.ctx);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_queue_discipline(jstd::net::QUEUE_DISCIPLINE discipline,
+                                                                           uint32_t quantum) {
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	if (!m_msg_queue.empty()) {
+		LOG_WARNING(USVR, "datagrams are queued, queue discipline left unchanged");
+		return false;
+	}
+	m_msg_queue.set_discipline(discipline, quantum);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::vector<jstd::net::FlowStats> jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::queue_stats() {
+	std::vector<jstd::net::FlowStats> flows;
+	{
+		std::lock_guard<mutex_type> lckm(m_qmtx);
+		m_msg_queue.flow_stats(flows);
+	}
+	for (auto &lane : m_lanes) {
+		std::lock_guard<mutex_type> lckm(lane->qmtx);
+		lane->queue.flow_stats(flows);
+	}
+	return flows;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::on_truncated(const sockaddr_in &from, size_t len) {
+	jstd::net::NetConnection conn;
+	conn.sa = from;
+	LOG_WARNING(USVR, "datagram of ", len, " bytes from ", conn.to_string(), " does not fit the receive buffer, dropped");
+	recv_stats().trunc_cnt++;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_load_shedding(const jstd::net::ShedConfig &cfg) {
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_msg_queue.configure(cfg);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+jstd::net::ServerStats jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::stats() {
+	jstd::net::ServerStats merged;
+	{
+		std::lock_guard<mutex_type> lckm(m_qmtx);
+		merged = m_stats;
+	}
+	for (auto &lane : m_lanes) {
+		std::lock_guard<mutex_type> lckm(lane->qmtx);
+		merged.merge(lane->stats);
+	}
+	if (m_reliable) {
+		std::lock_guard<mutex_type> lckm(m_rmtx);
+		merged.rel_sent_cnt = m_rel_counters.sent;
+		merged.rel_retrans_cnt = m_rel_counters.retransmitted;
+		merged.rel_fast_retrans_cnt = m_rel_counters.fast_retransmitted;
+		merged.rel_dup_cnt = m_rel_counters.duplicates;
+		merged.rel_reset_cnt = m_rel_counters.resets;
+		merged.rel_resync_cnt = m_rel_counters.resyncs;
+		merged.rel_injected_loss_cnt = m_rel_counters.injected_losses;
+	}
+	if (m_fragmenting) {
+		std::lock_guard<mutex_type> lckf(m_fmtx);
+		merged.frag_split_cnt = m_frag_counters.split;
+		merged.frag_sent_cnt = m_frag_counters.fragments;
+		merged.frag_reassembled_cnt = m_frag_counters.reassembled;
+		merged.frag_expired_cnt = m_frag_counters.expired;
+		merged.frag_evicted_cnt = m_frag_counters.evicted;
+		merged.frag_rejected_cnt = m_frag_counters.rejected;
+	}
+	return merged;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::vector<jstd::net::ServerStats> jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::lane_stats() {
+	std::vector<jstd::net::ServerStats> out;
+	for (auto &lane : m_lanes) {
+		std::lock_guard<mutex_type> lckm(lane->qmtx);
+		out.push_back(lane->stats);
+	}
+	return out;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::on_shed(QItem &&item, jstd::net::SHED_REASON reason) {
+	LOG_DEBUG(USVR, "shed datagram of ", item.conn, reason == jstd::net::SHED_REASON::DEADLINE ? ", deadline passed" : ", queue delay");
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+unsigned jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::item_deadline_ms(const QItem &) const {
+	return 0;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::join_threads() {
+	LOG_TRACE(USVR);
+	LOG_DEBUG(USVR, "UDP server is now blocking, until app termination");
+	if (m_recv_thread.joinable()) m_recv_thread.join();
+	if (m_rel_thread.joinable()) m_rel_thread.join();
+	for (auto &lane : m_lanes) {
+		if (lane->recv_thread.joinable()) lane->recv_thread.join();
+		if (lane->worker.joinable()) lane->worker.join();
+	}
+	for (auto &worker : m_workers)
+		if (worker.joinable()) worker.join();
+	m_workers.clear();
+	LOG_DEBUG(USVR, "UDP server theads have exited");
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::kill_threads() {
+	LOG_TRACE(USVR);
+	LOG_DEBUG(USVR, "shuttdown server threads");
+	LOG_DEBUG(USVR, "\n", m_stats);
+	m_qproc_active = false;
+	m_recv_active = false;
+#ifdef LINUX_OS
+	if (m_loop) detach();
+	// completion waits have no timeout, kick the ring so the recv thread sees the flag
+	if (m_io_backend == jstd::net::IO_BACKEND::IO_URING && m_uring.is_active()) {
+		m_uring.prep_nop(jstd::net::IoUring::pack_user_data(static_cast<uint8_t>(jstd::net::URING_TAG::WAKE), 0));
+		m_uring.submit();
+	}
+#endif
+	join_threads();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::quiesce() {
+	LOG_TRACE(USVR);
+#ifdef LINUX_OS
+	if (m_loop) {
+		// on the loop thread nothing new is read meanwhile, items held for the log are released inline
+		while (m_wal && !m_wal->drained()) {
+			wal_release();
+			util::chrono::sleep_milli(1);
+		}
+		detach();
+		return;
+	}
+#endif
+	m_recv_active = false;
+	if (m_recv_thread.joinable()) {
+		if (m_io_backend == jstd::net::IO_BACKEND::SELECT && !m_is_nonblocking) {
+			// a blocked recvfrom would never see the flag, wake it with an empty datagram, which it skips
+			int fd = socket(AF_INET, SOCK_DGRAM, 0);
+			if (fd >= 0) {
+				sendto(fd, nullptr, 0, 0, (const struct sockaddr *) &m_svr_conn.sa, sizeof(m_svr_conn.sa));
+				close(fd);
+			}
+		}
+		m_recv_thread.join();
+	}
+	if (!ThreadPolicy::threaded) return;
+	// a logged item counts until complete(), which also covers items between the log and the queue
+	while (true) {
+		bool idle = !m_wal || m_wal->drained();
+		{
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			idle = idle && m_msg_queue.empty();
+		}
+		if (idle) break;
+		util::chrono::sleep_milli(DEFAULT_SVR_THREAD_SLEEP);
+	}
+	// workers finish the datagram in hand before they look at the flag
+	m_qproc_active = false;
+	join_threads();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::hand_off(jstd::net::HotRestart &channel) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (!channel.is_connected()) {
+		LOG_ERROR(USVR, "no successor connected to hand the server off to");
+		return false;
+	}
+	if (!ThreadPolicy::threaded && !is_attached() && m_recv_active) {
+		LOG_ERROR(USVR, "stop the server with kill_threads() and hand it off once run() returned");
+		return false;
+	}
+	if (!m_lanes.empty()) {
+		LOG_ERROR(USVR, "servers with receive lanes can not be handed off, only the listening socket would be passed");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (m_io_backend == IO_BACKEND::IO_URING && !m_loop) {
+		LOG_ERROR(USVR, "io_uring servers can not be handed off, recvs armed on the ring would eat the successor's datagrams");
+		return false;
+	}
+	EventLoop *loop = m_loop;
+#endif
+	bool was_running = m_recv_active;
+	quiesce();
+	HandoffState state;
+	state.proto = PROTOCOL::UDP;
+	state.listen_fd = m_svr_conn.sockfd;
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		m_clients.for_each([this, &state](const NetConnection &conn) {
+			state.conns.push_back(conn);
+			state.conns.back().sockfd = INVALID_SOCKET;     // every client shares the server socket
+			state.cache_bypass.push_back(is_cache_bypassed(conn.handle));
+		});
+	}
+	if (!channel.send_state(state)) {
+		LOG_ERROR(USVR, "successor did not take over errno: ", errno, " descr: ", sockErrToString(errno), ", serving on");
+#ifdef LINUX_OS
+		if (loop) {
+			attach(*loop);
+			return false;
+		}
+#endif
+		if (ThreadPolicy::threaded && was_running) run();
+		return false;
+	}
+	{
+		std::lock_guard<mutex_type> lckm(m_cmtx);
+		m_clients.clear();
+		m_addr_index.clear();
+		std::lock_guard<mutex_type> lckr(m_rmtx);
+		m_rel_peers.clear();
+		if (m_fragmenting) {
+			std::lock_guard<mutex_type> lckf(m_fmtx);
+			m_reassembler->clear();
+		}
+	}
+#ifdef LINUX_OS
+	m_epoll.clear_fd(m_svr_conn.sockfd);
+#endif
+	close(m_svr_conn.sockfd);
+	m_svr_conn.sockfd = INVALID_SOCKET;
+	LOG_INFO(USVR, "handed socket ", m_svr_conn.to_string(), " and ", state.conns.size(), " client(s) to the successor");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+size_t jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::take_over(jstd::net::HandoffState &state) {
+	LOG_TRACE(USVR);
+	if (state.proto != jstd::net::PROTOCOL::UDP) {
+		LOG_ERROR(USVR, "handed off state is not a udp server's");
+		return 0;
+	}
+	for (size_t i = 0; i < state.conns.size(); i++) {
+		state.conns[i].sockfd = m_svr_conn.sockfd;
+		jstd::net::ConnHandle handle = add_client(state.conns[i]);
+		if (i < state.cache_bypass.size() && state.cache_bypass[i]) set_cache_bypass(handle, true);
+	}
+	size_t cnt = state.conns.size();
+	state.conns.clear();
+	state.conn_state.clear();
+	state.cache_bypass.clear();
+	LOG_INFO(USVR, "took over ", cnt, " client(s) on ", m_svr_conn.to_string());
+	return cnt;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_io_backend(jstd::net::IO_BACKEND backend) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "io backend can not be changed while the server is running");
+		return false;
+	}
+	if (!m_lanes.empty() && backend != IO_BACKEND::SELECT) {
+		LOG_WARNING(USVR, "receive lanes block in recv, turn them off with set_reuseport(1, false) first");
+		return false;
+	}
+#ifdef LINUX_OS
+	if (backend == IO_BACKEND::IO_URING && !init_uring()) {
+		LOG_WARNING(USVR, "io_uring unavailable errno: ", errno, " descr: ", sockErrToString(errno),
+			", falling back to epoll");
+		m_io_backend = m_epoll.is_valid() ? IO_BACKEND::EPOLL : IO_BACKEND::SELECT;
+		return false;
+	}
+	if (backend == IO_BACKEND::EPOLL && !m_epoll.is_valid()) {
+		LOG_WARNING(USVR, "epoll instance is invalid, staying on recvfrom");
+		return false;
+	}
+	if (backend == IO_BACKEND::IO_URING && m_gro) {
+		LOG_WARNING(USVR, "io_uring receives do not split coalesced datagrams, turning UDP_GRO off");
+		udp_offload::set_gro(m_svr_conn.sockfd, false);
+		m_gro = false;
+		m_rbatch = make_recv_batch();
+	}
+	m_io_backend = backend;
+	return true;
+#else
+	m_io_backend = IO_BACKEND::SELECT;
+	return backend == IO_BACKEND::SELECT;
+#endif
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_batching(unsigned recv_batch, unsigned send_batch) {
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, batch sizes can not be changed");
+		return false;
+	}
+#ifndef LINUX_OS
+	if (recv_batch > 1 || send_batch > 1) {
+		LOG_WARNING(USVR, "recvmmsg/sendmmsg are not available, batching stays off");
+		return false;
+	}
+#endif
+	m_recv_batch = std::max(1u, std::min(recv_batch, MAX_UDP_BATCH));
+	m_send_batch = std::max(1u, std::min(send_batch, MAX_UDP_BATCH));
+	m_rbatch = make_recv_batch();
+	m_recv_sends.reset(m_send_batch > 1 ? new jstd::net::SendBatch(m_send_batch) : nullptr);
+	LOG_INFO(USVR, "datagram batches, recv: ", m_recv_batch, " send: ", m_send_batch);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+std::unique_ptr<jstd::net::RecvBatch> jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::make_recv_batch() const {
+	// a coalesced datagram can be as large as a UDP payload gets
+	size_t buff_sz = m_gro ? UDP_GRO_BUFF_SIZE : MAX_BUFF_SIZE;
+	return std::unique_ptr<jstd::net::RecvBatch>(
+		m_recv_batch > 1 || m_gro ? new jstd::net::RecvBatch(m_recv_batch, buff_sz) : nullptr);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_reuseport(unsigned sockets, bool lane_workers, bool steer) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, receive lanes can not be changed");
+		return false;
+	}
+	if (!ThreadPolicy::threaded) {
+		LOG_WARNING(USVR, "receive lanes share the client table, they need a threaded policy");
+		return false;
+	}
+	if (m_io_backend != IO_BACKEND::SELECT) {
+		LOG_WARNING(USVR, "receive lanes block in recv, they need the SELECT backend");
+		return false;
+	}
+	for (size_t i = 1; i < m_lanes.size(); i++) close(m_lanes[i]->sockfd);
+	m_lanes.clear();
+	m_lane_workers = false;
+	if (sockets < 2) return true;
+	// the address actually bound, the kernel may have picked the port
+	sockaddr_in addr{};
+	socklen_t addr_len = sizeof(addr);
+	getsockname(m_svr_conn.sockfd, (struct sockaddr *) &addr, &addr_len);
+	if (!reuseport::is_set(m_svr_conn.sockfd)) {
+		// a group only takes sockets that all set SO_REUSEPORT before bind, the listening socket is bound again
+		close(m_svr_conn.sockfd);
+		m_svr_conn.sockfd = reuseport::bind_socket(addr);
+		if (m_svr_conn.sockfd < 0) {
+			LOG_ERROR(USVR, "binding SO_REUSEPORT socket failed errno #", errno, " descr: ", sockErrToString(errno));
+			util::chrono::sleep_milli(1000);
+			exit(static_cast<int>(FATAL_ERR::SOCK_BIND_FAIL));
+		}
+		m_is_nonblocking = false;
+		if (m_gro) udp_offload::set_gro(m_svr_conn.sockfd, true);
+	}
+	std::vector<int> fds(1, m_svr_conn.sockfd);
+	while (fds.size() < sockets) {
+		int fd = reuseport::bind_socket(addr);
+		if (fd < 0) {
+			LOG_ERROR(USVR, "binding SO_REUSEPORT socket failed errno #", errno, " descr: ", sockErrToString(errno));
+			for (size_t i = 1; i < fds.size(); i++) close(fds[i]);
+			return false;
+		}
+		fds.push_back(fd);
+	}
+	for (unsigned i = 0; i < fds.size(); i++) {
+		m_lanes.emplace_back(new reuseport_lane());
+		m_lanes.back()->owner = this;
+		m_lanes.back()->index = i;
+		m_lanes.back()->sockfd = fds[i];
+	}
+	m_lane_workers = lane_workers;
+	LOG_INFO(USVR, sockets, " receive lanes on ", m_svr_conn.ip_addr(), ":", ntohs(addr.sin_port),
+	         lane_workers ? " with a processing thread each" : "");
+	if (steer && !reuseport::steer_by_source(m_svr_conn.sockfd, sockets)) {
+		LOG_WARNING(USVR, "kernel refused the steering program errno: ", errno, ", lanes are picked by hash");
+		return false;
+	}
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_udp_offload(bool gso, bool gro) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, offload can not be changed");
+		return false;
+	}
+	bool ok = true;
+	m_gso = gso && udp_offload::gso_supported(m_svr_conn.sockfd);
+	if (gso && !m_gso) {
+		LOG_WARNING(USVR, "kernel does not support UDP_SEGMENT, sending a datagram per syscall");
+		ok = false;
+	}
+	if (gro && m_io_backend == IO_BACKEND::IO_URING) {
+		LOG_WARNING(USVR, "io_uring receives do not split coalesced datagrams, UDP_GRO stays off");
+		gro = false;
+		ok = false;
+	}
+	if (gro != m_gro) {
+		if (udp_offload::set_gro(m_svr_conn.sockfd, gro)) {
+			m_gro = gro;
+		} else {
+			LOG_WARNING(USVR, "kernel refused UDP_GRO errno: ", errno, " descr: ", sockErrToString(errno));
+			ok = false;
+		}
+	}
+	m_rbatch = make_recv_batch();
+	LOG_INFO(USVR, "udp offload, gso: ", m_gso.load(), " gro: ", m_gro);
+	return ok;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_segments(jstd::net::ConnHandle handle, const uint8_t *data,
+                                                                    size_t len, uint16_t seg_size) {
+	using namespace jstd::net;
+	if (!seg_size) return false;
+	NetConnection conn;
+	if (!get_connection(handle, conn)) {
+		LOG_WARNING(USVR, "connection handle ", handle, " is stale, not sending segments");
+		return false;
+	}
+	size_t off = 0;
+	if (m_gso && len > seg_size && m_io_backend != IO_BACKEND::IO_URING && !m_reliable && !m_fragmenting &&
+	    !send_gso(conn, data, len, seg_size, off))
+		return false;
+	bool ok = true;
+	for (; off < len; off += seg_size)
+		ok = send_payload(conn, data + off, std::min<size_t>(seg_size, len - off)) && ok;
+	return ok;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_gso(const jstd::net::NetConnection &conn,
+                                                               const uint8_t *data, size_t len, uint16_t seg_size,
+                                                               size_t &off) {
+	using namespace jstd::net;
+	// whatever this thread has batched goes out first, in the order it was sent
+	if (t_send_batch && t_send_batch->owner == this) flush_sends(*t_send_batch->batch);
+	size_t chunk = udp_offload::max_gso_bytes(seg_size);
+	while (off < len) {
+		size_t n = std::min(chunk, len - off);
+		if (udp_offload::send_gso(m_svr_conn.sockfd, conn.sa, data + off, n, seg_size) < 0) {
+			// EIO: the route has no checksum offload, the others: no GSO at all. Anything else, e.g. a segment
+			// larger than the path MTU, is this call's problem
+			if (errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {
+				LOG_WARNING(USVR, "kernel refused UDP_SEGMENT errno: ", errno, ", sending a datagram per syscall");
+				m_gso = false;
+				return true;
+			}
+			LOG_ERROR(USVR, "failed to send segments, errno# ", errno, " descr: ", sockErrToString(errno));
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			m_stats.sock_err_cnt++;
+			return false;
+		}
+		off += n;
+	}
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_reliability(const jstd::net::ReliableConfig &cfg) {
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, reliable delivery can not be turned on");
+		return false;
+	}
+	m_rel_cfg = cfg;
+	m_rel_cfg.window = std::max<uint32_t>(1, std::min(cfg.window, jstd::net::RUDP_MAX_WINDOW));
+	m_rel_cfg.tick_ms = std::max<uint32_t>(1, cfg.tick_ms);
+	m_reliable = true;
+	LOG_INFO(USVR, "reliable delivery on, window ", m_rel_cfg.window, m_rel_cfg.ordered ? ", in order" : ", unordered");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_reliable(jstd::net::ConnHandle handle, const uint8_t *data,
+                                                                    size_t len) {
+	if (!m_reliable) {
+		LOG_WARNING(USVR, "reliable delivery is off, see set_reliability()");
+		return false;
+	}
+	jstd::net::NetConnection conn;
+	if (!get_connection(handle, conn)) {
+		LOG_WARNING(USVR, "connection handle ", handle, " is stale, not sending message");
+		return false;
+	}
+	return reliable_send(conn, data, len);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+uint64_t jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_rtt_us(jstd::net::ConnHandle conn) {
+	std::lock_guard<mutex_type> lckr(m_rmtx);
+	auto it = m_rel_peers.find(conn.value);
+	return it != m_rel_peers.end() ? it->second.state.srtt_us() : 0;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::inject_loss(jstd::net::ConnHandle, const uint8_t *, size_t, bool) {
+	return false;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_payload(const jstd::net::NetConnection &conn,
+                                                                   const uint8_t *data, size_t len) {
+	return m_fragmenting ? send_fragments(conn, data, len) : send_datagram(conn, data, len);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_datagram(const jstd::net::NetConnection &conn,
+                                                                    const uint8_t *data, size_t len) {
+	return m_reliable ? reliable_send(conn, data, len) : send_data(conn, data, len);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_fragments(const jstd::net::NetConnection &conn,
+                                                                     const uint8_t *data, size_t len) {
+	using namespace jstd::net;
+	if (len > m_frag_cfg.max_message) {
+		LOG_WARNING(USVR, "message of ", len, " bytes is larger than max_message, not sent");
+		return false;
+	}
+	// framing buffer of the sending thread, grows to the largest message it sent
+	static thread_local std::vector<uint8_t> frames;
+	size_t cnt = fragment::split(m_frag_next_id.fetch_add(1, std::memory_order_relaxed), data, len,
+	                             m_frag_cfg.fragment_size, frames);
+	if (cnt == 1) return send_datagram(conn, frames.data(), frames.size());
+	{
+		std::lock_guard<mutex_type> lckf(m_fmtx);
+		m_frag_counters.split++;
+		m_frag_counters.fragments += cnt;
+	}
+	size_t stride = FRAG_HEADER + m_frag_cfg.fragment_size;
+	size_t off = 0;
+	if (m_gso && m_io_backend != IO_BACKEND::IO_URING && !m_reliable &&
+	    !send_gso(conn, frames.data(), frames.size(), static_cast<uint16_t>(stride), off))
+		return false;
+	bool ok = true;
+	for (; off < frames.size(); off += stride)
+		ok = send_datagram(conn, frames.data() + off, std::min(stride, frames.size() - off)) && ok;
+	return ok;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_fragmentation(const jstd::net::FragmentConfig &cfg) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, fragmentation can not be turned on");
+		return false;
+	}
+	// room for the reliability layer's header as well, either end may run it
+	if (!cfg.fragment_size || cfg.fragment_size + FRAG_HEADER + RUDP_DATA_HEADER > MAX_BUFF_SIZE) {
+		LOG_ERROR(USVR, "fragments of ", cfg.fragment_size, " bytes do not fit the receive buffer");
+		return false;
+	}
+	m_frag_cfg = cfg;
+	m_frag_cfg.max_message = static_cast<uint32_t>(
+		std::min<uint64_t>(cfg.max_message, static_cast<uint64_t>(FRAG_MAX_COUNT) * cfg.fragment_size));
+	m_reassembler.reset(new Reassembler(m_frag_cfg));
+	m_fragmenting = true;
+	LOG_INFO(USVR, "fragmentation on, fragments of ", cfg.fragment_size, " bytes, messages up to ",
+	         m_frag_cfg.max_message, " bytes");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::set_multicast(const std::string &group, in_port_t port,
+                                                                    const jstd::net::MulticastConfig &cfg) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, multicast can not be changed");
+		return false;
+	}
+	if (group.empty()) {
+		m_multicast = false;
+		LOG_INFO(USVR, "multicast off, broadcasts go to every client");
+		return true;
+	}
+	NetConnection conn;
+	conn.sa.sin_family = AF_INET;
+	conn.sa.sin_port = htons(port);
+	conn.port = port;
+	if (inet_aton(group.c_str(), &conn.sa.sin_addr) == 0 || !multicast::is_group(conn.sa.sin_addr)) {
+		LOG_ERROR(USVR, group, " is not a multicast group address");
+		return false;
+	}
+	if (!multicast::configure_sender(m_svr_conn.sockfd, cfg)) {
+		LOG_ERROR(USVR, "failed to set multicast options errno #", errno, " descr: ", sockErrToString(errno));
+		return false;
+	}
+	if (m_reliable) LOG_WARNING(USVR, "reliable delivery is on, broadcasts stay unicast");
+	m_mcast_group = conn;
+	m_multicast = true;
+	LOG_INFO(USVR, "broadcasts go to multicast group ", group, ":", port, " ttl ", static_cast<unsigned>(cfg.ttl));
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::join_group(const std::string &group, const std::string &iface) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	in_addr grp{}, ifa{};
+	ifa.s_addr = htonl(INADDR_ANY);
+	if (inet_aton(group.c_str(), &grp) == 0 || (!iface.empty() && inet_aton(iface.c_str(), &ifa) == 0)) {
+		LOG_ERROR(USVR, "invalid group ", group, " or interface ", iface);
+		return false;
+	}
+	if (!multicast::join(m_svr_conn.sockfd, grp, ifa)) {
+		LOG_ERROR(USVR, "failed to join group ", group, " errno #", errno, " descr: ", sockErrToString(errno));
+		return false;
+	}
+	LOG_INFO(USVR, "joined multicast group ", group);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::leave_group(const std::string &group, const std::string &iface) {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	in_addr grp{}, ifa{};
+	ifa.s_addr = htonl(INADDR_ANY);
+	if (inet_aton(group.c_str(), &grp) == 0 || (!iface.empty() && inet_aton(iface.c_str(), &ifa) == 0)) {
+		LOG_ERROR(USVR, "invalid group ", group, " or interface ", iface);
+		return false;
+	}
+	if (!multicast::leave(m_svr_conn.sockfd, grp, ifa)) {
+		LOG_WARNING(USVR, "failed to leave group ", group, " errno #", errno, " descr: ", sockErrToString(errno));
+		return false;
+	}
+	LOG_INFO(USVR, "left multicast group ", group);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_send(const jstd::net::NetConnection &conn,
+                                                                    const uint8_t *data, size_t len) {
+	using namespace jstd::net;
+	if (len + RUDP_DATA_HEADER > MAX_BUFF_SIZE) {
+		LOG_WARNING(USVR, "datagram of ", len, " bytes does not fit the receive buffer with its header, not sent");
+		return false;
+	}
+	std::lock_guard<mutex_type> lckr(m_rmtx);
+	reliable_peer &peer = reliable_state(conn);
+	m_rel_out.clear();
+	if (!peer.state.send(data, len, ReliablePeer::now_us(), m_rel_out, m_rel_counters)) {
+		LOG_WARNING(USVR, "reliable send queue of client ", conn.handle, " is full, datagram not sent");
+		return false;
+	}
+	send_reliable_out(peer.conn);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+typename jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_peer &
+jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_state(const jstd::net::NetConnection &conn) {
+	auto it = m_rel_peers.find(conn.handle.value);
+	if (it != m_rel_peers.end()) return it->second;
+	// sessions start from the clock, a restarted server does not reuse the ones its clients saw last
+	if (!m_rel_sessions) m_rel_sessions = static_cast<uint32_t>(jstd::net::ReliablePeer::now_us());
+	reliable_peer peer{conn, jstd::net::ReliablePeer(m_rel_cfg, m_rel_sessions++)};
+	return m_rel_peers.emplace(conn.handle.value, std::move(peer)).first->second;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::send_reliable_out(const jstd::net::NetConnection &conn) {
+	for (const auto &pkt : m_rel_out) {
+		if (derived().inject_loss(conn.handle, pkt.data, pkt.len, true)) {
+			m_rel_counters.injected_losses++;
+			continue;
+		}
+		send_data(conn, pkt.data, pkt.len);
+	}
+	m_rel_out.clear();
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::on_reliable_datagram(const uint8_t *buff, size_t len,
+                                                                           const jstd::net::NetConnection &conn) {
+	using namespace jstd::net;
+	uint8_t ack[RUDP_ACK_LEN];
+	std::vector<std::vector<uint8_t>> ready;
+	RUDP_RECV res;
+	{
+		std::lock_guard<mutex_type> lckr(m_rmtx);
+		if (derived().inject_loss(conn.handle, buff, len, false)) {
+			m_rel_counters.injected_losses++;
+			return;
+		}
+		uint8_t type = ReliablePeer::packet_type(buff, len);
+		if (!type) {
+			LOG_WARNING(USVR, "datagram of client ", conn.handle, " is not framed for reliable delivery, dropped");
+			return;
+		}
+		reliable_peer &peer = reliable_state(conn);
+		if (type == RUDP_ACK) {
+			m_rel_out.clear();
+			peer.state.on_ack(buff, len, ReliablePeer::now_us(), m_rel_out, m_rel_counters);
+			send_reliable_out(peer.conn);
+			return;
+		}
+		res = peer.state.on_data(buff, len, ack, ready, m_rel_counters);
+		if (res != RUDP_RECV::REJECTED && res != RUDP_RECV::STALE) {
+			if (derived().inject_loss(conn.handle, ack, RUDP_ACK_LEN, true)) m_rel_counters.injected_losses++;
+			else send_data(peer.conn, ack, RUDP_ACK_LEN);
+		}
+	}
+	// dispatched outside the lock, an inline process_item replies through reliable_send()
+	if (res != RUDP_RECV::DELIVER) return;
+	dispatch_datagram(buff + RUDP_DATA_HEADER, len - RUDP_DATA_HEADER, conn.handle);
+	for (const auto &payload : ready) dispatch_datagram(payload.data(), payload.size(), conn.handle);
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_tick() {
+	std::lock_guard<mutex_type> lckr(m_rmtx);
+	uint64_t now = jstd::net::ReliablePeer::now_us();
+	for (auto &entry : m_rel_peers) {
+		reliable_peer &peer = entry.second;
+		if (!peer.state.in_flight()) continue;
+		m_rel_out.clear();
+		if (!peer.state.poll(now, m_rel_out, m_rel_counters))
+			LOG_WARNING(USVR, "client ", peer.conn.handle, " acknowledged nothing over ", m_rel_cfg.max_retries,
+			            " retransmissions, its unacknowledged datagrams are dropped");
+		send_reliable_out(peer.conn);
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::reliable_timing() {
+	LOG_DEBUG(USVR, "retransmission thread started, every ", m_rel_cfg.tick_ms, "ms");
+	while (m_recv_active) {
+		util::chrono::sleep_milli(static_cast<int>(m_rel_cfg.tick_ms));
+		reliable_tick();
+	}
+	LOG_DEBUG(USVR, "terminating retransmission thread");
+}
+
+#ifdef LINUX_OS
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::attach(jstd::net::EventLoop &loop) {
+	LOG_TRACE(USVR);
+	if (m_recv_active) {
+		LOG_WARNING(USVR, "server is already running, can not attach it to an event loop");
+		return false;
+	}
+	bool ok = loop.add_fd(m_svr_conn.sockfd, EPOLLIN, [this](int, uint32_t) {
+		jstd::net::PooledBuffer buff(m_loop->buffers());
+		drain_socket(buff.data(), buff.size());
+	});
+	if (!ok) {
+		LOG_ERROR(USVR, "failed to register socket with the event loop errno: ", errno);
+		return false;
+	}
+	m_loop = &loop;
+	m_recv_active = true;
+	m_qproc_active = true;
+	if (m_wal) m_wal_event = loop.add_event([this]() { wal_release(); });
+	if (m_reliable) m_rel_timer = loop.add_timer(m_rel_cfg.tick_ms, true, [this]() { reliable_tick(); });
+	LOG_INFO(USVR, "socket ", m_svr_conn.to_string(), " attached to event loop");
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::detach() {
+	LOG_TRACE(USVR);
+	if (!m_loop) return;
+	m_loop->remove_fd(m_svr_conn.sockfd);
+	if (m_wal_event >= 0) m_loop->remove_event(m_wal_event);
+	m_wal_event = -1;
+	if (m_rel_timer >= 0) m_loop->cancel_timer(m_rel_timer);
+	m_rel_timer = -1;
+	m_loop = nullptr;
+	m_recv_active = false;
+	m_qproc_active = false;
+}
+#endif
+
+// socket is drained on every wakeup, the wait timeout bounds shutdown latency
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::epoll_recving() {
+	LOG_TRACE(USVR);
+#ifdef LINUX_OS
+	uint8_t buff[MAX_BUFF_SIZE];
+	m_epoll.add_fd(m_svr_conn.sockfd);
+	while (m_recv_active) {
+		int ready = m_epoll.wait(m_reliable ? static_cast<int>(m_rel_cfg.tick_ms) : DEFAULT_EPOLL_TIMEOUT_MILLI);
+		if (ready > 0) drain_socket(buff, MAX_BUFF_SIZE);
+		reliable_inline_tick();
+	}
+#endif
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::drain_socket(uint8_t *buff, size_t len) {
+#ifdef LINUX_OS
+	if (m_rbatch) {
+		// a batch that comes back short emptied the socket
+		while (recv_batch(m_svr_conn.sockfd, *m_rbatch, m_recv_sends.get(), MSG_DONTWAIT) ==
+		       static_cast<int>(m_rbatch->capacity())) {}
+		return;
+	}
+#endif
+	sockaddr_in from_addr{};
+	socklen_t addr_len;
+	while (true) {
+		addr_len = sizeof(sockaddr_in);
+		ssize_t num_bytes = recvfrom(m_svr_conn.sockfd, buff, len, MSG_DONTWAIT | MSG_TRUNC,
+			(struct sockaddr *) &from_addr, &addr_len);
+		if (num_bytes < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				LOG_ERROR(USVR, "recvfrom failed errno: ", errno, " descr: ", jstd::net::sockErrToString(errno));
+				std::lock_guard<mutex_type> lckm(m_qmtx);
+				m_stats.sock_err_cnt++;
+			}
+			break;
+		}
+		// empty datagrams are skipped like the recvfrom loop does, hand_off() wakes that loop with one
+		if (static_cast<size_t>(num_bytes) > len) on_truncated(from_addr, static_cast<size_t>(num_bytes));
+		else if (num_bytes > 0) on_datagram(buff, num_bytes, from_addr);
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+int jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::recv_batch(int sockfd, jstd::net::RecvBatch &rbatch,
+                                                                 jstd::net::SendBatch *sends, int flags) {
+	int cnt = rbatch.recv(sockfd, flags);
+	if (cnt < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+			LOG_ERROR(USVR, "recvmmsg failed errno: ", errno, " descr: ", jstd::net::sockErrToString(errno));
+			recv_stats().sock_err_cnt++;
+		}
+		return cnt;
+	}
+	send_batching batching{this, sends};
+	send_batching *outer = t_send_batch;
+	if (sends) t_send_batch = &batching;
+	for (unsigned i = 0; i < static_cast<unsigned>(cnt); i++) {
+		size_t len = rbatch.length(i);
+		if (rbatch.truncated(i)) {
+			on_truncated(rbatch.from(i), len);
+			continue;
+		}
+		const uint8_t *data = rbatch.data(i);
+		// GRO coalesced datagrams of one client, the segments are processed where they are
+		size_t seg = rbatch.segment_size(i);
+		if (!seg) seg = len;
+		// empty datagrams are skipped like the recvfrom loop does, hand_off() wakes that loop with one
+		for (size_t off = 0; off < len; off += seg)
+			on_datagram(data + off, static_cast<ssize_t>(std::min(seg, len - off)), rbatch.from(i));
+	}
+	t_send_batch = outer;
+	if (sends) flush_sends(*sends);
+	return cnt;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::flush_sends(jstd::net::SendBatch &batch) {
+	size_t queued = batch.size();
+	unsigned failed = batch.flush(m_svr_conn.sockfd);
+	if (!failed) {
+		LOG_INFO(USVR, "successfully sent out a batch of ", queued, " datagrams");
+		return;
+	}
+	LOG_ERROR(USVR, "failed to send ", failed, "/", queued, " batched datagrams, errno# ", errno,
+	          " descr: ", jstd::net::sockErrToString(errno));
+	std::lock_guard<mutex_type> lckm(m_qmtx);
+	m_stats.sock_err_cnt += failed;
+}
+
+// ------------------------------------------IO_URING BACKEND-------------------------------------------------
+#ifdef LINUX_OS
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::init_uring() {
+	using namespace jstd::net;
+	LOG_TRACE(USVR);
+	if (m_uring.is_active()) return true;
+	if (!m_uring.init(DEFAULT_URING_ENTRIES))
+		return false;
+	if (!m_uring.supports_op(IORING_OP_RECVMSG) || !m_uring.supports_op(IORING_OP_SENDMSG)) {
+		LOG_WARNING(USVR, "kernel io_uring lacks recvmsg/sendmsg support");
+		m_uring.close();
+		errno = EOPNOTSUPP;
+		return false;
+	}
+	if (!m_uring.register_buffers(DEFAULT_URING_UDP_RECV_DEPTH, MAX_BUFF_SIZE)) {
+		LOG_WARNING(USVR, "failed to register io_uring buffers");
+		m_uring.close();
+		return false;
+	}
+	m_uring_slots.assign(DEFAULT_URING_UDP_RECV_DEPTH, uring_recv_slot{});
+	LOG_INFO(USVR, "io_uring backend ready, recv depth: ", DEFAULT_URING_UDP_RECV_DEPTH);
+	return true;
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::arm_uring_recv(unsigned slot) {
+	using namespace jstd::net;
+	uring_recv_slot &s = m_uring_slots[slot];
+	s.iov.iov_base = m_uring.buffer(slot);
+	s.iov.iov_len = m_uring.buffer_size();
+	s.msg = msghdr{};
+	s.msg.msg_name = &s.addr;
+	s.msg.msg_namelen = sizeof(sockaddr_in);
+	s.msg.msg_iov = &s.iov;
+	s.msg.msg_iovlen = 1;
+	m_uring.prep_recvmsg(m_svr_conn.sockfd, &s.msg,
+		IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::RECVMSG), slot));
+}
+
+// keeps every registered buffer posted as a recvmsg, completions are reaped and re-armed in batches
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::uring_recving() {
+	LOG_TRACE(USVR);
+	for (unsigned slot = 0; slot < m_uring_slots.size(); slot++)
+		arm_uring_recv(slot);
+	while (m_recv_active) {
+		int rc = m_uring.submit_and_wait(1);
+		if (rc < 0 && rc != -EINTR && rc != -EAGAIN && rc != -EBUSY) {
+			LOG_ERROR(USVR, "io_uring_enter failed errno: ", -rc);
+			std::lock_guard<mutex_type> lckm(m_qmtx);
+			m_stats.sock_err_cnt++;
+		}
+		m_uring.for_each_cqe([this](const io_uring_cqe &cqe) { uring_complete(cqe); });
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::uring_complete(const io_uring_cqe &cqe) {
+	using namespace jstd::net;
+	uint64_t value = IoUring::user_data_value(cqe.user_data);
+	switch (static_cast<URING_TAG>(IoUring::user_data_tag(cqe.user_data))) {
+		case URING_TAG::RECVMSG: {
+			auto slot = static_cast<unsigned>(value);
+			if (cqe.res > 0 && (m_uring_slots[slot].msg.msg_flags & MSG_TRUNC)) {
+				on_truncated(m_uring_slots[slot].addr, static_cast<size_t>(cqe.res));
+			} else if (cqe.res > 0) {
+				on_datagram(m_uring.buffer(slot), cqe.res, m_uring_slots[slot].addr);
+			} else if (cqe.res < 0 && cqe.res != -EINTR) {
+				LOG_ERROR(USVR, "recvmsg failed errno: ", -cqe.res, " descr: ", sockErrToString(-cqe.res));
+				std::lock_guard<mutex_type> lckm(m_qmtx);
+				m_stats.sock_err_cnt++;
+			}
+			if (m_recv_active) arm_uring_recv(slot);
+			break;
+		}
+		case URING_TAG::SENDMSG: {
+			if (cqe.res < 0) {
+				LOG_ERROR(USVR, "failed to send data, errno# ", -cqe.res, " descr: ", sockErrToString(-cqe.res));
+				std::lock_guard<mutex_type> lckm(m_qmtx);
+				m_stats.sock_err_cnt++;
+			}
+			std::lock_guard<mutex_type> lck(m_smtx);
+			m_uring_sends.erase(value);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+bool jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::uring_send_data(const sockaddr_in &to, std::vector<uint8_t> &&data) {
+	using namespace jstd::net;
+	uint64_t send_id;
+	const msghdr *msg;
+	{
+		std::lock_guard<mutex_type> lck(m_smtx);
+		send_id = m_next_send_id++;
+		uring_sendmsg &pending = m_uring_sends[send_id];
+		pending.addr = to;
+		pending.data = std::move(data);
+		pending.iov.iov_base = pending.data.data();
+		pending.iov.iov_len = pending.data.size();
+		pending.msg = msghdr{};
+		pending.msg.msg_name = &pending.addr;
+		pending.msg.msg_namelen = sizeof(sockaddr_in);
+		pending.msg.msg_iov = &pending.iov;
+		pending.msg.msg_iovlen = 1;
+		msg = &pending.msg;
+	}
+	if (!m_uring.prep_sendmsg(m_svr_conn.sockfd, msg,
+			IoUring::pack_user_data(static_cast<uint8_t>(URING_TAG::SENDMSG), send_id))) {
+		LOG_ERROR(USVR, "io_uring submission queue full, failed to send data");
+		std::lock_guard<mutex_type> lck(m_smtx);
+		m_uring_sends.erase(send_id);
+		return false;
+	}
+	m_uring.submit();
+	return true;
+}
+
+#endif // LINUX_OS
+
+template<typename Derived, typename QItem, typename ThreadPolicy>
+void jstd::UdpServerBase<Derived, QItem, ThreadPolicy>::init(const std::string &ip, in_port_t port) {
+	using namespace util::chrono;
+	using namespace net;
+	LOG_TRACE(USVR);
+	m_svr_conn.sock_type = SOCK_DGRAM;
+	m_svr_conn.sa.sin_port = htons(port);
+	m_svr_conn.port = port;
+	if (inet_aton(ip.c_str(), &m_svr_conn.sa.sin_addr) == 0) {
+		LOG_ERROR(USVR, "invalid ip address supplied errno #", errno, " descr: ", jstd::net::sockErrToString(errno));
+		sleep_milli(1000);
+		exit(static_cast<int>(FATAL_ERR::IP_INET_FAIL));
+	}
+	m_svr_conn.sa.sin_family = AF_INET;
+	m_svr_conn.sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (m_svr_conn.sockfd < 0) {
+		LOG_ERROR(USVR, "error creating udp socket discriptor errno # ", errno, " descr: ", jstd::net::sockErrToString(errno));
+		sleep_milli(1000);
+		exit(static_cast<int>(FATAL_ERR::SOCK_FAIL));
+	}
+	int rc = bind(m_svr_conn.sockfd, (const struct sockaddr *) &m_svr_conn.sa, sizeof(m_svr_conn.sa));
+	if (rc < 0) {
+		LOG_ERROR(USVR, "binding socket to addr failed errno #", errno, " descr: ", jstd::net::sockErrToString(errno));
+		sleep_milli(1000);
+		exit(static_cast<int>(FATAL_ERR::SOCK_BIND_FAIL));
+	}
+	m_is_nonblocking = false;
+	LOG_INFO(USVR, "udpserver with IP: ", m_svr_conn.ip_addr(), " port: ", htons(m_svr_conn.sa.sin_port));
 }
 
-#endif    // THREADED REGION OF SOURCE
 #endif  // UPD_SERVER_H
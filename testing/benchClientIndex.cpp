@@ -0,0 +1,135 @@
+#include "ClientIndex.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Per datagram client lookup of UdpServerBase, -n known clients looked up in random order, -r rounds:
+ *  map         what the receive path did before, lock the client mutex and probe an unordered_map
+ *  map+string  the same plus the "ip:port" string its log line built for every datagram
+ *  index       ClientIndex::find(), no lock, no allocation
+ * Then -t reader threads look up the known clients while a writer adds and removes other clients for -d ms,
+ * every lookup of a known client has to return its own handle.
+ *
+ * usage: benchClientIndex [-n clients] [-r rounds] [-t readers] [-d duration_ms]
+ */
+
+using jstd::net::ClientIndex;
+using jstd::net::ConnHandle;
+using jstd::net::NetConnection;
+typedef std::chrono::steady_clock clock_type;
+
+static uint64_t key_of(const NetConnection &c) {
+    return (static_cast<uint64_t>(c.sa.sin_addr.s_addr) << 16) | c.sa.sin_port;
+}
+
+template<typename Fn>
+static double ns_per_lookup(const std::vector<uint32_t> &order, unsigned rounds, uint64_t &check, Fn fn) {
+    auto t0 = clock_type::now();
+    for (unsigned r = 0; r < rounds; r++)
+        for (uint32_t i : order) check += fn(i);
+    return std::chrono::duration<double, std::nano>(clock_type::now() - t0).count() / (double(order.size()) * rounds);
+}
+
+int main(int argc, char **argv) {
+    unsigned n = 10000;
+    unsigned rounds = 100;
+    unsigned readers = 2;
+    unsigned ms = 1000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:t:d:")) != -1) {
+        switch (opt) {
+            case 'n': n = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': rounds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': readers = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'd': ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            default:
+                std::cerr << "usage: benchClientIndex [-n clients] [-r rounds] [-t readers] [-d duration_ms]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    std::mt19937 rng(11);
+    std::vector<NetConnection> clients(n);
+    for (unsigned i = 0; i < n; i++) {
+        clients[i].sa.sin_addr.s_addr = htonl(0x0a000000u | (rng() & 0xffffff));
+        clients[i].sa.sin_port = htons(static_cast<uint16_t>(1024 + i % 60000));
+    }
+    std::mutex mtx;
+    std::unordered_map<uint64_t, ConnHandle> map;
+    ClientIndex index;
+    for (uint32_t i = 0; i < n; i++) {
+        map[std::hash<uint64_t>{}(key_of(clients[i]))] = ConnHandle(i, 0);
+        index.insert(key_of(clients[i]), ConnHandle(i, 0));
+    }
+    std::vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    uint64_t check_map = 0, check_str = 0, check_idx = 0;
+    double t_map = ns_per_lookup(order, rounds, check_map, [&](uint32_t i) {
+        std::lock_guard<std::mutex> lck(mtx);
+        auto it = map.find(std::hash<uint64_t>{}(key_of(clients[i])));
+        return it != map.end() ? it->second.index() : 0u;
+    });
+    double t_str = ns_per_lookup(order, rounds, check_str, [&](uint32_t i) {
+        std::string peer = clients[i].to_string();
+        std::lock_guard<std::mutex> lck(mtx);
+        auto it = map.find(std::hash<uint64_t>{}(key_of(clients[i])));
+        return (it != map.end() ? it->second.index() : 0u) + static_cast<uint32_t>(peer.empty());
+    });
+    double t_idx = ns_per_lookup(order, rounds, check_idx, [&](uint32_t i) {
+        return index.find(key_of(clients[i])).index();
+    });
+    std::printf("%u clients, %u rounds, index capacity %zu\n", n, rounds, index.capacity());
+    std::printf("lookup        ns/datagram\n");
+    std::printf("map          %12.1f\nmap+string   %12.1f\nindex        %12.1f\n", t_map, t_str, t_idx);
+    bool ok = check_map == check_idx && check_str == check_idx;
+
+    // readers against a churning writer, the writer holds the lock the server would
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> lookups(0), wrong(0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < readers; t++)
+        threads.emplace_back([&, t] {
+            uint64_t cnt = 0, bad = 0;
+            size_t at = t * 7919;
+            while (running.load(std::memory_order_relaxed)) {
+                uint32_t i = order[at++ % n];
+                if (index.find(key_of(clients[i])).index() != i) bad++;
+                cnt++;
+            }
+            lookups += cnt;
+            wrong += bad;
+        });
+    uint64_t churn = 0;
+    auto end = clock_type::now() + std::chrono::milliseconds(ms);
+    while (clock_type::now() < end) {
+        std::lock_guard<std::mutex> lck(mtx);
+        // transient clients outside the 10/8 block of the known ones
+        uint64_t key = (static_cast<uint64_t>(htonl(0xc0a80000u | (churn & 0xffff))) << 16) | (churn >> 16 & 0xffff);
+        index.insert(key, ConnHandle(static_cast<uint32_t>(n + churn), 1));
+        if (churn >= 512) {
+            uint64_t old = churn - 512;
+            index.erase((static_cast<uint64_t>(htonl(0xc0a80000u | (old & 0xffff))) << 16) | (old >> 16 & 0xffff));
+        }
+        churn++;
+    }
+    running = false;
+    for (auto &t : threads) t.join();
+    std::printf("%u readers: %llu lookups, %llu wrong, writer %llu inserts and %llu erases, size %zu capacity %zu\n",
+                readers, static_cast<unsigned long long>(lookups.load()), static_cast<unsigned long long>(wrong.load()),
+                static_cast<unsigned long long>(churn),
+                static_cast<unsigned long long>(churn > 512 ? churn - 512 : 0), index.size(), index.capacity());
+    ok = ok && wrong == 0;
+    std::fflush(stdout);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
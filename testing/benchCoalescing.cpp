@@ -0,0 +1,178 @@
+#include "tcp_server.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <netinet/tcp.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Backend work under a thundering herd with and without request coalescing.
+ * Every round all clients send the same snapshot request at once (a barrier releases them together) and wait
+ * for the answer, process_item spends work_us of cpu per call. Without coalescing the worker computes the
+ * snapshot once per client, with it once per round plus whatever arrived after the first call finished.
+ * -k spreads the rounds over that many distinct snapshots, each client picking one at random.
+ *
+ * usage: benchCoalescing [-c clients] [-w work_us] [-k keys] [-t seconds] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+typedef std::chrono::steady_clock clock_type;
+
+class SnapshotServer : public jstd::net::TcpServerBase<SnapshotServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    unsigned work_us = 200;
+    using jstd::net::TcpServerBase<SnapshotServer, NetItem, jstd::net::PipelinePolicy>::TcpServerBase;
+
+    bool process_item(NetItem &&item) {
+        auto until = clock_type::now() + std::chrono::microseconds(work_us);
+        while (clock_type::now() < until) { }
+        // snapshot "body" is the request echoed back
+        return send_to(item.conn, item.buff.data(), item.buff.size());
+    }
+
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+};
+
+// releases every client at once for each round, wait() returns true once any of the round asked to stop
+class round_barrier {
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    unsigned m_count;
+    unsigned m_waiting;
+    uint64_t m_round;
+    uint64_t m_stop_round;
+
+public:
+    explicit round_barrier(unsigned count) : m_count(count), m_waiting(0), m_round(0), m_stop_round(UINT64_MAX) {}
+
+    bool wait(bool stop = false) {
+        std::unique_lock<std::mutex> lck(m_mtx);
+        // the answer belongs to the round, a waiter of the previous round waking late must not see a newer stop
+        uint64_t round = m_round;
+        if (stop) m_stop_round = std::min(m_stop_round, round);
+        if (++m_waiting == m_count) {
+            m_waiting = 0;
+            m_round++;
+            m_cv.notify_all();
+            return round >= m_stop_round;
+        }
+        m_cv.wait(lck, [&]() { return m_round != round; });
+        return round >= m_stop_round;
+    }
+};
+
+struct client_result {
+    uint64_t replies = 0;
+    std::vector<uint32_t> lat_us;
+};
+
+static void client(uint16_t port, unsigned keys, unsigned seed, round_barrier &barrier, client_result &res) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    bool connected = connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    char req[32];
+    char rep[32];
+    uint64_t round = 0;
+    while (true) {
+        if (barrier.wait()) break;
+        round++;
+        int len = std::snprintf(req, sizeof(req), "SNAPSHOT %06u",
+                                static_cast<unsigned>((seed * 2654435761u + round * 40503u) % keys));
+        auto t0 = clock_type::now();
+        if (!connected || send(fd, req, static_cast<size_t>(len), MSG_NOSIGNAL) != len) continue;
+        ssize_t got = 0;
+        while (got < len) {
+            ssize_t n = recv(fd, rep + got, sizeof(rep) - static_cast<size_t>(got), 0);
+            if (n <= 0) break;
+            got += n;
+        }
+        if (got != len) continue;
+        res.lat_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t0).count()));
+        res.replies++;
+    }
+    close(fd);
+}
+
+int main(int argc, char **argv) {
+    unsigned clients = 32;
+    unsigned work_us = 200;
+    unsigned keys = 1;
+    unsigned seconds = 2;
+    uint16_t port = 9760;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:w:k:t:p:")) != -1) {
+        switch (opt) {
+            case 'c': clients = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'w': work_us = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'k': keys = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': seconds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchCoalescing [-c clients] [-w work_us] [-k keys] [-t seconds] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    std::cout << clients << " clients, " << keys << " distinct request(s), " << work_us << "us per process_item, "
+              << seconds << "s per run\n"
+              << "coalescing    replies/s   process_item/s   coalesced   calls/reply   p50_us   p99_us\n";
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<SnapshotServer>> servers;
+    for (int i = 0; i < 2; i++) {
+        uint16_t mport = static_cast<uint16_t>(port + i);
+        servers.emplace_back(new SnapshotServer(LOCALHOSTIP, mport));
+        SnapshotServer &server = *servers.back();
+        server.work_us = work_us;
+        server.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+        server.set_coalescing(i == 1);
+        server.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        round_barrier barrier(clients + 1);
+        std::vector<client_result> results(clients);
+        std::vector<std::thread> threads;
+        for (unsigned c = 0; c < clients; c++)
+            threads.emplace_back(client, mport, keys, c, std::ref(barrier), std::ref(results[c]));
+        // the main thread takes part in every round so it can stop the clients at a barrier
+        auto start = clock_type::now();
+        auto end = start + std::chrono::seconds(seconds);
+        while (!barrier.wait(clock_type::now() >= end)) { }
+        for (auto &t : threads) t.join();
+        double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        server.kill_threads();
+
+        jstd::net::ServerStats st = server.stats();
+        uint64_t replies = 0;
+        std::vector<uint32_t> lat;
+        for (auto &r : results) {
+            replies += r.replies;
+            lat.insert(lat.end(), r.lat_us.begin(), r.lat_us.end());
+        }
+        std::sort(lat.begin(), lat.end());
+        auto pct = [&lat](double p) -> uint32_t {
+            return lat.empty() ? 0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))];
+        };
+        std::printf("%-10s %12.0f %16.0f %11lu %13.3f %8u %8u\n", i ? "on" : "off", replies / elapsed,
+                    st.msg_processed_cnt / elapsed, static_cast<unsigned long>(st.coalesced_cnt),
+                    replies ? static_cast<double>(st.msg_processed_cnt) / replies : 0.0, pct(0.5), pct(0.99));
+        std::fflush(stdout);
+    }
+    std::_Exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,176 @@
+#include "codec.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * Encode and decode throughput of the codec (codec.h) against a fixed layout struct copied with memcpy and a
+ * space separated text encoding (snprintf / strtoull), on -n order messages of realistic values: growing ids,
+ * small quantities, prices in ticks, 3-5 character symbols and an optional client tag on -o percent of them.
+ * Every message is encoded into one preallocated buffer, then decoded back, -r times. Reported per encoding:
+ * bytes per message, encode and decode ns per message and decode MB/s.
+ *
+ * usage: benchCodec [-n messages] [-o optional_pct] [-r rounds]
+ */
+
+using jstd::net::BytesView;
+using jstd::net::Optional;
+namespace codec = jstd::net::codec;
+typedef std::chrono::steady_clock clock_type;
+
+struct Order {
+    uint64_t id;
+    int32_t qty;            // negative sells
+    uint32_t price;         // ticks
+    BytesView symbol;
+    Optional<uint64_t> client_tag;
+    JSTD_CODEC_FIELDS(id, qty, price, symbol, client_tag)
+};
+
+#pragma pack(push, 1)
+struct PodOrder {
+    uint64_t id;
+    int32_t qty;
+    uint32_t price;
+    uint8_t symbol_len;
+    char symbol[15];
+    uint8_t has_tag;
+    uint64_t client_tag;
+};
+#pragma pack(pop)
+
+struct result {
+    size_t bytes;
+    double enc_ns;
+    double dec_ns;
+    uint64_t check;
+};
+
+static const char *SYMBOLS[] = {"AAPL", "MSFT", "IBM", "GOOGL", "T", "NVDA", "AMZN", "META"};
+
+template<typename Enc, typename Dec>
+static result run(const std::vector<Order> &orders, unsigned rounds, std::vector<uint8_t> &buff,
+                  std::vector<size_t> &offs, Enc enc, Dec dec) {
+    result res{0, 0, 0, 0};
+    auto t0 = clock_type::now();
+    for (unsigned r = 0; r < rounds; r++) {
+        size_t at = 0;
+        for (size_t i = 0; i < orders.size(); i++) {
+            offs[i] = at;
+            at += enc(orders[i], buff.data() + at, buff.size() - at);
+        }
+        offs[orders.size()] = at;
+        res.bytes = at;
+    }
+    auto t1 = clock_type::now();
+    for (unsigned r = 0; r < rounds; r++)
+        for (size_t i = 0; i < orders.size(); i++)
+            res.check += dec(buff.data() + offs[i], offs[i + 1] - offs[i]);
+    auto t2 = clock_type::now();
+    double msgs = static_cast<double>(orders.size()) * rounds;
+    res.enc_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / msgs;
+    res.dec_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / msgs;
+    return res;
+}
+
+static void report(const char *name, const result &res, size_t n) {
+    std::printf("%-8s %9.1f %11.1f %11.1f %13.0f   %llu\n", name, static_cast<double>(res.bytes) / n, res.enc_ns,
+                res.dec_ns, static_cast<double>(res.bytes) / n / res.dec_ns * 1e3,
+                static_cast<unsigned long long>(res.check));
+}
+
+int main(int argc, char **argv) {
+    size_t n = 1 << 16;
+    unsigned optional_pct = 30;
+    unsigned rounds = 50;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:r:")) != -1) {
+        switch (opt) {
+            case 'n': n = std::strtoul(optarg, nullptr, 10); break;
+            case 'o': optional_pct = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'r': rounds = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchCodec [-n messages] [-o optional_pct] [-r rounds]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    std::mt19937_64 rng(7);
+    std::vector<Order> orders(n);
+    uint64_t id = 1700000000000ULL;
+    for (auto &o : orders) {
+        o.id = id += 1 + rng() % 8;
+        o.qty = static_cast<int32_t>(rng() % 1000) * (rng() & 1 ? 1 : -1);
+        o.price = static_cast<uint32_t>(10000 + rng() % 10000);
+        o.symbol = BytesView(SYMBOLS[rng() % 8]);
+        if (rng() % 100 < optional_pct) o.client_tag = rng() % 100000;
+    }
+    std::vector<uint8_t> buff(n * 64);
+    std::vector<size_t> offs(n + 1);
+    std::printf("%zu orders, %u%% with the optional tag, %u rounds\n", n, optional_pct, rounds);
+    std::printf("encoding  bytes/msg   enc ns/msg  dec ns/msg  dec MB/s      check\n");
+
+    result c = run(orders, rounds, buff, offs,
+        [](const Order &o, uint8_t *out, size_t cap) { return codec::encode(o, out, cap); },
+        [](const uint8_t *in, size_t len) -> uint64_t {
+            Order o;
+            if (!codec::decode(in, len, o)) return 0;
+            return o.id + static_cast<uint64_t>(o.qty) + o.price + o.symbol.data[0] + o.symbol.len +
+                   (o.client_tag ? o.client_tag.value : 0);
+        });
+    report("codec", c, n);
+
+    result p = run(orders, rounds, buff, offs,
+        [](const Order &o, uint8_t *out, size_t) {
+            PodOrder pod;
+            pod.id = o.id;
+            pod.qty = o.qty;
+            pod.price = o.price;
+            pod.symbol_len = static_cast<uint8_t>(o.symbol.len);
+            std::memset(pod.symbol, 0, sizeof(pod.symbol));
+            std::memcpy(pod.symbol, o.symbol.data, o.symbol.len);
+            pod.has_tag = o.client_tag.has;
+            pod.client_tag = o.client_tag.value;
+            std::memcpy(out, &pod, sizeof(pod));
+            return sizeof(pod);
+        },
+        [](const uint8_t *in, size_t) -> uint64_t {
+            PodOrder pod;
+            std::memcpy(&pod, in, sizeof(pod));
+            return pod.id + static_cast<uint64_t>(pod.qty) + pod.price + static_cast<uint8_t>(pod.symbol[0]) +
+                   pod.symbol_len + (pod.has_tag ? pod.client_tag : 0);
+        });
+    report("memcpy", p, n);
+
+    result t = run(orders, rounds, buff, offs,
+        [](const Order &o, uint8_t *out, size_t cap) {
+            int len = o.client_tag
+                ? std::snprintf(reinterpret_cast<char*>(out), cap, "%llu %d %u %.*s %llu\n",
+                                static_cast<unsigned long long>(o.id), o.qty, o.price, static_cast<int>(o.symbol.len),
+                                o.symbol.chars(), static_cast<unsigned long long>(o.client_tag.value))
+                : std::snprintf(reinterpret_cast<char*>(out), cap, "%llu %d %u %.*s\n",
+                                static_cast<unsigned long long>(o.id), o.qty, o.price, static_cast<int>(o.symbol.len),
+                                o.symbol.chars());
+            return static_cast<size_t>(len);
+        },
+        [](const uint8_t *in, size_t len) -> uint64_t {
+            const char *p = reinterpret_cast<const char*>(in);
+            const char *end = p + len;
+            char *next;
+            uint64_t sum = std::strtoull(p, &next, 10);
+            sum += static_cast<uint64_t>(std::strtol(next, &next, 10));
+            sum += std::strtoul(next, &next, 10);
+            const char *sym = next + 1;
+            const char *sym_end = sym;
+            while (sym_end < end && *sym_end != ' ' && *sym_end != '\n') sym_end++;
+            sum += static_cast<uint8_t>(*sym) + static_cast<uint64_t>(sym_end - sym);
+            if (*sym_end == ' ') sum += std::strtoull(sym_end, &next, 10);
+            return sum;
+        });
+    report("text", t, n);
+    std::fflush(stdout);
+    return c.check == p.check && p.check == t.check ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,191 @@
+#include "udp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+/*
+ * FIFO vs deficit round robin in the processing queue.
+ *  1. scheduler cost: ns per push+pop of MsgQueue with the items spread over 1..10000 flows
+ *  2. a UdpServer whose worker spends work_us per request, one client floods it above capacity while a light
+ *     client sends ping_hz requests/sec, the light client's round trip is reported, with FIFO it waits behind
+ *     the flood's backlog, with DRR one round at most
+ *
+ * usage: benchFairQueue [-w work_us] [-r flood_per_sec] [-z ping_hz] [-t seconds] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::MsgQueue;
+using jstd::net::QUEUE_DISCIPLINE;
+typedef std::chrono::steady_clock clock_type;
+
+class SlowServer : public jstd::UdpServerBase<SlowServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    unsigned work_us = 50;
+    using jstd::UdpServerBase<SlowServer, NetItem, jstd::net::PipelinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        auto until = clock_type::now() + std::chrono::microseconds(work_us);
+        while (clock_type::now() < until) { }
+        return send_item(item);
+    }
+};
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count());
+}
+
+static void bench_scheduler(QUEUE_DISCIPLINE discipline, uint32_t quantum, const char *name) {
+    const size_t ops = 2000000;
+    for (uint64_t flows : {1, 100, 10000}) {
+        MsgQueue<uint64_t> q;
+        q.set_discipline(discipline, quantum);
+        MsgQueue<uint64_t>::shed_list shed;
+        // keep a standing backlog of two items per flow so pops rotate through every flow
+        for (uint64_t i = 0; i < flows * 2; i++) q.push(uint64_t(i), i % flows, 64);
+        uint64_t out, sojourn, sum = 0;
+        auto start = clock_type::now();
+        for (size_t i = 0; i < ops; i++) {
+            q.push(uint64_t(i), i % flows, 64);
+            if (q.pop(out, sojourn, shed)) sum += out;
+        }
+        double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / ops;
+        std::printf("%-13s %6lu flows  %6.1f ns per push+pop  (%lu)\n", name, static_cast<unsigned long>(flows), ns,
+                    static_cast<unsigned long>(sum & 0xf));
+    }
+}
+
+struct ping_result {
+    std::vector<uint32_t> rtt_us;
+    uint64_t flood_replies = 0;
+};
+
+static int udp_client(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+    timeval tv{0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static ping_result drive(uint16_t port, unsigned flood_rate, unsigned ping_hz, unsigned seconds, SlowServer &server) {
+    ping_result res;
+    std::atomic<bool> running(true);
+    int flood_fd = udp_client(port);
+    int ping_fd = udp_client(port);
+    std::thread flood_rx([&]() {
+        uint64_t rep;
+        while (running) if (recv(flood_fd, &rep, sizeof(rep), 0) == sizeof(rep)) res.flood_replies++;
+    });
+    std::thread ping_rx([&]() {
+        uint64_t sent;
+        // replies echo the send time, late ones still count after the flood stopped
+        auto drain_until = clock_type::time_point::max();
+        while (clock_type::now() < drain_until) {
+            if (!running && drain_until == clock_type::time_point::max())
+                drain_until = clock_type::now() + std::chrono::seconds(2);
+            if (recv(ping_fd, &sent, sizeof(sent), 0) == sizeof(sent))
+                res.rtt_us.push_back(static_cast<uint32_t>((now_ns() - sent) / 1000));
+        }
+    });
+    std::thread pinger([&]() {
+        auto next = clock_type::now();
+        while (running) {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::microseconds(1000000 / ping_hz);
+            uint64_t sent = now_ns();
+            send(ping_fd, &sent, sizeof(sent), 0);
+        }
+    });
+    auto start = clock_type::now();
+    auto end = start + std::chrono::seconds(seconds);
+    std::chrono::nanoseconds gap(1000000000ULL / flood_rate);
+    auto next = start;
+    bool sampled = false;
+    while (next < end) {
+        while (clock_type::now() < next) std::this_thread::yield();
+        uint64_t v = 0;
+        send(flood_fd, &v, sizeof(v), 0);
+        next += gap;
+        if (!sampled && next - start > (end - start) / 2) {
+            sampled = true;
+            for (const auto &f : server.queue_stats())
+                std::printf("    midway flow %-12lu depth %6lu  head wait %7lu us  served %7lu  avg wait %7lu us\n",
+                            static_cast<unsigned long>(f.flow), static_cast<unsigned long>(f.depth),
+                            static_cast<unsigned long>(f.head_wait_us), static_cast<unsigned long>(f.served),
+                            static_cast<unsigned long>(f.served ? f.wait_us_total / f.served : 0));
+        }
+    }
+    running = false;
+    flood_rx.join();
+    pinger.join();
+    ping_rx.join();
+    close(flood_fd);
+    close(ping_fd);
+    return res;
+}
+
+int main(int argc, char **argv) {
+    unsigned work_us = 50;
+    unsigned flood_rate = 0;
+    unsigned ping_hz = 20;
+    unsigned seconds = 3;
+    uint16_t port = 9720;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:r:z:t:p:")) != -1) {
+        switch (opt) {
+            case 'w': work_us = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': flood_rate = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'z': ping_hz = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': seconds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchFairQueue [-w work_us] [-r flood_per_sec] [-z ping_hz] [-t seconds] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (!flood_rate) flood_rate = 3 * 1000000 / work_us / 2;
+
+    bench_scheduler(QUEUE_DISCIPLINE::FIFO, 0, "fifo");
+    bench_scheduler(QUEUE_DISCIPLINE::DRR_MESSAGES, 0, "drr_messages");
+    bench_scheduler(QUEUE_DISCIPLINE::DRR_BYTES, 0, "drr_bytes");
+
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    std::cout << "\nwork " << work_us << "us per request, flood " << flood_rate << " req/s, ping " << ping_hz
+              << "/s for " << seconds << "s\n";
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<SlowServer>> servers;
+    const QUEUE_DISCIPLINE disciplines[] = {QUEUE_DISCIPLINE::FIFO, QUEUE_DISCIPLINE::DRR_MESSAGES};
+    const char *names[] = {"fifo", "drr"};
+    for (int i = 0; i < 2; i++) {
+        uint16_t mport = static_cast<uint16_t>(port + i);
+        servers.emplace_back(new SlowServer(LOCALHOSTIP, mport));
+        SlowServer &server = *servers.back();
+        server.work_us = work_us;
+        server.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+        server.set_queue_discipline(disciplines[i]);
+        server.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::printf("%s\n", names[i]);
+        ping_result res = drive(mport, flood_rate, ping_hz, seconds, server);
+        server.kill_threads();
+        std::sort(res.rtt_us.begin(), res.rtt_us.end());
+        auto pct = [&res](double p) -> unsigned long {
+            return res.rtt_us.empty() ? 0 : res.rtt_us[std::min(res.rtt_us.size() - 1, static_cast<size_t>(p * res.rtt_us.size()))];
+        };
+        std::printf("    light client %lu replies  rtt p50 %lu us  p99 %lu us   flood served %.0f/s\n",
+                    static_cast<unsigned long>(res.rtt_us.size()), pct(0.5), pct(0.99),
+                    static_cast<double>(res.flood_replies) / seconds);
+        std::fflush(stdout);
+    }
+    std::_Exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,214 @@
+#include "udp_server.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Snapshots larger than a datagram over loopback with set_fragmentation(). A sender server passes messages of -s
+ * bytes to send_item, a receiver server (InlinePolicy) checks every byte of what process_item gets. At most -w
+ * messages are outstanding, when nothing arrives for 50ms the rest counts as lost and the window is refilled.
+ *  frag                fragments as a datagram each
+ *  frag + gso          the fragment train of a message in one UDP_SEGMENT send
+ *  frag + gro          the receiver gets the train coalesced and reassembles from the segments in place
+ *  frag + reliable     fragments through set_reliability() as well
+ *  frag + rel 1% loss  the same with inject_loss dropping 1% of the datagrams in each direction
+ * Reported per mode and size: messages and MB per second, messages lost and corrupted, the receiver's reassembly
+ * counters. First, what a receiver without fragmentation does with one such datagram.
+ *
+ * usage: benchFragmentation [-s size] [-w window] [-d duration_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+// requests are sent from main while acks arrive on the recv thread, InlinePolicy with a real lock
+struct LockedInlinePolicy : jstd::net::InlinePolicy {
+    typedef std::mutex mutex_type;
+};
+
+// loss injection of the reliability layer, under its lock
+struct LossHook {
+    uint32_t loss_ppm = 0;
+    std::mt19937 rng{49};
+
+    bool drop() { return loss_ppm && rng() % 1000000 < loss_ppm; }
+};
+
+class Receiver : public jstd::UdpServerBase<Receiver, NetItem, jstd::net::InlinePolicy>, public LossHook {
+public:
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> corrupt{0};
+    using jstd::UdpServerBase<Receiver, NetItem, jstd::net::InlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        const std::vector<uint8_t> &msg = item.buff;
+        uint32_t seq = 0;
+        bool ok = msg.size() >= 4;
+        if (ok) std::memcpy(&seq, msg.data(), 4);
+        for (size_t i = 4; ok && i < msg.size(); i++) ok = msg[i] == static_cast<uint8_t>(seq * 31 + i);
+        if (!ok) corrupt++;
+        bytes.fetch_add(msg.size(), std::memory_order_relaxed);
+        messages.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    bool inject_loss(jstd::net::ConnHandle, const uint8_t *, size_t, bool) { return drop(); }
+};
+
+class Sender : public jstd::UdpServerBase<Sender, NetItem, LockedInlinePolicy>, public LossHook {
+public:
+    using jstd::UdpServerBase<Sender, NetItem, LockedInlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&) { return true; }
+
+    bool inject_loss(jstd::net::ConnHandle, const uint8_t *, size_t, bool) { return drop(); }
+};
+
+static void fill(std::vector<uint8_t> &msg, uint32_t seq) {
+    std::memcpy(msg.data(), &seq, 4);
+    for (size_t i = 4; i < msg.size(); i++) msg[i] = static_cast<uint8_t>(seq * 31 + i);
+}
+
+static jstd::net::ConnHandle connect_to(Sender &sndr, uint16_t port) {
+    jstd::net::NetConnection peer;
+    peer.sa.sin_family = AF_INET;
+    peer.sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &peer.sa.sin_addr);
+    peer.port = port;
+    return sndr.add_client(peer);
+}
+
+int main(int argc, char **argv) {
+    unsigned size = 0;
+    unsigned window = 2;    // two 64KB messages stay below the default socket receive buffer
+    unsigned ms = 1000;
+    uint16_t port = 9950;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:w:d:p:")) != -1) {
+        switch (opt) {
+            case 's': size = std::max(8u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'w': window = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'd': ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchFragmentation [-s size] [-w window] [-d duration_ms] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::ERROR);
+    std::vector<unsigned> sizes = size ? std::vector<unsigned>{size} : std::vector<unsigned>{16 * 1024, 64 * 1024};
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<Receiver>> receivers;
+    std::vector<std::unique_ptr<Sender>> senders;
+
+    {
+        // a plain datagram larger than the receive buffer
+        uint16_t rport = port++;
+        receivers.emplace_back(new Receiver(LOCALHOSTIP, rport));
+        Receiver &rcvr = *receivers.back();
+        senders.emplace_back(new Sender(LOCALHOSTIP, port++));
+        Sender &sndr = *senders.back();
+        rcvr.set_recv_timeout(20);
+        std::thread runner([&rcvr] { rcvr.run(); });
+        NetItem item;
+        item.conn = connect_to(sndr, rport);
+        item.buff.resize(sizes[0]);
+        fill(item.buff, 0);
+        sndr.send_item(item);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::printf("without fragmentation a %u byte datagram: %llu processed, %llu dropped as truncated\n\n",
+                    sizes[0], static_cast<unsigned long long>(rcvr.messages.load()),
+                    static_cast<unsigned long long>(rcvr.stats().trunc_cnt));
+        rcvr.kill_threads();
+        runner.join();
+    }
+
+    struct mode {
+        const char *name;
+        bool gso;
+        bool gro;
+        bool reliable;
+        uint32_t loss_ppm;
+    };
+    const mode modes[] = {{"frag", false, false, false, 0}, {"frag + gso", true, false, false, 0},
+                          {"frag + gro", false, true, false, 0}, {"frag + reliable", false, false, true, 0},
+                          {"frag + rel 1% loss", false, false, true, 10000}};
+    std::printf("window %u messages, %u ms per mode\n", window, ms);
+    std::printf("size   mode                  msgs/s      MB/s    lost  corrupt  reassembled  expired  evicted\n");
+    for (unsigned sz : sizes) {
+        for (const mode &m : modes) {
+            uint16_t rport = port++;
+            receivers.emplace_back(new Receiver(LOCALHOSTIP, rport));
+            Receiver &rcvr = *receivers.back();
+            senders.emplace_back(new Sender(LOCALHOSTIP, port++));
+            Sender &sndr = *senders.back();
+            jstd::net::FragmentConfig fcfg;
+            rcvr.set_fragmentation(fcfg);
+            sndr.set_fragmentation(fcfg);
+            rcvr.set_recv_timeout(2);
+            sndr.set_recv_timeout(2);
+            rcvr.set_udp_offload(false, m.gro);
+            sndr.set_udp_offload(m.gso, false);
+            if (m.reliable) {
+                jstd::net::ReliableConfig rcfg;
+                rcvr.set_reliability(rcfg);
+                sndr.set_reliability(rcfg);
+            }
+            rcvr.loss_ppm = sndr.loss_ppm = m.loss_ppm;
+            std::thread rcvr_runner([&rcvr] { rcvr.run(); });
+            std::thread sndr_runner([&sndr] { sndr.run(); });
+            NetItem item;
+            item.conn = connect_to(sndr, rport);
+            item.buff.resize(sz);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            uint64_t sent = 0;
+            uint64_t lost = 0;
+            auto start = clock_type::now();
+            auto end = start + std::chrono::milliseconds(ms);
+            auto last_progress = start;
+            uint64_t last_seen = 0;
+            while (clock_type::now() < end) {
+                uint64_t seen = rcvr.messages.load(std::memory_order_acquire);
+                if (seen != last_seen) {
+                    last_seen = seen;
+                    last_progress = clock_type::now();
+                }
+                if (sent - lost - seen < window) {
+                    fill(item.buff, static_cast<uint32_t>(sent));
+                    sndr.send_item(item);
+                    sent++;
+                } else if (clock_type::now() - last_progress > std::chrono::milliseconds(50)) {
+                    lost = sent - seen;
+                    last_progress = clock_type::now();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            double secs = std::chrono::duration<double>(clock_type::now() - start).count();
+            // whatever is still on its way is not lost
+            for (int i = 0; i < 100 && rcvr.messages.load() < sent; i++)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            uint64_t got = rcvr.messages.load();
+            jstd::net::ServerStats st = rcvr.stats();
+            std::printf("%3uK   %-18s %9.0f %9.1f %7llu %8llu %12llu %8llu %8llu\n", sz / 1024, m.name,
+                        static_cast<double>(got) / secs, static_cast<double>(rcvr.bytes.load()) / secs / 1e6,
+                        static_cast<unsigned long long>(sent - got), static_cast<unsigned long long>(rcvr.corrupt.load()),
+                        static_cast<unsigned long long>(st.frag_reassembled_cnt),
+                        static_cast<unsigned long long>(st.frag_expired_cnt),
+                        static_cast<unsigned long long>(st.frag_evicted_cnt));
+            sndr.kill_threads();
+            rcvr.kill_threads();
+            sndr_runner.join();
+            rcvr_runner.join();
+        }
+    }
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,239 @@
+#include "tcp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <netinet/tcp.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Client impact of hot restarts.
+ * -c clients keep one connection each and send numbered requests back to back, -n more clients open a new
+ * connection for every request. Every -i ms the serving generation hands its listener and connections to a
+ * successor over a HotRestart channel (in process, but over the same unix socket and SCM_RIGHTS a separate
+ * process would use), the successor then listens on the channel path for the next one.
+ * Reported: failed requests (reset, timeout or a reply that is not the request's echo), latency percentiles
+ * over the run and the worst latency of a request in flight while a hand off ran.
+ *
+ * usage: benchHotRestart [-c clients] [-n connecting_clients] [-r restarts] [-i interval_ms] [-w work_us] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+using jstd::net::HotRestart;
+using jstd::net::HandoffState;
+typedef std::chrono::steady_clock clock_type;
+
+constexpr size_t REQ_LEN = 16;
+
+class EchoServer : public jstd::net::TcpServerBase<EchoServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    unsigned work_us = 50;
+    using jstd::net::TcpServerBase<EchoServer, NetItem, jstd::net::PipelinePolicy>::TcpServerBase;
+
+    bool process_item(NetItem &&item) {
+        auto until = clock_type::now() + std::chrono::microseconds(work_us);
+        while (clock_type::now() < until) { }
+        return send_to(item.conn, item.buff.data(), item.buff.size());
+    }
+
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+};
+
+struct sample {
+    int64_t start_us;       // since the run started
+    uint32_t lat_us;
+};
+
+struct client_result {
+    uint64_t replies = 0;
+    uint64_t failures = 0;
+    std::vector<sample> samples;
+};
+
+static std::atomic<bool> g_running(false);
+
+static int connect_to(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// one request, true if the echo came back intact
+static bool round_trip(int fd, unsigned id, uint64_t seq) {
+    char req[REQ_LEN + 1];
+    char rep[REQ_LEN];
+    std::snprintf(req, sizeof(req), "%04u:%010llu\n", id % 10000, static_cast<unsigned long long>(seq % 10000000000ULL));
+    if (send(fd, req, REQ_LEN, MSG_NOSIGNAL) != static_cast<ssize_t>(REQ_LEN)) return false;
+    size_t got = 0;
+    while (got < REQ_LEN) {
+        ssize_t n = recv(fd, rep + got, REQ_LEN - got, 0);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return std::memcmp(req, rep, REQ_LEN) == 0;
+}
+
+static void client(uint16_t port, unsigned id, bool reconnect, clock_type::time_point start, client_result &res) {
+    int fd = reconnect ? -1 : connect_to(port);
+    uint64_t seq = 0;
+    while (g_running) {
+        auto t0 = clock_type::now();
+        if (reconnect) fd = connect_to(port);
+        bool ok = fd >= 0 && round_trip(fd, id, seq++);
+        if (reconnect && fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+        auto t1 = clock_type::now();
+        if (!ok) {
+            res.failures++;
+            if (!reconnect) {
+                // a persistent connection that failed is lost, count it once and start a new one
+                if (fd >= 0) close(fd);
+                fd = connect_to(port);
+            }
+            continue;
+        }
+        res.replies++;
+        res.samples.push_back(sample{std::chrono::duration_cast<std::chrono::microseconds>(t0 - start).count(),
+            static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count())});
+    }
+    if (fd >= 0) close(fd);
+}
+
+int main(int argc, char **argv) {
+    unsigned clients = 16;
+    unsigned connecting = 2;
+    unsigned restarts = 5;
+    unsigned interval_ms = 400;
+    unsigned work_us = 50;
+    uint16_t port = 9800;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:n:r:i:w:p:")) != -1) {
+        switch (opt) {
+            case 'c': clients = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'n': connecting = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'r': restarts = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'i': interval_ms = std::max(10u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'w': work_us = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchHotRestart [-c clients] [-n connecting_clients] [-r restarts] "
+                             "[-i interval_ms] [-w work_us] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    std::string path = "/tmp/benchHotRestart." + std::to_string(getpid()) + ".sock";
+    std::printf("%u persistent and %u connect-per-request clients, %u hand offs every %ums, %uus per process_item\n",
+                clients, connecting, restarts, interval_ms, work_us);
+
+    // generations are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<EchoServer>> servers;
+    std::vector<std::unique_ptr<HotRestart>> channels;
+    servers.emplace_back(new EchoServer(LOCALHOSTIP, port));
+    servers.back()->work_us = work_us;
+    servers.back()->set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+    servers.back()->run();
+    channels.emplace_back(new HotRestart());
+    if (!channels.back()->listen(path)) {
+        std::cerr << "can not listen on " << path << " errno " << errno << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto start = clock_type::now();
+    std::vector<client_result> results(clients + connecting);
+    std::vector<std::thread> threads;
+    g_running = true;
+    for (unsigned c = 0; c < clients + connecting; c++)
+        threads.emplace_back(client, port, c, c >= clients, start, std::ref(results[c]));
+
+    struct window { int64_t from_us, to_us; double handoff_ms; size_t conns; };
+    std::vector<window> windows;
+    for (unsigned r = 0; r < restarts; r++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        // the successor, what a freshly started process would run
+        std::unique_ptr<EchoServer> next;
+        size_t taken = 0;
+        std::unique_ptr<HotRestart> next_chan(new HotRestart());
+        std::thread successor([&]() {
+            HotRestart chan;
+            HandoffState state;
+            if (!chan.connect(path) || !chan.recv_state(state)) return;
+            next.reset(new EchoServer(state.listen_fd));
+            next->work_us = work_us;
+            next->set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+            taken = next->take_over(state);
+            next->run();
+            next_chan->listen(path);
+        });
+        auto t0 = clock_type::now();
+        bool ok = channels.back()->accept(1000) && servers.back()->hand_off(*channels.back());
+        auto t1 = clock_type::now();
+        successor.join();
+        if (!ok || !next) {
+            std::cerr << "hand off " << r + 1 << " failed" << std::endl;
+            break;
+        }
+        channels.back()->close();
+        windows.push_back(window{std::chrono::duration_cast<std::chrono::microseconds>(t0 - start).count(),
+                                 std::chrono::duration_cast<std::chrono::microseconds>(t1 - start).count(),
+                                 std::chrono::duration<double, std::milli>(t1 - t0).count(), taken});
+        servers.push_back(std::move(next));
+        channels.push_back(std::move(next_chan));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    g_running = false;
+    for (auto &t : threads) t.join();
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    servers.back()->kill_threads();
+
+    uint64_t replies = 0, failures = 0;
+    std::vector<uint32_t> lat;
+    for (auto &res : results) {
+        replies += res.replies;
+        failures += res.failures;
+        for (const auto &s : res.samples) lat.push_back(s.lat_us);
+    }
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&lat](double p) -> uint32_t {
+        return lat.empty() ? 0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))];
+    };
+    std::printf("replies/s %.0f  failed %lu  p50 %uus  p99 %uus  max %uus\n", replies / elapsed,
+                static_cast<unsigned long>(failures), pct(0.5), pct(0.99), lat.empty() ? 0 : lat.back());
+    std::printf("hand off   duration_ms   connections   worst_inflight_us\n");
+    for (size_t i = 0; i < windows.size(); i++) {
+        uint32_t worst = 0;
+        for (auto &res : results)
+            for (const auto &s : res.samples)
+                if (s.start_us <= windows[i].to_us && s.start_us + s.lat_us >= windows[i].from_us)
+                    worst = std::max(worst, s.lat_us);
+        std::printf("%8lu %13.2f %13lu %19u\n", static_cast<unsigned long>(i + 1), windows[i].handoff_ms,
+                    static_cast<unsigned long>(windows[i].conns), worst);
+    }
+    std::printf("items processed per generation:");
+    for (auto &s : servers) std::printf(" %lu", static_cast<unsigned long>(s->stats().msg_processed_cnt));
+    std::printf("\n");
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
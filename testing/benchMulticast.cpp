@@ -0,0 +1,218 @@
+#include "udp_server.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * Broadcasts to many receivers on loopback, one send to a multicast group (set_multicast()) against a send per client.
+ * First, subscribers as servers: -n servers (InlinePolicy) built on multicast::bind_socket() join the group, the
+ * sender broadcasts fragmented 16KB messages through send_item in broadcast mode, one subscriber leaves half way.
+ * Then the cost of a broadcast of -s bytes to 100 and 1000 receiving sockets (or -c), each mode for -r rounds:
+ *  unicast             a sendto per client
+ *  unicast sendmmsg    the fan-out of set_batching(), 64 clients per syscall
+ *  multicast           one sendto to the group, every socket that joined it gets a copy
+ * A round is one broadcast_data call on the sender followed by draining every receiving socket. Reported: the
+ * sender's time per broadcast (on loopback it includes the kernel delivering the copies), the time to drain the
+ * receivers and the datagrams delivered of those expected.
+ *
+ * usage: benchMulticast [-c clients] [-s size] [-r rounds] [-n subscribers] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+static const char *GROUP = "239.77.0.1";
+
+class Subscriber : public jstd::UdpServerBase<Subscriber, NetItem, jstd::net::InlinePolicy> {
+public:
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> corrupt{0};
+    using jstd::UdpServerBase<Subscriber, NetItem, jstd::net::InlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        const std::vector<uint8_t> &msg = item.buff;
+        bool ok = !msg.empty();
+        for (size_t i = 1; ok && i < msg.size(); i++) ok = msg[i] == static_cast<uint8_t>(msg[0] + i);
+        if (!ok) corrupt++;
+        messages.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+};
+
+class Publisher : public jstd::UdpServerBase<Publisher, NetItem, jstd::net::InlinePolicy> {
+public:
+    using jstd::UdpServerBase<Publisher, NetItem, jstd::net::InlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&) { return true; }
+};
+
+static jstd::net::MulticastConfig loopback_config() {
+    jstd::net::MulticastConfig cfg;
+    inet_aton(LOCALHOSTIP, &cfg.interface);
+    return cfg;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(p * (v.size() - 1))];
+}
+
+int main(int argc, char **argv) {
+    unsigned clients = 0;
+    unsigned size = 256;
+    unsigned rounds = 200;
+    unsigned subscribers = 4;
+    uint16_t port = 9960;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:r:n:p:")) != -1) {
+        switch (opt) {
+            case 'c': clients = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 's': size = std::max(1u, std::min<unsigned>(1400, std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': rounds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'n': subscribers = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchMulticast [-c clients] [-s size] [-r rounds] [-n subscribers] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::ERROR);
+    std::vector<unsigned> counts = clients ? std::vector<unsigned>{clients} : std::vector<unsigned>{100, 1000};
+    in_addr group{}, lo{};
+    inet_aton(GROUP, &group);
+    inet_aton(LOCALHOSTIP, &lo);
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<Subscriber>> subs;
+    std::vector<std::unique_ptr<Publisher>> pubs;
+
+    {
+        uint16_t gport = port++;
+        pubs.emplace_back(new Publisher(LOCALHOSTIP, port++));
+        Publisher &pub = *pubs.back();
+        jstd::net::FragmentConfig fcfg;
+        pub.set_fragmentation(fcfg);
+        if (!pub.set_multicast(GROUP, gport, loopback_config())) {
+            std::cerr << "multicast refused, errno " << errno << std::endl;
+            return EXIT_FAILURE;
+        }
+        pub.set_bcast_mode(true);
+        std::vector<std::thread> runners;
+        for (unsigned i = 0; i < subscribers; i++) {
+            int fd = jstd::net::multicast::bind_socket(gport);
+            if (fd < 0) {
+                std::cerr << "binding the group port failed, errno " << errno << std::endl;
+                return EXIT_FAILURE;
+            }
+            subs.emplace_back(new Subscriber(fd));
+            Subscriber &sub = *subs.back();
+            sub.set_fragmentation(fcfg);
+            sub.set_recv_timeout(20);
+            if (!sub.join_group(GROUP, LOCALHOSTIP)) {
+                std::cerr << "joining the group failed, errno " << errno << std::endl;
+                return EXIT_FAILURE;
+            }
+            runners.emplace_back([&sub] { sub.run(); });
+        }
+        NetItem item;
+        item.buff.resize(16 * 1024);
+        const unsigned messages = 100;
+        for (unsigned m = 0; m < 2 * messages; m++) {
+            // the last subscriber leaves half way, it should stop getting them
+            if (m == messages) subs.back()->leave_group(GROUP, LOCALHOSTIP);
+            for (size_t i = 0; i < item.buff.size(); i++) item.buff[i] = static_cast<uint8_t>(m + i);
+            pub.send_item(item);
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::printf("%u subscribers, %u fragmented 16KB broadcasts, the last one leaves after %u: %llu sent to the group\n",
+                    subscribers, 2 * messages, messages, static_cast<unsigned long long>(pub.stats().mcast_sent_cnt));
+        for (unsigned i = 0; i < subscribers; i++) {
+            Subscriber &sub = *subs[i];
+            std::printf("  subscriber %u: %llu messages, %llu corrupt, %llu reassembled\n", i,
+                        static_cast<unsigned long long>(sub.messages.load()),
+                        static_cast<unsigned long long>(sub.corrupt.load()),
+                        static_cast<unsigned long long>(sub.stats().frag_reassembled_cnt));
+            sub.kill_threads();
+        }
+        for (auto &runner : runners) runner.join();
+    }
+
+    std::vector<uint8_t> payload(size, 0x5a);
+    std::printf("\n%u byte broadcasts, %u rounds per mode\n", size, rounds);
+    std::printf("clients  mode                 send us p50      p99     mean   bcasts/s   drain us    delivered\n");
+    for (unsigned n : counts) {
+        for (int mode = 0; mode < 3; mode++) {
+            const char *name = mode == 0 ? "unicast" : mode == 1 ? "unicast sendmmsg" : "multicast";
+            uint16_t base = port;
+            port = static_cast<uint16_t>(port + n + 2);
+            pubs.emplace_back(new Publisher(LOCALHOSTIP, base));
+            Publisher &pub = *pubs.back();
+            std::vector<int> socks;
+            for (unsigned i = 0; i < n; i++) {
+                int fd;
+                if (mode == 2) {
+                    fd = jstd::net::multicast::bind_socket(static_cast<uint16_t>(base + 1));
+                    if (fd >= 0 && !jstd::net::multicast::join(fd, group, lo)) {
+                        close(fd);
+                        fd = -1;
+                    }
+                } else {
+                    fd = socket(AF_INET, SOCK_DGRAM, 0);
+                    jstd::net::NetConnection conn;
+                    conn.sa.sin_port = htons(static_cast<uint16_t>(base + 1 + i));
+                    conn.port = base + 1 + i;
+                    inet_aton(LOCALHOSTIP, &conn.sa.sin_addr);
+                    if (fd >= 0 && bind(fd, reinterpret_cast<const sockaddr *>(&conn.sa), sizeof(conn.sa)) < 0) {
+                        close(fd);
+                        fd = -1;
+                    }
+                    pub.add_client(conn);
+                }
+                if (fd < 0) {
+                    std::cerr << "receiver socket " << i << " failed, errno " << errno << std::endl;
+                    return EXIT_FAILURE;
+                }
+                socks.push_back(fd);
+            }
+            if (mode == 1) pub.set_batching(1, 64);
+            if (mode == 2) pub.set_multicast(GROUP, static_cast<uint16_t>(base + 1), loopback_config());
+
+            std::vector<double> send_us, drain_us;
+            uint64_t delivered = 0;
+            uint8_t buf[2048];
+            for (unsigned r = 0; r < rounds; r++) {
+                auto t0 = clock_type::now();
+                pub.broadcast_data(payload);
+                auto t1 = clock_type::now();
+                unsigned got = 0;
+                auto give_up = t1 + std::chrono::milliseconds(20);
+                while (got < n && clock_type::now() < give_up) {
+                    for (int fd : socks)
+                        while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) got++;
+                }
+                auto t2 = clock_type::now();
+                delivered += got;
+                send_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                drain_us.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+            }
+            double mean = 0, drain = 0;
+            for (double v : send_us) mean += v;
+            for (double v : drain_us) drain += v;
+            mean /= send_us.size();
+            drain /= drain_us.size();
+            std::printf("%7u  %-18s %12.1f %8.1f %8.1f %10.0f %10.1f %7llu/%llu\n", n, name, percentile(send_us, 0.5),
+                        percentile(send_us, 0.99), mean, 1e6 / mean, drain,
+                        static_cast<unsigned long long>(delivered),
+                        static_cast<unsigned long long>(static_cast<uint64_t>(n) * rounds));
+            for (int fd : socks) close(fd);
+        }
+    }
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
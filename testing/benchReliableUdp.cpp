@@ -0,0 +1,427 @@
+#include "udp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/if_tun.h>
+#include <memory>
+#include <net/if.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <sys/ioctl.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Request latency of the reliable UDP layer against TCP over a lossy link. A client sends -n requests of -s bytes
+ * at -r per second (open loop, a late answer does not hold back the next request), the server echoes them and the
+ * client records the time to the answer. Per loss rate (0, 1, 2 and 5% of the packets in each direction):
+ *  tcp               one TCP_NODELAY connection, the kernel's retransmission
+ *  rudp ordered      UdpServerBase with set_reliability(), answers delivered in sequence order
+ *  rudp unordered    the same with ordered off, a lost answer only delays itself
+ * The link is a TUN device in this process: both ends bind to its address and talk to two made up peers behind it,
+ * a forwarder thread turns every packet around, drops it with the loss probability and holds it back for the one
+ * way delay -l. Needs CAP_NET_ADMIN, without a TUN device the UDP rows run over loopback with the loss injected
+ * through inject_loss and TCP is skipped.
+ * Reported: latency percentiles of the answers received, answers missing after -t ms, duplicates, answers out of
+ * request order and retransmissions of the reliable layer (both ends).
+ *
+ * usage: benchReliableUdp [-n requests] [-r rate] [-s size] [-l delay_ms] [-t timeout_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+static const char *LINK_ADDR = "10.77.0.1";     // both ends bind here
+static const char *FAKE_CLIENT = "10.77.1.1";   // what the server sees
+static const char *FAKE_SERVER = "10.77.1.2";   // what the client connects to
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock_type::now().time_since_epoch()).count());
+}
+
+static uint32_t sum16(const uint8_t *p, size_t len, uint32_t sum) {
+    for (; len > 1; p += 2, len -= 2) sum += static_cast<uint32_t>(p[0] << 8 | p[1]);
+    if (len) sum += static_cast<uint32_t>(p[0] << 8);
+    return sum;
+}
+
+static uint16_t fold(uint32_t sum) {
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum & 0xFFFF);
+}
+
+// the TUN device and the thread turning its packets around
+class LossyLink {
+    int m_fd = -1;
+    uint64_t m_delay_ns = 0;
+    in_addr m_link{}, m_client{}, m_server{};
+    std::deque<std::pair<uint64_t, std::vector<uint8_t>>> m_delayed;
+    std::mt19937 m_rng{20261019};
+    std::thread m_thread;
+
+    void turn_around(uint8_t *pkt, size_t len) {
+        if (len < 20 || (pkt[0] >> 4) != 4) return;
+        size_t ihl = (pkt[0] & 0x0Fu) * 4u;
+        size_t total = static_cast<size_t>(pkt[2] << 8 | pkt[3]);
+        if (ihl < 20 || total > len || total < ihl) return;
+        in_addr dst;
+        std::memcpy(&dst, pkt + 16, 4);
+        in_addr src;
+        if (dst.s_addr == m_server.s_addr) src = m_client;
+        else if (dst.s_addr == m_client.s_addr) src = m_server;
+        else return;
+        uint32_t ppm = loss_ppm.load(std::memory_order_relaxed);
+        if (ppm && m_rng() % 1000000 < ppm) {
+            dropped++;
+            return;
+        }
+        std::memcpy(pkt + 12, &src, 4);
+        std::memcpy(pkt + 16, &m_link, 4);
+        pkt[10] = pkt[11] = 0;
+        uint16_t sum = fold(sum16(pkt, ihl, 0));
+        pkt[10] = static_cast<uint8_t>(sum >> 8);
+        pkt[11] = static_cast<uint8_t>(sum);
+        uint8_t proto = pkt[9];
+        size_t csum_at = proto == IPPROTO_TCP ? 16 : proto == IPPROTO_UDP ? 6 : 0;
+        size_t l4len = total - ihl;
+        if (csum_at && l4len >= csum_at + 2) {
+            uint8_t *l4 = pkt + ihl;
+            l4[csum_at] = l4[csum_at + 1] = 0;
+            uint32_t pseudo = sum16(pkt + 12, 8, 0) + proto + static_cast<uint32_t>(l4len);
+            sum = fold(sum16(l4, l4len, pseudo));
+            if (proto == IPPROTO_UDP && !sum) sum = 0xFFFF;
+            l4[csum_at] = static_cast<uint8_t>(sum >> 8);
+            l4[csum_at + 1] = static_cast<uint8_t>(sum);
+        }
+        m_delayed.emplace_back(now_ns() + m_delay_ns, std::vector<uint8_t>(pkt, pkt + total));
+    }
+
+    void forward() {
+        uint8_t buff[65536];
+        while (!stop.load(std::memory_order_relaxed)) {
+            uint64_t wait_ns = 10000000;
+            if (!m_delayed.empty()) {
+                uint64_t now = now_ns();
+                wait_ns = m_delayed.front().first > now ? std::min(wait_ns, m_delayed.front().first - now) : 0;
+            }
+            timespec ts{static_cast<time_t>(wait_ns / 1000000000), static_cast<long>(wait_ns % 1000000000)};
+            pollfd pfd{m_fd, POLLIN, 0};
+            if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+                ssize_t len;
+                while ((len = read(m_fd, buff, sizeof(buff))) > 0) turn_around(buff, static_cast<size_t>(len));
+            }
+            uint64_t now = now_ns();
+            while (!m_delayed.empty() && m_delayed.front().first <= now) {
+                if (write(m_fd, m_delayed.front().second.data(), m_delayed.front().second.size()) < 0) dropped++;
+                m_delayed.pop_front();
+            }
+        }
+    }
+
+public:
+    std::atomic<uint32_t> loss_ppm{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> stop{false};
+    std::string error;
+
+    bool open(unsigned delay_ms) {
+        m_delay_ns = delay_ms * 1000000ULL;
+        inet_aton(LINK_ADDR, &m_link);
+        inet_aton(FAKE_CLIENT, &m_client);
+        inet_aton(FAKE_SERVER, &m_server);
+        m_fd = ::open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+        if (m_fd < 0) {
+            error = std::string("/dev/net/tun: ") + std::strerror(errno);
+            return false;
+        }
+        ifreq ifr{};
+        ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+        std::strncpy(ifr.ifr_name, "rudpb%d", IFNAMSIZ - 1);
+        int sd = socket(AF_INET, SOCK_DGRAM, 0);
+        auto *sa = reinterpret_cast<sockaddr_in*>(&ifr.ifr_addr);
+        bool ok = ioctl(m_fd, TUNSETIFF, &ifr) == 0;
+        if (ok) {
+            sa->sin_family = AF_INET;
+            sa->sin_addr = m_link;
+            ok = ioctl(sd, SIOCSIFADDR, &ifr) == 0;
+        }
+        if (ok) {
+            inet_aton("255.255.0.0", &sa->sin_addr);
+            ok = ioctl(sd, SIOCSIFNETMASK, &ifr) == 0;
+        }
+        if (ok) ok = ioctl(sd, SIOCGIFFLAGS, &ifr) == 0;
+        if (ok) {
+            ifr.ifr_flags = static_cast<short>(ifr.ifr_flags | IFF_UP | IFF_RUNNING);
+            ok = ioctl(sd, SIOCSIFFLAGS, &ifr) == 0;
+        }
+        if (!ok) error = std::string("tun setup: ") + std::strerror(errno);
+        close(sd);
+        if (!ok) {
+            close(m_fd);
+            return false;
+        }
+        m_thread = std::thread(&LossyLink::forward, this);
+        return true;
+    }
+};
+
+// answers as they arrive, written by one receiving thread
+struct Recorder {
+    std::unique_ptr<std::atomic<uint64_t>[]> lat_ns;
+    uint32_t count = 0;
+    int64_t last_seq = -1;
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> out_of_order{0};
+
+    explicit Recorder(uint32_t n) : lat_ns(new std::atomic<uint64_t>[n]()), count(n) {}
+
+    void record(const uint8_t *msg, size_t len) {
+        if (len < 12) return;
+        uint32_t seq;
+        uint64_t sent;
+        std::memcpy(&seq, msg, 4);
+        std::memcpy(&sent, msg + 4, 8);
+        if (seq >= count) return;
+        uint64_t expect = 0;
+        if (!lat_ns[seq].compare_exchange_strong(expect, std::max<uint64_t>(1, now_ns() - sent))) {
+            duplicates++;
+            return;
+        }
+        if (static_cast<int64_t>(seq) != last_seq + 1) out_of_order++;
+        last_seq = seq;
+        received.fetch_add(1, std::memory_order_release);
+    }
+};
+
+// loss injection when there is no TUN link, under the reliable layer's lock
+struct LossHook {
+    std::atomic<uint32_t> loss_ppm{0};
+    std::mt19937 rng{1019};
+
+    bool drop() {
+        uint32_t ppm = loss_ppm.load(std::memory_order_relaxed);
+        return ppm && rng() % 1000000 < ppm;
+    }
+};
+
+class EchoServer : public jstd::UdpServerBase<EchoServer, NetItem, jstd::net::InlinePolicy>, public LossHook {
+public:
+    using jstd::UdpServerBase<EchoServer, NetItem, jstd::net::InlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) { return send_item(item); }
+
+    bool inject_loss(jstd::net::ConnHandle, const uint8_t *, size_t, bool) { return drop(); }
+};
+
+// answers processed on the recv thread like InlinePolicy, locked because requests are sent from main meanwhile.
+// PipelinePolicy would add the worker's idle sleep to every answer
+struct LockedInlinePolicy : jstd::net::InlinePolicy {
+    typedef std::mutex mutex_type;
+};
+
+class ClientServer : public jstd::UdpServerBase<ClientServer, NetItem, LockedInlinePolicy>, public LossHook {
+public:
+    Recorder *rec = nullptr;
+    using jstd::UdpServerBase<ClientServer, NetItem, LockedInlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        rec->record(item.buff.data(), item.buff.size());
+        return true;
+    }
+
+    bool inject_loss(jstd::net::ConnHandle, const uint8_t *, size_t, bool) { return drop(); }
+};
+
+struct params {
+    uint32_t requests;
+    unsigned rate;
+    unsigned size;
+    unsigned timeout_ms;
+};
+
+// paced requests through send, then wait up to timeout_ms for the rest of the answers
+template<typename Send>
+static void drive(const params &prm, Recorder &rec, Send send) {
+    std::vector<uint8_t> msg(prm.size, 'q');
+    auto start = clock_type::now();
+    auto interval = std::chrono::nanoseconds(1000000000ULL / prm.rate);
+    for (uint32_t seq = 0; seq < prm.requests; seq++) {
+        std::this_thread::sleep_until(start + interval * seq);
+        uint64_t ts = now_ns();
+        std::memcpy(msg.data(), &seq, 4);
+        std::memcpy(msg.data() + 4, &ts, 8);
+        send(msg.data(), msg.size());
+    }
+    auto until = clock_type::now() + std::chrono::milliseconds(prm.timeout_ms);
+    while (rec.received.load(std::memory_order_acquire) < prm.requests && clock_type::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+static bool read_full(int fd, uint8_t *buff, size_t len) {
+    for (size_t got = 0; got < len;) {
+        ssize_t n = read(fd, buff + got, len - got);
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool run_tcp(const params &prm, uint16_t port, LossyLink &link, uint32_t loss_ppm, Recorder &rec) {
+    int lsd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(lsd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LINK_ADDR, &sa.sin_addr);
+    if (bind(lsd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0 || listen(lsd, 1) < 0) {
+        close(lsd);
+        return false;
+    }
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    inet_aton(FAKE_SERVER, &sa.sin_addr);
+    if (connect(cfd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        close(cfd);
+        close(lsd);
+        return false;
+    }
+    int sfd = accept(lsd, nullptr, nullptr);
+    setsockopt(sfd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    size_t size = prm.size;
+    std::thread echo([sfd, size] {
+        std::vector<uint8_t> buff(size);
+        while (read_full(sfd, buff.data(), size))
+            if (write(sfd, buff.data(), size) != static_cast<ssize_t>(size)) break;
+    });
+    link.loss_ppm = loss_ppm;
+    std::thread answers([cfd, size, &rec] {
+        std::vector<uint8_t> buff(size);
+        while (read_full(cfd, buff.data(), size)) rec.record(buff.data(), size);
+    });
+    drive(prm, rec, [cfd](const uint8_t *data, size_t len) {
+        if (write(cfd, data, len) != static_cast<ssize_t>(len)) std::perror("tcp write");
+    });
+    link.loss_ppm = 0;
+    shutdown(cfd, SHUT_RDWR);
+    shutdown(sfd, SHUT_RDWR);
+    answers.join();
+    echo.join();
+    close(cfd);
+    close(sfd);
+    close(lsd);
+    return true;
+}
+
+static double pct(const std::vector<uint64_t> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t at = std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[at]) / 1e6;
+}
+
+int main(int argc, char **argv) {
+    params prm{5000, 1000, 64, 5000};
+    unsigned delay_ms = 5;
+    uint16_t port = 9960;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:s:l:t:p:")) != -1) {
+        switch (opt) {
+            case 'n': prm.requests = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': prm.rate = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 's': prm.size = std::max(16u, std::min(1024u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)))); break;
+            case 'l': delay_ms = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 't': prm.timeout_ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchReliableUdp [-n requests] [-r rate] [-s size] [-l delay_ms] [-t timeout_ms] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::ERROR);
+    LossyLink link;
+    bool tun = link.open(delay_ms);
+    if (tun) {
+        std::printf("TUN link, %u ms one way, %u requests of %u bytes at %u/s\n", delay_ms, prm.requests, prm.size,
+                    prm.rate);
+    } else {
+        std::printf("no TUN link (%s), UDP over loopback with inject_loss, TCP skipped\n", link.error.c_str());
+        std::printf("%u requests of %u bytes at %u/s\n", prm.requests, prm.size, prm.rate);
+    }
+    std::printf("loss  mode                p50 ms   p99 ms  p99.9 ms   max ms  missing  dup  out of order  retrans\n");
+    const char *server_ip = tun ? LINK_ADDR : LOCALHOSTIP;
+    const char *peer_ip = tun ? FAKE_SERVER : LOCALHOSTIP;
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<EchoServer>> servers;
+    std::vector<std::unique_ptr<ClientServer>> clients;
+    const unsigned losses[] = {0, 1, 2, 5};
+    for (unsigned loss : losses) {
+        for (int mode = 0; mode < 3; mode++) {
+            if (mode == 0 && !tun) continue;
+            Recorder rec(prm.requests);
+            uint64_t retrans = 0;
+            uint32_t ppm = loss * 10000;
+            if (mode == 0) {
+                if (!run_tcp(prm, port++, link, ppm, rec)) {
+                    std::printf("%3u%%  tcp               could not connect over the link\n", loss);
+                    continue;
+                }
+            } else {
+                uint16_t sport = port++;
+                servers.emplace_back(new EchoServer(server_ip, sport));
+                EchoServer &svr = *servers.back();
+                clients.emplace_back(new ClientServer(tun ? LINK_ADDR : LOCALHOSTIP, port++));
+                ClientServer &cli = *clients.back();
+                jstd::net::ReliableConfig cfg;
+                cfg.ordered = mode == 1;
+                svr.set_recv_timeout(static_cast<int>(cfg.tick_ms));
+                svr.set_reliability(cfg);
+                cli.set_recv_timeout(static_cast<int>(cfg.tick_ms));
+                cli.set_reliability(cfg);
+                cli.rec = &rec;
+                std::thread runner([&svr] { svr.run(); });
+                std::thread client_runner([&cli] { cli.run(); });
+                jstd::net::NetConnection peer;
+                peer.sa.sin_family = AF_INET;
+                peer.sa.sin_port = htons(sport);
+                inet_aton(peer_ip, &peer.sa.sin_addr);
+                peer.port = sport;
+                jstd::net::ConnHandle to = cli.add_client(peer);
+                // one request out of range first, its answer gives the layer an RTT sample
+                uint8_t warm[12] = {0xFF, 0xFF, 0xFF, 0xFF};
+                cli.send_reliable(to, warm, sizeof(warm));
+                std::this_thread::sleep_for(std::chrono::milliseconds(50 + 4 * delay_ms));
+                if (tun) link.loss_ppm = ppm;
+                else svr.loss_ppm = cli.loss_ppm = ppm;
+                drive(prm, rec, [&cli, to](const uint8_t *data, size_t len) { cli.send_reliable(to, data, len); });
+                link.loss_ppm = 0;
+                retrans = svr.stats().rel_retrans_cnt + cli.stats().rel_retrans_cnt;
+                cli.kill_threads();
+                svr.kill_threads();
+                runner.join();
+                client_runner.join();
+            }
+            std::vector<uint64_t> lat;
+            for (uint32_t i = 0; i < prm.requests; i++)
+                if (uint64_t ns = rec.lat_ns[i].load()) lat.push_back(ns);
+            std::sort(lat.begin(), lat.end());
+            static const char *names[] = {"tcp", "rudp ordered", "rudp unordered"};
+            std::printf("%3u%%  %-16s %8.2f %8.2f %9.2f %8.2f %8llu %4llu %13llu %8s\n", loss, names[mode],
+                        pct(lat, 0.5), pct(lat, 0.99), pct(lat, 0.999), lat.empty() ? 0.0 : lat.back() / 1e6,
+                        static_cast<unsigned long long>(prm.requests - lat.size()),
+                        static_cast<unsigned long long>(rec.duplicates.load()),
+                        static_cast<unsigned long long>(rec.out_of_order.load()),
+                        mode ? std::to_string(retrans).c_str() : "kernel");
+        }
+    }
+    link.stop = true;
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
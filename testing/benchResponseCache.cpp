@@ -0,0 +1,264 @@
+#include "tcp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <netinet/tcp.h>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * ResponseCache (W-TinyLFU) against a plain LRU of the same byte budget.
+ *  1. hit ratio and ns per lookup(+insert on miss) on a zipf request stream over -n distinct requests, with a
+ *     burst of one-off requests (a scan) every 1000 requests, at 1%, 5% and 20% of the working set
+ *  2. a TcpServerBase whose process_item spends work_us per request, clients send zipf requests, replies/s and
+ *     process_item calls with and without the cache in front
+ *
+ * usage: benchResponseCache [-n requests] [-s zipf_skew] [-r response_size] [-w work_us] [-c clients] [-t seconds] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+using jstd::net::ResponseCache;
+typedef std::chrono::steady_clock clock_type;
+
+class PureServer : public jstd::net::TcpServerBase<PureServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    unsigned work_us = 100;
+    size_t response_size = 256;
+    using jstd::net::TcpServerBase<PureServer, NetItem, jstd::net::PipelinePolicy>::TcpServerBase;
+
+    bool process_item(NetItem &&item) {
+        auto until = clock_type::now() + std::chrono::microseconds(work_us);
+        while (clock_type::now() < until) { }
+        std::vector<uint8_t> resp(response_size, '.');
+        std::copy(item.buff.begin(), item.buff.begin() + std::min(item.buff.size(), resp.size()), resp.begin());
+        resp.back() = '\n';
+        return send_to(item.conn, resp.data(), resp.size());
+    }
+
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+};
+
+// byte budgeted LRU, the baseline
+class LruCache {
+    struct entry {
+        std::vector<uint8_t> response;
+        std::list<uint64_t>::iterator pos;
+    };
+    std::unordered_map<uint64_t, entry> m_map;
+    std::list<uint64_t> m_lru;
+    size_t m_bytes;
+    size_t m_max;
+
+public:
+    explicit LruCache(size_t max_bytes) : m_bytes(0), m_max(max_bytes) {}
+
+    bool lookup(uint64_t key, std::vector<uint8_t> &out) {
+        auto it = m_map.find(key);
+        if (it == m_map.end()) return false;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.pos);
+        out = it->second.response;
+        return true;
+    }
+
+    void insert(uint64_t key, const uint8_t *data, size_t len) {
+        m_lru.push_front(key);
+        entry &e = m_map[key];
+        e.response.assign(data, data + len);
+        e.pos = m_lru.begin();
+        m_bytes += len + jstd::net::RESPONSE_CACHE_ENTRY_OVERHEAD;
+        while (m_bytes > m_max && !m_lru.empty()) {
+            auto victim = m_map.find(m_lru.back());
+            m_bytes -= victim->second.response.size() + jstd::net::RESPONSE_CACHE_ENTRY_OVERHEAD;
+            m_map.erase(victim);
+            m_lru.pop_back();
+        }
+    }
+};
+
+// zipf(s) over [0, n) by inverse transform of the precomputed cdf
+class Zipf {
+    std::vector<double> m_cdf;
+
+public:
+    Zipf(unsigned n, double s) : m_cdf(n) {
+        double sum = 0;
+        for (unsigned i = 0; i < n; i++) m_cdf[i] = (sum += 1.0 / std::pow(i + 1.0, s));
+        for (auto &c : m_cdf) c /= sum;
+    }
+
+    template<typename Rng>
+    unsigned operator()(Rng &rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<unsigned>(std::lower_bound(m_cdf.begin(), m_cdf.end(), u) - m_cdf.begin());
+    }
+};
+
+static std::vector<std::string> make_trace(unsigned n, double skew, size_t len) {
+    std::mt19937_64 rng(42);
+    Zipf zipf(n, skew);
+    std::vector<std::string> trace;
+    trace.reserve(len);
+    uint64_t scan = 0;
+    char buf[40];
+    for (size_t i = 0; i < len; i++) {
+        if (i % 1000 < 100) {
+            // one-off requests that never repeat, pollution an LRU keeps and TinyLFU refuses
+            std::snprintf(buf, sizeof(buf), "GET /scan/%012llu", static_cast<unsigned long long>(scan++));
+        } else {
+            std::snprintf(buf, sizeof(buf), "GET /item/%08u", zipf(rng));
+        }
+        trace.emplace_back(buf);
+    }
+    return trace;
+}
+
+static void bench_hit_ratio(unsigned n, double skew, size_t response_size) {
+    const size_t len = 2000000;
+    std::vector<std::string> trace = make_trace(n, skew, len);
+    std::vector<uint8_t> response(response_size, 'r');
+    size_t working_set = static_cast<size_t>(n) * (response_size + jstd::net::RESPONSE_CACHE_ENTRY_OVERHEAD);
+    std::printf("%u distinct requests, zipf %.2f, 10%% one-off scans, %lu byte responses\n", n, skew,
+                static_cast<unsigned long>(response_size));
+    std::printf("budget       lru_hit%%   tinylfu_hit%%   lru_ns   tinylfu_ns   evictions  rejections\n");
+    for (double pct : {0.01, 0.05, 0.20}) {
+        size_t budget = static_cast<size_t>(working_set * pct);
+        LruCache lru(budget);
+        ResponseCache cache(budget, 0, 1);
+        std::vector<uint8_t> out;
+        uint64_t lru_hits = 0;
+        auto t0 = clock_type::now();
+        for (const auto &req : trace) {
+            uint64_t key, check;
+            ResponseCache::fingerprint(reinterpret_cast<const uint8_t*>(req.data()), req.size(), key, check);
+            if (lru.lookup(key, out)) lru_hits++;
+            else lru.insert(key, response.data(), response.size());
+        }
+        double lru_ns = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count() / len;
+        t0 = clock_type::now();
+        for (const auto &req : trace) {
+            uint64_t key, check;
+            ResponseCache::fingerprint(reinterpret_cast<const uint8_t*>(req.data()), req.size(), key, check);
+            if (!cache.lookup(key, check, out)) cache.insert(key, check, response.data(), response.size());
+        }
+        double lfu_ns = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count() / len;
+        jstd::net::CacheStats st = cache.stats();
+        std::printf("%3.0f%% %9lu %8.1f %14.1f %8.0f %12.0f %11lu %11lu\n", pct * 100, static_cast<unsigned long>(budget),
+                    100.0 * lru_hits / len, 100.0 * st.hit_ratio(), lru_ns, lfu_ns,
+                    static_cast<unsigned long>(st.evictions), static_cast<unsigned long>(st.rejections));
+    }
+}
+
+struct client_result {
+    uint64_t replies = 0;
+};
+
+static std::atomic<bool> g_running(false);
+
+static void client(uint16_t port, unsigned n, double skew, size_t response_size, unsigned seed, client_result &res) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        close(fd);
+        return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::mt19937_64 rng(seed);
+    Zipf zipf(n, skew);
+    std::vector<char> rep(response_size);
+    char req[40];
+    while (g_running) {
+        int len = std::snprintf(req, sizeof(req), "GET /item/%08u", zipf(rng));
+        if (send(fd, req, static_cast<size_t>(len), MSG_NOSIGNAL) != len) break;
+        size_t got = 0;
+        while (got < response_size) {
+            ssize_t r = recv(fd, rep.data() + got, response_size - got, 0);
+            if (r <= 0) break;
+            got += static_cast<size_t>(r);
+        }
+        if (got != response_size) break;
+        res.replies++;
+    }
+    close(fd);
+}
+
+int main(int argc, char **argv) {
+    unsigned n = 100000;
+    double skew = 0.9;
+    size_t response_size = 256;
+    unsigned work_us = 100;
+    unsigned clients = 8;
+    unsigned seconds = 2;
+    uint16_t port = 9780;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:r:w:c:t:p:")) != -1) {
+        switch (opt) {
+            case 'n': n = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 's': skew = std::strtod(optarg, nullptr); break;
+            case 'r': response_size = std::max<size_t>(2, std::strtoul(optarg, nullptr, 10)); break;
+            case 'w': work_us = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': clients = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': seconds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchResponseCache [-n requests] [-s zipf_skew] [-r response_size] [-w work_us] "
+                             "[-c clients] [-t seconds] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    bench_hit_ratio(n, skew, response_size);
+
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    size_t budget = static_cast<size_t>(n) * (response_size + jstd::net::RESPONSE_CACHE_ENTRY_OVERHEAD) / 20;
+    std::printf("\n%u clients, %uus per process_item, cache budget %lu bytes (5%% of the working set)\n", clients,
+                work_us, static_cast<unsigned long>(budget));
+    std::printf("cache     replies/s   process_item/s   hit%%\n");
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<PureServer>> servers;
+    ResponseCache cache(budget);
+    for (int i = 0; i < 2; i++) {
+        uint16_t mport = static_cast<uint16_t>(port + i);
+        servers.emplace_back(new PureServer(LOCALHOSTIP, mport));
+        PureServer &server = *servers.back();
+        server.work_us = work_us;
+        server.response_size = response_size;
+        server.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+        if (i) server.set_response_cache(&cache);
+        server.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::vector<client_result> results(clients);
+        std::vector<std::thread> threads;
+        g_running = true;
+        for (unsigned c = 0; c < clients; c++)
+            threads.emplace_back(client, mport, n, skew, response_size, c + 1, std::ref(results[c]));
+        auto start = clock_type::now();
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        g_running = false;
+        for (auto &t : threads) t.join();
+        double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        server.kill_threads();
+        uint64_t replies = 0;
+        for (auto &r : results) replies += r.replies;
+        std::printf("%-6s %12.0f %16.0f %6.1f\n", i ? "on" : "off", replies / elapsed,
+                    server.stats().msg_processed_cnt / elapsed, i ? 100.0 * cache.stats().hit_ratio() : 0.0);
+        std::fflush(stdout);
+    }
+    std::_Exit(EXIT_SUCCESS);
+}
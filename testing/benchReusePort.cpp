@@ -0,0 +1,162 @@
+#include "udp_server.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * SO_REUSEPORT receive lanes of UdpServerBase (PipelinePolicy). -c client sockets send datagrams round robin with
+ * at most -w unprocessed, for -d ms per configuration:
+ *  1 socket               the single recv thread feeding the worker
+ *  N lanes                N sockets and recv threads feeding the worker
+ *  N lanes + workers      every lane with a processing thread of its own
+ *  N lanes + steering     the same with the CBPF program pinning a client to lane (address ^ port) % N
+ * Reported: datagrams processed per second and how they spread over the lanes (lane_stats()). Afterwards every
+ * client sends alone to check that the steered server receives it on the lane steered_index() predicts.
+ * Lanes pay off with cores to run them on, on a single core the rows only show what the extra threads cost.
+ *
+ * usage: benchReusePort [-n lanes] [-c clients] [-w window] [-d duration_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+class CountingServer : public jstd::UdpServerBase<CountingServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    std::atomic<uint64_t> processed{0};
+    using jstd::UdpServerBase<CountingServer, NetItem, jstd::net::PipelinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&) {
+        processed.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+};
+
+static int client_socket() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+    return fd;
+}
+
+static uint64_t blast(CountingServer &svr, const std::vector<int> &fds, uint16_t port, unsigned window, unsigned ms) {
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &to.sin_addr);
+    uint8_t msg[64];
+    std::memset(msg, 'r', sizeof(msg));
+    uint64_t sent = 0;
+    uint64_t lost = 0;
+    size_t next = 0;
+    auto start = clock_type::now();
+    auto end = start + std::chrono::milliseconds(ms);
+    auto last_progress = start;
+    uint64_t last_seen = 0;
+    while (clock_type::now() < end) {
+        uint64_t seen = svr.processed.load(std::memory_order_acquire);
+        if (seen != last_seen) {
+            last_seen = seen;
+            last_progress = clock_type::now();
+        }
+        if (sent - lost - seen < window) {
+            sendto(fds[next], msg, sizeof(msg), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+            next = (next + 1) % fds.size();
+            sent++;
+        } else if (clock_type::now() - last_progress > std::chrono::milliseconds(20)) {
+            lost = sent - seen;
+            last_progress = clock_type::now();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return svr.processed.load();
+}
+
+int main(int argc, char **argv) {
+    unsigned lanes = 4;
+    unsigned clients = 32;
+    unsigned window = 256;
+    unsigned ms = 1000;
+    uint16_t port = 9990;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:w:d:p:")) != -1) {
+        switch (opt) {
+            case 'n': lanes = std::max(2u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'c': clients = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'w': window = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'd': ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchReusePort [-n lanes] [-c clients] [-w window] [-d duration_ms] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    std::vector<int> fds;
+    for (unsigned c = 0; c < clients; c++) fds.push_back(client_socket());
+
+    struct config {
+        const char *name;
+        unsigned sockets;
+        bool workers;
+        bool steer;
+    };
+    const config configs[] = {{"1 socket", 1, false, false}, {"lanes", lanes, false, false},
+                              {"lanes + workers", lanes, true, false}, {"lanes + steering", lanes, true, true}};
+    std::printf("%u clients, window %u, %u ms per configuration, %u cores\n", clients, window, ms,
+                std::thread::hardware_concurrency());
+    std::printf("configuration        pkts/s   per lane received\n");
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<CountingServer>> servers;
+    for (const config &cfg : configs) {
+        uint16_t sport = port++;
+        servers.emplace_back(new CountingServer(LOCALHOSTIP, sport));
+        CountingServer &svr = *servers.back();
+        svr.set_recv_timeout(50);
+        bool ok = svr.set_reuseport(cfg.sockets, cfg.workers, cfg.steer);
+        svr.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto start = clock_type::now();
+        uint64_t done = blast(svr, fds, sport, window, ms);
+        double secs = std::chrono::duration<double>(clock_type::now() - start).count();
+        std::printf("%-18s %10.0f  ", cfg.name, static_cast<double>(done) / secs);
+        std::vector<jstd::net::ServerStats> per_lane = svr.lane_stats();
+        if (per_lane.empty()) per_lane.push_back(svr.stats());
+        for (const auto &st : per_lane) std::printf(" %llu", static_cast<unsigned long long>(st.msg_recvd_cnt));
+        std::printf("%s\n", ok ? "" : "  (not fully applied)");
+
+        if (cfg.steer) {
+            // one client at a time, the lane whose counter moves is the one it was steered to
+            sockaddr_in to{};
+            to.sin_family = AF_INET;
+            to.sin_port = htons(sport);
+            inet_aton(LOCALHOSTIP, &to.sin_addr);
+            unsigned matched = 0;
+            for (int fd : fds) {
+                std::vector<jstd::net::ServerStats> before = svr.lane_stats();
+                uint64_t want = svr.processed.load() + 1;
+                sendto(fd, "s", 1, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+                for (int i = 0; i < 200 && svr.processed.load() < want; i++)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                std::vector<jstd::net::ServerStats> after = svr.lane_stats();
+                sockaddr_in from{};
+                socklen_t len = sizeof(from);
+                getsockname(fd, reinterpret_cast<sockaddr*>(&from), &len);
+                unsigned expect = jstd::net::reuseport::steered_index(from, cfg.sockets);
+                if (after[expect].msg_recvd_cnt == before[expect].msg_recvd_cnt + 1) matched++;
+            }
+            std::printf("steering: %u/%u clients received on the predicted lane\n", matched, clients);
+        }
+        svr.kill_threads();
+    }
+    for (int fd : fds) close(fd);
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,172 @@
+#include "msg_router.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Cost of getting a framed message to the handler of its type.
+ * -n frames of -t types (uniformly mixed, -u percent of them of a type nobody handles) are dispatched -r times by
+ *  - switch      hand written switch on the type, the floor
+ *  - router      MsgRouter with null_mutex stats (InlinePolicy server), with std::mutex stats (threaded) and
+ *                timing every message instead of a sample
+ *  - map         unordered_map of type to std::function, what handlers registered at runtime usually get
+ *  - virtual     unordered_map of type to a handler object called through a virtual method
+ * Every handler sums a payload byte so the calls are not optimized away, ns per message is reported.
+ *
+ * usage: benchRouter [-n frames] [-t types] [-u unknown_pct] [-r rounds]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::MsgRoute;
+using jstd::net::MsgFallback;
+using jstd::net::MsgRouter;
+typedef std::chrono::steady_clock clock_type;
+
+class App {
+public:
+    uint64_t sum = 0;
+    uint64_t unknown = 0;
+
+    template<unsigned N>
+    bool on_msg(NetItem &&item) {
+        sum += item.buff[jstd::net::MSG_HEADER_LEN] * N;
+        return true;
+    }
+
+    bool on_unknown(NetItem &&, uint16_t) {
+        unknown++;
+        return false;
+    }
+};
+
+template<typename Mutex>
+using AppRouter = MsgRouter<Mutex, MsgFallback<App, NetItem, &App::on_unknown>,
+    MsgRoute<1, App, NetItem, &App::on_msg<1>>, MsgRoute<2, App, NetItem, &App::on_msg<2>>,
+    MsgRoute<3, App, NetItem, &App::on_msg<3>>, MsgRoute<4, App, NetItem, &App::on_msg<4>>,
+    MsgRoute<5, App, NetItem, &App::on_msg<5>>, MsgRoute<6, App, NetItem, &App::on_msg<6>>,
+    MsgRoute<7, App, NetItem, &App::on_msg<7>>, MsgRoute<8, App, NetItem, &App::on_msg<8>>,
+    MsgRoute<9, App, NetItem, &App::on_msg<9>>, MsgRoute<10, App, NetItem, &App::on_msg<10>>,
+    MsgRoute<11, App, NetItem, &App::on_msg<11>>, MsgRoute<12, App, NetItem, &App::on_msg<12>>,
+    MsgRoute<13, App, NetItem, &App::on_msg<13>>, MsgRoute<14, App, NetItem, &App::on_msg<14>>,
+    MsgRoute<15, App, NetItem, &App::on_msg<15>>, MsgRoute<16, App, NetItem, &App::on_msg<16>>>;
+
+static bool switch_dispatch(App &app, NetItem &&item) {
+    switch (jstd::net::msg_type(item.buff.data(), item.buff.size())) {
+        case 1: return app.on_msg<1>(std::move(item));
+        case 2: return app.on_msg<2>(std::move(item));
+        case 3: return app.on_msg<3>(std::move(item));
+        case 4: return app.on_msg<4>(std::move(item));
+        case 5: return app.on_msg<5>(std::move(item));
+        case 6: return app.on_msg<6>(std::move(item));
+        case 7: return app.on_msg<7>(std::move(item));
+        case 8: return app.on_msg<8>(std::move(item));
+        case 9: return app.on_msg<9>(std::move(item));
+        case 10: return app.on_msg<10>(std::move(item));
+        case 11: return app.on_msg<11>(std::move(item));
+        case 12: return app.on_msg<12>(std::move(item));
+        case 13: return app.on_msg<13>(std::move(item));
+        case 14: return app.on_msg<14>(std::move(item));
+        case 15: return app.on_msg<15>(std::move(item));
+        case 16: return app.on_msg<16>(std::move(item));
+        default: return app.on_unknown(std::move(item), 0);
+    }
+}
+
+struct Handler {
+    virtual ~Handler() = default;
+    virtual bool handle(App &app, NetItem &&item) = 0;
+};
+
+template<unsigned N>
+struct TypeHandler : Handler {
+    bool handle(App &app, NetItem &&item) override { return app.on_msg<N>(std::move(item)); }
+};
+
+template<unsigned... N>
+static void register_all(std::unordered_map<uint16_t, std::function<bool(App&, NetItem&&)>> &fns,
+                         std::unordered_map<uint16_t, std::unique_ptr<Handler>> &objs,
+                         std::integer_sequence<unsigned, N...>) {
+    int unused[] = {(fns[N + 1] = [](App &app, NetItem &&item) { return app.on_msg<N + 1>(std::move(item)); },
+                     objs[N + 1].reset(new TypeHandler<N + 1>()), 0)...};
+    (void)unused;
+}
+
+template<typename F>
+static double run(const char *name, std::vector<NetItem> &frames, unsigned rounds, App &app, F dispatch) {
+    app.sum = app.unknown = 0;
+    auto t0 = clock_type::now();
+    for (unsigned r = 0; r < rounds; r++)
+        for (auto &f : frames) dispatch(std::move(f));
+    double ns = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count() /
+                static_cast<double>(frames.size() * rounds);
+    std::printf("%-22s %8.2f ns/msg   (checksum %llu, unknown %llu)\n", name, ns,
+                static_cast<unsigned long long>(app.sum), static_cast<unsigned long long>(app.unknown));
+    return ns;
+}
+
+int main(int argc, char **argv) {
+    size_t n = 1 << 16;
+    unsigned types = 16;
+    unsigned unknown_pct = 1;
+    unsigned rounds = 100;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:u:r:")) != -1) {
+        switch (opt) {
+            case 'n': n = std::strtoul(optarg, nullptr, 10); break;
+            case 't': types = std::max(1u, std::min(16u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)))); break;
+            case 'u': unknown_pct = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'r': rounds = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchRouter [-n frames] [-t types] [-u unknown_pct] [-r rounds]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<unsigned> pick(1, types);
+    std::uniform_int_distribution<unsigned> pct(0, 99);
+    std::vector<NetItem> frames(n);
+    for (auto &f : frames) {
+        uint16_t type = pct(rng) < unknown_pct ? 500 : static_cast<uint16_t>(pick(rng));
+        uint8_t payload[32];
+        for (auto &b : payload) b = static_cast<uint8_t>(rng());
+        jstd::net::msg_frame(f.buff, type, payload, sizeof(payload));
+    }
+    std::printf("%zu frames of %u types, %u%% unknown, %u rounds\n", n, types, unknown_pct, rounds);
+
+    App app;
+    std::unique_ptr<AppRouter<jstd::net::null_mutex>> router(new AppRouter<jstd::net::null_mutex>());
+    std::unique_ptr<AppRouter<std::mutex>> locked(new AppRouter<std::mutex>());
+    std::unique_ptr<AppRouter<jstd::net::null_mutex>> timed(new AppRouter<jstd::net::null_mutex>());
+    timed->set_latency_sampling(1);
+    std::unordered_map<uint16_t, std::function<bool(App&, NetItem&&)>> fns;
+    std::unordered_map<uint16_t, std::unique_ptr<Handler>> objs;
+    register_all(fns, objs, std::make_integer_sequence<unsigned, 16>());
+
+    run("switch", frames, rounds, app, [&](NetItem &&item) { return switch_dispatch(app, std::move(item)); });
+    run("router", frames, rounds, app, [&](NetItem &&item) { return router->dispatch(app, std::move(item)); });
+    run("router (std::mutex)", frames, rounds, app, [&](NetItem &&item) { return locked->dispatch(app, std::move(item)); });
+    run("router (time all)", frames, rounds, app, [&](NetItem &&item) { return timed->dispatch(app, std::move(item)); });
+    run("map std::function", frames, rounds, app, [&](NetItem &&item) {
+        auto it = fns.find(jstd::net::msg_type(item.buff.data(), item.buff.size()));
+        return it == fns.end() ? app.on_unknown(std::move(item), 0) : it->second(app, std::move(item));
+    });
+    run("map virtual", frames, rounds, app, [&](NetItem &&item) {
+        auto it = objs.find(jstd::net::msg_type(item.buff.data(), item.buff.size()));
+        return it == objs.end() ? app.on_unknown(std::move(item), 0) : it->second->handle(app, std::move(item));
+    });
+
+    std::printf("router stats   type      count   failed   p50_us   p99_us\n");
+    for (const auto &s : router->stats())
+        std::printf("            %6u %10llu %8llu %8llu %8llu\n", s.type, static_cast<unsigned long long>(s.count),
+                    static_cast<unsigned long long>(s.failed),
+                    static_cast<unsigned long long>(s.latency_us.percentile(0.5)),
+                    static_cast<unsigned long long>(s.latency_us.percentile(0.99)));
+    return EXIT_SUCCESS;
+}
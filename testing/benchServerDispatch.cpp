@@ -0,0 +1,141 @@
+#include "tcp_server.h"
+#include "udp_server.h"
+#include <iostream>
+#include <chrono>
+
+/*
+ * Per message hook dispatch cost, virtual TcpServer/UdpServer subclasses vs the CRTP bases.
+ * Each iteration runs the hooks the recv and processing threads call per message:
+ * hash_conn -> build_qitem -> process_item. The drivers are noinline so the compiler cannot see
+ * the dynamic type of the virtual servers and devirtualize the calls.
+ *
+ * usage: benchServerDispatch [iterations]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::NetConnection;
+using jstd::net::ConnHandle;
+
+static const size_t MSG_SIZE = 64;
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= virtual hooks =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+class VirtualTcp : public jstd::net::TcpServer<NetItem> {
+public:
+    uint64_t bytes = 0;
+    using jstd::net::TcpServer<NetItem>::TcpServer;
+    bool process_item(NetItem &&item) override { bytes += item.buff.size(); return true; }
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const override {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+    uint64_t hash_conn(const NetConnection &conn) const override { return conn.sa.sin_port; }
+};
+
+class VirtualUdp : public jstd::UdpServer<NetItem> {
+public:
+    uint64_t bytes = 0;
+    using jstd::UdpServer<NetItem>::UdpServer;
+    bool process_item(NetItem &&item) override { bytes += item.buff.size(); return true; }
+    void _build_qitem(NetItem &item, const uint8_t *buff, const ssize_t &len, ConnHandle conn) const override {
+        item.conn = conn;
+        item.buff.assign(buff, buff + len);
+    }
+    uint64_t hash_conn(const NetConnection &conn) const override { return conn.sa.sin_port; }
+};
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= static hooks =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+class StaticTcp : public jstd::net::TcpServerBase<StaticTcp, NetItem> {
+public:
+    uint64_t bytes = 0;
+    using jstd::net::TcpServerBase<StaticTcp, NetItem>::TcpServerBase;
+    bool process_item(NetItem &&item) { bytes += item.buff.size(); return true; }
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+    uint64_t hash_conn(const NetConnection &conn) const { return conn.sa.sin_port; }
+};
+
+class StaticUdp : public jstd::UdpServerBase<StaticUdp, NetItem> {
+public:
+    uint64_t bytes = 0;
+    using jstd::UdpServerBase<StaticUdp, NetItem>::UdpServerBase;
+    bool process_item(NetItem &&item) { bytes += item.buff.size(); return true; }
+    void _build_qitem(NetItem &item, const uint8_t *buff, const ssize_t &len, ConnHandle conn) const {
+        item.conn = conn;
+        item.buff.assign(buff, buff + len);
+    }
+    uint64_t hash_conn(const NetConnection &conn) const { return conn.sa.sin_port; }
+};
+
+// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= drivers =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+template<typename Server>
+__attribute__((noinline)) uint64_t drive_tcp(Server &srvr, size_t iterations) {
+    NetConnection conn;
+    uint64_t hsum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        conn.sa.sin_port = static_cast<in_port_t>(i);
+        hsum += srvr.hash_conn(conn);
+        srvr.process_item(srvr.build_qitem(std::vector<uint8_t>(MSG_SIZE), ConnHandle(i & 0xff, 0)));
+    }
+    return hsum;
+}
+
+template<typename Server>
+__attribute__((noinline)) uint64_t drive_udp(Server &srvr, size_t iterations) {
+    NetConnection conn;
+    uint8_t buff[MSG_SIZE] = {};
+    ssize_t len = MSG_SIZE;
+    uint64_t hsum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        conn.sa.sin_port = static_cast<in_port_t>(i);
+        hsum += srvr.hash_conn(conn);
+        NetItem item;
+        srvr._build_qitem(item, buff, len, ConnHandle(i & 0xff, 0));
+        srvr.process_item(std::move(item));
+    }
+    return hsum;
+}
+
+// best of ROUNDS runs, the logging thread and the idle server sockets add noise
+static const int ROUNDS = 5;
+
+template<typename Fn>
+double ns_per_msg(Fn &&fn, size_t iterations) {
+    double best = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    size_t iterations = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    // port 0, the listening sockets are only needed to construct the servers
+    VirtualTcp vtcp(LOCALHOSTIP, 0);
+    StaticTcp stcp(LOCALHOSTIP, 0);
+    VirtualUdp vudp(LOCALHOSTIP, 0);
+    StaticUdp sudp(LOCALHOSTIP, 0);
+
+    uint64_t sink = 0;
+    double vt = ns_per_msg([&] { sink += drive_tcp(vtcp, iterations); }, iterations);
+    double st = ns_per_msg([&] { sink += drive_tcp(stcp, iterations); }, iterations);
+    double vu = ns_per_msg([&] { sink += drive_udp(vudp, iterations); }, iterations);
+    double su = ns_per_msg([&] { sink += drive_udp(sudp, iterations); }, iterations);
+
+    std::cout << "iterations: " << iterations << " msg size: " << MSG_SIZE << " (checksum " << sink << ")\n"
+              << "tcp virtual hooks: " << vt << " ns/msg\n"
+              << "tcp static hooks:  " << st << " ns/msg\n"
+              << "udp virtual hooks: " << vu << " ns/msg\n"
+              << "udp static hooks:  " << su << " ns/msg\n"
+              << "bytes processed: " << vtcp.bytes + stcp.bytes + vudp.bytes + sudp.bytes << std::endl;
+    return 0;
+}
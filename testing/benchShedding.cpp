@@ -0,0 +1,155 @@
+#include "udp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+/*
+ * Goodput of a UdpServer under overload with and without load shedding.
+ * Every request costs the worker work_us of cpu, the client sends at a fixed rate (default twice what the
+ * worker can serve) and counts replies that come back within the latency objective. Without shedding the
+ * queue grows without bound and soon every reply is late, with CoDel or deadlines stale requests are dropped
+ * before they cost work and the worker keeps answering fresh ones in time.
+ *
+ * usage: benchShedding [-w work_us] [-r req_per_sec] [-l slo_ms] [-t seconds] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+using jstd::net::ShedConfig;
+typedef std::chrono::steady_clock clock_type;
+
+class SlowServer : public jstd::UdpServerBase<SlowServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    unsigned work_us = 100;
+    using jstd::UdpServerBase<SlowServer, NetItem, jstd::net::PipelinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        auto until = clock_type::now() + std::chrono::microseconds(work_us);
+        while (clock_type::now() < until) { }
+        return send_item(item);
+    }
+};
+
+struct request {
+    uint64_t sent_ns;
+    uint64_t seq;
+};
+
+static uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::now().time_since_epoch()).count());
+}
+
+struct run_result {
+    uint64_t sent = 0;
+    uint64_t replies = 0;
+    uint64_t good = 0;
+};
+
+static run_result drive(uint16_t port, unsigned rate, unsigned seconds, unsigned slo_ms) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+    int rcvbuf = 8 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    run_result res;
+    std::atomic<bool> sending(true);
+    uint64_t slo_ns = static_cast<uint64_t>(slo_ms) * 1000000ULL;
+    std::thread receiver([&]() {
+        request rep{};
+        auto drain_until = clock_type::time_point::max();
+        while (clock_type::now() < drain_until) {
+            if (!sending && drain_until == clock_type::time_point::max())
+                drain_until = clock_type::now() + std::chrono::milliseconds(slo_ms);
+            if (recv(fd, &rep, sizeof(rep), 0) != static_cast<ssize_t>(sizeof(rep))) continue;
+            res.replies++;
+            if (now_ns() - rep.sent_ns <= slo_ns) res.good++;
+        }
+    });
+    auto start = clock_type::now();
+    auto end = start + std::chrono::seconds(seconds);
+    std::chrono::nanoseconds gap(1000000000ULL / rate);
+    auto next = start;
+    while (next < end) {
+        while (clock_type::now() < next) std::this_thread::yield();
+        request req{now_ns(), res.sent};
+        if (send(fd, &req, sizeof(req), 0) == static_cast<ssize_t>(sizeof(req))) res.sent++;
+        next += gap;
+    }
+    sending = false;
+    receiver.join();
+    close(fd);
+    return res;
+}
+
+int main(int argc, char **argv) {
+    unsigned work_us = 100;
+    unsigned rate = 0;
+    unsigned slo_ms = 50;
+    unsigned seconds = 3;
+    uint16_t port = 9700;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:r:l:t:p:")) != -1) {
+        switch (opt) {
+            case 'w': work_us = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': rate = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'l': slo_ms = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': seconds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchShedding [-w work_us] [-r req_per_sec] [-l slo_ms] [-t seconds] [-p port]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (!rate) rate = 2 * 1000000 / work_us;
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+
+    struct mode {
+        const char *name;
+        ShedConfig cfg;
+    };
+    std::vector<mode> modes(3);
+    modes[0].name = "none";
+    modes[1].name = "codel";
+    modes[1].cfg.codel = true;
+    modes[2].name = "deadline";
+    modes[2].cfg.deadline_ms = slo_ms / 2;     // leave the other half for the reply to travel back
+
+    std::cout << "work " << work_us << "us per request (" << 1000000 / work_us << " req/s at most), sending "
+              << rate << " req/s for " << seconds << "s, latency objective " << slo_ms << "ms\n"
+              << "shedding      sent   replies   in time   goodput/s   shed_delay  shed_deadline   sojourn_p50  p99 us\n";
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<SlowServer>> servers;
+    for (size_t i = 0; i < modes.size(); i++) {
+        uint16_t mport = static_cast<uint16_t>(port + i);
+        servers.emplace_back(new SlowServer(LOCALHOSTIP, mport));
+        SlowServer &server = *servers.back();
+        server.work_us = work_us;
+        server.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+        server.set_load_shedding(modes[i].cfg);
+        server.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        run_result res = drive(mport, rate, seconds, slo_ms);
+        server.kill_threads();
+        jstd::net::ServerStats st = server.stats();
+        std::printf("%-9s %8lu %9lu %9lu %11.0f %12lu %14lu %13lu %6lu\n", modes[i].name,
+                    static_cast<unsigned long>(res.sent), static_cast<unsigned long>(res.replies),
+                    static_cast<unsigned long>(res.good), static_cast<double>(res.good) / seconds,
+                    static_cast<unsigned long>(st.shed_delay_cnt), static_cast<unsigned long>(st.shed_deadline_cnt),
+                    static_cast<unsigned long>(st.sojourn_us.percentile(0.5)),
+                    static_cast<unsigned long>(st.sojourn_us.percentile(0.99)));
+        std::fflush(stdout);
+    }
+    std::_Exit(EXIT_SUCCESS);
+}
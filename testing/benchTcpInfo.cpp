@@ -0,0 +1,205 @@
+#include "tcp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <netinet/tcp.h>
+#include <thread>
+#include <vector>
+
+/*
+ * TCP_INFO telemetry of TcpServerBase.
+ *  1. cost: -n idle connections, sample_tcp_info() rounds timed directly, us per round and ns per connection
+ *  2. flagging: -c clients doing small echo round trips next to one client that requests large replies and
+ *     never reads them, sampled every -i ms with a 64KB send queue limit. The stalled client's send queue
+ *     grows and on_tcp_flagged reports it, the others stay below the limit
+ *
+ * usage: benchTcpInfo [-n idle_connections] [-c clients] [-i interval_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+using jstd::net::TcpInfoSample;
+typedef std::chrono::steady_clock clock_type;
+
+constexpr size_t BIG_REPLY = 16 << 10;
+
+class TelemetryServer : public jstd::net::TcpServerBase<TelemetryServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    std::atomic<unsigned> flagged_calls{0};
+    std::atomic<uint64_t> last_flagged{0};
+    using jstd::net::TcpServerBase<TelemetryServer, NetItem, jstd::net::PipelinePolicy>::TcpServerBase;
+
+    // large replies to a client that does not read must fit the send buffer, a blocking send would stall
+    // the processing thread for every client
+    void on_accept(ConnHandle conn) {
+        jstd::net::NetConnection rec;
+        if (!get_connection(conn, rec)) return;
+        int sndbuf = 4 << 20;
+        setsockopt(rec.sockfd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        int one = 1;
+        setsockopt(rec.sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    // 'B' asks for BIG_REPLY bytes per request byte, anything else is echoed
+    bool process_item(NetItem &&item) {
+        if (!item.buff.empty() && item.buff[0] == 'B') {
+            std::vector<uint8_t> reply(BIG_REPLY, 'b');
+            bool ok = true;
+            for (size_t i = 0; i < item.buff.size(); i++) ok = send_to(item.conn, reply.data(), reply.size()) && ok;
+            return ok;
+        }
+        return send_to(item.conn, item.buff.data(), item.buff.size());
+    }
+
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+
+    void on_tcp_flagged(ConnHandle conn, const TcpInfoSample &) {
+        flagged_calls++;
+        last_flagged = conn.value;
+    }
+};
+
+static int connect_to(uint16_t port, int rcvbuf = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (rcvbuf) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static std::atomic<bool> g_running(false);
+
+static void echo_client(uint16_t port, std::atomic<uint64_t> &replies) {
+    int fd = connect_to(port);
+    char buff[32];
+    while (fd >= 0 && g_running) {
+        if (send(fd, "ping", 4, MSG_NOSIGNAL) != 4) break;
+        size_t got = 0;
+        while (got < 4) {
+            ssize_t n = recv(fd, buff + got, sizeof(buff) - got, 0);
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        if (got < 4) break;
+        replies++;
+    }
+    if (fd >= 0) close(fd);
+}
+
+static void wait_clients(TelemetryServer &svr, size_t want) {
+    for (int i = 0; i < 200 && svr.stats().clients_added_cnt - svr.stats().clients_removed_cnt < want; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+int main(int argc, char **argv) {
+    unsigned idle = 1000;
+    unsigned clients = 8;
+    unsigned interval_ms = 100;
+    uint16_t port = 9900;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:i:p:")) != -1) {
+        switch (opt) {
+            case 'n': idle = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': clients = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'i': interval_ms = std::max(10u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchTcpInfo [-n idle_connections] [-c clients] [-i interval_ms] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<TelemetryServer>> servers;
+
+    // 1. cost of a sampling round
+    servers.emplace_back(new TelemetryServer(LOCALHOSTIP, port));
+    TelemetryServer &cost = *servers.back();
+    cost.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+    cost.run();
+    std::vector<int> fds;
+    for (unsigned i = 0; i < idle; i++) {
+        int fd = connect_to(port);
+        if (fd >= 0) fds.push_back(fd);
+    }
+    wait_clients(cost, fds.size());
+    const unsigned rounds = 100;
+    size_t sampled = 0;
+    auto t0 = clock_type::now();
+    for (unsigned r = 0; r < rounds; r++) sampled += cost.sample_tcp_info();
+    double round_us = std::chrono::duration<double, std::micro>(clock_type::now() - t0).count() / rounds;
+    std::printf("sampling round over %zu connections: %.1f us, %.0f ns per connection\n", sampled / rounds, round_us,
+                sampled ? round_us * 1e3 * rounds / static_cast<double>(sampled) : 0.0);
+    for (int fd : fds) close(fd);
+    cost.kill_threads();
+
+    // 2. a stalled reader gets flagged
+    servers.emplace_back(new TelemetryServer(LOCALHOSTIP, port + 1));
+    TelemetryServer &svr = *servers.back();
+    svr.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+    jstd::net::TcpInfoConfig cfg;
+    cfg.interval_ms = interval_ms;
+    cfg.send_queue_limit = 64 << 10;
+    svr.set_tcp_info_sampling(cfg);
+    svr.run();
+    g_running = true;
+    std::atomic<uint64_t> replies(0);
+    std::vector<std::thread> threads;
+    for (unsigned c = 0; c < clients; c++) threads.emplace_back(echo_client, port + 1, std::ref(replies));
+    int stalled = connect_to(port + 1, 4096);
+    wait_clients(svr, clients + 1);
+    ConnHandle stalled_handle;
+    {
+        sockaddr_in sa{};
+        socklen_t len = sizeof(sa);
+        getsockname(stalled, reinterpret_cast<sockaddr*>(&sa), &len);
+        stalled_handle = svr.lookup_client(LOCALHOSTIP, ntohs(sa.sin_port));
+    }
+    std::string big(16, 'B');      // 16 * BIG_REPLY = 256KB the client never reads
+    send(stalled, big.data(), big.size(), MSG_NOSIGNAL);
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms * 5));
+    g_running = false;
+    for (auto &t : threads) t.join();
+
+    jstd::net::ServerStats stats = svr.stats();
+    std::vector<ConnHandle> flagged = svr.flagged_connections();
+    std::printf("echo replies %llu, sampled %llu, flagged %llu, on_tcp_flagged calls %u\n",
+                static_cast<unsigned long long>(replies.load()), static_cast<unsigned long long>(stats.tcp_sampled_cnt),
+                static_cast<unsigned long long>(stats.tcp_flagged_cnt), svr.flagged_calls.load());
+    std::printf("rtt us p50 %llu p99 %llu, send queue max %llu bytes, retransmits %llu\n",
+                static_cast<unsigned long long>(stats.tcp_rtt_us.percentile(0.5)),
+                static_cast<unsigned long long>(stats.tcp_rtt_us.percentile(0.99)),
+                static_cast<unsigned long long>(stats.tcp_send_queue_max),
+                static_cast<unsigned long long>(stats.tcp_retrans_cnt));
+    TcpInfoSample s;
+    if (svr.get_tcp_info(stalled_handle, s))
+        std::printf("stalled client %s: rtt %uus rttvar %uus cwnd %u unacked %u notsent %u delivery %llu B/s\n",
+                    stalled_handle.value == svr.last_flagged ? "flagged" : "NOT flagged", s.rtt_us,
+                    s.rttvar_us, s.snd_cwnd, s.unacked, s.notsent_bytes,
+                    static_cast<unsigned long long>(s.delivery_rate));
+    bool ok = flagged.size() == 1 && flagged[0] == stalled_handle;
+    std::printf("flagged_connections(): %zu, %s\n", flagged.size(), ok ? "only the stalled client" : "unexpected");
+    close(stalled);
+    svr.kill_threads();
+    std::fflush(stdout);
+    std::_Exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,180 @@
+#include "udp_server.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * Datagrams per second of UdpServerBase at recvmmsg / sendmmsg batch sizes 1 (a syscall per datagram), 8, 32 and 64.
+ *  1. echo, InlinePolicy: one client keeps -w datagrams in flight and sends another for every reply, for -d ms.
+ *     The server reads a batch, echoes each datagram and sends the replies of the batch in one sendmmsg
+ *  2. echo, PipelinePolicy: the same through the processing queue, the worker batches the replies of back to back
+ *     items
+ *  3. broadcast: broadcast_data() to -c clients for -d ms, the fan-out goes out a batch per sendmmsg
+ * The client always uses batches of 64 so its cost is the same in every row.
+ *
+ * usage: benchUdpBatch [-w window] [-c broadcast_clients] [-d duration_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+constexpr size_t MSG_SIZE = 64;
+constexpr unsigned CLIENT_BATCH = 64;
+static const unsigned BATCHES[] = {1, 8, 32, 64};
+
+template<typename Policy>
+class EchoServer : public jstd::UdpServerBase<EchoServer<Policy>, NetItem, Policy> {
+public:
+    using jstd::UdpServerBase<EchoServer<Policy>, NetItem, Policy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) { return this->send_item(item); }
+};
+
+struct echo_result {
+    uint64_t replies;
+    uint64_t stalls;        // the window was lost to drops and refilled
+    double secs;
+};
+
+static int udp_socket(int rcvbuf) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+    return fd;
+}
+
+static echo_result drive(uint16_t port, unsigned window, unsigned ms) {
+    int fd = udp_socket(4 << 20);
+    timeval tv{0, 20000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in svr{};
+    svr.sin_family = AF_INET;
+    svr.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &svr.sin_addr);
+    uint8_t msg[MSG_SIZE];
+    std::memset(msg, 'u', sizeof(msg));
+    jstd::net::RecvBatch rb(CLIENT_BATCH, MAX_BUFF_SIZE);
+    jstd::net::SendBatch sb(CLIENT_BATCH);
+    auto send_n = [&](unsigned n) {
+        while (n) {
+            while (n && sb.add(svr, msg, sizeof(msg))) n--;
+            sb.flush(fd);
+        }
+    };
+    echo_result res{0, 0, 0};
+    send_n(window);
+    auto start = clock_type::now();
+    auto end = start + std::chrono::milliseconds(ms);
+    while (clock_type::now() < end) {
+        int n = rb.recv(fd, MSG_WAITFORONE);
+        if (n > 0) {
+            res.replies += static_cast<unsigned>(n);
+            send_n(static_cast<unsigned>(n));
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // nothing came back for the whole timeout, whatever was in flight was dropped
+            res.stalls++;
+            send_n(window);
+        }
+    }
+    res.secs = std::chrono::duration<double>(clock_type::now() - start).count();
+    close(fd);
+    return res;
+}
+
+static void report(const char *mode, unsigned batch, const echo_result &res, const jstd::net::ServerStats &st) {
+    std::printf("%-10s %6u %12.0f %10llu %10llu %8llu\n", mode, batch, static_cast<double>(res.replies) / res.secs,
+                static_cast<unsigned long long>(res.replies), static_cast<unsigned long long>(st.msg_recvd_cnt),
+                static_cast<unsigned long long>(res.stalls));
+}
+
+int main(int argc, char **argv) {
+    unsigned window = 256;
+    unsigned clients = 256;
+    unsigned ms = 1000;
+    uint16_t port = 9950;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:c:d:p:")) != -1) {
+        switch (opt) {
+            case 'w': window = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'c': clients = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'd': ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchUdpBatch [-w window] [-c broadcast_clients] [-d duration_ms] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+
+    std::printf("%zu byte datagrams, echo window %u, %u ms per run\n", MSG_SIZE, window, ms);
+    std::printf("mode        batch     pkts/s     replies   srv_recvd   stalls\n");
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<EchoServer<jstd::net::InlinePolicy>>> inline_servers;
+    std::vector<std::unique_ptr<EchoServer<jstd::net::PipelinePolicy>>> pipeline_servers;
+
+    // 1. inline echo
+    for (unsigned batch : BATCHES) {
+        inline_servers.emplace_back(new EchoServer<jstd::net::InlinePolicy>(LOCALHOSTIP, port));
+        auto &svr = *inline_servers.back();
+        svr.set_recv_timeout(50);
+        svr.set_batching(batch, batch);
+        std::thread runner([&svr] { svr.run(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        echo_result res = drive(port++, window, ms);
+        svr.kill_threads();
+        runner.join();
+        report("inline", batch, res, svr.stats());
+    }
+
+    // 2. queued echo
+    for (unsigned batch : BATCHES) {
+        pipeline_servers.emplace_back(new EchoServer<jstd::net::PipelinePolicy>(LOCALHOSTIP, port));
+        auto &svr = *pipeline_servers.back();
+        svr.set_recv_timeout(50);
+        svr.set_batching(batch, batch);
+        svr.run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        echo_result res = drive(port++, window, ms);
+        svr.kill_threads();
+        report("pipeline", batch, res, svr.stats());
+    }
+
+    // 3. broadcast fan-out, nobody reads the client sockets, datagrams past their buffers are dropped by the kernel
+    std::vector<int> fds;
+    for (unsigned c = 0; c < clients; c++) fds.push_back(udp_socket(0));
+    std::vector<uint8_t> data(MSG_SIZE, 'b');
+    std::printf("broadcast to %u clients\nbatch     pkts/s   broadcasts   reached\n", clients);
+    for (unsigned batch : BATCHES) {
+        inline_servers.emplace_back(new EchoServer<jstd::net::InlinePolicy>(LOCALHOSTIP, port++));
+        auto &svr = *inline_servers.back();
+        for (int fd : fds) {
+            sockaddr_in sa{};
+            socklen_t len = sizeof(sa);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&sa), &len);
+            svr.add_client(LOCALHOSTIP, sa.sin_port);      // add_client takes the port in network order
+        }
+        svr.set_batching(1, batch);
+        uint64_t casts = 0;
+        uint64_t reached = 0;
+        auto start = clock_type::now();
+        auto end = start + std::chrono::milliseconds(ms);
+        while (clock_type::now() < end) {
+            reached += static_cast<uint64_t>(svr.broadcast_data(data));
+            casts++;
+        }
+        double secs = std::chrono::duration<double>(clock_type::now() - start).count();
+        std::printf("%5u %10.0f %12llu %9llu\n", batch, static_cast<double>(reached) / secs,
+                    static_cast<unsigned long long>(casts), static_cast<unsigned long long>(reached));
+    }
+    for (int fd : fds) close(fd);
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
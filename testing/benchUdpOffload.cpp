@@ -0,0 +1,134 @@
+#include "udp_server.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+/*
+ * UDP segmentation offload on loopback. A sender server sends -b byte buffers with send_segments() as datagrams
+ * of -s bytes, to a receiver server (InlinePolicy, recv batch of 8) that counts them. At most -w datagrams are
+ * outstanding, when nothing arrives for 20ms the rest counts as lost and the window is refilled.
+ *  none      a sendto per datagram, every datagram received on its own
+ *  gso       one sendmsg per buffer, the kernel splits it before delivery
+ *  gso+gro   one sendmsg per buffer and the receiver gets it coalesced, split into views in place
+ * Reported per mode: datagrams delivered per second and process CPU (user + system) per delivered datagram.
+ *
+ * usage: benchUdpOffload [-s segment] [-b buffer_bytes] [-w window] [-d duration_ms] [-p port]
+ */
+
+using jstd::net::NetItem;
+typedef std::chrono::steady_clock clock_type;
+
+class CountingServer : public jstd::UdpServerBase<CountingServer, NetItem, jstd::net::InlinePolicy> {
+public:
+    std::atomic<uint64_t> datagrams{0};
+    std::atomic<uint64_t> bytes{0};
+    using jstd::UdpServerBase<CountingServer, NetItem, jstd::net::InlinePolicy>::UdpServerBase;
+
+    bool process_item(NetItem &&item) {
+        bytes.fetch_add(item.buff.size(), std::memory_order_relaxed);
+        datagrams.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+};
+
+static double cpu_secs() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+int main(int argc, char **argv) {
+    unsigned seg = 1400;
+    unsigned buff_sz = 64 * 1024;
+    unsigned window = 128;      // stays below the default socket receive buffer
+    unsigned ms = 1000;
+    uint16_t port = 9970;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:b:w:d:p:")) != -1) {
+        switch (opt) {
+            case 's': seg = std::max(1u, std::min(1472u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)))); break;
+            case 'b': buff_sz = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'w': window = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'd': ms = std::max(100u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'p': port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: benchUdpOffload [-s segment] [-b buffer_bytes] [-w window] [-d duration_ms] [-p port]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+    std::vector<uint8_t> buff(buff_sz, 'g');
+    uint64_t per_buff = (buff_sz + seg - 1) / seg;
+
+    struct mode {
+        const char *name;
+        bool gso;
+        bool gro;
+    };
+    const mode modes[] = {{"none", false, false}, {"gso", true, false}, {"gso+gro", true, true}};
+    std::printf("%u byte buffers as %u byte datagrams, window %u, %u ms per mode\n", buff_sz, seg, window, ms);
+    std::printf("mode        datagrams/s      MB/s   cpu ns/dgram   lost   offload\n");
+    // servers are only stopped, see benchWal for why they are not destroyed
+    std::vector<std::unique_ptr<CountingServer>> servers;
+    for (const mode &m : modes) {
+        uint16_t rport = port++;
+        servers.emplace_back(new CountingServer(LOCALHOSTIP, rport));
+        CountingServer &rcvr = *servers.back();
+        servers.emplace_back(new CountingServer(LOCALHOSTIP, port++));
+        CountingServer &sndr = *servers.back();
+        rcvr.set_recv_timeout(50);
+        rcvr.set_batching(8, 1);
+        bool rcvr_ok = rcvr.set_udp_offload(false, m.gro);
+        bool sndr_ok = sndr.set_udp_offload(m.gso, false);
+        std::thread runner([&rcvr] { rcvr.run(); });
+        jstd::net::NetConnection peer;
+        peer.sa.sin_family = AF_INET;
+        peer.sa.sin_port = htons(rport);
+        inet_aton(LOCALHOSTIP, &peer.sa.sin_addr);
+        peer.port = rport;
+        jstd::net::ConnHandle to = sndr.add_client(peer);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        uint64_t sent = 0;
+        uint64_t lost = 0;
+        double cpu0 = cpu_secs();
+        auto start = clock_type::now();
+        auto end = start + std::chrono::milliseconds(ms);
+        auto last_progress = start;
+        uint64_t last_seen = 0;
+        while (clock_type::now() < end) {
+            uint64_t seen = rcvr.datagrams.load(std::memory_order_acquire);
+            if (seen != last_seen) {
+                last_seen = seen;
+                last_progress = clock_type::now();
+            }
+            if (sent - lost - seen + per_buff <= window) {
+                sndr.send_segments(to, buff.data(), buff.size(), static_cast<uint16_t>(seg));
+                sent += per_buff;
+            } else if (clock_type::now() - last_progress > std::chrono::milliseconds(20)) {
+                lost = sent - seen;
+                last_progress = clock_type::now();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        double secs = std::chrono::duration<double>(clock_type::now() - start).count();
+        double cpu = cpu_secs() - cpu0;
+        uint64_t got = rcvr.datagrams.load();
+        std::printf("%-9s %13.0f %9.1f %14.0f %6llu   %s\n", m.name, static_cast<double>(got) / secs,
+                    static_cast<double>(rcvr.bytes.load()) / secs / 1e6, got ? cpu * 1e9 / static_cast<double>(got) : 0.0,
+                    static_cast<unsigned long long>(lost), rcvr_ok && sndr_ok ? "on" : "refused, fell back");
+        rcvr.kill_threads();
+        runner.join();
+        sndr.kill_threads();
+    }
+    std::fflush(stdout);
+    std::_Exit(EXIT_SUCCESS);
+}
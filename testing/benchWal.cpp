@@ -0,0 +1,204 @@
+#include "tcp_server.h"
+#include "udp_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+/*
+ * Durable messages/sec of WriteAheadLog group commit against the batch window.
+ * Every client appends a message, waits until it is committed and completes it, so a client has one message
+ * in flight and a wider window lets more clients share one fdatasync at the cost of latency.
+ * With -e the same runs end to end: clients send over TCP (-u: UDP) to a server with the log set and wait for
+ * the one byte ack process_item sends, which only happens after the commit.
+ *
+ * usage: benchWal [-c clients] [-s msg_size] [-t seconds] [-w window_us,...] [-e port] [-u] [dir]
+ *   dir defaults to ./wal_bench, its contents are removed before every run
+ */
+
+using jstd::net::WriteAheadLog;
+using jstd::net::NetItem;
+using jstd::net::ConnHandle;
+typedef std::chrono::steady_clock clock_type;
+
+class AckServer : public jstd::net::TcpServerBase<AckServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    using jstd::net::TcpServerBase<AckServer, NetItem, jstd::net::PipelinePolicy>::TcpServerBase;
+    bool process_item(NetItem &&item) {
+        static const uint8_t ack = '+';
+        return send_to(item.conn, &ack, 1);
+    }
+    NetItem build_qitem(std::vector<uint8_t> &&data, ConnHandle conn) const {
+        NetItem item;
+        item.conn = conn;
+        item.buff = std::move(data);
+        return item;
+    }
+};
+
+class UdpAckServer : public jstd::UdpServerBase<UdpAckServer, NetItem, jstd::net::PipelinePolicy> {
+public:
+    using jstd::UdpServerBase<UdpAckServer, NetItem, jstd::net::PipelinePolicy>::UdpServerBase;
+    bool process_item(NetItem &&item) {
+        item.buff.assign(1, '+');
+        return send_item(item);
+    }
+};
+
+struct client_result {
+    uint64_t msgs = 0;
+    std::vector<uint32_t> lat_us;
+};
+
+static std::atomic<bool> g_running(false);
+
+static void log_client(WriteAheadLog &wal, size_t msg_size, client_result &res) {
+    std::vector<uint8_t> msg(msg_size, 'x');
+    while (g_running) {
+        auto t0 = clock_type::now();
+        uint64_t seq = wal.append(msg.data(), msg.size());
+        if (!seq || !wal.wait_committed(seq)) break;
+        wal.complete(seq);
+        res.lat_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t0).count()));
+        res.msgs++;
+    }
+}
+
+static void net_client(uint16_t port, bool udp, size_t msg_size, client_result &res) {
+    int fd = socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    inet_aton(LOCALHOSTIP, &sa.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+        std::cerr << "connect failed errno: " << errno << std::endl;
+        close(fd);
+        return;
+    }
+    int one = 1;
+    if (!udp) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval tv{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::vector<uint8_t> msg(msg_size, 'x');
+    uint8_t ack;
+    while (g_running) {
+        auto t0 = clock_type::now();
+        if (send(fd, msg.data(), msg.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(msg.size())) break;
+        if (recv(fd, &ack, 1, 0) != 1) break;
+        res.lat_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - t0).count()));
+        res.msgs++;
+    }
+    close(fd);
+}
+
+static void clear_dir(const std::string &dir) {
+    std::string cmd = "rm -rf '" + dir + "'";
+    if (std::system(cmd.c_str()) != 0) std::cerr << "could not clear " << dir << std::endl;
+}
+
+int main(int argc, char **argv) {
+    unsigned clients = 32;
+    size_t msg_size = 256;
+    unsigned seconds = 2;
+    uint16_t e2e_port = 0;
+    bool udp = false;
+    std::vector<unsigned> windows = {0, 100, 250, 500, 1000, 2000, 5000};
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:t:w:e:u")) != -1) {
+        switch (opt) {
+            case 'c': clients = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 's': msg_size = std::strtoul(optarg, nullptr, 10); break;
+            case 't': seconds = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'e': e2e_port = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'u': udp = true; break;
+            case 'w': {
+                windows.clear();
+                std::stringstream ss(optarg);
+                std::string w;
+                while (std::getline(ss, w, ',')) windows.push_back(static_cast<unsigned>(std::strtoul(w.c_str(), nullptr, 10)));
+                break;
+            }
+            default:
+                std::cerr << "usage: benchWal [-c clients] [-s msg_size] [-t seconds] [-w window_us,...] [-e port] [-u] [dir]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    std::string dir = optind < argc ? argv[optind] : "wal_bench";
+    logger::get_instance().set_level(LOG_LEVEL::WARNING);
+
+    std::cout << clients << " clients, " << msg_size << " byte messages, " << seconds << "s per window, "
+              << (!e2e_port ? "log only" : udp ? "end to end over udp" : "end to end over tcp") << "\n"
+              << "window_us    msgs/sec   syncs/sec   msgs/sync   p50_us   p99_us\n";
+    // servers are only stopped, their destructor stops the logger which drains its queued entries (trace
+    // level included) one per THREAD_MILLI_SLEEP, the process exits without running it
+    std::vector<std::unique_ptr<AckServer>> servers;
+    std::vector<std::unique_ptr<UdpAckServer>> udp_servers;
+    for (size_t i = 0; i < windows.size(); i++) {
+        clear_dir(dir);
+        WriteAheadLog wal(windows[i]);
+        if (!wal.open(dir)) {
+            std::cerr << "can not open log in " << dir << std::endl;
+            return EXIT_FAILURE;
+        }
+        AckServer *server = nullptr;
+        UdpAckServer *udp_server = nullptr;
+        uint16_t port = static_cast<uint16_t>(e2e_port + i);
+        if (e2e_port && udp) {
+            udp_servers.emplace_back(new UdpAckServer(LOCALHOSTIP, port));
+            udp_server = udp_servers.back().get();
+            udp_server->set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+            udp_server->set_wal(&wal);
+            udp_server->run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        } else if (e2e_port) {
+            servers.emplace_back(new AckServer(LOCALHOSTIP, port));
+            server = servers.back().get();
+            server->set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+            server->set_wal(&wal);
+            server->run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        std::vector<client_result> results(clients);
+        std::vector<std::thread> threads;
+        g_running = true;
+        for (unsigned c = 0; c < clients; c++) {
+            if (e2e_port) threads.emplace_back(net_client, port, udp, msg_size, std::ref(results[c]));
+            else threads.emplace_back(log_client, std::ref(wal), msg_size, std::ref(results[c]));
+        }
+        auto start = clock_type::now();
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        g_running = false;
+        for (auto &t : threads) t.join();
+        double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        if (server) server->kill_threads();
+        if (udp_server) udp_server->kill_threads();
+        jstd::net::WalStats st = wal.stats();
+        wal.close();
+
+        uint64_t msgs = 0;
+        std::vector<uint32_t> lat;
+        for (auto &r : results) {
+            msgs += r.msgs;
+            lat.insert(lat.end(), r.lat_us.begin(), r.lat_us.end());
+        }
+        std::sort(lat.begin(), lat.end());
+        auto pct = [&lat](double p) -> uint32_t {
+            return lat.empty() ? 0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))];
+        };
+        std::printf("%9u %11.0f %11.0f %11.1f %8u %8u\n", windows[i], msgs / elapsed, st.syncs / elapsed,
+                    st.syncs ? static_cast<double>(st.records) / st.syncs : 0.0, pct(0.50), pct(0.99));
+    }
+    clear_dir(dir);
+    std::fflush(stdout);
+    if (!servers.empty() || !udp_servers.empty()) std::_Exit(EXIT_SUCCESS);
+    logger::get_instance().stopLogging();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+ * wrk style HTTP/1.1 load generator, keep-alive connections spread over threads, each thread drives its
+ * connections from one epoll instance and keeps `pipeline` requests in flight per connection.
+ * Reports requests/sec and the latency distribution (time from writing a request to reading its response).
+ *
+ * usage: httpLoad [-c connections] [-t threads] [-d seconds] [-p pipeline] ip port [path]
+ */
+
+typedef std::chrono::steady_clock clock_type;
+
+struct load_conn {
+    int fd = -1;
+    std::string rbuf;
+    std::deque<clock_type::time_point> in_flight;
+};
+
+struct thread_result {
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> latency_us;
+};
+
+static sockaddr_in g_addr;
+static std::string g_request;
+static std::atomic<bool> g_running(true);
+
+static bool iequals_prefix(const char *p, const char *end, const char *s) {
+    size_t len = std::strlen(s);
+    if (static_cast<size_t>(end - p) < len) return false;
+    for (size_t i = 0; i < len; i++)
+        if (std::tolower(static_cast<unsigned char>(p[i])) != s[i]) return false;
+    return true;
+}
+
+// size of the first complete response in buf, 0 if more data is needed, -1 if it can not be parsed
+static long response_size(const std::string &buf) {
+    size_t hdr_end = buf.find("\r\n\r\n");
+    if (hdr_end == std::string::npos) return 0;
+    hdr_end += 4;
+    const char *p = buf.data();
+    const char *end = p + hdr_end;
+    long content_length = -1;
+    bool chunked = false;
+    for (const char *line = p; line < end; ) {
+        const char *eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol) break;
+        if (iequals_prefix(line, eol, "content-length:"))
+            content_length = std::strtol(line + 15, nullptr, 10);
+        else if (iequals_prefix(line, eol, "transfer-encoding:") && std::string(line, eol).find("chunked") != std::string::npos)
+            chunked = true;
+        line = eol + 1;
+    }
+    if (!chunked) {
+        if (content_length < 0) return -1;
+        return (buf.size() >= hdr_end + content_length) ? static_cast<long>(hdr_end + content_length) : 0;
+    }
+    size_t pos = hdr_end;
+    while (true) {
+        size_t eol = buf.find("\r\n", pos);
+        if (eol == std::string::npos) return 0;
+        size_t chunk = std::strtoul(buf.c_str() + pos, nullptr, 16);
+        pos = eol + 2;
+        if (chunk == 0)
+            return (buf.size() >= pos + 2) ? static_cast<long>(pos + 2) : 0;
+        pos += chunk + 2;
+        if (pos > buf.size()) return 0;
+    }
+}
+
+static bool open_conn(load_conn &c, int epfd) {
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0) return false;
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(c.fd, reinterpret_cast<sockaddr*>(&g_addr), sizeof(g_addr)) < 0) {
+        close(c.fd);
+        c.fd = -1;
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &c;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, c.fd, &ev);
+    c.rbuf.clear();
+    c.in_flight.clear();
+    return true;
+}
+
+static bool send_request(load_conn &c) {
+    if (send(c.fd, g_request.data(), g_request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(g_request.size()))
+        return false;
+    c.in_flight.push_back(clock_type::now());
+    return true;
+}
+
+static void reconnect(load_conn &c, int epfd, unsigned pipeline, thread_result &res) {
+    if (c.fd >= 0) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, nullptr);
+        close(c.fd);
+    }
+    if (!open_conn(c, epfd)) {
+        res.errors++;
+        return;
+    }
+    for (unsigned i = 0; i < pipeline; i++)
+        if (!send_request(c)) res.errors++;
+}
+
+static void load_thread(unsigned connections, unsigned pipeline, thread_result &res) {
+    int epfd = epoll_create1(0);
+    std::vector<load_conn> conns(connections);
+    for (auto &c : conns)
+        reconnect(c, epfd, pipeline, res);
+    std::vector<epoll_event> events(connections ? connections : 1);
+    char buff[16384];
+    while (g_running) {
+        int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), 100);
+        for (int i = 0; i < n; i++) {
+            load_conn &c = *static_cast<load_conn*>(events[i].data.ptr);
+            ssize_t len = recv(c.fd, buff, sizeof(buff), MSG_DONTWAIT);
+            if (len <= 0) {
+                if (len < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                if (!c.in_flight.empty()) res.errors++;
+                reconnect(c, epfd, pipeline, res);   // server closed, e.g. Connection: close
+                continue;
+            }
+            c.rbuf.append(buff, static_cast<size_t>(len));
+            long sz;
+            while ((sz = response_size(c.rbuf)) > 0 && !c.in_flight.empty()) {
+                auto lat = clock_type::now() - c.in_flight.front();
+                c.in_flight.pop_front();
+                res.latency_us.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(lat).count()));
+                res.requests++;
+                c.rbuf.erase(0, static_cast<size_t>(sz));
+                if (g_running && !send_request(c)) res.errors++;
+            }
+            if (sz < 0) {
+                res.errors++;
+                reconnect(c, epfd, pipeline, res);
+            }
+        }
+    }
+    for (auto &c : conns)
+        if (c.fd >= 0) close(c.fd);
+    close(epfd);
+}
+
+int main(int argc, char **argv) {
+    unsigned connections = 16;
+    unsigned threads = 2;
+    unsigned seconds = 10;
+    unsigned pipeline = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:d:p:")) != -1) {
+        switch (opt) {
+            case 'c': connections = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 't': threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'd': seconds = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'p': pipeline = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            default:
+                std::cerr << "usage: httpLoad [-c connections] [-t threads] [-d seconds] [-p pipeline] ip port [path]"
+                          << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind < 2) {
+        std::cerr << "usage: httpLoad [-c connections] [-t threads] [-d seconds] [-p pipeline] ip port [path]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    threads = std::max(1u, std::min(threads, connections));
+    pipeline = std::max(1u, pipeline);
+    g_addr = sockaddr_in{};
+    g_addr.sin_family = AF_INET;
+    g_addr.sin_port = htons(static_cast<uint16_t>(std::strtoul(argv[optind + 1], nullptr, 10)));
+    if (inet_aton(argv[optind], &g_addr.sin_addr) == 0) {
+        std::cerr << "invalid ip address " << argv[optind] << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string path = (argc - optind > 2) ? argv[optind + 2] : "/";
+    g_request = "GET " + path + " HTTP/1.1\r\nHost: " + argv[optind] + "\r\n\r\n";
+
+    std::vector<thread_result> results(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        unsigned share = connections / threads + (t < connections % threads ? 1 : 0);
+        workers.emplace_back(load_thread, share, pipeline, std::ref(results[t]));
+    }
+    auto start = clock_type::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    g_running = false;
+    for (auto &w : workers) w.join();
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> latency;
+    for (auto &r : results) {
+        requests += r.requests;
+        errors += r.errors;
+        latency.insert(latency.end(), r.latency_us.begin(), r.latency_us.end());
+    }
+    std::sort(latency.begin(), latency.end());
+    auto pct = [&latency](double p) -> uint32_t {
+        if (latency.empty()) return 0;
+        return latency[std::min(latency.size() - 1, static_cast<size_t>(p * latency.size()))];
+    };
+    std::cout << connections << " connections, " << threads << " threads, pipeline " << pipeline
+              << ", " << seconds << "s against " << argv[optind] << ":" << argv[optind + 1] << path << "\n"
+              << "requests: " << requests << " errors: " << errors << "\n"
+              << "requests/sec: " << static_cast<uint64_t>(requests / elapsed) << "\n"
+              << "latency us  p50: " << pct(0.50) << "  p90: " << pct(0.90) << "  p99: " << pct(0.99)
+              << "  max: " << (latency.empty() ? 0 : latency.back()) << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+ * RESP cache benchmark client, every connection keeps `depth` GET/SET commands in flight and a new one is
+ * written for each reply read. The run is repeated for every pipeline depth and reports ops/sec per depth.
+ *
+ * usage: kvBench [-c connections] [-t threads] [-d seconds] [-p depths] [-k keys] [-v value_size] [-r get_ratio]
+ *                ip port
+ *   -p  comma separated pipeline depths (default 1,4,16,64)
+ *   -r  fraction of GETs, the rest are SETs (default 0.9)
+ */
+
+struct bench_conn {
+    int fd = -1;
+    std::string rbuf;
+    std::string wbuf;
+    unsigned in_flight = 0;
+};
+
+struct bench_cfg {
+    sockaddr_in addr;
+    unsigned keys = 100000;
+    unsigned value_size = 64;
+    double get_ratio = 0.9;
+};
+
+static bench_cfg g_cfg;
+static std::atomic<bool> g_running(false);
+
+// size of the first complete reply in buf, 0 if more data is needed, -1 if it can not be parsed
+static long reply_size(const char *buf, size_t size) {
+    if (size == 0) return 0;
+    const char *lf = static_cast<const char*>(std::memchr(buf, '\n', size));
+    if (!lf) return 0;
+    size_t line = static_cast<size_t>(lf - buf) + 1;
+    switch (buf[0]) {
+        case '+': case '-': case ':':
+            return static_cast<long>(line);
+        case '$': {
+            long len = std::strtol(buf + 1, nullptr, 10);
+            if (len < 0) return static_cast<long>(line);
+            size_t total = line + static_cast<size_t>(len) + 2;
+            return (size >= total) ? static_cast<long>(total) : 0;
+        }
+        default:
+            return -1;
+    }
+}
+
+static void append_command(std::string &out, std::mt19937 &rng, const std::string &value) {
+    std::string key = "key:" + std::to_string(rng() % g_cfg.keys);
+    bool get = (rng() % 1000) < static_cast<unsigned>(g_cfg.get_ratio * 1000);
+    if (get) {
+        out += "*2\r\n$3\r\nGET\r\n$" + std::to_string(key.size()) + "\r\n" + key + "\r\n";
+    } else {
+        out += "*3\r\n$3\r\nSET\r\n$" + std::to_string(key.size()) + "\r\n" + key + "\r\n$"
+               + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    }
+}
+
+static bool flush(bench_conn &c) {
+    while (!c.wbuf.empty()) {
+        ssize_t n = send(c.fd, c.wbuf.data(), c.wbuf.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        c.wbuf.erase(0, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+static void bench_thread(unsigned connections, unsigned depth, uint64_t &ops, uint64_t &errors, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string value(g_cfg.value_size, 'x');
+    int epfd = epoll_create1(0);
+    std::vector<bench_conn> conns(connections);
+    for (auto &c : conns) {
+        c.fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(c.fd, reinterpret_cast<const sockaddr*>(&g_cfg.addr), sizeof(g_cfg.addr)) < 0) {
+            errors++;
+            close(c.fd);
+            c.fd = -1;
+            continue;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = &c;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+    while (!g_running) std::this_thread::yield();
+    for (auto &c : conns) {
+        if (c.fd < 0) continue;
+        for (unsigned i = 0; i < depth; i++) append_command(c.wbuf, rng, value);
+        c.in_flight = depth;
+        if (!flush(c)) errors++;
+    }
+    std::vector<epoll_event> events(connections ? connections : 1);
+    char buff[65536];
+    while (g_running) {
+        int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), 100);
+        for (int i = 0; i < n; i++) {
+            bench_conn &c = *static_cast<bench_conn*>(events[i].data.ptr);
+            ssize_t len = recv(c.fd, buff, sizeof(buff), MSG_DONTWAIT);
+            if (len <= 0) {
+                if (len < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                errors++;
+                epoll_ctl(epfd, EPOLL_CTL_DEL, c.fd, nullptr);
+                close(c.fd);
+                c.fd = -1;
+                continue;
+            }
+            c.rbuf.append(buff, static_cast<size_t>(len));
+            size_t pos = 0;
+            long sz;
+            // replies are consumed from the front, one new command per reply keeps the depth constant
+            while (c.in_flight) {
+                sz = reply_size(c.rbuf.data() + pos, c.rbuf.size() - pos);
+                if (sz <= 0) {
+                    if (sz < 0) errors++;
+                    break;
+                }
+                if (c.rbuf[pos] == '-') errors++;
+                pos += static_cast<size_t>(sz);
+                c.in_flight--;
+                ops++;
+                if (g_running) {
+                    append_command(c.wbuf, rng, value);
+                    c.in_flight++;
+                }
+            }
+            c.rbuf.erase(0, pos);
+            if (!flush(c)) errors++;
+        }
+    }
+    for (auto &c : conns)
+        if (c.fd >= 0) close(c.fd);
+    close(epfd);
+}
+
+int main(int argc, char **argv) {
+    unsigned connections = 16;
+    unsigned threads = 2;
+    unsigned seconds = 5;
+    std::string depth_list = "1,4,16,64";
+    int opt;
+    const char *usage = "usage: kvBench [-c connections] [-t threads] [-d seconds] [-p depths] [-k keys] "
+                        "[-v value_size] [-r get_ratio] ip port";
+    while ((opt = getopt(argc, argv, "c:t:d:p:k:v:r:")) != -1) {
+        switch (opt) {
+            case 'c': connections = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 't': threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'd': seconds = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'p': depth_list = optarg; break;
+            case 'k': g_cfg.keys = std::max(1ul, std::strtoul(optarg, nullptr, 10)); break;
+            case 'v': g_cfg.value_size = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'r': g_cfg.get_ratio = std::strtod(optarg, nullptr); break;
+            default:
+                std::cerr << usage << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind < 2) {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+    threads = std::max(1u, std::min(threads, connections));
+    g_cfg.addr = sockaddr_in{};
+    g_cfg.addr.sin_family = AF_INET;
+    g_cfg.addr.sin_port = htons(static_cast<uint16_t>(std::strtoul(argv[optind + 1], nullptr, 10)));
+    if (inet_aton(argv[optind], &g_cfg.addr.sin_addr) == 0) {
+        std::cerr << "invalid ip address " << argv[optind] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << connections << " connections, " << threads << " threads, " << g_cfg.keys << " keys, "
+              << g_cfg.value_size << " byte values, " << g_cfg.get_ratio * 100 << "% GET, " << seconds
+              << "s per depth\n";
+    std::stringstream depths(depth_list);
+    std::string item;
+    while (std::getline(depths, item, ',')) {
+        unsigned depth = std::max(1u, static_cast<unsigned>(std::strtoul(item.c_str(), nullptr, 10)));
+        std::vector<uint64_t> ops(threads, 0);
+        std::vector<uint64_t> errors(threads, 0);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            unsigned share = connections / threads + (t < connections % threads ? 1 : 0);
+            workers.emplace_back(bench_thread, share, depth, std::ref(ops[t]), std::ref(errors[t]), t + 1);
+        }
+        g_running = true;
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        g_running = false;
+        for (auto &w : workers) w.join();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t total = 0;
+        uint64_t errs = 0;
+        for (unsigned t = 0; t < threads; t++) {
+            total += ops[t];
+            errs += errors[t];
+        }
+        std::cout << "depth " << depth << ": " << static_cast<uint64_t>(total / elapsed) << " ops/sec, "
+                  << total << " ops, " << errs << " errors" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+#include "kv_server.h"
+
+/*
+ * RESP key/value cache daemon, answers GET/SET/DEL/EXPIRE/MGET from redis clients.
+ *
+ * usage: kvCacheServer [-m max_mb] [-s shards] [-u] [-w capture_file] [ip port]
+ *   -m  memory limit in MB, least recently used keys are evicted above it (default unlimited)
+ *   -s  number of store shards (default 16)
+ *   -u  io_uring backend instead of epoll
+ *   -w  record received traffic for trafficReplay
+ */
+
+int main(int argc, char** argv) {
+	size_t max_mb = 0;
+	unsigned shards = 16;
+	jstd::net::IO_BACKEND backend = jstd::net::IO_BACKEND::EPOLL;
+	std::string capture_file;
+	int opt;
+	while ((opt = getopt(argc, argv, "m:s:uw:")) != -1) {
+		switch (opt) {
+			case 'm': max_mb = std::strtoul(optarg, nullptr, 10); break;
+			case 's': shards = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+			case 'u': backend = jstd::net::IO_BACKEND::IO_URING; break;
+			case 'w': capture_file = optarg; break;
+			default:
+				std::cerr << "usage: kvCacheServer [-m max_mb] [-s shards] [-u] [-w capture_file] [ip port]" << std::endl;
+				return EXIT_FAILURE;
+		}
+	}
+	std::string ipaddr = LOCALHOSTIP;
+	uint16_t port = 6379;
+	if (argc - optind >= 2) {
+		ipaddr = argv[optind];
+		port = static_cast<uint16_t>(std::strtol(argv[optind + 1], nullptr, 10));
+	} else {
+		std::cout << "applying default server ipaddr: " << ipaddr << " port: " << port << std::endl;
+	}
+	logger::get_instance().set_level(LOG_LEVEL::WARNING);
+	jstd::net::KvServer<> kv_server(ipaddr, port, max_mb << 20, shards);
+	kv_server.set_io_backend(backend);
+	jstd::net::TrafficCapture capture;
+	if (!capture_file.empty()) {
+		if (!capture.open(capture_file)) {
+			std::cerr << "can not open capture file " << capture_file << std::endl;
+			return EXIT_FAILURE;
+		}
+		kv_server.set_capture(&capture);
+	}
+	kv_server.run();   // inline policy, returns once the server is stopped
+	return EXIT_SUCCESS;
+}
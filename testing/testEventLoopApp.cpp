@@ -0,0 +1,57 @@
+#include "tcp_server.h"
+#include "udp_server.h"
+#include "EventLoop.h"
+#include <csignal>
+
+/*
+ * One application thread serving a TCP listener and a UDP socket from a single EventLoop,
+ * with a timer reporting the loop's buffer pool usage. ctrl-c stops the loop.
+ *
+ * usage: testEventLoopApp [ip tcp_port udp_port]
+ */
+
+std::string g_ipaddr;
+uint16_t g_tcp_port;
+uint16_t g_udp_port;
+jstd::net::EventLoop *g_loop = nullptr;
+
+void handle_args(int argc, char** argv) {
+	if (argc != 4) {
+		g_ipaddr = LOCALHOSTIP;
+		g_tcp_port = DEFAULT_TCP_SERVER_PORT;
+		g_udp_port = DEFAULT_UDP_SERVER_PORT;
+		std::cout << "applying default server ipaddr: " << LOCALHOSTIP << " tcp port: " << g_tcp_port
+		          << " udp port: " << g_udp_port << std::endl;
+	} else {
+		g_ipaddr = std::string(argv[1]);
+		g_tcp_port = static_cast<uint16_t>(std::strtol(argv[2], nullptr, 10));
+		g_udp_port = static_cast<uint16_t>(std::strtol(argv[3], nullptr, 10));
+	}
+}
+
+void handle_signal(int) {
+	if (g_loop) g_loop->stop();
+}
+
+int main(int argc, char** argv) {
+	handle_args(argc, argv);
+	jstd::net::EventLoop loop;
+	g_loop = &loop;
+	std::signal(SIGINT, handle_signal);
+
+	// inline policy, the loop thread is the only thread touching either server
+	jstd::net::TcpServer<jstd::net::NetItem, jstd::net::InlinePolicy> tcp_server(g_ipaddr, g_tcp_port);
+	jstd::UdpServer<jstd::net::NetItem, jstd::net::InlinePolicy> udp_server(g_ipaddr, g_udp_port);
+	if (!tcp_server.attach(loop) || !udp_server.attach(loop))
+		return EXIT_FAILURE;
+
+	loop.add_timer(5000, true, [&loop]() {
+		std::cout << "buffer pool: " << loop.buffers().available() << "/" << loop.buffers().capacity()
+		          << " buffers free" << std::endl;
+	});
+	loop.run();
+
+	tcp_server.detach();
+	udp_server.detach();
+	return EXIT_SUCCESS;
+}
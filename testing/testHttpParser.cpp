@@ -0,0 +1,201 @@
+#include "HttpParser.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/*
+ * Feeds crafted and malformed requests through HttpParser and checks the verdict, the error status and the fields
+ * of what it accepts. Complete requests are also fed one byte at a time to one parser, so every split point of the
+ * request line, the headers, the "\r\n\r\n" and the body is covered. Prints each wrong result and exits non-zero
+ * if there was one.
+ *
+ * usage: testHttpParser
+ */
+
+using jstd::net::HTTP_PARSE;
+using jstd::net::HttpParser;
+using jstd::net::HttpRange;
+using jstd::net::HttpRequest;
+
+static unsigned failures = 0;
+static unsigned checks = 0;
+
+static void check(bool ok, const char *name, const char *what) {
+    checks++;
+    if (ok) return;
+    failures++;
+    std::printf("FAIL %s: %s\n", name, what);
+}
+
+static const char *verdict(HTTP_PARSE res) {
+    return res == HTTP_PARSE::COMPLETE ? "COMPLETE" : res == HTTP_PARSE::INCOMPLETE ? "INCOMPLETE" : "ERROR";
+}
+
+// the whole request at once, then growing a byte at a time through one parser, both have to agree
+static HTTP_PARSE parse_all(const char *name, const std::string &in, HttpRequest &req) {
+    HttpParser parser;
+    HTTP_PARSE res = parser.parse(in.data(), in.size(), req);
+    HttpParser incremental;
+    HttpRequest partial;
+    for (size_t len = 1; len < in.size(); len++) {
+        HTTP_PARSE step = incremental.parse(in.data(), len, partial);
+        if (step == HTTP_PARSE::INCOMPLETE) continue;
+        // a verdict before the last byte is only fine for errors and for requests followed by pipelined data
+        if (step == HTTP_PARSE::ERROR || partial.total_len == len) return res;
+        check(false, name, "completed early when fed a byte at a time");
+        return res;
+    }
+    return res;
+}
+
+static void expect_complete(const char *name, const std::string &in, size_t total_len, bool keep_alive) {
+    HttpRequest req;
+    HTTP_PARSE res = parse_all(name, in, req);
+    if (res != HTTP_PARSE::COMPLETE) {
+        std::printf("FAIL %s: %s instead of COMPLETE\n", name, verdict(res));
+        failures++;
+        return;
+    }
+    check(req.total_len == total_len, name, "total_len");
+    check(req.keep_alive == keep_alive, name, "keep_alive");
+}
+
+static void expect_complete(const char *name, const std::string &in, bool keep_alive) {
+    expect_complete(name, in, in.size(), keep_alive);
+}
+
+// literals with embedded NULs
+template <size_t N>
+static std::string bytes(const char (&s)[N]) { return std::string(s, N - 1); }
+
+static void expect_error(const char *name, const std::string &in, int status) {
+    HttpParser parser;
+    HttpRequest req;
+    HTTP_PARSE res = parser.parse(in.data(), in.size(), req);
+    checks++;
+    if (res != HTTP_PARSE::ERROR || parser.error_status() != status) {
+        std::printf("FAIL %s: %s/%d instead of ERROR/%d\n", name, verdict(res), parser.error_status(), status);
+        failures++;
+    }
+}
+
+static void test_accepted() {
+    std::string get = "GET /index.html?x=1 HTTP/1.1\r\nHost: a\r\nAccept: */*\r\n\r\n";
+    expect_complete("simple GET", get, get.size(), true);
+    HttpRequest req;
+    HttpParser parser;
+    parser.parse(get.data(), get.size(), req);
+    check(req.equals(req.method, "GET"), "simple GET", "method");
+    check(req.equals(req.target, "/index.html?x=1"), "simple GET", "target");
+    check(req.path().len == 11, "simple GET", "path");
+    check(req.header_cnt == 2, "simple GET", "header count");
+    HttpRange host;
+    check(req.header("HOST", host) && req.equals(host, "a"), "simple GET", "case insensitive header lookup");
+    check(req.body.len == 0, "simple GET", "empty body");
+
+    std::string post = "POST /kv HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    expect_complete("POST with body", post, post.size(), true);
+    parser.parse(post.data(), post.size(), req);
+    check(req.content_length == 5 && req.str(req.body) == "hello", "POST with body", "body range");
+
+    HttpParser waiting;
+    check(waiting.parse(post.data(), post.size() - 1, req) == HTTP_PARSE::INCOMPLETE, "POST body short by a byte",
+          "verdict");
+    check(waiting.parse(post.data(), post.size(), req) == HTTP_PARSE::COMPLETE, "POST body short by a byte",
+          "completes on the last byte");
+
+    expect_complete("optional whitespace", "GET / HTTP/1.1\r\nHost:a\r\nX-A: \t b \t\r\n\r\n", true);
+    expect_complete("Content-Length 0", "POST / HTTP/1.1\r\nContent-Length: 0\r\n\r\n", true);
+    expect_complete("Connection: close", "GET / HTTP/1.1\r\nConnection: close\r\n\r\n", false);
+    expect_complete("Connection token list", "GET / HTTP/1.1\r\nConnection: Upgrade, CLOSE\r\n\r\n", false);
+    expect_complete("HTTP/1.0", "GET / HTTP/1.0\r\n\r\n", false);
+    expect_complete("HTTP/1.0 keep-alive", "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", true);
+    expect_complete("obs-text in value", "GET / HTTP/1.1\r\nX-A: caf\xc3\xa9\r\n\r\n", true);
+
+    std::string first = "POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc";
+    std::string second = "GET /b HTTP/1.1\r\n\r\n";
+    std::string pipelined = first + second;
+    HttpParser pipe;
+    check(pipe.parse(pipelined.data(), pipelined.size(), req) == HTTP_PARSE::COMPLETE &&
+          req.total_len == first.size(), "pipelined", "first request");
+    const char *rest = pipelined.data() + req.total_len;
+    check(pipe.parse(rest, pipelined.size() - first.size(), req) == HTTP_PARSE::COMPLETE &&
+          req.total_len == second.size() && req.equals(req.target, "/b"), "pipelined", "second request");
+    expect_complete("pipelined, byte at a time", pipelined, first.size(), true);
+
+    // "\r\n\r\n" split across reads at every position, the resumed search must still find it
+    for (size_t cut = get.size() - 4; cut < get.size(); cut++) {
+        HttpParser split;
+        check(split.parse(get.data(), cut, req) == HTTP_PARSE::INCOMPLETE, "split terminator", "first part");
+        check(split.parse(get.data(), get.size(), req) == HTTP_PARSE::COMPLETE && req.total_len == get.size(),
+              "split terminator", "second part");
+    }
+    // a "\r\n\r" at the end of one read that does not turn into the terminator
+    std::string almost = "GET / HTTP/1.1\r\nA: b\r\n\r";
+    HttpParser near;
+    check(near.parse(almost.data(), almost.size(), req) == HTTP_PARSE::INCOMPLETE, "\\r\\n\\r then more", "first part");
+    almost += "\nX";
+    check(near.parse(almost.data(), almost.size(), req) == HTTP_PARSE::COMPLETE && req.total_len == 24,
+          "\\r\\n\\r then more", "second part");
+}
+
+static void test_rejected() {
+    expect_error("lowercase method", "get / HTTP/1.1\r\n\r\n", 400);
+    expect_error("missing target", "GET  HTTP/1.1\r\n\r\n", 400);
+    expect_error("no version", "GET /\r\n\r\n", 400);
+    expect_error("NUL in target", bytes("GET /a\0b HTTP/1.1\r\n\r\n"), 400);
+    expect_error("bare LF after request line", "GET / HTTP/1.1\nHost: a\r\n\r\n", 400);
+    expect_error("HTTP/2.0", "GET / HTTP/2.0\r\n\r\n", 505);
+    expect_error("HTTP/1.2", "GET / HTTP/1.2\r\n\r\n", 505);
+    expect_error("garbage version", "GET / FTP/1.1\r\n\r\n", 400);
+
+    expect_error("header without colon", "GET / HTTP/1.1\r\nHost a\r\n\r\n", 400);
+    expect_error("empty header name", "GET / HTTP/1.1\r\n: a\r\n\r\n", 400);
+    expect_error("space before colon", "GET / HTTP/1.1\r\nContent-Length : 5\r\n\r\nhello", 400);
+    expect_error("space inside name", "GET / HTTP/1.1\r\nX A: b\r\n\r\n", 400);
+    expect_error("obs-fold line", "GET / HTTP/1.1\r\nX-A: b\r\n c\r\n\r\n", 400);
+    expect_error("bare LF in value", "GET / HTTP/1.1\r\nX-A: b\nContent-Length: 5\r\n\r\nhello", 400);
+    expect_error("bare CR in value", "GET / HTTP/1.1\r\nX-A: b\rc\r\n\r\n", 400);
+    expect_error("NUL in value", bytes("GET / HTTP/1.1\r\nX-A: b\0c\r\n\r\n"), 400);
+    expect_error("DEL in value", "GET / HTTP/1.1\r\nX-A: b\x7f\r\n\r\n", 400);
+
+    expect_error("duplicate Content-Length", "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\na", 400);
+    expect_error("duplicate Content-Length, other case",
+                 "POST / HTTP/1.1\r\nContent-Length: 1\r\ncontent-length: 2\r\n\r\nab", 400);
+    expect_error("empty Content-Length", "POST / HTTP/1.1\r\nContent-Length:\r\n\r\n", 400);
+    expect_error("signed Content-Length", "POST / HTTP/1.1\r\nContent-Length: +5\r\n\r\nhello", 400);
+    expect_error("negative Content-Length", "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", 400);
+    expect_error("Content-Length list", "POST / HTTP/1.1\r\nContent-Length: 5, 5\r\n\r\nhello", 400);
+    expect_error("hex Content-Length", "POST / HTTP/1.1\r\nContent-Length: 0x10\r\n\r\n", 400);
+    expect_error("Content-Length over the body limit", "POST / HTTP/1.1\r\nContent-Length: 1048577\r\n\r\n", 413);
+    expect_error("overflowing Content-Length",
+                 "POST / HTTP/1.1\r\nContent-Length: 18446744073709551617\r\n\r\n", 413);
+
+    expect_error("Transfer-Encoding chunked", "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", 501);
+    expect_error("Transfer-Encoding with Content-Length",
+                 "POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", 501);
+
+    std::string big = "GET / HTTP/1.1\r\nX-A: " + std::string(jstd::net::HTTP_MAX_HEADER_BYTES, 'a') + "\r\n\r\n";
+    expect_error("header block over the limit", big, 431);
+    expect_error("unterminated header block over the limit", big.substr(0, big.size() - 4), 431);
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (unsigned i = 0; i <= jstd::net::HTTP_MAX_HEADERS; i++) many += "X-" + std::to_string(i) + ": v\r\n";
+    expect_error("too many headers", many + "\r\n", 431);
+
+    // after an error the parser is reset by its owner and takes the next request
+    HttpParser parser;
+    HttpRequest req;
+    std::string bad = "GET / HTTP/1.1\r\nX A: b\r\n\r\n";
+    std::string good = "GET / HTTP/1.1\r\n\r\n";
+    parser.parse(bad.data(), bad.size(), req);
+    parser.reset();
+    check(parser.parse(good.data(), good.size(), req) == HTTP_PARSE::COMPLETE && parser.error_status() == 0,
+          "reset after error", "next request");
+}
+
+int main() {
+    test_accepted();
+    test_rejected();
+    std::printf("%u checks, %u failed\n", checks, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
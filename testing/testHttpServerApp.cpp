@@ -0,0 +1,47 @@
+#include "http_server.h"
+
+/*
+ * HTTP/1.1 server, files below doc_root are streamed with sendfile, /hello answers from memory and
+ * /chunked with a chunked body.
+ *
+ * usage: testHttpServerApp [ip port [doc_root]]
+ */
+
+std::string g_ipaddr;
+uint16_t g_port;
+std::string g_doc_root;
+
+void handle_args(int argc, char** argv) {
+	if (argc < 3) {
+		g_port = 8080;
+		g_ipaddr = LOCALHOSTIP;
+		std::cout << "applying default server ipaddr: " << LOCALHOSTIP << " port: " << g_port << std::endl;
+	} else {
+		g_ipaddr = std::string(argv[1]);
+		g_port = static_cast<uint16_t>(std::strtol(argv[2], nullptr, 10));
+	}
+	if (argc > 3) g_doc_root = argv[3];
+}
+
+int main(int argc, char** argv) {
+	handle_args(argc, argv);
+	logger::get_instance().set_level(LOG_LEVEL::WARNING);
+	jstd::net::HttpServer<> http_server(g_ipaddr, g_port);
+	http_server.set_io_backend(jstd::net::IO_BACKEND::EPOLL);
+	http_server.set_static_root(g_doc_root);
+	http_server.set_handler([](const jstd::net::HttpRequest &req, jstd::net::HttpResponse &resp) {
+		if (req.equals(req.path(), "/hello")) {
+			resp.set_body("hello world\n");
+		} else if (req.equals(req.path(), "/chunked")) {
+			for (int i = 0; i < 3; i++) {
+				std::string chunk = "chunk " + std::to_string(i) + "\n";
+				resp.write_chunk(chunk.data(), chunk.size());
+			}
+		} else {
+			resp.set_status(404);
+			resp.set_body("not found\n");
+		}
+	});
+	http_server.run();   // inline policy, returns once the server is stopped
+	return EXIT_SUCCESS;
+}
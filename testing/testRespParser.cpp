@@ -0,0 +1,163 @@
+#include "RespParser.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/*
+ * Feeds crafted and malformed commands through RespParser and checks the verdict and the arguments of what it
+ * accepts. Complete commands are also fed one byte at a time to one parser, so every split point of the length
+ * lines, the bulk strings and their terminators is covered. Prints each wrong result and exits non-zero if there
+ * was one.
+ *
+ * usage: testRespParser
+ */
+
+using jstd::net::RESP_PARSE;
+using jstd::net::RespCommand;
+using jstd::net::RespParser;
+
+static unsigned failures = 0;
+static unsigned checks = 0;
+
+static void check(bool ok, const char *name, const char *what) {
+    checks++;
+    if (ok) return;
+    failures++;
+    std::printf("FAIL %s: %s\n", name, what);
+}
+
+static const char *verdict(RESP_PARSE res) {
+    return res == RESP_PARSE::COMPLETE ? "COMPLETE" : res == RESP_PARSE::INCOMPLETE ? "INCOMPLETE" : "ERROR";
+}
+
+// a byte at a time through one parser, nothing but INCOMPLETE before the command is all there
+static void check_prefixes(const char *name, const std::string &in, size_t total_len) {
+    RespParser parser;
+    RespCommand cmd;
+    for (size_t len = 1; len < total_len; len++) {
+        RESP_PARSE res = parser.parse(in.data(), len, cmd);
+        if (res != RESP_PARSE::INCOMPLETE) {
+            std::printf("FAIL %s: %s after %zu of %zu bytes\n", name, verdict(res), len, total_len);
+            failures++;
+            return;
+        }
+    }
+    checks++;
+}
+
+static void expect_complete(const char *name, const std::string &in, const std::vector<std::string> &args,
+                            size_t total_len) {
+    RespParser parser;
+    RespCommand cmd;
+    RESP_PARSE res = parser.parse(in.data(), in.size(), cmd);
+    if (res != RESP_PARSE::COMPLETE) {
+        std::printf("FAIL %s: %s (%s) instead of COMPLETE\n", name, verdict(res),
+                    parser.error() ? parser.error() : "");
+        failures++;
+        return;
+    }
+    check(cmd.total_len == total_len, name, "total_len");
+    bool same = cmd.args.size() == args.size();
+    for (size_t i = 0; same && i < args.size(); i++) same = cmd.str(i) == args[i];
+    check(same, name, "arguments");
+    check_prefixes(name, in, total_len);
+}
+
+static void expect_complete(const char *name, const std::string &in, const std::vector<std::string> &args) {
+    expect_complete(name, in, args, in.size());
+}
+
+static void expect_error(const char *name, const std::string &in) {
+    RespParser parser;
+    RespCommand cmd;
+    RESP_PARSE res = parser.parse(in.data(), in.size(), cmd);
+    checks++;
+    if (res != RESP_PARSE::ERROR || !parser.error()) {
+        std::printf("FAIL %s: %s instead of ERROR\n", name, verdict(res));
+        failures++;
+    }
+}
+
+static void expect_incomplete(const char *name, const std::string &in) {
+    RespParser parser;
+    RespCommand cmd;
+    RESP_PARSE res = parser.parse(in.data(), in.size(), cmd);
+    checks++;
+    if (res != RESP_PARSE::INCOMPLETE) {
+        std::printf("FAIL %s: %s instead of INCOMPLETE\n", name, verdict(res));
+        failures++;
+    }
+}
+
+static void test_accepted() {
+    expect_complete("array", "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$5\r\nhello\r\n", {"SET", "k", "hello"});
+    expect_complete("binary safe bulk", "*2\r\n$3\r\nGET\r\n$4\r\na\r\nb\r\n", {"GET", std::string("a\r\nb")});
+    expect_complete("empty bulk", "*2\r\n$3\r\nGET\r\n$0\r\n\r\n", {"GET", ""});
+    expect_complete("empty array", "*0\r\n", {});
+    expect_complete("inline", "SET k  v\r\n", {"SET", "k", "v"});
+    expect_complete("inline, LF only", "PING\n", {"PING"});
+    expect_complete("inline with tabs", "\tGET\tk \r\n", {"GET", "k"});
+    expect_complete("empty inline line", "\r\n", {});
+
+    std::string first = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n";
+    std::string second = "PING\r\n";
+    std::string third = "*1\r\n$4\r\nQUIT\r\n";
+    std::string pipelined = first + second + third;
+    expect_complete("pipelined", pipelined, {"GET", "a"}, first.size());
+    RespParser parser;
+    RespCommand cmd;
+    size_t off = 0;
+    unsigned cnt = 0;
+    while (off < pipelined.size() && parser.parse(pipelined.data() + off, pipelined.size() - off, cmd) ==
+                                     RESP_PARSE::COMPLETE) {
+        off += cmd.total_len;
+        cnt++;
+    }
+    check(cnt == 3 && off == pipelined.size() && cmd.is("QUIT"), "pipelined", "all three commands");
+
+    std::string line(jstd::net::RESP_MAX_INLINE_BYTES - 1, 'a');
+    expect_complete("inline at the size limit", line + "\r\n", {line});
+    std::string bulk(1 << 16, 'x');
+    expect_complete("64KB bulk", "*1\r\n$65536\r\n" + bulk + "\r\n", {bulk});
+}
+
+static void test_rejected() {
+    expect_error("multibulk count without digits", "*\r\n");
+    expect_error("multibulk count of a lone sign", "*-\r\n");
+    expect_error("negative multibulk count", "*-1\r\n");
+    expect_error("multibulk count with garbage", "*1x\r\n$1\r\na\r\n");
+    expect_error("multibulk count with plus sign", "*+1\r\n$1\r\na\r\n");
+    expect_error("multibulk count over the limit", "*1048577\r\n");
+    expect_error("overflowing multibulk count", "*9223372036854775808\r\n");
+    expect_error("far overflowing multibulk count", "*99999999999999999999999\r\n");
+    expect_error("CR without LF", "*1\r$1\r\na\r\n");
+    expect_error("count line ended by LF only", "*1\n$1\r\na\r\n");
+    expect_error("count line without CR past 32 bytes", "*1\n" + std::string(40, 'a'));
+    expect_incomplete("count line cut short", "*12");
+
+    expect_error("element that is not a bulk", "*1\r\n:1\r\n");
+    expect_error("bulk length of a lone sign", "*1\r\n$-\r\n");
+    expect_error("empty bulk length", "*1\r\n$\r\n\r\n");
+    expect_error("negative bulk length", "*1\r\n$-1\r\n");
+    expect_error("bulk length over the limit", "*1\r\n$16777217\r\n");
+    expect_error("overflowing bulk length", "*1\r\n$9223372036854775808\r\n");
+    expect_error("overflowing negative bulk length", "*1\r\n$-9223372036854775809\r\n");
+    expect_error("bulk not terminated", "*1\r\n$3\r\nGETx\r\n");
+    expect_error("bulk terminated by LF only", "*1\r\n$3\r\nGET\n\r\n");
+    expect_error("bad second element", "*2\r\n$3\r\nGET\r\n$x\r\nk\r\n");
+    expect_incomplete("bulk at the length limit, data pending", "*1\r\n$16777216\r\n");
+
+    std::string line(jstd::net::RESP_MAX_INLINE_BYTES + 1, 'a');
+    expect_error("unterminated inline over the limit", line);
+    expect_error("inline line over the limit", line + "\r\n");
+    expect_error("inline line over the limit, LF only", line + "\n");
+    expect_incomplete("unterminated inline at the limit", line.substr(1));
+}
+
+int main() {
+    test_accepted();
+    test_rejected();
+    std::printf("%u checks, %u failed\n", checks, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#include "tcp_proxy.h"
+
+/*
+ * L4 proxy in front of one or more backends, client bytes are spliced to the selected backend and back.
+ *
+ * usage: testTcpProxyApp [-l] ip port backend_ip:port [backend_ip:port ...]
+ *   -l  least connections instead of round robin
+ */
+
+int main(int argc, char** argv) {
+	jstd::net::LB_POLICY policy = jstd::net::LB_POLICY::ROUND_ROBIN;
+	int opt;
+	while ((opt = getopt(argc, argv, "l")) != -1) {
+		if (opt == 'l') {
+			policy = jstd::net::LB_POLICY::LEAST_CONNECTIONS;
+		} else {
+			std::cerr << "usage: testTcpProxyApp [-l] ip port backend_ip:port [backend_ip:port ...]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (argc - optind < 3) {
+		std::cerr << "usage: testTcpProxyApp [-l] ip port backend_ip:port [backend_ip:port ...]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	logger::get_instance().set_level(LOG_LEVEL::WARNING);
+	jstd::net::TcpProxy<> proxy(argv[optind], static_cast<uint16_t>(std::strtol(argv[optind + 1], nullptr, 10)), policy);
+	for (int i = optind + 2; i < argc; i++) {
+		std::string backend(argv[i]);
+		size_t colon = backend.rfind(':');
+		if (colon == std::string::npos) {
+			std::cerr << "backend must be ip:port, got " << backend << std::endl;
+			return EXIT_FAILURE;
+		}
+		proxy.add_backend(backend.substr(0, colon),
+			static_cast<uint16_t>(std::strtol(backend.c_str() + colon + 1, nullptr, 10)));
+	}
+	proxy.run();   // returns once the proxy is stopped
+	return EXIT_SUCCESS;
+}
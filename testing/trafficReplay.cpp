@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TrafficCapture.h"
+
+/*
+ * Replays a TrafficCapture file against a server. Every captured connection gets its own connection
+ * (TCP or UDP as recorded), frames go out in capture order at the recorded pace scaled by -s, closes are
+ * replayed too. -n runs that many copies of every captured connection side by side to multiply the load.
+ * Responses are read and discarded. The file is mmap'ed, payload is sent straight from the mapping.
+ *
+ * usage: trafficReplay [-s speed] [-n copies] [-t threads] capture_file ip port
+ *   -s  1 replays at the recorded pace (default), 10 ten times faster, 0 as fast as possible
+ */
+
+typedef std::chrono::steady_clock clock_type;
+using jstd::net::CaptureFileHeader;
+using jstd::net::CaptureRecord;
+
+struct frame_ref {
+    const CaptureRecord *rec;
+    const uint8_t *payload;
+    uint32_t slot;                  // index of the captured connection
+};
+
+struct replay_result {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t bytes_recvd = 0;
+    uint64_t connects = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> late_us;  // send time behind schedule
+};
+
+static sockaddr_in g_addr;
+static std::vector<frame_ref> g_frames;
+static uint32_t g_slots = 0;
+static std::atomic<bool> g_go(false);
+
+static void drain(int epfd, replay_result &res) {
+    epoll_event events[64];
+    char buff[65536];
+    int n = epoll_wait(epfd, events, 64, 0);
+    for (int i = 0; i < n; i++) {
+        ssize_t len;
+        while ((len = recv(events[i].data.fd, buff, sizeof(buff), MSG_DONTWAIT)) > 0)
+            res.bytes_recvd += static_cast<uint64_t>(len);
+        if (len == 0) epoll_ctl(epfd, EPOLL_CTL_DEL, events[i].data.fd, nullptr);   // server closed
+    }
+}
+
+static int open_conn(uint8_t proto, int epfd, replay_result &res) {
+    bool tcp = proto == static_cast<uint8_t>(jstd::net::CAPTURE_PROTO::TCP);
+    int fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    if (tcp) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&g_addr), sizeof(g_addr)) < 0) {
+        close(fd);
+        res.errors++;
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    res.connects++;
+    return fd;
+}
+
+// responses are drained while the socket is full so client and server can not block each other
+static bool send_all(int fd, const uint8_t *data, size_t len, int epfd, replay_result &res) {
+    while (len) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) return false;
+            drain(epfd, res);
+            pollfd pfd{fd, POLLOUT, 0};
+            poll(&pfd, 1, 10);
+            continue;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static void wait_until(clock_type::time_point target, int epfd, replay_result &res) {
+    while (true) {
+        auto now = clock_type::now();
+        if (now >= target) return;
+        auto left = target - now;
+        if (left > std::chrono::microseconds(500)) {
+            drain(epfd, res);
+            std::this_thread::sleep_for(left - std::chrono::microseconds(200));
+        }
+    }
+}
+
+static void replay_thread(unsigned thread, unsigned threads, unsigned copies, double speed, replay_result &res) {
+    int epfd = epoll_create1(0);
+    // unit = slot * copies + copy, this thread owns the units with unit % threads == thread
+    std::vector<std::vector<int>> fds(g_slots);
+    for (uint32_t slot = 0; slot < g_slots; slot++)
+        for (unsigned c = 0; c < copies; c++)
+            if ((slot * copies + c) % threads == thread) fds[slot].push_back(-2);    // -2 not connected yet
+    while (!g_go) std::this_thread::yield();
+    auto start = clock_type::now();
+    uint64_t first_ts = g_frames.empty() ? 0 : g_frames.front().rec->ts_ns;
+    unsigned since_drain = 0;
+    for (const auto &f : g_frames) {
+        std::vector<int> &conns = fds[f.slot];
+        if (conns.empty()) continue;
+        clock_type::time_point target = start;
+        if (speed > 0) {
+            target += std::chrono::nanoseconds(static_cast<uint64_t>((f.rec->ts_ns - first_ts) / speed));
+            wait_until(target, epfd, res);
+        }
+        bool is_close = f.rec->event == static_cast<uint8_t>(jstd::net::CAPTURE_EVENT::CLOSE);
+        for (int &fd : conns) {
+            if (is_close) {
+                if (fd >= 0) {
+                    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+                    close(fd);
+                }
+                fd = -2;
+                continue;
+            }
+            if (fd == -2) fd = open_conn(f.rec->proto, epfd, res);
+            if (fd < 0) continue;
+            if (!send_all(fd, f.payload, f.rec->len, epfd, res)) {
+                res.errors++;
+                continue;
+            }
+            res.frames++;
+            res.bytes += f.rec->len;
+        }
+        if (speed > 0 && !is_close)
+            res.late_us.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(clock_type::now() - target).count()));
+        if (++since_drain == 64) {
+            drain(epfd, res);
+            since_drain = 0;
+        }
+    }
+    // give the server a moment to answer the tail
+    auto end = clock_type::now() + std::chrono::milliseconds(200);
+    while (clock_type::now() < end) {
+        drain(epfd, res);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto &conns : fds)
+        for (int fd : conns)
+            if (fd >= 0) close(fd);
+    close(epfd);
+}
+
+int main(int argc, char **argv) {
+    double speed = 1.0;
+    unsigned copies = 1;
+    unsigned threads = 1;
+    const char *usage = "usage: trafficReplay [-s speed] [-n copies] [-t threads] capture_file ip port";
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:t:")) != -1) {
+        switch (opt) {
+            case 's': speed = std::strtod(optarg, nullptr); break;
+            case 'n': copies = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 't': threads = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            default:
+                std::cerr << usage << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (argc - optind < 3) {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+    g_addr = sockaddr_in{};
+    g_addr.sin_family = AF_INET;
+    g_addr.sin_port = htons(static_cast<uint16_t>(std::strtoul(argv[optind + 2], nullptr, 10)));
+    if (inet_aton(argv[optind + 1], &g_addr.sin_addr) == 0) {
+        std::cerr << "invalid ip address " << argv[optind + 1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(CaptureFileHeader)) {
+        std::cerr << "can not read capture file " << argv[optind] << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "mmap failed errno: " << errno << std::endl;
+        return EXIT_FAILURE;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    const uint8_t *base = static_cast<const uint8_t*>(map);
+    const auto *hdr = reinterpret_cast<const CaptureFileHeader*>(base);
+    if (hdr->magic != jstd::net::CAPTURE_MAGIC || hdr->version != jstd::net::CAPTURE_VERSION) {
+        std::cerr << "not a capture file (or unsupported version)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // index the frames, captured connection ids become dense slots
+    std::unordered_map<uint64_t, uint32_t> slots;
+    size_t pos = sizeof(CaptureFileHeader);
+    while (pos + sizeof(CaptureRecord) <= size) {
+        const auto *rec = reinterpret_cast<const CaptureRecord*>(base + pos);
+        if (pos + sizeof(CaptureRecord) + rec->len > size) break;   // truncated tail
+        auto it = slots.emplace(rec->conn_id, static_cast<uint32_t>(slots.size())).first;
+        g_frames.push_back(frame_ref{rec, base + pos + sizeof(CaptureRecord), it->second});
+        pos += sizeof(CaptureRecord) + rec->len;
+    }
+    g_slots = static_cast<uint32_t>(slots.size());
+    double captured_s = g_frames.empty() ? 0 :
+        (g_frames.back().rec->ts_ns - g_frames.front().rec->ts_ns) / 1e9;
+    std::cout << g_frames.size() << " frames on " << g_slots << " connections over " << captured_s
+              << "s captured, replaying x" << copies << " at " << (speed > 0 ? std::to_string(speed) + "x" : "max")
+              << " speed with " << threads << " thread(s)" << std::endl;
+
+    std::vector<replay_result> results(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back(replay_thread, t, threads, copies, speed, std::ref(results[t]));
+    auto start = clock_type::now();
+    g_go = true;
+    for (auto &w : workers) w.join();
+    double elapsed = std::chrono::duration<double>(clock_type::now() - start).count() - 0.2;   // minus the tail wait
+
+    replay_result total;
+    for (auto &r : results) {
+        total.frames += r.frames;
+        total.bytes += r.bytes;
+        total.bytes_recvd += r.bytes_recvd;
+        total.connects += r.connects;
+        total.errors += r.errors;
+        total.late_us.insert(total.late_us.end(), r.late_us.begin(), r.late_us.end());
+    }
+    std::sort(total.late_us.begin(), total.late_us.end());
+    auto pct = [&total](double p) -> uint32_t {
+        if (total.late_us.empty()) return 0;
+        return total.late_us[std::min(total.late_us.size() - 1, static_cast<size_t>(p * total.late_us.size()))];
+    };
+    std::cout << "sent " << total.frames << " frames, " << total.bytes << " bytes on " << total.connects
+              << " connections in " << elapsed << "s (" << static_cast<uint64_t>(total.frames / elapsed)
+              << " frames/sec), received " << total.bytes_recvd << " bytes, errors " << total.errors << "\n";
+    if (!total.late_us.empty())
+        std::cout << "schedule lag us  p50: " << pct(0.50) << "  p99: " << pct(0.99)
+                  << "  max: " << total.late_us.back() << "\n";
+    munmap(map, size);
+    return EXIT_SUCCESS;
+}